@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt4 and libtorrent.
- * Copyright (C) 2006-2012  Christophe Dumez
+ * Copyright (C) 2014  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -28,49 +28,51 @@
  * Contact : chris@qbittorrent.org
  */
 
-#include "torrentcontentmodelfile.h"
-#include "torrentcontentmodelfolder.h"
-#include "fs_utils.h"
-#include "misc.h"
+#include <QtTest>
 
-TorrentContentModelFile::TorrentContentModelFile(const libtorrent::file_entry& f,
-                                                 TorrentContentModelFolder* parent,
-                                                 int file_index)
-  : TorrentContentModelItem(parent)
-  , m_fileIndex(file_index)
-{
-  Q_ASSERT(parent);
-
-  m_name = fsutils::fileName(misc::toQStringU(f.path.c_str()));
+#include "benchmarks.h"
+#include "filterparserthread.h"
+#include "fixtures.h"
+#include "qbtsession.h"
 
-  // Do not display incomplete extensions
-  if (m_name.endsWith(".!qB"))
-    m_name.chop(4);
-
-  m_size = (qulonglong)f.size;
+static void addRangeRows()
+{
+  QTest::addColumn<int>("ranges");
+  QTest::newRow("1000 ranges") << 1000;
+  QTest::newRow("10000 ranges") << 10000;
+  QTest::newRow("100000 ranges") << 100000;
 }
 
-int TorrentContentModelFile::fileIndex() const
+void QbtBenchmarks::filterParserDat_data()
 {
-  return m_fileIndex;
+  addRangeRows();
 }
 
-void TorrentContentModelFile::setPriority(int new_prio, bool update_parent)
+void QbtBenchmarks::filterParserDat()
 {
-  Q_ASSERT(new_prio != prio::MIXED);
-
-  if (m_priority == new_prio)
-    return;
-
-  m_priority = new_prio;
+  QFETCH(int, ranges);
+  const QString path = fixtures::writeDatFilter(ranges);
+  int rules = 0;
+  QBENCHMARK {
+    FilterParserThread parser(0, QBtSession::instance()->getSession());
+    rules = parser.parseDATFilterFile(path);
+  }
+  QCOMPARE(rules, ranges);
+}
 
-  // Update parent
-  if (update_parent)
-    m_parentItem->updatePriority();
+void QbtBenchmarks::filterParserP2P_data()
+{
+  addRangeRows();
 }
 
-void TorrentContentModelFile::setProgress(qulonglong done)
+void QbtBenchmarks::filterParserP2P()
 {
-  m_totalDone = done;
-  Q_ASSERT(m_totalDone <= m_size);
+  QFETCH(int, ranges);
+  const QString path = fixtures::writeP2PFilter(ranges);
+  int rules = 0;
+  QBENCHMARK {
+    FilterParserThread parser(0, QBtSession::instance()->getSession());
+    rules = parser.parseP2PFilterFile(path);
+  }
+  QCOMPARE(rules, ranges);
 }
@@ -0,0 +1,65 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "httprequestparser.h"
+
+Q_DECLARE_METATYPE(fixtures::HttpRequest)
+
+void QbtBenchmarks::httpRequestParser_data()
+{
+  QTest::addColumn<fixtures::HttpRequest>("request");
+  QTest::addColumn<int>("torrents");
+  QTest::newRow("GET, 2 parameters") << fixtures::getRequest(2) << 0;
+  QTest::newRow("GET, 50 parameters") << fixtures::getRequest(50) << 0;
+  QTest::newRow("POST form, 50 fields") << fixtures::formRequest(50) << 0;
+  QTest::newRow("POST form, 500 fields") << fixtures::formRequest(500) << 0;
+  QTest::newRow("POST upload, 1 torrent") << fixtures::uploadRequest(1) << 1;
+  QTest::newRow("POST upload, 20 torrents") << fixtures::uploadRequest(20) << 20;
+}
+
+void QbtBenchmarks::httpRequestParser()
+{
+  QFETCH(fixtures::HttpRequest, request);
+  QFETCH(int, torrents);
+  int parsed = 0;
+  QBENCHMARK {
+    HttpRequestParser parser;
+    parser.writeHeader(request.header);
+    if (!request.message.isEmpty())
+      parser.writeMessage(request.message);
+    QVERIFY(!parser.isError());
+    parsed = parser.torrents().size();
+  }
+  QCOMPARE(parsed, torrents);
+}
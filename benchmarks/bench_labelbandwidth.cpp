@@ -0,0 +1,75 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include <limits>
+
+#include <libtorrent/session.hpp>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "labelbandwidth.h"
+#include "qbtsession.h"
+#include "torrentpersistentdata.h"
+
+void QbtBenchmarks::labelBandwidthApply()
+{
+  // One label out of ten, see fixtures::fillPersistentData()
+  fixtures::fillPersistentData(0);
+  LabelBandwidth *labelBandwidth = QBtSession::instance()->getLabelBandwidth();
+  // More than fits in bytes/s, the budget must not overflow
+  LabelLimits limits;
+  limits.downloadLimit = std::numeric_limits<int>::max();
+  limits.uploadLimit = 1024;
+  QBENCHMARK_ONCE {
+    labelBandwidth->setLabelClass("Label 0", limits);
+  }
+
+  const QHash<QString, QVariant> allData = TorrentPersistentData::getAllData();
+  const std::vector<libtorrent::torrent_handle> torrents = QBtSession::instance()->getSession()->get_torrents();
+  int members = 0;
+  std::vector<libtorrent::torrent_handle>::const_iterator it = torrents.begin();
+  std::vector<libtorrent::torrent_handle>::const_iterator itend = torrents.end();
+  for ( ; it != itend; ++it) {
+    const QTorrentHandle h(*it);
+    if (allData.value(h.hash()).toHash().value("label").toString() != "Label 0")
+      continue;
+    QVERIFY(h.download_limit() > 0);
+    QVERIFY(h.upload_limit() > 0);
+    ++members;
+  }
+  QCOMPARE(members, (fixtures::torrentCount() + 9) / 10);
+
+  QVariantMap map;
+  map["dl_limit"] = std::numeric_limits<int>::max();
+  QCOMPARE(LabelLimits::fromVariant(map).downloadLimit, std::numeric_limits<int>::max() / 1024);
+  labelBandwidth->setLabelClass("Label 0", LabelLimits());
+}
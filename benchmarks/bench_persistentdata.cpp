@@ -0,0 +1,78 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "torrentpersistentdata.h"
+
+// Every access of TorrentPersistentData goes through the whole resume
+// data of all the torrents, so the rows grow the number of entries.
+
+void QbtBenchmarks::persistentDataRead_data()
+{
+  QTest::addColumn<int>("entries");
+  QTest::newRow("100 entries") << 100;
+  QTest::newRow("1000 entries") << 1000;
+  QTest::newRow("10000 entries") << 10000;
+}
+
+void QbtBenchmarks::persistentDataRead()
+{
+  QFETCH(int, entries);
+  const QStringList hashes = fixtures::fillPersistentData(entries);
+  int i = 0;
+  QString label;
+  QBENCHMARK {
+    label = TorrentPersistentData::getLabel(hashes.at(i));
+    i = (i + 1) % hashes.size();
+  }
+  QVERIFY(!label.isEmpty());
+}
+
+void QbtBenchmarks::persistentDataWrite_data()
+{
+  QTest::addColumn<int>("entries");
+  QTest::newRow("100 entries") << 100;
+  QTest::newRow("1000 entries") << 1000;
+}
+
+void QbtBenchmarks::persistentDataWrite()
+{
+  QFETCH(int, entries);
+  const QStringList hashes = fixtures::fillPersistentData(entries);
+  int i = 0;
+  QBENCHMARK {
+    TorrentPersistentData::saveLabel(hashes.at(i), "Benchmark");
+    i = (i + 1) % hashes.size();
+  }
+  QCOMPARE(TorrentPersistentData::getLabel(hashes.first()), QString("Benchmark"));
+}
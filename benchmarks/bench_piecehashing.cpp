@@ -0,0 +1,101 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/file_storage.hpp>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "fs_utils.h"
+#include "piecehasher.h"
+
+using namespace libtorrent;
+
+static const int PIECE_SIZE = 256 * 1024;
+
+// A small file followed by the data: none of the pieces of the data
+// start on a file boundary, so the hash cache can't be used.
+// Without it, the data starts on a piece boundary and is found in the
+// hash cache after the first run.
+static file_storage hashedFiles(bool cacheable)
+{
+  const qint64 size = (qint64) fixtures::hashedMegabytes() * 1024 * 1024;
+  const QString dataPath = fixtures::workDir() + "/hashing/data.bin";
+  if (QFileInfo(dataPath).size() != size)
+    fixtures::writeDataFile("hashing/data.bin", size);
+  file_storage fs;
+  if (!cacheable) {
+    fixtures::writeDataFile("hashing/header.bin", 1000);
+    fs.add_file("hashing/header.bin", 1000);
+  }
+  fs.add_file("hashing/data.bin", size);
+  return fs;
+}
+
+void QbtBenchmarks::pieceHasher_data()
+{
+  QTest::addColumn<bool>("cacheable");
+  QTest::addColumn<int>("workers");
+  QTest::newRow("1 worker") << false << 1;
+  QTest::newRow("ideal worker count") << false << 0;
+  QTest::newRow("from the hash cache") << true << 0;
+}
+
+void QbtBenchmarks::pieceHasher()
+{
+  QFETCH(bool, cacheable);
+  QFETCH(int, workers);
+  file_storage fs = hashedFiles(cacheable);
+  const volatile bool abort = false;
+  bool ok = false;
+  if (cacheable) {
+    // Fill the cache first
+    create_torrent t(fs, PIECE_SIZE);
+    PieceHasher(t, fixtures::workDir(), workers).run(abort, PieceHasher::ProgressCallback());
+  }
+  QBENCHMARK {
+    create_torrent t(fs, PIECE_SIZE);
+    PieceHasher hasher(t, fixtures::workDir(), workers);
+    ok = hasher.run(abort, PieceHasher::ProgressCallback());
+  }
+  QVERIFY(ok);
+}
+
+// Reference: what the torrent creator used before PieceHasher
+void QbtBenchmarks::setPieceHashes()
+{
+  file_storage fs = hashedFiles(false);
+  QBENCHMARK {
+    create_torrent t(fs, PIECE_SIZE);
+    set_piece_hashes(t, fsutils::toNativePath(fixtures::workDir()).toUtf8().constData());
+  }
+}
@@ -0,0 +1,120 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include <vector>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "piecesbarkernels.h"
+
+// A bar of BAR_WIDTH pixels over the pieces, every pixel accumulating
+// the pieces it covers. The "reference" rows add the pieces one by one,
+// like the bars did before the kernels.
+static const int BAR_WIDTH = 1000;
+
+static void addPieceRows()
+{
+  QTest::addColumn<int>("pieces");
+  QTest::addColumn<bool>("reference");
+  const int counts[] = { 1000, 10000, 100000 };
+  for (uint i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+    QTest::newRow(qPrintable(QString("%1 pieces, reference").arg(counts[i]))) << counts[i] << true;
+    QTest::newRow(qPrintable(QString("%1 pieces, %2").arg(counts[i]).arg(piecesbar::kernelName()))) << counts[i] << false;
+  }
+}
+
+static float referenceBits(float value, const char *bytes, int from, int to)
+{
+  for (int i = from; i < to; ++i)
+    value += (bytes[i >> 3] >> (7 - (i & 7))) & 1;
+  return value;
+}
+
+static float referenceInts(float value, const int *values, int count)
+{
+  for (int i = 0; i < count; ++i)
+    value += values[i];
+  return value;
+}
+
+void QbtBenchmarks::piecesBarBits_data()
+{
+  addPieceRows();
+}
+
+void QbtBenchmarks::piecesBarBits()
+{
+  QFETCH(int, pieces);
+  QFETCH(bool, reference);
+  const QByteArray bytes = fixtures::pieceBitfield(pieces);
+  std::vector<float> bar(BAR_WIDTH);
+  QBENCHMARK {
+    for (int x = 0; x < BAR_WIDTH; ++x) {
+      const int from = (qint64) pieces * x / BAR_WIDTH;
+      const int to = (qint64) pieces * (x + 1) / BAR_WIDTH;
+      bar[x] = reference ? referenceBits(0, bytes.constData(), from, to)
+                         : piecesbar::accumulateBits(0, bytes.constData(), from, to);
+    }
+  }
+  // The kernels must give exactly the same bar
+  for (int x = 0; x < BAR_WIDTH; ++x) {
+    const int from = (qint64) pieces * x / BAR_WIDTH;
+    const int to = (qint64) pieces * (x + 1) / BAR_WIDTH;
+    QVERIFY(bar[x] == referenceBits(0, bytes.constData(), from, to));
+  }
+}
+
+void QbtBenchmarks::piecesBarInts_data()
+{
+  addPieceRows();
+}
+
+void QbtBenchmarks::piecesBarInts()
+{
+  QFETCH(int, pieces);
+  QFETCH(bool, reference);
+  const std::vector<int> availability = fixtures::pieceAvailability(pieces);
+  std::vector<float> bar(BAR_WIDTH);
+  QBENCHMARK {
+    for (int x = 0; x < BAR_WIDTH; ++x) {
+      const int from = (qint64) pieces * x / BAR_WIDTH;
+      const int to = (qint64) pieces * (x + 1) / BAR_WIDTH;
+      bar[x] = reference ? referenceInts(0, &availability[from], to - from)
+                         : piecesbar::accumulateInts(0, &availability[from], to - from);
+    }
+  }
+  for (int x = 0; x < BAR_WIDTH; ++x) {
+    const int from = (qint64) pieces * x / BAR_WIDTH;
+    const int to = (qint64) pieces * (x + 1) / BAR_WIDTH;
+    QVERIFY(bar[x] == referenceInts(0, &availability[from], to - from));
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "rssdownloadrulelist.h"
+
+static const char FEED_URL[] = "http://127.0.0.1/rss";
+static const int ARTICLES = 1000;
+
+static void addRuleRows()
+{
+  QTest::addColumn<int>("rules");
+  QTest::newRow("10 rules") << 10;
+  QTest::newRow("100 rules") << 100;
+  QTest::newRow("1000 rules") << 1000;
+}
+
+void QbtBenchmarks::rssRuleMatches_data()
+{
+  addRuleRows();
+}
+
+// Every rule against every article, one RssDownloadRule::matches() call
+// at a time
+void QbtBenchmarks::rssRuleMatches()
+{
+  QFETCH(int, rules);
+  const QList<RssDownloadRulePtr> ruleList = fixtures::rssRules(rules, FEED_URL);
+  const QStringList titles = fixtures::articleTitles(ARTICLES, rules);
+  int matches = 0;
+  QBENCHMARK {
+    matches = 0;
+    foreach (const QString &title, titles) {
+      foreach (const RssDownloadRulePtr &rule, ruleList) {
+        if (rule->matches(title)) {
+          ++matches;
+          break;
+        }
+      }
+    }
+  }
+  QVERIFY(matches > 0);
+}
+
+void QbtBenchmarks::rssRuleListMatching_data()
+{
+  addRuleRows();
+}
+
+// Same set of articles through RssDownloadRuleList::findMatchingRule(),
+// which matches all the rules of the feed at once
+void QbtBenchmarks::rssRuleListMatching()
+{
+  QFETCH(int, rules);
+  RssDownloadRuleList ruleList;
+  foreach (const RssDownloadRulePtr &rule, fixtures::rssRules(rules, FEED_URL))
+    ruleList.saveRule(rule);
+  const QStringList titles = fixtures::articleTitles(ARTICLES, rules);
+  int matches = 0;
+  QBENCHMARK {
+    matches = 0;
+    foreach (const QString &title, titles) {
+      if (ruleList.findMatchingRule(FEED_URL, title))
+        ++matches;
+    }
+  }
+  QVERIFY(matches > 0);
+}
@@ -0,0 +1,66 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QtTest>
+
+#include <libtorrent/session.hpp>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "qbtsession.h"
+#include "torrentmodel.h"
+
+void QbtBenchmarks::torrentModelPopulate()
+{
+  QBENCHMARK {
+    TorrentModel model;
+    model.populate();
+  }
+}
+
+void QbtBenchmarks::torrentModelStateUpdated()
+{
+  TorrentModel model;
+  model.populate();
+  QCOMPARE(model.rowCount(), fixtures::torrentCount());
+
+  // What the session posts every second when all the torrents changed
+  std::vector<libtorrent::torrent_status> statuses;
+  std::vector<libtorrent::torrent_handle> torrents = QBtSession::instance()->getSession()->get_torrents();
+  std::vector<libtorrent::torrent_handle>::const_iterator it = torrents.begin();
+  std::vector<libtorrent::torrent_handle>::const_iterator itend = torrents.end();
+  for ( ; it != itend; ++it)
+    statuses.push_back(it->status());
+
+  QBENCHMARK {
+    QMetaObject::invokeMethod(&model, "stateUpdated", Qt::DirectConnection,
+                              Q_ARG(std::vector<libtorrent::torrent_status>, statuses));
+  }
+}
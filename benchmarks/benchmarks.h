@@ -0,0 +1,92 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <QObject>
+
+// QtTest benchmarks of the hot paths of the application.
+// They run offline, against a paused local libtorrent session filled with
+// synthetic torrents, in a temporary profile (see main.cpp).
+class QbtBenchmarks: public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  // bench_persistentdata.cpp
+  void persistentDataRead_data();
+  void persistentDataRead();
+  void persistentDataWrite_data();
+  void persistentDataWrite();
+
+  // bench_btjson.cpp
+  void btjsonGetTorrents();
+
+  // bench_filterparser.cpp
+  void filterParserDat_data();
+  void filterParserDat();
+  void filterParserP2P_data();
+  void filterParserP2P();
+
+  // bench_httprequestparser.cpp
+  void httpRequestParser_data();
+  void httpRequestParser();
+
+  // bench_labelbandwidth.cpp
+  void labelBandwidthApply();
+
+#ifndef DISABLE_GUI
+  // bench_torrentmodel.cpp
+  void torrentModelPopulate();
+  void torrentModelStateUpdated();
+
+  // bench_rss.cpp
+  void rssRuleMatches_data();
+  void rssRuleMatches();
+  void rssRuleListMatching_data();
+  void rssRuleListMatching();
+
+  // bench_piecehashing.cpp
+  void pieceHasher_data();
+  void pieceHasher();
+  void setPieceHashes();
+
+  // bench_piecesbar.cpp
+  void piecesBarBits_data();
+  void piecesBarBits();
+  void piecesBarInts_data();
+  void piecesBarInts();
+#endif
+};
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,41 @@
+# Benchmarks of the hot paths of qBittorrent, built with:
+#   qmake CONFIG+=benchmarks
+# and run with run_benchmarks.sh
+TEMPLATE = app
+TARGET = qbt-benchmarks
+CONFIG += qt thread console
+CONFIG -= app_bundle
+QT += testlib
+
+# Configuration, modules and source code of the application
+include(../src/src.pri)
+
+# Nothing from the platform configuration gets installed or packaged
+INSTALLS =
+RC_FILE =
+ICON =
+QMAKE_INFO_PLIST =
+QMAKE_BUNDLE_DATA =
+
+HEADERS += $$PWD/benchmarks.h \
+           $$PWD/fixtures.h
+
+SOURCES += $$PWD/main.cpp \
+           $$PWD/fixtures.cpp \
+           $$PWD/bench_persistentdata.cpp \
+           $$PWD/bench_btjson.cpp \
+           $$PWD/bench_filterparser.cpp \
+           $$PWD/bench_httprequestparser.cpp \
+           $$PWD/bench_labelbandwidth.cpp
+
+!nox {
+  SOURCES += $$PWD/bench_torrentmodel.cpp \
+             $$PWD/bench_rss.cpp \
+             $$PWD/bench_piecehashing.cpp \
+             $$PWD/bench_piecesbar.cpp
+}
+
+DESTDIR = .
+
+OTHER_FILES += $$PWD/run_benchmarks.sh \
+               $$PWD/compare_results.py
@@ -0,0 +1,62 @@
+#!/usr/bin/env python
+# Compares two benchmark results written by run_benchmarks.sh:
+#   compare_results.py [-t THRESHOLD] baseline.xml current.xml
+# Lists every benchmark with its change and exits with status 1 if any of
+# them got slower by more than THRESHOLD percent (10 by default).
+
+import optparse
+import sys
+import xml.etree.ElementTree as ET
+
+
+def load(path, per_iteration):
+    results = {}
+    for function in ET.parse(path).getroot().iter('TestFunction'):
+        for result in function.iter('BenchmarkResult'):
+            value = float(result.get('value'))
+            # Qt 4 writes the total of all the iterations, Qt 5 the
+            # value of a single one
+            if per_iteration:
+                value /= max(int(result.get('iterations', 1)), 1)
+            key = (function.get('name'), result.get('tag'))
+            results[key] = (value, result.get('metric'))
+    return results
+
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] baseline.xml current.xml')
+    parser.add_option('-t', '--threshold', type='float', default=10.0,
+                      help='regression threshold in percent (default: %default)')
+    parser.add_option('--qt4', action='store_true', default=False,
+                      help='results were produced by a Qt 4 build')
+    options, args = parser.parse_args()
+    if len(args) != 2:
+        parser.error('expected two result files')
+
+    baseline = load(args[0], options.qt4)
+    current = load(args[1], options.qt4)
+    regressions = 0
+    for key in sorted(current):
+        name = '%s(%s)' % key if key[1] else key[0]
+        value, metric = current[key]
+        if key not in baseline:
+            print('%-70s %14.4f %s (new)' % (name, value, metric))
+            continue
+        previous = baseline[key][0]
+        change = (value - previous) * 100.0 / previous if previous else 0.0
+        flag = ''
+        if change > options.threshold:
+            flag = ' REGRESSION'
+            regressions += 1
+        print('%-70s %14.4f %s %+7.1f%%%s' % (name, value, metric, change, flag))
+    for key in sorted(set(baseline) - set(current)):
+        print('%-70s (removed)' % ('%s(%s)' % key if key[1] else key[0]))
+
+    if regressions:
+        print('%d regression(s) above %.1f%%' % (regressions, options.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
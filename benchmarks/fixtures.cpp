@@ -0,0 +1,344 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/session.hpp>
+#include <libtorrent/torrent_info.hpp>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QVariant>
+
+#include <iterator>
+
+#include "fixtures.h"
+#include "fs_utils.h"
+#include "misc.h"
+#include "qinisettings.h"
+
+using namespace libtorrent;
+
+namespace {
+  const int PIECE_SIZE = 256 * 1024;
+
+  QString workDirPath;
+  // Resume data of the session torrents, see fillPersistentData()
+  QHash<QString, QVariant> sessionResumeData;
+
+  // Deterministic pseudo random numbers (LCG)
+  class Random {
+  public:
+    explicit Random(quint32 seed): m_state(seed) {}
+    quint32 next() {
+      m_state = m_state * 1664525u + 1013904223u;
+      return m_state >> 8;
+    }
+    int bounded(int max) { return next() % max; }
+
+  private:
+    quint32 m_state;
+  };
+
+  QVariant resumeData(int index) {
+    QHash<QString, QVariant> data;
+    data["save_path"] = fixtures::workDir() + "/downloads";
+    data["label"] = QString("Label %1").arg(index % 10);
+    data["add_date"] = QDateTime(QDate(2014, 1, 1)).addSecs(index);
+    data["is_magnet"] = false;
+    return data;
+  }
+
+  QString ipv4(quint32 address) {
+    return QString("%1.%2.%3.%4").arg(address >> 24).arg((address >> 16) & 0xFF)
+        .arg((address >> 8) & 0xFF).arg(address & 0xFF);
+  }
+
+  QString writeFile(const QString &name, const QByteArray &data) {
+    const QString path = fixtures::workDir() + "/" + name;
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+      file.write(data);
+      file.close();
+    }
+    return path;
+  }
+
+  bool removeRecursively(const QString &path) {
+    QDir dir(path);
+    foreach (const QFileInfo &info, dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot)) {
+      if (info.isDir() && !info.isSymLink())
+        removeRecursively(info.absoluteFilePath());
+      else
+        QFile::remove(info.absoluteFilePath());
+    }
+    return dir.rmdir(path);
+  }
+}
+
+namespace fixtures {
+
+void setWorkDir(const QString &path)
+{
+  workDirPath = path;
+  QDir().mkpath(path);
+}
+
+QString workDir()
+{
+  return workDirPath;
+}
+
+void removeWorkDir()
+{
+  if (!workDirPath.isEmpty())
+    removeRecursively(workDirPath);
+}
+
+int torrentCount()
+{
+  bool ok;
+  const int count = qgetenv("QBT_BENCH_TORRENTS").toInt(&ok);
+  return ok && count > 0 ? count : 1000;
+}
+
+int hashedMegabytes()
+{
+  bool ok;
+  const int size = qgetenv("QBT_BENCH_HASH_MB").toInt(&ok);
+  return ok && size > 0 ? size : 64;
+}
+
+QByteArray torrentFile(int index, int pieces)
+{
+  file_storage fs;
+  fs.add_file(QString("bench-%1/data.bin").arg(index).toStdString(), (size_type) pieces * PIECE_SIZE);
+  create_torrent t(fs, PIECE_SIZE);
+  for (int piece = 0; piece < t.num_pieces(); ++piece) {
+    const QByteArray digest = QCryptographicHash::hash(QByteArray::number(index) + ':' + QByteArray::number(piece),
+                                                       QCryptographicHash::Sha1);
+    t.set_hash(piece, sha1_hash(digest.constData()));
+  }
+  std::vector<char> buffer;
+  bencode(std::back_inserter(buffer), t.generate());
+  return QByteArray(&buffer[0], buffer.size());
+}
+
+void addTorrents(session *s, int count)
+{
+  const std::string savePath = fsutils::toNativePath(workDir() + "/downloads").toUtf8().constData();
+  sessionResumeData.clear();
+  for (int i = 0; i < count; ++i) {
+    const QByteArray data = torrentFile(i, 64);
+    add_torrent_params p;
+    p.ti = new torrent_info(data.constData(), data.size());
+    p.save_path = savePath;
+    p.storage_mode = storage_mode_sparse;
+    p.flags |= add_torrent_params::flag_paused;
+    p.flags &= ~add_torrent_params::flag_auto_managed;
+    p.flags &= ~add_torrent_params::flag_duplicate_is_error;
+    const torrent_handle h = s->add_torrent(p);
+    sessionResumeData[misc::toQString(h.info_hash())] = resumeData(i);
+  }
+  // One write for all of them, the model would otherwise add the
+  // missing dates one torrent at a time
+  QIniSettings settings("qBittorrent", "qBittorrent-resume");
+  settings.setValue("torrents", sessionResumeData);
+}
+
+QStringList fillPersistentData(int count)
+{
+  QHash<QString, QVariant> allData = sessionResumeData;
+  QStringList hashes;
+  for (int i = 0; i < count; ++i) {
+    const QString hash = QCryptographicHash::hash(QByteArray::number(i), QCryptographicHash::Sha1).toHex();
+    allData[hash] = resumeData(i);
+    hashes << hash;
+  }
+  QIniSettings settings("qBittorrent", "qBittorrent-resume");
+  settings.setValue("torrents", allData);
+  return hashes;
+}
+
+QString writeDatFilter(int ranges)
+{
+  QByteArray data = "# eMule ipfilter.dat\n";
+  for (int i = 0; i < ranges; ++i) {
+    const quint32 start = 0x01000000 + i * 256;
+    data += QString("%1 - %2 , 000 , Organization %3\n").arg(ipv4(start)).arg(ipv4(start + 255)).arg(i).toLatin1();
+  }
+  return writeFile(QString("ipfilter-%1.dat").arg(ranges), data);
+}
+
+QString writeP2PFilter(int ranges)
+{
+  QByteArray data = "# PeerGuardian p2p\n";
+  for (int i = 0; i < ranges; ++i) {
+    const quint32 start = 0x01000000 + i * 256;
+    data += QString("Organization %1:%2-%3\n").arg(i).arg(ipv4(start)).arg(ipv4(start + 255)).toLatin1();
+  }
+  return writeFile(QString("ipfilter-%1.p2p").arg(ranges), data);
+}
+
+HttpRequest getRequest(int parameters)
+{
+  QByteArray path = "/json/torrents";
+  for (int i = 0; i < parameters; ++i)
+    path += (i ? "&" : "?") + QByteArray("param") + QByteArray::number(i) + "=value%20" + QByteArray::number(i);
+  HttpRequest request;
+  request.header = "GET " + path + " HTTP/1.1\r\n"
+                   "Host: 127.0.0.1:8080\r\n"
+                   "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:31.0) Gecko/20100101 Firefox/31.0\r\n"
+                   "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+                   "Accept-Encoding: gzip, deflate\r\n"
+                   "Cookie: SID=0123456789abcdef\r\n"
+                   "Connection: keep-alive";
+  return request;
+}
+
+HttpRequest formRequest(int fields)
+{
+  HttpRequest request;
+  for (int i = 0; i < fields; ++i)
+    request.message += (i ? "&" : "") + QByteArray("field") + QByteArray::number(i) + "=value%20" + QByteArray::number(i);
+  request.header = "POST /command/setPreferences HTTP/1.1\r\n"
+                   "Host: 127.0.0.1:8080\r\n"
+                   "Content-Type: application/x-www-form-urlencoded\r\n"
+                   "Content-Length: " + QByteArray::number(request.message.size()) + "\r\n"
+                   "Cookie: SID=0123456789abcdef";
+  return request;
+}
+
+HttpRequest uploadRequest(int torrents)
+{
+  const QByteArray boundary = "cH2ae0GI3KM7GI3Ij5ae0ei4Ij5Ij5";
+  HttpRequest request;
+  for (int i = 0; i < torrents; ++i) {
+    request.message += "--" + boundary + "\r\n"
+                       "Content-Disposition: form-data; name=\"torrentfile\"; filename=\"bench-" + QByteArray::number(i) + ".torrent\"\r\n"
+                       "Content-Type: application/x-bittorrent\r\n\r\n"
+                       + torrentFile(i, 1024) + "\r\n";
+  }
+  request.message += "--" + boundary + "\r\n"
+                     "Content-Disposition: form-data; name=\"Upload\"\r\n\r\n"
+                     "Submit Query\r\n"
+                     "--" + boundary + "--\r\n";
+  request.header = "POST /command/upload HTTP/1.1\r\n"
+                   "Host: 127.0.0.1:8080\r\n"
+                   "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n"
+                   "Content-Length: " + QByteArray::number(request.message.size()) + "\r\n"
+                   "Cookie: SID=0123456789abcdef";
+  return request;
+}
+
+#ifndef DISABLE_GUI
+QList<RssDownloadRulePtr> rssRules(int count, const QString &feedUrl)
+{
+  QList<RssDownloadRulePtr> rules;
+  for (int i = 0; i < count; ++i) {
+    RssDownloadRulePtr rule(new RssDownloadRule);
+    rule->setName(QString("Rule %1").arg(i));
+    rule->setMustContain(QString("show%1 720p").arg(i));
+    rule->setMustNotContain("cam");
+    rule->setRssFeeds(QStringList() << feedUrl);
+    rule->setEnabled(true);
+    rules << rule;
+  }
+  return rules;
+}
+
+QStringList articleTitles(int count, int shows)
+{
+  static const char *const qualities[] = { "720p HDTV x264", "1080p WEB-DL", "720p CAM", "HDTV XviD" };
+  Random random(count);
+  QStringList titles;
+  for (int i = 0; i < count; ++i) {
+    titles << QString("Show%1 S%2E%3 %4").arg(random.bounded(2 * shows))
+              .arg(random.bounded(10) + 1, 2, 10, QChar('0'))
+              .arg(random.bounded(24) + 1, 2, 10, QChar('0'))
+              .arg(qualities[random.bounded(4)]);
+  }
+  return titles;
+}
+
+QString writeDataFile(const QString &name, qint64 size)
+{
+  const QString path = workDir() + "/" + name;
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return path;
+  Random random(size);
+  QByteArray block(1024 * 1024, 0);
+  while (size > 0) {
+    for (int i = 0; i < block.size(); ++i)
+      block[i] = char(random.next());
+    const qint64 length = qMin(size, (qint64) block.size());
+    file.write(block.constData(), length);
+    size -= length;
+  }
+  file.close();
+  return path;
+}
+
+QByteArray pieceBitfield(int count)
+{
+  // Runs of downloaded and missing pieces, like a partially
+  // downloaded torrent
+  QByteArray bytes((count + 7) / 8, 0);
+  Random random(count);
+  bool have = false;
+  for (int piece = 0; piece < count; ) {
+    const int run = qMin(count - piece, random.bounded(64) + 1);
+    if (have) {
+      for (int i = piece; i < piece + run; ++i)
+        bytes.data()[i / 8] |= 0x80 >> (i % 8);
+    }
+    piece += run;
+    have = !have;
+  }
+  return bytes;
+}
+
+std::vector<int> pieceAvailability(int count)
+{
+  std::vector<int> availability(count);
+  Random random(count);
+  for (int piece = 0; piece < count; ++piece)
+    availability[piece] = random.bounded(50);
+  return availability;
+}
+#endif
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#ifndef DISABLE_GUI
+#include "rssdownloadrule.h"
+#endif
+
+namespace libtorrent {
+  class session;
+}
+
+// Synthetic data sets of the benchmarks. Everything is deterministic so
+// that the results of two runs can be compared.
+namespace fixtures {
+
+  // Scratch directory of the run (the temporary profile)
+  void setWorkDir(const QString &path);
+  QString workDir();
+  void removeWorkDir();
+
+  // Number of torrents in the session (QBT_BENCH_TORRENTS, 1000 by default)
+  int torrentCount();
+  // Size of the data hashed by the torrent creator benchmarks
+  // (QBT_BENCH_HASH_MB, 64 by default)
+  int hashedMegabytes();
+
+  // Bencoded torrent with a single file of 'pieces' 256KiB pieces
+  QByteArray torrentFile(int index, int pieces);
+  // Adds 'count' paused, non auto managed torrents to the session,
+  // with their resume data
+  void addTorrents(libtorrent::session *s, int count);
+
+  // Replaces the resume data by the one of the session torrents plus
+  // 'count' other torrents, returns the hashes of the latter
+  QStringList fillPersistentData(int count);
+
+  // IP filter files with 'ranges' distinct IPv4 ranges
+  QString writeDatFilter(int ranges);
+  QString writeP2PFilter(int ranges);
+
+  // Raw request as split by HttpConnection
+  struct HttpRequest {
+    QByteArray header;
+    QByteArray message;
+  };
+  HttpRequest getRequest(int parameters);
+  HttpRequest formRequest(int fields);
+  HttpRequest uploadRequest(int torrents);
+
+#ifndef DISABLE_GUI
+  // Enabled rules for 'feedUrl', rule i wants "show<i> 720p" and no "cam"
+  QList<RssDownloadRulePtr> rssRules(int count, const QString &feedUrl);
+  // Article titles about random shows in [0, 2 * shows), so that about
+  // half of them match one of the rules above
+  QStringList articleTitles(int count, int shows);
+
+  // Writes 'size' bytes of pseudo random data in the work directory
+  QString writeDataFile(const QString &name, qint64 size);
+  // Pieces bar inputs: 'count' pieces, about half of them downloaded,
+  // and the availability of each piece
+  QByteArray pieceBitfield(int count);
+  std::vector<int> pieceAvailability(int count);
+#endif
+
+}
+
+#endif // FIXTURES_H
@@ -0,0 +1,102 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+#include <QtTest>
+
+#include <libtorrent/session.hpp>
+
+#include "benchmarks.h"
+#include "fixtures.h"
+#include "preferences.h"
+#include "qbtsession.h"
+
+void QbtBenchmarks::initTestCase()
+{
+  // Nothing may leave the machine: no DHT, peer discovery, port
+  // mapping or web server. The torrents are paused anyway.
+  {
+    Preferences pref;
+    pref.setDHTEnabled(false);
+    pref.setLSDEnabled(false);
+    pref.setPeXEnabled(false);
+    pref.setUPnPEnabled(false);
+    pref.setRandomPort(true);
+    pref.setWebUiEnabled(false);
+    pref.setTrackerEnabled(false);
+    pref.setFilteringEnabled(false);
+    pref.setQueueingSystemEnabled(false);
+  }
+  libtorrent::session *s = QBtSession::instance()->getSession();
+  fixtures::addTorrents(s, fixtures::torrentCount());
+  QCOMPARE((int) s->get_torrents().size(), fixtures::torrentCount());
+}
+
+void QbtBenchmarks::cleanupTestCase()
+{
+  // Remove the synthetic torrents first, so that no fast resume data
+  // gets saved for them
+  libtorrent::session *s = QBtSession::instance()->getSession();
+  std::vector<libtorrent::torrent_handle> torrents = s->get_torrents();
+  std::vector<libtorrent::torrent_handle>::const_iterator it = torrents.begin();
+  std::vector<libtorrent::torrent_handle>::const_iterator itend = torrents.end();
+  for ( ; it != itend; ++it)
+    s->remove_torrent(*it);
+  QBtSession::drop();
+}
+
+int main(int argc, char *argv[])
+{
+  // Run in a temporary profile: the settings, resume data and caches of
+  // the user must neither be read nor modified. The environment covers
+  // the XDG locations, the settings are redirected below.
+  const QString profile = QDir::temp().absoluteFilePath(QString("qbt-benchmarks-%1").arg(QCoreApplication::applicationPid()));
+  fixtures::setWorkDir(profile);
+  qputenv("HOME", QFile::encodeName(profile));
+  qputenv("XDG_CONFIG_HOME", QFile::encodeName(profile + "/config"));
+  qputenv("XDG_DATA_HOME", QFile::encodeName(profile + "/data"));
+  qputenv("XDG_CACHE_HOME", QFile::encodeName(profile + "/cache"));
+
+  // Benchmarks don't need a display, even in the GUI build
+  QCoreApplication app(argc, argv);
+  QSettings::setDefaultFormat(QSettings::IniFormat);
+  QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, profile + "/config");
+
+  int ret;
+  {
+    QbtBenchmarks benchmarks;
+    ret = QTest::qExec(&benchmarks, app.arguments());
+  }
+  fixtures::removeWorkDir();
+  return ret;
+}
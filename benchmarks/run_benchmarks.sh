@@ -0,0 +1,24 @@
+#!/bin/sh
+# Runs the benchmarks and stores the results in the QtTest XML format,
+# one file per run named after the date and the git revision:
+#   ./run_benchmarks.sh [results directory] [QtTest options...]
+# Two runs can then be compared with compare_results.py.
+# QBT_BENCH_TORRENTS and QBT_BENCH_HASH_MB change the fixture sizes.
+
+BENCHMARKS=${BENCHMARKS:-./qbt-benchmarks}
+RESULTS_DIR=${1:-results}
+[ $# -gt 0 ] && shift
+
+if [ ! -x "$BENCHMARKS" ]; then
+  echo "$BENCHMARKS not found, build with: qmake CONFIG+=benchmarks && make" >&2
+  exit 1
+fi
+
+REVISION=$(git -C "$(dirname "$0")" describe --always --dirty 2>/dev/null || echo unknown)
+mkdir -p "$RESULTS_DIR" || exit 1
+OUTPUT="$RESULTS_DIR/$(date +%Y%m%d-%H%M%S)-$REVISION.xml"
+
+"$BENCHMARKS" -xml -o "$OUTPUT" "$@"
+STATUS=$?
+echo "Results written to $OUTPUT"
+exit $STATUS
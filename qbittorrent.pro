@@ -2,6 +2,11 @@ TEMPLATE = subdirs
 
 SUBDIRS += src
 
+# Benchmarks, enabled with: qmake CONFIG+=benchmarks
+benchmarks {
+  SUBDIRS += benchmarks
+}
+
 include(version.pri)
 include(qm_gen.pri)
 
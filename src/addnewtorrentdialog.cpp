@@ -289,12 +289,7 @@ void AddNewTorrentDialog::updateDiskSpaceLabel()
   // Determine torrent size
   qulonglong torrent_size = 0;
   if (m_contentModel) {
-    const std::vector<int> priorities = m_contentModel->model()->getFilesPriorities();
-    Q_ASSERT(priorities.size() == (uint) m_torrentInfo->num_files());
-    for (uint i=0; i<priorities.size(); ++i) {
-      if (priorities[i] > 0)
-        torrent_size += m_torrentInfo->files().file_size(i);
-    }
+    torrent_size = m_contentModel->model()->selectedSize();
   } else {
     torrent_size = m_torrentInfo->total_size();
   }
@@ -406,15 +401,12 @@ void AddNewTorrentDialog::renameSelectedFile()
       new_name = fsutils::expandPath(new_name);
       qDebug("New name: %s", qPrintable(new_name));
       // Check if that name is already used
-      for (int i=0; i<m_torrentInfo->num_files(); ++i) {
-        if (i == file_index) continue;
-        if (fsutils::sameFileNames(m_filesPath.at(i), new_name)) {
-          // Display error message
-          MessageBoxRaised::warning(this, tr("The file could not be renamed"),
-                               tr("This name is already in use in this folder. Please use a different name."),
-                               QMessageBox::Ok);
-          return;
-        }
+      if (m_contentModel->model()->hasSiblingNamed(m_contentModel->mapToSource(index), new_name_last)) {
+        // Display error message
+        MessageBoxRaised::warning(this, tr("The file could not be renamed"),
+                             tr("This name is already in use in this folder. Please use a different name."),
+                             QMessageBox::Ok);
+        return;
       }
       qDebug("Renaming %s to %s", qPrintable(old_name), qPrintable(new_name));
       // Rename file in files_path
@@ -437,21 +429,15 @@ void AddNewTorrentDialog::renameSelectedFile()
       QString new_path = path_items.join("/");
       if (!new_path.endsWith("/")) new_path += "/";
       // Check for overwriting
-      for (int i=0; i<m_torrentInfo->num_files(); ++i) {
-        const QString &current_name = m_filesPath.at(i);
-#if defined(Q_OS_UNIX) || defined(Q_WS_QWS)
-        if (current_name.startsWith(new_path, Qt::CaseSensitive)) {
-#else
-        if (current_name.startsWith(new_path, Qt::CaseInsensitive)) {
-#endif
-          MessageBoxRaised::warning(this, tr("The folder could not be renamed"),
-                               tr("This name is already in use in this folder. Please use a different name."),
-                               QMessageBox::Ok);
-          return;
-        }
+      const QModelIndex source_index = m_contentModel->mapToSource(index);
+      if (m_contentModel->model()->hasSiblingNamed(source_index, new_name_last)) {
+        MessageBoxRaised::warning(this, tr("The folder could not be renamed"),
+                             tr("This name is already in use in this folder. Please use a different name."),
+                             QMessageBox::Ok);
+        return;
       }
-      // Replace path in all files
-      for (int i=0; i<m_torrentInfo->num_files(); ++i) {
+      // Replace path in the files of the folder
+      foreach (int i, m_contentModel->model()->folderFileIndexes(source_index)) {
         const QString &current_name = m_filesPath.at(i);
         if (current_name.startsWith(old_path)) {
           QString new_name = current_name;
@@ -0,0 +1,7 @@
+INCLUDEPATH += $$PWD
+
+HEADERS += $$PWD/controlserver.h \
+           $$PWD/controlconnection.h
+
+SOURCES += $$PWD/controlserver.cpp \
+           $$PWD/controlconnection.cpp
@@ -0,0 +1,506 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "controlconnection.h"
+#include "fs_utils.h"
+#include "jsonutils.h"
+#include "misc.h"
+#include "preferences.h"
+#include "qbtsession.h"
+#include "sessionsnapshot.h"
+#include "torrentpersistentdata.h"
+
+#include <QDebug>
+#include <QLocalSocket>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+using namespace libtorrent;
+
+namespace {
+  // A client sending a longer line is disconnected
+  const int MAX_LINE_SIZE = 4 * 1024 * 1024;
+  // Events are dropped while the client has that much left to read
+  const qint64 MAX_PENDING_EVENT_BYTES = 1024 * 1024;
+
+  bool anyTorrent(const torrent_status &) {
+    return true;
+  }
+
+  bool wanted(const QSet<QString> &fields, const char *field) {
+    return fields.isEmpty() || fields.contains(QString::fromLatin1(field));
+  }
+
+  // The persistent data is loaded once per request by the caller
+  QVariantMap torrentStatus(const torrent_status &status, const QString &hash, const QSet<QString> &fields,
+                            const QHash<QString, QVariant> &allData) {
+    QBtSession *session = QBtSession::instance();
+    const QHash<QString, QVariant> data = allData.value(hash).toHash();
+    QVariantMap ret;
+    if (wanted(fields, "hash"))
+      ret["hash"] = hash;
+    if (wanted(fields, "name")) {
+      QString name = data.value("name").toString();
+      if (name.isEmpty())
+        name = misc::toQStringU(status.name);
+      ret["name"] = name;
+    }
+    if (wanted(fields, "state"))
+      ret["state"] = SessionSnapshotService::torrentState(status);
+    if (wanted(fields, "progress"))
+      ret["progress"] = (double) QTorrentHandle::progress(status);
+    if (wanted(fields, "size"))
+      ret["size"] = (qlonglong) status.total_wanted;
+    if (wanted(fields, "dlspeed"))
+      ret["dlspeed"] = status.download_payload_rate;
+    if (wanted(fields, "upspeed"))
+      ret["upspeed"] = status.upload_payload_rate;
+    if (wanted(fields, "priority"))
+      ret["priority"] = session->isQueueingEnabled() ? QTorrentHandle::queue_position(status) : -1;
+    if (wanted(fields, "num_seeds"))
+      ret["num_seeds"] = status.num_seeds;
+    if (wanted(fields, "num_leechs"))
+      ret["num_leechs"] = status.num_peers - status.num_seeds;
+    if (wanted(fields, "ratio"))
+      ret["ratio"] = (double) session->getRealRatio(status);
+    if (wanted(fields, "eta"))
+      ret["eta"] = session->getETA(hash, status);
+    if (wanted(fields, "label"))
+      ret["label"] = data.value("label").toString();
+    if (wanted(fields, "save_path"))
+      ret["save_path"] = fsutils::toNativePath(misc::toQStringU(status.save_path));
+    return ret;
+  }
+}
+
+ControlConnection::ControlConnection(QLocalSocket *socket, QObject *parent)
+  : QObject(parent)
+  , m_socket(socket)
+{
+  m_socket->setParent(this);
+  connect(m_socket, SIGNAL(readyRead()), SLOT(read()));
+  connect(m_socket, SIGNAL(disconnected()), SLOT(deleteLater()));
+
+  QBtSession *session = QBtSession::instance();
+  connect(session, SIGNAL(addedTorrent(QTorrentHandle)), SLOT(handleTorrentAdded(QTorrentHandle)));
+  connect(session, SIGNAL(deletedTorrent(QString)), SLOT(handleTorrentDeleted(QString)));
+  connect(session, SIGNAL(pausedTorrent(QTorrentHandle)), SLOT(handleTorrentPaused(QTorrentHandle)));
+  connect(session, SIGNAL(resumedTorrent(QTorrentHandle)), SLOT(handleTorrentResumed(QTorrentHandle)));
+  connect(session, SIGNAL(finishedTorrent(QTorrentHandle)), SLOT(handleTorrentFinished(QTorrentHandle)));
+  connect(session, SIGNAL(newConsoleMessage(QString)), SLOT(handleLogMessage(QString)));
+  connect(session->getSnapshotService(), SIGNAL(snapshotUpdated()), SLOT(handleSnapshotUpdated()));
+}
+
+void ControlConnection::read()
+{
+  m_buffer += m_socket->readAll();
+  int start = 0;
+  int end;
+  while ((end = m_buffer.indexOf('\n', start)) >= 0) {
+    const QByteArray line = m_buffer.mid(start, end - start).trimmed();
+    start = end + 1;
+    if (!line.isEmpty())
+      handleMessage(line);
+  }
+  m_buffer.remove(0, start);
+
+  if (m_buffer.size() > MAX_LINE_SIZE) {
+    qWarning() << "Control socket message too long, disconnecting the client";
+    m_buffer.clear();
+    m_socket->disconnectFromServer();
+  }
+}
+
+void ControlConnection::handleMessage(const QByteArray &line)
+{
+  const QVariant message = json::fromJson(QString::fromUtf8(line));
+  QVariantMap response;
+  if (message.type() != QVariant::Map) {
+    response["error"] = "Invalid message";
+    send(response);
+    return;
+  }
+
+  const QVariantMap request = message.toMap();
+  if (request.contains("id"))
+    response["id"] = request.value("id");
+  QString error;
+  const QVariant result = call(request.value("method").toString(), request.value("params").toMap(), error);
+  if (error.isEmpty())
+    response["result"] = result;
+  else
+    response["error"] = error;
+  send(response);
+}
+
+QVariant ControlConnection::call(const QString &method, const QVariantMap &params, QString &error)
+{
+  if (method == "add")
+    return add(params, error);
+  if (method == "status")
+    return status(params, error);
+  if (method == "pause")
+    return pause(params, error);
+  if (method == "resume")
+    return resume(params, error);
+  if (method == "delete")
+    return remove(params, error);
+  if (method == "setLimits")
+    return setLimits(params, error);
+  if (method == "setQueuePosition")
+    return setQueuePosition(params, error);
+  if (method == "setFilePriority")
+    return setFilePriority(params, error);
+  if (method == "subscribe")
+    return subscribe(params, error);
+  if (method == "unsubscribe")
+    return unsubscribe(params, error);
+  error = "Unknown method: " + method;
+  return QVariant();
+}
+
+void ControlConnection::send(const QVariantMap &message)
+{
+  QByteArray data = json::toCompactJson(message);
+  data += '\n';
+  m_socket->write(data);
+}
+
+void ControlConnection::sendEvent(const QString &event, const QString &key, const QVariant &value)
+{
+  if (!m_events.contains(event) || m_socket->bytesToWrite() > MAX_PENDING_EVENT_BYTES)
+    return;
+  QVariantMap message;
+  message["event"] = event;
+  if (!key.isEmpty())
+    message[key] = value;
+  send(message);
+}
+
+// Returns the number of torrents queued for addition
+QVariant ControlConnection::add(const QVariantMap &params, QString &error)
+{
+  const QStringList urls = params.value("urls").toStringList();
+  if (urls.isEmpty()) {
+    error = "urls is required";
+    return QVariant();
+  }
+  const QString savePath = params.value("savepath").toString();
+  const QString label = params.value("label").toString();
+
+  QBtSession *session = QBtSession::instance();
+  int count = 0;
+  foreach (QString url, urls) {
+    url = url.trimmed();
+    if (url.isEmpty())
+      continue;
+    if (url.startsWith("bc://bt/", Qt::CaseInsensitive))
+      url = misc::bcLinkToMagnet(url);
+    if (url.startsWith("magnet:", Qt::CaseInsensitive))
+      session->addMagnetSkipAddDlg(url, savePath, label);
+    else if (url.startsWith("http://", Qt::CaseInsensitive) || url.startsWith("https://", Qt::CaseInsensitive)
+             || url.startsWith("ftp://", Qt::CaseInsensitive))
+      session->downloadUrlAndSkipDialog(url, savePath, label);
+    else
+      session->addTorrent(fsutils::fromNativePath(url));
+    ++count;
+  }
+  return count;
+}
+
+QVariant ControlConnection::status(const QVariantMap &params, QString &error)
+{
+  Q_UNUSED(error);
+  const QSet<QString> fields = params.value("fields").toStringList().toSet();
+  const QSet<QString> hashes = params.value("hashes").toStringList().toSet();
+
+  // A single round trip to the network thread for all the torrents
+  std::vector<torrent_status> statuses;
+  QBtSession::instance()->getSession()->get_torrent_status(&statuses, &anyTorrent,
+                                                           torrent_handle::query_name | torrent_handle::query_save_path);
+  const QHash<QString, QVariant> allData = TorrentPersistentData::getAllData();
+  QVariantList ret;
+  std::vector<torrent_status>::const_iterator it = statuses.begin();
+  std::vector<torrent_status>::const_iterator end = statuses.end();
+  for ( ; it != end; ++it) {
+    const QString hash = misc::toQString(it->handle.info_hash());
+    if (hashes.isEmpty() || hashes.contains(hash))
+      ret << torrentStatus(*it, hash, fields, allData);
+  }
+  return ret;
+}
+
+QVariant ControlConnection::pause(const QVariantMap &params, QString &error)
+{
+  Q_UNUSED(error);
+  const QStringList hashes = params.value("hashes").toStringList();
+  if (hashes.isEmpty())
+    QBtSession::instance()->pauseAllTorrents();
+  foreach (const QString &hash, hashes)
+    QBtSession::instance()->pauseTorrent(hash);
+  return true;
+}
+
+QVariant ControlConnection::resume(const QVariantMap &params, QString &error)
+{
+  Q_UNUSED(error);
+  const QStringList hashes = params.value("hashes").toStringList();
+  if (hashes.isEmpty())
+    QBtSession::instance()->resumeAllTorrents();
+  foreach (const QString &hash, hashes)
+    QBtSession::instance()->resumeTorrent(hash);
+  return true;
+}
+
+QVariant ControlConnection::remove(const QVariantMap &params, QString &error)
+{
+  const QStringList hashes = params.value("hashes").toStringList();
+  if (hashes.isEmpty()) {
+    error = "hashes is required";
+    return QVariant();
+  }
+  const bool deleteFiles = params.value("delete_files").toBool();
+  foreach (const QString &hash, hashes)
+    QBtSession::instance()->deleteTorrent(hash, deleteFiles);
+  return true;
+}
+
+QVariant ControlConnection::setLimits(const QVariantMap &params, QString &error)
+{
+  const bool hasDlLimit = params.contains("dl_limit");
+  const bool hasUpLimit = params.contains("up_limit");
+  if (!hasDlLimit && !hasUpLimit) {
+    error = "dl_limit or up_limit is required";
+    return QVariant();
+  }
+  qlonglong dlLimit = params.value("dl_limit").toLongLong();
+  if (dlLimit <= 0) dlLimit = -1;
+  qlonglong upLimit = params.value("up_limit").toLongLong();
+  if (upLimit <= 0) upLimit = -1;
+
+  QBtSession *session = QBtSession::instance();
+  const QStringList hashes = params.value("hashes").toStringList();
+  if (hashes.isEmpty()) {
+    Preferences pref;
+    if (hasDlLimit) {
+      session->setDownloadRateLimit(dlLimit);
+      pref.setGlobalDownloadLimit(dlLimit / 1024);
+    }
+    if (hasUpLimit) {
+      session->setUploadRateLimit(upLimit);
+      pref.setGlobalUploadLimit(upLimit / 1024);
+    }
+    return true;
+  }
+  foreach (const QString &hash, hashes) {
+    QTorrentHandle h = session->getTorrentHandle(hash);
+    if (!h.is_valid())
+      continue;
+    if (hasDlLimit)
+      h.set_download_limit(dlLimit);
+    if (hasUpLimit)
+      h.set_upload_limit(upLimit);
+  }
+  return true;
+}
+
+QVariant ControlConnection::setQueuePosition(const QVariantMap &params, QString &error)
+{
+  const QStringList hashes = params.value("hashes").toStringList();
+  const QString action = params.value("action").toString();
+  if (hashes.isEmpty() || action.isEmpty()) {
+    error = "hashes and action are required";
+    return QVariant();
+  }
+
+  QBtSession *session = QBtSession::instance();
+  if (action == "top" || action == "bottom") {
+    foreach (const QString &hash, hashes) {
+      QTorrentHandle h = session->getTorrentHandle(hash);
+      if (!h.is_valid())
+        continue;
+      if (action == "top")
+        h.queue_position_top();
+      else
+        h.queue_position_bottom();
+    }
+    return true;
+  }
+  if (action == "up") {
+    // Starting with the first in the queue, as the Web UI does
+    std::priority_queue<QPair<int, QTorrentHandle>,
+        std::vector<QPair<int, QTorrentHandle> >,
+        std::greater<QPair<int, QTorrentHandle> > > torrent_queue;
+    foreach (const QString &hash, hashes) {
+      QTorrentHandle h = session->getTorrentHandle(hash);
+      if (h.is_valid() && !h.is_seed())
+        torrent_queue.push(qMakePair(h.queue_position(), h));
+    }
+    for ( ; !torrent_queue.empty(); torrent_queue.pop()) {
+      try {
+        QTorrentHandle h = torrent_queue.top().second;
+        h.queue_position_up();
+      } catch(invalid_handle&) {}
+    }
+    return true;
+  }
+  if (action == "down") {
+    // Starting with the last in the queue
+    std::priority_queue<QPair<int, QTorrentHandle>,
+        std::vector<QPair<int, QTorrentHandle> >,
+        std::less<QPair<int, QTorrentHandle> > > torrent_queue;
+    foreach (const QString &hash, hashes) {
+      QTorrentHandle h = session->getTorrentHandle(hash);
+      if (h.is_valid() && !h.is_seed())
+        torrent_queue.push(qMakePair(h.queue_position(), h));
+    }
+    for ( ; !torrent_queue.empty(); torrent_queue.pop()) {
+      try {
+        QTorrentHandle h = torrent_queue.top().second;
+        h.queue_position_down();
+      } catch(invalid_handle&) {}
+    }
+    return true;
+  }
+  error = "Unknown action: " + action;
+  return QVariant();
+}
+
+QVariant ControlConnection::setFilePriority(const QVariantMap &params, QString &error)
+{
+  const QString hash = params.value("hash").toString();
+  const QVariantList files = params.value("files").toList();
+  bool ok = false;
+  const int priority = params.value("priority").toInt(&ok);
+  if (hash.isEmpty() || files.isEmpty() || !ok) {
+    error = "hash, files and priority are required";
+    return QVariant();
+  }
+  if (priority < 0 || priority > 7) {
+    error = "priority must be between 0 and 7";
+    return QVariant();
+  }
+  QTorrentHandle h = QBtSession::instance()->getTorrentHandle(hash);
+  if (!h.is_valid() || !h.has_metadata()) {
+    error = "Unknown torrent, or its metadata isn't there yet";
+    return QVariant();
+  }
+  const int numFiles = h.num_files();
+  foreach (const QVariant &file, files) {
+    const int index = file.toInt();
+    if (index >= 0 && index < numFiles)
+      h.file_priority(index, priority);
+  }
+  return true;
+}
+
+QVariant ControlConnection::subscribe(const QVariantMap &params, QString &error)
+{
+  QStringList events = params.value("events").toStringList();
+  if (events.isEmpty())
+    events = eventNames();
+  foreach (const QString &event, events) {
+    if (!eventNames().contains(event)) {
+      error = "Unknown event: " + event;
+      return QVariant();
+    }
+  }
+  m_events += events.toSet();
+  QStringList ret = m_events.toList();
+  ret.sort();
+  return ret;
+}
+
+QVariant ControlConnection::unsubscribe(const QVariantMap &params, QString &error)
+{
+  Q_UNUSED(error);
+  const QStringList events = params.value("events").toStringList();
+  if (events.isEmpty())
+    m_events.clear();
+  else
+    m_events -= events.toSet();
+  QStringList ret = m_events.toList();
+  ret.sort();
+  return ret;
+}
+
+QStringList ControlConnection::eventNames()
+{
+  static const QStringList names = QStringList() << "added" << "deleted" << "paused" << "resumed"
+                                                 << "finished" << "log" << "transfer";
+  return names;
+}
+
+void ControlConnection::handleTorrentAdded(const QTorrentHandle &h)
+{
+  sendEvent("added", "hash", h.hash());
+}
+
+void ControlConnection::handleTorrentDeleted(const QString &hash)
+{
+  sendEvent("deleted", "hash", hash);
+}
+
+void ControlConnection::handleTorrentPaused(const QTorrentHandle &h)
+{
+  sendEvent("paused", "hash", h.hash());
+}
+
+void ControlConnection::handleTorrentResumed(const QTorrentHandle &h)
+{
+  sendEvent("resumed", "hash", h.hash());
+}
+
+void ControlConnection::handleTorrentFinished(const QTorrentHandle &h)
+{
+  sendEvent("finished", "hash", h.hash());
+}
+
+void ControlConnection::handleLogMessage(const QString &msg)
+{
+  sendEvent("log", "msg", msg);
+}
+
+void ControlConnection::handleSnapshotUpdated()
+{
+  if (!m_events.contains("transfer") || m_socket->bytesToWrite() > MAX_PENDING_EVENT_BYTES)
+    return;
+  const SessionSnapshotPtr snapshot = QBtSession::instance()->sessionSnapshot();
+  QVariantMap message;
+  message["event"] = "transfer";
+  message["dl_rate"] = snapshot->status.payload_download_rate;
+  message["up_rate"] = snapshot->status.payload_upload_rate;
+  message["dl_total"] = (qlonglong) snapshot->status.total_payload_download;
+  message["up_total"] = (qlonglong) snapshot->status.total_payload_upload;
+  message["peers"] = snapshot->status.num_peers;
+  send(message);
+}
@@ -0,0 +1,111 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef CONTROLCONNECTION_H
+#define CONTROLCONNECTION_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QSet>
+#include <QStringList>
+#include <QVariant>
+
+QT_BEGIN_NAMESPACE
+class QLocalSocket;
+QT_END_NAMESPACE
+
+class QTorrentHandle;
+
+// One client of the control socket.
+//
+// Methods, the params are optional unless noted:
+//   add              {"urls": [...] (required), "savepath", "label"}
+//                    torrent files, http(s)/ftp URLs and magnet links;
+//                    savepath and label apply to URLs and magnets
+//   status           {"hashes": [...], "fields": [...]}
+//                    fields: hash, name, state, progress, size, dlspeed,
+//                    upspeed, priority, num_seeds, num_leechs, ratio,
+//                    eta, label, save_path; all of them by default
+//   pause, resume    {"hashes": [...]}, all the torrents by default
+//   delete           {"hashes": [...] (required), "delete_files"}
+//   setLimits        {"hashes": [...], "dl_limit", "up_limit"}
+//                    in bytes/s, 0 for unlimited; global without hashes
+//   setQueuePosition {"hashes": [...], "action": top|bottom|up|down}
+//                    (both required)
+//   setFilePriority  {"hash", "files": [...], "priority"} (all required)
+//   subscribe        {"events": [...]}, all of them by default
+//   unsubscribe      {"events": [...]}, all of them by default
+//
+// Events: added, deleted, paused, resumed, finished (with "hash"),
+// log (with "msg"), transfer (with the global rates, once per tick).
+class ControlConnection : public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(ControlConnection)
+
+public:
+  ControlConnection(QLocalSocket *socket, QObject *parent = 0);
+
+private slots:
+  void read();
+  void handleTorrentAdded(const QTorrentHandle &h);
+  void handleTorrentDeleted(const QString &hash);
+  void handleTorrentPaused(const QTorrentHandle &h);
+  void handleTorrentResumed(const QTorrentHandle &h);
+  void handleTorrentFinished(const QTorrentHandle &h);
+  void handleLogMessage(const QString &msg);
+  void handleSnapshotUpdated();
+
+private:
+  void handleMessage(const QByteArray &line);
+  QVariant call(const QString &method, const QVariantMap &params, QString &error);
+  void send(const QVariantMap &message);
+  void sendEvent(const QString &event, const QString &key = QString(), const QVariant &value = QVariant());
+
+  QVariant add(const QVariantMap &params, QString &error);
+  QVariant status(const QVariantMap &params, QString &error);
+  QVariant pause(const QVariantMap &params, QString &error);
+  QVariant resume(const QVariantMap &params, QString &error);
+  QVariant remove(const QVariantMap &params, QString &error);
+  QVariant setLimits(const QVariantMap &params, QString &error);
+  QVariant setQueuePosition(const QVariantMap &params, QString &error);
+  QVariant setFilePriority(const QVariantMap &params, QString &error);
+  QVariant subscribe(const QVariantMap &params, QString &error);
+  QVariant unsubscribe(const QVariantMap &params, QString &error);
+
+  static QStringList eventNames();
+
+private:
+  QLocalSocket *m_socket;
+  QByteArray m_buffer;
+  QSet<QString> m_events;
+};
+
+#endif // CONTROLCONNECTION_H
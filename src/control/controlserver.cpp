@@ -0,0 +1,101 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "controlserver.h"
+#include "controlconnection.h"
+#include "fs_utils.h"
+
+#include <QFile>
+#include <QLocalSocket>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+ControlServer::ControlServer(QObject *parent)
+  : QLocalServer(parent)
+{
+  connect(this, SIGNAL(newConnection()), SLOT(handleNewConnection()));
+}
+
+ControlServer::~ControlServer()
+{
+  // Removes the socket file
+  close();
+}
+
+bool ControlServer::start(const QString &path)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+  setSocketOptions(QLocalServer::UserAccessOption);
+#endif
+  m_error.clear();
+#ifdef Q_OS_UNIX
+  // Left behind by a crash, nobody is listening on it anymore. Anything
+  // else than a socket is the user's, never remove it.
+  struct stat st;
+  if (::lstat(QFile::encodeName(path).constData(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      m_error = tr("%1 exists and is not a socket").arg(path);
+      return false;
+    }
+    QLocalServer::removeServer(path);
+  }
+#else
+  QLocalServer::removeServer(path);
+#endif
+#if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0)) && defined(Q_OS_UNIX)
+  // Never accessible to the others, not even until the chmod
+  const mode_t oldMask = ::umask(077);
+  const bool listening = listen(path);
+  ::umask(oldMask);
+  if (listening)
+    QFile::setPermissions(fullServerName(), QFile::ReadOwner | QFile::WriteOwner);
+  return listening;
+#else
+  return listen(path);
+#endif
+}
+
+QString ControlServer::errorString() const
+{
+  return m_error.isEmpty() ? QLocalServer::errorString() : m_error;
+}
+
+QString ControlServer::defaultPath()
+{
+  return fsutils::cacheLocation() + "/control.sock";
+}
+
+void ControlServer::handleNewConnection()
+{
+  while (hasPendingConnections())
+    new ControlConnection(nextPendingConnection(), this);
+}
@@ -0,0 +1,69 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QLocalServer>
+
+// Local control socket, for scripts driving qBittorrent without going
+// through the Web UI. Only the user running qBittorrent can connect to
+// it, there is no other authentication.
+//
+// The protocol is line delimited JSON, one object per line:
+//
+//   -> {"id":1,"method":"status","params":{"fields":["hash","state"]}}
+//   <- {"id":1,"result":[{"hash":"...","state":"downloading"}]}
+//   <- {"event":"finished","hash":"..."}
+//
+// See ControlConnection for the methods and the events.
+class ControlServer : public QLocalServer
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(ControlServer)
+
+public:
+  ControlServer(QObject *parent = 0);
+  ~ControlServer();
+
+  bool start(const QString &path);
+  // Also covers the start() refusals
+  QString errorString() const;
+
+  static QString defaultPath();
+
+private slots:
+  void handleNewConnection();
+
+private:
+  QString m_error;
+};
+
+#endif // CONTROLSERVER_H
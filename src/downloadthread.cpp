@@ -44,6 +44,8 @@
 
 /** Download Thread **/
 
+static const char IN_MEMORY_PROPERTY[] = "qbt_inMemory";
+
 DownloadThread::DownloadThread(QObject* parent) : QObject(parent) {
   connect(&m_networkManager, SIGNAL(finished (QNetworkReply*)), this, SLOT(processDlFinished(QNetworkReply*)));
 #ifndef QT_NO_OPENSSL
@@ -123,8 +125,14 @@ void DownloadThread::processDlFinished(QNetworkReply* reply) {
     const QString newUrlString = newUrl.toString();
     qDebug("Redirecting from %s to %s", qPrintable(url), qPrintable(newUrlString));
     m_redirectMapping.insert(newUrlString, url);
-    // redirecting with first cookies
-    downloadUrl(newUrlString, m_networkManager.cookieJar()->cookiesForUrl(url));
+    // redirecting with first cookies and conditional request headers
+    QHash<QByteArray, QByteArray> headers;
+    foreach (const QByteArray &name, reply->request().rawHeaderList()) {
+      if (name.startsWith("If-"))
+        headers.insert(name, reply->request().rawHeader(name));
+    }
+    QNetworkReply *redirected = downloadUrl(newUrlString, m_networkManager.cookieJar()->cookiesForUrl(url), headers);
+    redirected->setProperty(IN_MEMORY_PROPERTY, reply->property(IN_MEMORY_PROPERTY));
     reply->deleteLater();
     return;
   }
@@ -133,6 +141,22 @@ void DownloadThread::processDlFinished(QNetworkReply* reply) {
     url = m_redirectMapping.take(url);
   }
   // Success
+  if (reply->property(IN_MEMORY_PROPERTY).toBool()) {
+    if (reply->isOpen() || reply->open(QIODevice::ReadOnly)) {
+      QByteArray replyData = reply->readAll();
+      if (reply->rawHeader("Content-Encoding") == "gzip")
+        replyData = gUncompress(reinterpret_cast<unsigned char*>(replyData.data()), replyData.length());
+      QVariantHash replyInfo;
+      replyInfo["status"] = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+      foreach (const QByteArray &name, reply->rawHeaderList())
+        replyInfo[QString::fromLatin1(name.toLower())] = QString::fromLatin1(reply->rawHeader(name));
+      emit downloadToMemoryFinished(url, replyData, replyInfo);
+    } else {
+      emit downloadFailure(url, tr("I/O Error"));
+    }
+    reply->deleteLater();
+    return;
+  }
   QTemporaryFile *tmpfile = new QTemporaryFile;
   if (tmpfile->open()) {
     tmpfile->setAutoRemove(false);
@@ -172,7 +196,16 @@ void DownloadThread::downloadTorrentUrl(const QString &url, const QList<QNetwork
   connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(checkDownloadSize(qint64,qint64)));
 }
 
-QNetworkReply* DownloadThread::downloadUrl(const QString &url, const QList<QNetworkCookie>& cookies) {
+QNetworkReply* DownloadThread::downloadUrlToMemory(const QString &url, const QList<QNetworkCookie>& cookies,
+                                                   const QHash<QByteArray, QByteArray>& headers)
+{
+  QNetworkReply *reply = downloadUrl(url, cookies, headers);
+  reply->setProperty(IN_MEMORY_PROPERTY, true);
+  return reply;
+}
+
+QNetworkReply* DownloadThread::downloadUrl(const QString &url, const QList<QNetworkCookie>& cookies,
+                                           const QHash<QByteArray, QByteArray>& headers) {
   // Update proxy settings
   applyProxySettings();
   // Set cookies
@@ -195,6 +228,10 @@ QNetworkReply* DownloadThread::downloadUrl(const QString &url, const QList<QNetw
   }
   // accept gzip
   request.setRawHeader("Accept-Encoding", "gzip");
+  QHash<QByteArray, QByteArray>::ConstIterator it = headers.begin();
+  QHash<QByteArray, QByteArray>::ConstIterator itend = headers.end();
+  for ( ; it != itend; ++it)
+    request.setRawHeader(it.key(), it.value());
   return m_networkManager.get(request);
 }
 
@@ -35,6 +35,7 @@
 #include <QNetworkCookie>
 #include <QObject>
 #include <QHash>
+#include <QVariantHash>
 #include <QSslError>
 #include <zlib.h>
 
@@ -47,12 +48,20 @@ class DownloadThread : public QObject {
 
 public:
   DownloadThread(QObject* parent = 0);
-  QNetworkReply* downloadUrl(const QString &url, const QList<QNetworkCookie>& cookies = QList<QNetworkCookie>());
+  QNetworkReply* downloadUrl(const QString &url, const QList<QNetworkCookie>& cookies = QList<QNetworkCookie>(),
+                             const QHash<QByteArray, QByteArray>& headers = QHash<QByteArray, QByteArray>());
   void downloadTorrentUrl(const QString &url, const QList<QNetworkCookie>& cookies = QList<QNetworkCookie>());
+  // Same as downloadUrl() but the content is handed over in memory through
+  // downloadToMemoryFinished() instead of going through a temporary file.
+  // The reply info holds the HTTP status ("status") and the reply headers
+  // (lowercase names), e.g. to handle conditional requests.
+  QNetworkReply* downloadUrlToMemory(const QString &url, const QList<QNetworkCookie>& cookies = QList<QNetworkCookie>(),
+                                     const QHash<QByteArray, QByteArray>& headers = QHash<QByteArray, QByteArray>());
   //void setProxy(QString IP, int port, QString username, QString password);
 
 signals:
   void downloadFinished(const QString &url, const QString &file_path);
+  void downloadToMemoryFinished(const QString &url, const QByteArray &data, const QVariantHash &replyInfo);
   void downloadFailure(const QString &url, const QString &reason);
 
 private slots:
@@ -0,0 +1,477 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "filesystemwatcher.h"
+#include "fs_utils.h"
+#include "misc.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+#ifndef Q_OS_WIN
+#include <iostream>
+#include <errno.h>
+#if defined(Q_OS_MAC) || defined(Q_OS_FREEBSD)
+#include <sys/param.h>
+#include <sys/mount.h>
+#include <string.h>
+#else
+#include <sys/vfs.h>
+#endif
+#endif
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Parses the candidate files away from the main thread and reports
+// the results to the watcher through a queued call
+class ScanFileValidator : public QThread {
+public:
+  explicit ScanFileValidator(QObject *receiver)
+    : m_receiver(receiver), m_running(true)
+  {
+    start(QThread::LowPriority);
+  }
+
+  ~ScanFileValidator()
+  {
+    m_mutex.lock();
+    m_running = false;
+    m_cond.wakeOne();
+    m_mutex.unlock();
+    wait();
+  }
+
+  void enqueue(const QStringList &files)
+  {
+    QMutexLocker locker(&m_mutex);
+    foreach (const QString &file, files) {
+      if (!m_queue.contains(file))
+        m_queue << file;
+    }
+    m_cond.wakeOne();
+  }
+
+protected:
+  void run()
+  {
+    forever {
+      m_mutex.lock();
+      while (m_running && m_queue.isEmpty())
+        m_cond.wait(&m_mutex);
+      if (!m_running) {
+        m_mutex.unlock();
+        return;
+      }
+      const QStringList files = m_queue;
+      m_queue.clear();
+      m_mutex.unlock();
+
+      QStringList torrents;
+      QStringList invalid;
+      foreach (const QString &file, files) {
+        if (!QFile::exists(file))
+          continue;
+        if (isValid(file))
+          torrents << file;
+        else
+          invalid << file;
+      }
+      QMetaObject::invokeMethod(m_receiver, "onFilesValidated", Qt::QueuedConnection,
+                                Q_ARG(QStringList, torrents), Q_ARG(QStringList, invalid));
+    }
+  }
+
+private:
+  static bool isValid(const QString &file)
+  {
+    if (file.endsWith(".magnet")) {
+      QFile f(file);
+      return f.open(QIODevice::ReadOnly)
+          && !misc::magnetUriToHash(QString::fromLocal8Bit(f.readAll())).isEmpty();
+    }
+    return fsutils::isValidTorrentFile(file);
+  }
+
+private:
+  QObject *m_receiver;
+  QMutex m_mutex;
+  QWaitCondition m_cond;
+  QStringList m_queue;
+  bool m_running;
+};
+
+FileSystemWatcher::FileSystemWatcher(QObject *parent)
+  : QFileSystemWatcher(parent)
+#ifdef Q_OS_LINUX
+  , m_inotifyFd(-1)
+  , m_inotifyNotifier(0)
+#endif
+{
+  connect(this, SIGNAL(directoryChanged(QString)), this, SLOT(scanLocalFolder(QString)));
+  connect(&m_watchTimer, SIGNAL(timeout()), SLOT(scanNetworkFolders()));
+  m_debounceTimer.setSingleShot(true);
+  connect(&m_debounceTimer, SIGNAL(timeout()), SLOT(processPendingFiles()));
+  m_partialTorrentTimer.setSingleShot(true);
+  connect(&m_partialTorrentTimer, SIGNAL(timeout()), SLOT(processPartialTorrents()));
+  m_validator = new ScanFileValidator(this);
+#ifdef Q_OS_LINUX
+  m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotifyFd >= 0) {
+    m_inotifyNotifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+    connect(m_inotifyNotifier, SIGNAL(activated(int)), SLOT(readInotifyEvents()));
+  } else {
+    std::cerr << "Error: inotify_init1() failed, falling back to directory notifications. Errno: " << errno << std::endl;
+  }
+#endif
+}
+
+FileSystemWatcher::~FileSystemWatcher()
+{
+  delete m_validator;
+#ifdef Q_OS_LINUX
+  delete m_inotifyNotifier;
+  if (m_inotifyFd >= 0)
+    close(m_inotifyFd);
+#endif
+}
+
+bool FileSystemWatcher::isNetworkFileSystem(const QString &path)
+{
+#ifdef Q_OS_WIN
+  Q_UNUSED(path);
+  return false;
+#else
+  QString file = path;
+  if (!file.endsWith("/"))
+    file += "/";
+  file += ".";
+  struct statfs buf;
+  if (!statfs(file.toLocal8Bit().constData(), &buf)) {
+#ifdef Q_OS_MAC
+    // XXX: should we make sure HAVE_STRUCT_FSSTAT_F_FSTYPENAME is defined?
+    return (strcmp(buf.f_fstypename, "nfs") == 0 || strcmp(buf.f_fstypename, "cifs") == 0 || strcmp(buf.f_fstypename, "smbfs") == 0);
+#else
+    return (buf.f_type == (long)CIFS_MAGIC_NUMBER || buf.f_type == (long)NFS_SUPER_MAGIC || buf.f_type == (long)SMB_SUPER_MAGIC);
+#endif
+  } else {
+    std::cerr << "Error: statfs() call failed for " << qPrintable(file) << ". Supposing it is a local folder..." << std::endl;
+    switch(errno) {
+    case EACCES:
+      std::cerr << "Search permission is denied for a component of the path prefix of the path" << std::endl;
+      break;
+    case EFAULT:
+      std::cerr << "Buf or path points to an invalid address" << std::endl;
+      break;
+    case EINTR:
+      std::cerr << "This call was interrupted by a signal" << std::endl;
+      break;
+    case EIO:
+      std::cerr << "I/O Error" << std::endl;
+      break;
+    case ELOOP:
+      std::cerr << "Too many symlinks" << std::endl;
+      break;
+    case ENAMETOOLONG:
+      std::cerr << "path is too long" << std::endl;
+      break;
+    case ENOENT:
+      std::cerr << "The file referred by path does not exist" << std::endl;
+      break;
+    case ENOMEM:
+      std::cerr << "Insufficient kernel memory" << std::endl;
+      break;
+    case ENOSYS:
+      std::cerr << "The file system does not detect this call" << std::endl;
+      break;
+    case ENOTDIR:
+      std::cerr << "A component of the path is not a directory" << std::endl;
+      break;
+    case EOVERFLOW:
+      std::cerr << "Some values were too large to be represented in the struct" << std::endl;
+      break;
+    default:
+      std::cerr << "Unknown error" << std::endl;
+    }
+    std::cerr << "Errno: " << errno << std::endl;
+    return false;
+  }
+#endif
+}
+
+bool FileSystemWatcher::matchesFilters(const QString &fileName)
+{
+  return fileName.endsWith(".torrent") || fileName.endsWith(".magnet");
+}
+
+QStringList FileSystemWatcher::directories() const
+{
+  QStringList dirs = m_networkFolders.keys();
+#ifdef Q_OS_LINUX
+  dirs << m_inotifyWatches.values();
+#endif
+  dirs << QFileSystemWatcher::directories();
+  return dirs;
+}
+
+void FileSystemWatcher::addPath(const QString &path)
+{
+  QDir dir(path);
+  if (!dir.exists())
+    return;
+  const QString dir_path = dir.canonicalPath();
+  // Check if the path points to a network file system or not
+  if (isNetworkFileSystem(dir_path)) {
+    // Network mode
+    qDebug("Network folder detected: %s", qPrintable(dir_path));
+    qDebug("Using file polling mode instead of inotify...");
+    m_networkFolders.insert(dir_path, FolderIndex());
+    scanFolder(dir_path, true);
+    if (!m_watchTimer.isActive())
+      m_watchTimer.start(WATCH_INTERVAL);
+    return;
+  }
+#ifdef Q_OS_LINUX
+  if (m_inotifyFd >= 0) {
+    const int wd = inotify_add_watch(m_inotifyFd, QFile::encodeName(dir_path).constData(),
+                                     IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR);
+    if (wd >= 0) {
+      qDebug("FS Watching is watching %s with inotify", qPrintable(dir_path));
+      m_inotifyWatches.insert(wd, dir_path);
+      // Pick up the files which were already there
+      scanFolder(dir_path, false);
+      return;
+    }
+    std::cerr << "Error: inotify_add_watch() failed for " << qPrintable(dir_path) << ". Errno: " << errno << std::endl;
+  }
+#endif
+  // Normal mode
+  qDebug("FS Watching is watching %s in normal mode", qPrintable(dir_path));
+  QFileSystemWatcher::addPath(dir_path);
+  m_localIndex.insert(dir_path, FolderIndex());
+  scanFolder(dir_path, true);
+}
+
+void FileSystemWatcher::removePath(const QString &path)
+{
+  const QString dir_path = QDir(path).canonicalPath();
+  if (m_networkFolders.remove(dir_path)) {
+    if (m_networkFolders.isEmpty())
+      m_watchTimer.stop();
+    return;
+  }
+#ifdef Q_OS_LINUX
+  const int wd = m_inotifyWatches.key(dir_path, -1);
+  if (wd >= 0) {
+    inotify_rm_watch(m_inotifyFd, wd);
+    m_inotifyWatches.remove(wd);
+    return;
+  }
+#endif
+  // Normal mode
+  m_localIndex.remove(dir_path);
+  m_dirtyFolders.remove(dir_path);
+  QFileSystemWatcher::removePath(dir_path);
+}
+
+void FileSystemWatcher::scanLocalFolder(const QString &path)
+{
+  qDebug("scanLocalFolder(%s) called", qPrintable(path));
+  // The folder is listed once the burst of changes is over
+  m_dirtyFolders << path;
+  restartDebounceTimer();
+}
+
+void FileSystemWatcher::scanNetworkFolders()
+{
+  qDebug("scanNetworkFolders() called");
+  foreach (const QString &dir_path, m_networkFolders.keys())
+    scanFolder(dir_path, true);
+}
+
+void FileSystemWatcher::scanFolder(const QString &path, bool useIndex)
+{
+  const QFileInfoList entries = QDir(path).entryInfoList(QStringList() << "*.torrent" << "*.magnet", QDir::Files, QDir::Unsorted);
+  FolderIndex index;
+  FolderIndex *old_index = 0;
+  if (useIndex) {
+    if (m_networkFolders.contains(path))
+      old_index = &m_networkFolders[path];
+    else
+      old_index = &m_localIndex[path];
+  }
+  foreach (const QFileInfo &entry, entries) {
+    FileStamp stamp;
+    stamp.size = entry.size();
+    stamp.mtime = entry.lastModified().toTime_t();
+    if (old_index) {
+      index.insert(entry.fileName(), stamp);
+      const FolderIndex::ConstIterator it = old_index->constFind(entry.fileName());
+      if (it != old_index->constEnd() && it->size == stamp.size && it->mtime == stamp.mtime)
+        continue;
+    }
+    queueFile(entry.absoluteFilePath());
+  }
+  if (old_index)
+    *old_index = index;
+}
+
+void FileSystemWatcher::queueFile(const QString &path)
+{
+  m_pendingFiles << path;
+  restartDebounceTimer();
+}
+
+void FileSystemWatcher::restartDebounceTimer()
+{
+  if (!m_debounceTimer.isActive()) {
+    m_pendingSince.start();
+    m_debounceTimer.start(DEBOUNCE_DELAY);
+  } else if (m_pendingSince.elapsed() < MAX_DEBOUNCE_DELAY) {
+    // Keep collecting while the burst goes on, but not forever
+    m_debounceTimer.start(DEBOUNCE_DELAY);
+  }
+}
+
+void FileSystemWatcher::processPendingFiles()
+{
+  foreach (const QString &dir_path, m_dirtyFolders) {
+    if (m_localIndex.contains(dir_path))
+      scanFolder(dir_path, true);
+  }
+  m_dirtyFolders.clear();
+  // scanFolder() may have restarted the timer, the files are sent right away
+  m_debounceTimer.stop();
+  if (m_pendingFiles.isEmpty())
+    return;
+  qDebug("Validating %d scan folder files", m_pendingFiles.size());
+  m_validator->enqueue(m_pendingFiles.toList());
+  m_pendingFiles.clear();
+}
+
+#ifdef Q_OS_LINUX
+void FileSystemWatcher::readInotifyEvents()
+{
+  char buffer[64 * 1024] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  forever {
+    const ssize_t len = read(m_inotifyFd, buffer, sizeof(buffer));
+    if (len <= 0)
+      break;
+    for (const char *ptr = buffer; ptr < buffer + len; ) {
+      const struct inotify_event *event = reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        qDebug("inotify queue overflow, rescanning the local folders");
+        foreach (const QString &dir_path, m_inotifyWatches)
+          scanFolder(dir_path, false);
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        // The folder was removed or unmounted
+        m_inotifyWatches.remove(event->wd);
+        continue;
+      }
+      if (!event->len || (event->mask & IN_ISDIR))
+        continue;
+      const QString file_name = QFile::decodeName(event->name);
+      if (!matchesFilters(file_name))
+        continue;
+      const QHash<int, QString>::ConstIterator it = m_inotifyWatches.constFind(event->wd);
+      if (it != m_inotifyWatches.constEnd())
+        queueFile(it.value() + "/" + file_name);
+    }
+  }
+}
+#endif
+
+void FileSystemWatcher::onFilesValidated(const QStringList &torrents, const QStringList &invalid)
+{
+  foreach (const QString &torrent_path, torrents)
+    m_partialTorrents.remove(torrent_path);
+
+  foreach (const QString &torrent_path, invalid) {
+    QHash<QString, int>::Iterator it = m_partialTorrents.find(torrent_path);
+    if (it == m_partialTorrents.end()) {
+      qDebug("Partial torrent detected at: %s", qPrintable(torrent_path));
+      qDebug("Delay the file's processing...");
+      m_partialTorrents.insert(torrent_path, 0);
+    } else if (it.value() >= MAX_PARTIAL_RETRIES) {
+      m_partialTorrents.erase(it);
+      QFile::rename(torrent_path, torrent_path+".invalid");
+    } else {
+      ++it.value();
+    }
+  }
+  if (!m_partialTorrents.isEmpty())
+    startPartialTorrentTimer();
+
+  // Notify of new torrents
+  if (!torrents.isEmpty()) {
+    qDebug("The following files are being reported: %s", qPrintable(torrents.join("\n")));
+    QStringList batch = torrents;
+    emit torrentsAdded(batch);
+  }
+}
+
+void FileSystemWatcher::processPartialTorrents()
+{
+  QStringList still_partial;
+  QHash<QString, int>::Iterator it = m_partialTorrents.begin();
+  while (it != m_partialTorrents.end()) {
+    if (!QFile::exists(it.key())) {
+      it = m_partialTorrents.erase(it);
+    } else {
+      still_partial << it.key();
+      ++it;
+    }
+  }
+  if (still_partial.isEmpty()) {
+    qDebug("No longer any partial torrent.");
+    return;
+  }
+  qDebug("Still %d partial torrents after delayed processing.", still_partial.size());
+  m_validator->enqueue(still_partial);
+}
+
+void FileSystemWatcher::startPartialTorrentTimer()
+{
+  Q_ASSERT(!m_partialTorrents.isEmpty());
+  if (!m_partialTorrentTimer.isActive())
+    m_partialTorrentTimer.start(WATCH_INTERVAL);
+}
@@ -0,0 +1,216 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QPair>
+#include <QtAlgorithms>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+#include "hashcache.h"
+#include "fs_utils.h"
+
+static const quint32 CACHE_MAGIC = 0x51424843; // "QBHC"
+static const quint32 CACHE_VERSION = 1;
+// Least recently used entries are dropped beyond this
+static const int MAX_ENTRIES = 100000;
+
+Q_GLOBAL_STATIC(HashCache, globalHashCache)
+
+HashCache::HashCache():
+  m_loaded(false), m_dirty(false)
+{
+}
+
+HashCache* HashCache::instance()
+{
+  return globalHashCache();
+}
+
+QString HashCache::cacheFilePath()
+{
+  return QDir(fsutils::cacheLocation()).absoluteFilePath("hash_cache.dat");
+}
+
+QString HashCache::entryId(const QString &path, int blockSize)
+{
+  return QString::number(blockSize) + QLatin1Char(':') + path;
+}
+
+HashCache::FileKey HashCache::fileKey(const QString &path)
+{
+  FileKey key;
+  const QFileInfo info(path);
+  if (!info.isFile())
+    return key;
+  key.size = info.size();
+  key.mtime = info.lastModified().toMSecsSinceEpoch();
+#ifndef Q_OS_WIN
+  struct stat st;
+  if (::stat(QFile::encodeName(path).constData(), &st) == 0)
+    key.inode = st.st_ino;
+#endif
+  return key;
+}
+
+bool HashCache::isKnownDigest(const char *digest)
+{
+  for (int i = 0; i < DIGEST_SIZE; ++i) {
+    if (digest[i])
+      return true;
+  }
+  return false;
+}
+
+QByteArray HashCache::blockHashes(const QString &path, int blockSize)
+{
+  const FileKey key = fileKey(path);
+  if (!key.isValid())
+    return QByteArray();
+
+  QMutexLocker locker(&m_mutex);
+  load();
+  QHash<QString, Entry>::Iterator it = m_entries.find(entryId(path, blockSize));
+  if (it == m_entries.end())
+    return QByteArray();
+  if (!(it->key == key)) {
+    // The file changed since
+    m_entries.erase(it);
+    m_dirty = true;
+    return QByteArray();
+  }
+  it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+  m_dirty = true;
+  return it->hashes;
+}
+
+void HashCache::storeBlockHashes(const QString &path, int blockSize, const FileKey &key, const QByteArray &hashes)
+{
+  // Don't cache a file that changed while it was being read
+  if (!key.isValid() || !(fileKey(path) == key))
+    return;
+
+  QMutexLocker locker(&m_mutex);
+  load();
+  Entry &entry = m_entries[entryId(path, blockSize)];
+  if (!(entry.key == key) || entry.hashes.size() != hashes.size()) {
+    entry.key = key;
+    entry.hashes = hashes;
+  } else {
+    for (int i = 0; i + DIGEST_SIZE <= hashes.size(); i += DIGEST_SIZE) {
+      if (isKnownDigest(hashes.constData() + i))
+        entry.hashes.replace(i, DIGEST_SIZE, hashes.constData() + i, DIGEST_SIZE);
+    }
+  }
+  entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+  m_dirty = true;
+}
+
+void HashCache::load()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  QFile file(cacheFilePath());
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_4_5);
+  quint32 magic, version;
+  qint32 count;
+  in >> magic >> version >> count;
+  if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+    qWarning() << "Ignoring unsupported hash cache" << file.fileName();
+    return;
+  }
+  for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    QString id;
+    Entry entry;
+    in >> id >> entry.key.size >> entry.key.mtime >> entry.key.inode >> entry.lastUsed >> entry.hashes;
+    if (in.status() == QDataStream::Ok)
+      m_entries.insert(id, entry);
+  }
+  qDebug("Loaded %d hash cache entries", m_entries.size());
+}
+
+static bool entryUsedBefore(const QPair<qint64, QString> &left, const QPair<qint64, QString> &right)
+{
+  return left.first < right.first;
+}
+
+void HashCache::save()
+{
+  QMutexLocker locker(&m_mutex);
+  if (!m_dirty)
+    return;
+
+  if (m_entries.size() > MAX_ENTRIES) {
+    QList<QPair<qint64, QString> > usage;
+    QHash<QString, Entry>::ConstIterator it = m_entries.begin();
+    QHash<QString, Entry>::ConstIterator itend = m_entries.end();
+    for ( ; it != itend; ++it)
+      usage << qMakePair(it->lastUsed, it.key());
+    qSort(usage.begin(), usage.end(), entryUsedBefore);
+    for (int i = 0; i < usage.size() - MAX_ENTRIES; ++i)
+      m_entries.remove(usage.at(i).second);
+  }
+
+  const QString path = cacheFilePath();
+  QFile file(path + ".tmp");
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "Failed to save the hash cache to" << file.fileName();
+    return;
+  }
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_4_5);
+  out << CACHE_MAGIC << CACHE_VERSION << (qint32) m_entries.size();
+  QHash<QString, Entry>::ConstIterator it = m_entries.begin();
+  QHash<QString, Entry>::ConstIterator itend = m_entries.end();
+  for ( ; it != itend; ++it)
+    out << it.key() << it->key.size << it->key.mtime << it->key.inode << it->lastUsed << it->hashes;
+  file.close();
+  if (out.status() != QDataStream::Ok) {
+    file.remove();
+    return;
+  }
+  // QFile::rename() does not overwrite existing files
+  QFile::remove(path);
+  if (QFile::rename(file.fileName(), path))
+    m_dirty = false;
+}
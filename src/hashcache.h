@@ -0,0 +1,96 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef HASHCACHE_H
+#define HASHCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// Persistent cache of the SHA-1 digests of file blocks.
+//
+// The digests are stored per (file, block size), the blocks being aligned
+// on the start of the file. An entry is only used as long as the size,
+// modification time and inode of the file did not change.
+// The torrent creator reuses them for the pieces that are aligned on a
+// file boundary and the torrent import verifies data against them.
+class HashCache {
+  Q_DISABLE_COPY(HashCache)
+
+public:
+  static const int DIGEST_SIZE = 20;
+
+  struct FileKey {
+    FileKey(): size(-1), mtime(0), inode(0) {}
+    bool isValid() const { return size >= 0; }
+    bool operator==(const FileKey &other) const {
+      return size == other.size && mtime == other.mtime && inode == other.inode;
+    }
+    qint64 size;
+    qint64 mtime;
+    quint64 inode;
+  };
+
+  HashCache();
+  static HashCache* instance();
+  static FileKey fileKey(const QString &path);
+
+  // DIGEST_SIZE bytes per block, all zeros for the blocks that are not
+  // known. Empty if nothing is cached for the current state of the file.
+  QByteArray blockHashes(const QString &path, int blockSize);
+  // Merges the known digests (non zero) into the entry of the file.
+  // key is the state of the file when it was read.
+  void storeBlockHashes(const QString &path, int blockSize, const FileKey &key, const QByteArray &hashes);
+  void save();
+
+  static bool isKnownDigest(const char *digest);
+
+private:
+  struct Entry {
+    Entry(): lastUsed(0) {}
+    FileKey key;
+    QByteArray hashes;
+    qint64 lastUsed;
+  };
+
+  void load();
+  static QString entryId(const QString &path, int blockSize);
+  static QString cacheFilePath();
+
+private:
+  QMutex m_mutex;
+  bool m_loaded;
+  bool m_dirty;
+  QHash<QString, Entry> m_entries;
+};
+
+#endif // HASHCACHE_H
@@ -33,14 +33,45 @@
 
 #include <QObject>
 #include <QCoreApplication>
+#include <QFile>
 #include "preferences.h"
 #include "qbtsession.h"
 
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <syslog.h>
+#include "sdnotify.h"
+#include "unixsignalwatcher.h"
+#endif
+
 class HeadlessLoader: public QObject {
   Q_OBJECT
 
 public:
-  HeadlessLoader(const QStringList &torrentCmdLine) {
+  enum LogTarget {
+    LogToConsole,
+    LogToFile,
+    LogToSyslog
+  };
+
+  // 'logFile' is only used with LogToFile
+  HeadlessLoader(const QStringList &torrentCmdLine, LogTarget logTarget = LogToConsole, const QString &logFile = QString())
+    : m_logTarget(logTarget)
+  {
+    if (m_logTarget == LogToFile) {
+      m_logFile.setFileName(logFile);
+      if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        std::cerr << qPrintable(tr("Couldn't open the log file %1, logging to the console.").arg(logFile)) << std::endl;
+        m_logTarget = LogToConsole;
+      }
+    }
+#ifdef Q_OS_UNIX
+    if (m_logTarget == LogToSyslog)
+      openlog("qbittorrent-nox", LOG_PID, LOG_DAEMON);
+#else
+    if (m_logTarget == LogToSyslog)
+      m_logTarget = LogToConsole;
+#endif
     connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(shutdownCleanUp()), Qt::DirectConnection);
     Preferences pref;
     // Enable Web UI
@@ -52,20 +83,42 @@ public:
     // Process command line parameters
     processParams(torrentCmdLine);
     // Display some information to the user
-    std::cout << std::endl << "******** " << qPrintable(tr("Information")) << " ********" << std::endl;
-    std::cout << qPrintable(tr("To control qBittorrent, access the Web UI at http://localhost:%1").arg(QString::number(pref.getWebUiPort()))) << std::endl;
-    std::cout << qPrintable(tr("The Web UI administrator user name is: %1").arg(pref.getWebUiUsername())) << std::endl;
+    if (m_logTarget == LogToConsole)
+      std::cout << std::endl << "******** " << qPrintable(tr("Information")) << " ********" << std::endl;
+    displayConsoleMessage(tr("To control qBittorrent, access the Web UI at http://localhost:%1").arg(QString::number(pref.getWebUiPort())));
+    displayConsoleMessage(tr("The Web UI administrator user name is: %1").arg(pref.getWebUiUsername()));
     qDebug() << "Password:" << pref.getWebUiPassword();
     if (pref.getWebUiPassword() == "32fe0bd2bb001911bb8bcfe23fc92b63") {
-      std::cout << qPrintable(tr("The Web UI administrator password is still the default one: %1").arg("adminadmin")) << std::endl;
-      std::cout << qPrintable(tr("This is a security risk, please consider changing your password from program preferences.")) << std::endl;
+      displayConsoleMessage(tr("The Web UI administrator password is still the default one: %1").arg("adminadmin"));
+      displayConsoleMessage(tr("This is a security risk, please consider changing your password from program preferences."));
     }
+#ifdef Q_OS_UNIX
+    // kill -HUP reloads the preferences, kill -USR1 saves the resume data
+    UnixSignalWatcher::instance()->watch(SIGHUP);
+    UnixSignalWatcher::instance()->watch(SIGUSR1);
+    connect(UnixSignalWatcher::instance(), SIGNAL(signalReceived(int)), SLOT(handleUnixSignal(int)));
+    // The torrents are loaded, tell the service manager we are up
+    sdnotify::notify("READY=1\nMAINPID=" + QByteArray::number(QCoreApplication::applicationPid()));
+#endif
+  }
+
+  ~HeadlessLoader() {
+#ifdef Q_OS_UNIX
+    if (m_logTarget == LogToSyslog)
+      closelog();
+#endif
   }
 
 public slots:
   void shutdownCleanUp() {
+#ifdef Q_OS_UNIX
+    sdnotify::notify("STOPPING=1");
+#endif
     Preferences().sync();
     QBtSession::drop();
+#ifdef Q_OS_UNIX
+    UnixSignalWatcher::drop();
+#endif
   }
 
   // Call this function to exit qBittorrent headless loader
@@ -75,7 +128,22 @@ public slots:
   }
 
   void displayConsoleMessage(const QString &msg) {
-    std::cout << qPrintable(msg) << std::endl;
+    switch (m_logTarget) {
+    case LogToFile: {
+      QByteArray line = msg.toUtf8();
+      line += '\n';
+      m_logFile.write(line);
+      m_logFile.flush();
+      break;
+    }
+#ifdef Q_OS_UNIX
+    case LogToSyslog:
+      syslog(LOG_INFO, "%s", msg.toUtf8().constData());
+      break;
+#endif
+    default:
+      std::cout << qPrintable(msg) << std::endl;
+    }
   }
 
   void processParams(const QString& params_str) {
@@ -105,6 +173,42 @@ public slots:
     }
   }
 
+  // Applies the preferences changed on disk, the torrents stay loaded
+  void reloadPreferences() {
+#ifdef Q_OS_UNIX
+    sdnotify::notify("RELOADING=1");
+#endif
+    Preferences pref;
+    // Rereads the configuration file
+    pref.sync();
+    pref.setWebUiEnabled(true);
+    QBtSession::instance()->configureSession();
+    displayConsoleMessage(tr("The preferences were reloaded."));
+#ifdef Q_OS_UNIX
+    sdnotify::notify("READY=1");
+#endif
+  }
+
+private slots:
+  void handleUnixSignal(int signum) {
+#ifdef Q_OS_UNIX
+    switch (signum) {
+    case SIGHUP:
+      reloadPreferences();
+      break;
+    case SIGUSR1:
+      displayConsoleMessage(tr("Saving the resume data..."));
+      QBtSession::instance()->saveTempFastResumeData();
+      break;
+    }
+#else
+    Q_UNUSED(signum);
+#endif
+  }
+
+private:
+  LogTarget m_logTarget;
+  QFile m_logFile;
 };
 
 #endif
@@ -0,0 +1,97 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "labelbandwidthdlg.h"
+
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QSpinBox>
+
+#include "misc.h"
+
+LabelBandwidthDlg::LabelBandwidthDlg(const QString &label, const LabelLimits &limits, QWidget *parent)
+  : QDialog(parent)
+{
+  setWindowTitle(tr("Bandwidth limits of %1", "Bandwidth limits of <label>").arg(label));
+  QFormLayout *layout = new QFormLayout(this);
+
+  m_downloadLimit = new QSpinBox(this);
+  m_downloadLimit->setRange(0, 1000000);
+  m_downloadLimit->setSuffix(tr(" KiB/s"));
+  m_downloadLimit->setSpecialValueText(QString::fromUtf8("∞"));
+  m_downloadLimit->setValue(qMax(0, limits.downloadLimit));
+  layout->addRow(tr("Download limit:"), m_downloadLimit);
+
+  m_uploadLimit = new QSpinBox(this);
+  m_uploadLimit->setRange(0, 1000000);
+  m_uploadLimit->setSuffix(tr(" KiB/s"));
+  m_uploadLimit->setSpecialValueText(QString::fromUtf8("∞"));
+  m_uploadLimit->setValue(qMax(0, limits.uploadLimit));
+  layout->addRow(tr("Upload limit:"), m_uploadLimit);
+
+  m_maxConnections = new QSpinBox(this);
+  m_maxConnections->setRange(-1, 65535);
+  m_maxConnections->setSpecialValueText(QString::fromUtf8("∞"));
+  m_maxConnections->setValue(qMax(-1, limits.maxConnections));
+  m_maxConnections->setToolTip(tr("Shared evenly by the torrents of this label. Each torrent keeps at least 2 connections, so a label with many torrents can exceed it."));
+  layout->addRow(tr("Maximum connections:"), m_maxConnections);
+
+  m_weight = new QSpinBox(this);
+  m_weight->setRange(0, 255);
+  m_weight->setValue(limits.weight);
+  m_weight->setToolTip(tr("Bandwidth priority of the torrents of this label, 0 is the default"));
+  layout->addRow(tr("Priority weight:"), m_weight);
+
+  QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, this);
+  connect(buttons, SIGNAL(accepted()), SLOT(accept()));
+  connect(buttons, SIGNAL(rejected()), SLOT(reject()));
+  layout->addRow(buttons);
+
+  move(misc::screenCenter(this));
+}
+
+LabelLimits LabelBandwidthDlg::limits() const
+{
+  LabelLimits limits;
+  limits.downloadLimit = m_downloadLimit->value();
+  limits.uploadLimit = m_uploadLimit->value();
+  limits.maxConnections = m_maxConnections->value();
+  limits.weight = m_weight->value();
+  return limits;
+}
+
+bool LabelBandwidthDlg::askLabelLimits(QWidget *parent, const QString &label, LabelLimits &limits)
+{
+  LabelBandwidthDlg dlg(label, limits, parent);
+  if (dlg.exec() != QDialog::Accepted)
+    return false;
+  limits = dlg.limits();
+  return true;
+}
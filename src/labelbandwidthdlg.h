@@ -0,0 +1,62 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef LABELBANDWIDTHDLG_H
+#define LABELBANDWIDTHDLG_H
+
+#include <QDialog>
+
+#include "labelbandwidth.h"
+
+QT_BEGIN_NAMESPACE
+class QSpinBox;
+QT_END_NAMESPACE
+
+// Edits the bandwidth class of a label
+class LabelBandwidthDlg : public QDialog
+{
+  Q_OBJECT
+
+public:
+  LabelBandwidthDlg(const QString &label, const LabelLimits &limits, QWidget *parent = 0);
+
+  LabelLimits limits() const;
+
+  // Returns false if the dialog was cancelled
+  static bool askLabelLimits(QWidget *parent, const QString &label, LabelLimits &limits);
+
+private:
+  QSpinBox *m_downloadLimit;
+  QSpinBox *m_uploadLimit;
+  QSpinBox *m_maxConnections;
+  QSpinBox *m_weight;
+};
+
+#endif // LABELBANDWIDTHDLG_H
@@ -58,6 +58,10 @@ Q_IMPORT_PLUGIN(qico)
 #include "qtsinglecoreapplication.h"
 #include <iostream>
 #include <stdio.h>
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 #include "headlessloader.h"
 #endif
 
@@ -94,6 +98,9 @@ public:
     std::cout << '\t' << prg_name << " --no-splash: " << qPrintable(tr("disable splash screen")) << std::endl;
 #else
     std::cout << '\t' << prg_name << " -d | --daemon: " << qPrintable(tr("run in daemon-mode (background)")) << std::endl;
+    std::cout << '\t' << prg_name << " --pidfile=x: " << qPrintable(tr("writes the process ID to the file x")) << std::endl;
+    std::cout << '\t' << prg_name << " --logfile=x: " << qPrintable(tr("logs to the file x instead of the console")) << std::endl;
+    std::cout << '\t' << prg_name << " --syslog: " << qPrintable(tr("logs to syslog instead of the console (default in daemon-mode)")) << std::endl;
 #endif
     std::cout << '\t' << prg_name << " --help: " << qPrintable(tr("displays this help message")) << std::endl;
     std::cout << '\t' << prg_name << " --webui-port=x: " << qPrintable(tr("changes the webui port (current: %1)").arg(QString::number(Preferences().getWebUiPort()))) << std::endl;
@@ -110,6 +117,13 @@ public:
     if (settings.value(QString::fromUtf8("LegalNotice/Accepted"), false).toBool()) // Already accepted once
       return true;
 #ifdef DISABLE_GUI
+#ifdef Q_OS_UNIX
+    // Nobody can answer, e.g. started by a service manager
+    if (!isatty(STDIN_FILENO)) {
+      std::cerr << qPrintable(tr("The legal notice was not accepted yet, please run qbittorrent-nox once from a terminal to accept it.")) << std::endl;
+      return false;
+    }
+#endif
     std::cout << std::endl << "*** " << qPrintable(tr("Legal Notice")) << " ***" << std::endl;
     std::cout << qPrintable(tr("qBittorrent is a file sharing program. When you run a torrent, its data will be made available to others by means of upload. Any content you share is your sole responsibility.\n\nNo further notices will be issued.")) << std::endl << std::endl;
     std::cout << qPrintable(tr("Press %1 key to accept and continue...").arg("'y'")) << std::endl;
@@ -141,6 +155,43 @@ public:
 
 #include "main.moc"
 
+#ifdef DISABLE_GUI
+void writePidFile(const QString &path, qint64 pid) {
+  QFile file(path);
+  if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    file.write(QByteArray::number(pid));
+    file.write("\n");
+  } else {
+    qCritical("Couldn't write the PID file %s", qPrintable(path));
+  }
+}
+
+// Like daemon(1, 0), but the PID file is written by the parent before it
+// exits, so that a forking service manager always finds it
+bool daemonize(const QString &pidFile) {
+  const pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid > 0) {
+    if (!pidFile.isEmpty())
+      writePidFile(pidFile, pid);
+    // Leaves the single application socket to the child
+    _exit(EXIT_SUCCESS);
+  }
+  if (setsid() < 0)
+    return false;
+  const int fd = open("/dev/null", O_RDWR);
+  if (fd >= 0) {
+    dup2(fd, STDIN_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+    if (fd > STDERR_FILENO)
+      close(fd);
+  }
+  return true;
+}
+#endif
+
 #if defined(Q_OS_UNIX) || defined(STACKTRACE_WIN)
 void sigintHandler(int) {
   signal(SIGINT, 0);
@@ -253,10 +304,9 @@ int main(int argc, char *argv[]) {
 #ifndef DISABLE_GUI
   bool no_splash = false;
 #else
-  if(shouldDaemonize && daemon(1, 0) != 0) {
-    qCritical("Something went wrong while daemonizing, exiting...");
-    return EXIT_FAILURE;
-  }
+  QString pidFile;
+  QString logFile;
+  bool useSyslog = false;
 #endif
 
   // Load translation
@@ -310,6 +360,14 @@ int main(int argc, char *argv[]) {
       if (QString::fromLocal8Bit(argv[i]) == QString::fromUtf8("--no-splash")) {
         no_splash = true;
       } else {
+#else
+      if (QString::fromLocal8Bit(argv[i]).startsWith("--pidfile=")) {
+        pidFile = QString::fromLocal8Bit(argv[i]).section('=', 1);
+      } else if (QString::fromLocal8Bit(argv[i]).startsWith("--logfile=")) {
+        logFile = QString::fromLocal8Bit(argv[i]).section('=', 1);
+      } else if (QString::fromLocal8Bit(argv[i]) == QString::fromUtf8("--syslog")) {
+        useSyslog = true;
+      } else {
 #endif
         if (QString::fromLocal8Bit(argv[i]).startsWith("--webui-port=")) {
           QStringList parts = QString::fromLocal8Bit(argv[i]).split("=");
@@ -321,9 +379,7 @@ int main(int argc, char *argv[]) {
             }
           }
         }
-#ifndef DISABLE_GUI
       }
-#endif
     }
   }
 
@@ -355,8 +411,25 @@ int main(int argc, char *argv[]) {
 #endif
 
   if (!LegalNotice::userAgreesWithNotice()) {
+#if defined(DISABLE_GUI) && defined(Q_OS_UNIX)
+    // Nobody was asked, let the service manager know the start failed
+    if (!isatty(STDIN_FILENO))
+      return EXIT_FAILURE;
+#endif
     return 0;
   }
+#ifdef DISABLE_GUI
+  // After the legal notice, which needs the terminal, and before the
+  // session starts its threads
+  if (shouldDaemonize) {
+    if (!daemonize(pidFile)) {
+      qCritical("Something went wrong while daemonizing, exiting...");
+      return EXIT_FAILURE;
+    }
+  } else if (!pidFile.isEmpty()) {
+    writePidFile(pidFile, QCoreApplication::applicationPid());
+  }
+#endif
 #ifndef DISABLE_GUI
   app.setQuitOnLastWindowClosed(false);
 #endif
@@ -386,13 +459,22 @@ int main(int argc, char *argv[]) {
 #endif // Q_OS_MAC
 #else
   // Load Headless class
-  HeadlessLoader loader(torrents);
+  HeadlessLoader::LogTarget logTarget = HeadlessLoader::LogToConsole;
+  if (!logFile.isEmpty())
+    logTarget = HeadlessLoader::LogToFile;
+  else if (useSyslog || shouldDaemonize)
+    logTarget = HeadlessLoader::LogToSyslog;
+  HeadlessLoader loader(torrents, logTarget, logFile);
   QObject::connect(&app, SIGNAL(messageReceived(const QString&)),
                    &loader, SLOT(processParams(const QString&)));
 #endif
 
   int ret = app.exec();
   qDebug("Application has exited");
+#ifdef DISABLE_GUI
+  if (!pidFile.isEmpty())
+    QFile::remove(pidFile);
+#endif
   return ret;
 }
 
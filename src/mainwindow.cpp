@@ -73,6 +73,7 @@
 #include "torrentmodel.h"
 #include "executionlog.h"
 #include "iconprovider.h"
+#include "reverseresolution.h"
 #ifndef DISABLE_GUI
 #include "autoexpandabledialog.h"
 #endif
@@ -387,6 +388,7 @@ void MainWindow::shutdownCleanUp() {
   delete switchTransferShortcut;
   delete switchRSSShortcut;
   IconProvider::drop();
+  ReverseResolution::drop();
   Preferences().sync();
   qDebug("Finished GUI destruction");
 }
@@ -1128,6 +1130,8 @@ void MainWindow::trackerAuthenticationRequired(const QTorrentHandle& h) {
 
 // Check connection status and display right icon
 void MainWindow::updateGUI() {
+  const SessionSnapshotPtr snapshot = QBtSession::instance()->sessionSnapshot();
+  const libtorrent::session_status &status = snapshot->status;
   // update global informations
   if (systrayIcon) {
 #if defined(Q_OS_UNIX)
@@ -1135,21 +1139,21 @@ void MainWindow::updateGUI() {
     html += "qBittorrent";
     html += "</div>";
     html += "<div style='vertical-align: baseline; height: 18px;'>";
-    html += "<img src=':/Icons/skin/download.png'/>&nbsp;"+tr("DL speed: %1 KiB/s", "e.g: Download speed: 10 KiB/s").arg(misc::accurateDoubleToString(QBtSession::instance()->getPayloadDownloadRate()/1024., 1));
+    html += "<img src=':/Icons/skin/download.png'/>&nbsp;"+tr("DL speed: %1 KiB/s", "e.g: Download speed: 10 KiB/s").arg(misc::accurateDoubleToString(status.payload_download_rate/1024., 1));
     html += "</div>";
     html += "<div style='vertical-align: baseline; height: 18px;'>";
-    html += "<img src=':/Icons/skin/seeding.png'/>&nbsp;"+tr("UP speed: %1 KiB/s", "e.g: Upload speed: 10 KiB/s").arg(misc::accurateDoubleToString(QBtSession::instance()->getPayloadUploadRate()/1024., 1));
+    html += "<img src=':/Icons/skin/seeding.png'/>&nbsp;"+tr("UP speed: %1 KiB/s", "e.g: Upload speed: 10 KiB/s").arg(misc::accurateDoubleToString(status.payload_upload_rate/1024., 1));
     html += "</div>";
 #else
     // OSes such as Windows do not support html here
-    QString html =tr("DL speed: %1 KiB/s", "e.g: Download speed: 10 KiB/s").arg(misc::accurateDoubleToString(QBtSession::instance()->getPayloadDownloadRate()/1024., 1));
+    QString html =tr("DL speed: %1 KiB/s", "e.g: Download speed: 10 KiB/s").arg(misc::accurateDoubleToString(status.payload_download_rate/1024., 1));
     html += "\n";
-    html += tr("UP speed: %1 KiB/s", "e.g: Upload speed: 10 KiB/s").arg(misc::accurateDoubleToString(QBtSession::instance()->getPayloadUploadRate()/1024., 1));
+    html += tr("UP speed: %1 KiB/s", "e.g: Upload speed: 10 KiB/s").arg(misc::accurateDoubleToString(status.payload_upload_rate/1024., 1));
 #endif
     systrayIcon->setToolTip(html); // tray icon
   }
   if (displaySpeedInTitle) {
-    setWindowTitle(tr("[D: %1/s, U: %2/s] qBittorrent %3", "D = Download; U = Upload; %3 is qBittorrent version").arg(misc::friendlyUnit(QBtSession::instance()->getSessionStatus().payload_download_rate)).arg(misc::friendlyUnit(QBtSession::instance()->getSessionStatus().payload_upload_rate)).arg(QString::fromUtf8(VERSION)));
+    setWindowTitle(tr("[D: %1/s, U: %2/s] qBittorrent %3", "D = Download; U = Upload; %3 is qBittorrent version").arg(misc::friendlyUnit(status.payload_download_rate)).arg(misc::friendlyUnit(status.payload_upload_rate)).arg(QString::fromUtf8(VERSION)));
   }
 }
 
@@ -11,9 +11,10 @@
 #include <QNetworkInterface>
 #include <libtorrent/version.hpp>
 #include "preferences.h"
+#include "qbtsession.h"
 
 enum AdvSettingsCols {PROPERTY, VALUE};
-enum AdvSettingsRows {DISK_CACHE, DISK_CACHE_TTL, OUTGOING_PORT_MIN, OUTGOING_PORT_MAX, IGNORE_LIMIT_LAN, RECHECK_COMPLETED, LIST_REFRESH, RESOLVE_COUNTRIES, RESOLVE_HOSTS, MAX_HALF_OPEN, SUPER_SEEDING, NETWORK_IFACE, NETWORK_ADDRESS, PROGRAM_NOTIFICATIONS, TRACKER_STATUS, TRACKER_PORT,
+enum AdvSettingsRows {DISK_CACHE, DISK_CACHE_TTL, DISK_CACHE_ADAPTIVE, DISK_READ_CACHE, DISK_READ_CACHE_VOLATILE, DISK_CACHE_ALGORITHM, DISK_CACHE_CHUNK_SIZE, COALESCE_READS_WRITES, FILE_POOL_SIZE, MAX_QUEUED_DISK_BYTES, OUTGOING_PORT_MIN, OUTGOING_PORT_MAX, IGNORE_LIMIT_LAN, RECHECK_COMPLETED, LIST_REFRESH, RESOLVE_COUNTRIES, RESOLVE_HOSTS, MAX_HALF_OPEN, SUPER_SEEDING, NETWORK_IFACE, NETWORK_ADDRESS, PROGRAM_NOTIFICATIONS, TRACKER_STATUS, TRACKER_PORT,
                     #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
                       UPDATE_CHECK,
                     #endif
@@ -21,7 +22,7 @@ enum AdvSettingsRows {DISK_CACHE, DISK_CACHE_TTL, OUTGOING_PORT_MIN, OUTGOING_PO
                       USE_ICON_THEME,
                     #endif
                       CONFIRM_DELETE_TORRENT, TRACKER_EXCHANGE,
-                      ANNOUNCE_ALL_TRACKERS,
+                      ANNOUNCE_ALL_TRACKERS, PERFORMANCE_PROFILE,
                       ROW_COUNT};
 
 class AdvancedSettings: public QTableWidget {
@@ -34,6 +35,9 @@ private:
   cb_enable_tracker_ext;
   QComboBox combo_iface;
   QSpinBox spin_cache_ttl;
+  QCheckBox cb_cache_adaptive, cb_read_cache, cb_read_cache_volatile, cb_coalesce_reads_writes;
+  QComboBox combo_cache_algorithm;
+  QSpinBox spin_cache_chunk_size, spin_file_pool_size, spin_max_queued_disk_bytes;
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
   QCheckBox cb_update_check;
 #endif
@@ -41,6 +45,7 @@ private:
   QCheckBox cb_use_icon_theme;
 #endif
   QCheckBox cb_announce_all_trackers;
+  QComboBox combo_performance_profile;
   QLineEdit txt_network_address;
 
 public:
@@ -71,6 +76,15 @@ public slots:
     // Disk write cache
     pref.setDiskCacheSize(spin_cache.value());
     pref.setDiskCacheTTL(spin_cache_ttl.value());
+    pref.setDiskCacheAdaptive(cb_cache_adaptive.isChecked());
+    pref.setUseDiskReadCache(cb_read_cache.isChecked());
+    pref.setDiskReadCacheVolatile(cb_read_cache_volatile.isChecked());
+    pref.setDiskCacheFlushAlgorithm(combo_cache_algorithm.currentIndex());
+    pref.setDiskCacheChunkSize(spin_cache_chunk_size.value());
+    pref.setCoalesceDiskReadsWrites(cb_coalesce_reads_writes.isChecked());
+    // Disk I/O
+    pref.setFilePoolSize(spin_file_pool_size.value());
+    pref.setMaxQueuedDiskBytes(spin_max_queued_disk_bytes.value());
     // Outgoing ports
     pref.setOutgoingPortsMin(outgoing_ports_min.value());
     pref.setOutgoingPortsMax(outgoing_ports_max.value());
@@ -118,6 +132,7 @@ public slots:
     // Tracker exchange
     pref.setTrackerExchangeEnabled(cb_enable_tracker_ext.isChecked());
     pref.setAnnounceToAllTrackers(cb_announce_all_trackers.isChecked());
+    pref.setPerformanceProfile(combo_performance_profile.currentIndex());
   }
 
 signals:
@@ -180,6 +195,40 @@ private slots:
     spin_cache_ttl.setValue(pref.diskCacheTTL());
     spin_cache_ttl.setSuffix(tr(" s", " seconds"));
     setRow(DISK_CACHE_TTL, tr("Disk cache expiry interval"), &spin_cache_ttl);
+    // Adaptive disk cache, the size above becomes its upper bound
+    cb_cache_adaptive.setChecked(pref.isDiskCacheAdaptive());
+    setRow(DISK_CACHE_ADAPTIVE, tr("Adapt disk cache size to the workload"), &cb_cache_adaptive);
+    // Disk read cache
+    cb_read_cache.setChecked(pref.useDiskReadCache());
+    setRow(DISK_READ_CACHE, tr("Enable disk read cache"), &cb_read_cache);
+    cb_read_cache_volatile.setChecked(pref.isDiskReadCacheVolatile());
+    setRow(DISK_READ_CACHE_VOLATILE, tr("Evict read cache blocks once sent"), &cb_read_cache_volatile);
+    // Disk cache flush algorithm, in libtorrent's disk_cache_algo_t order
+    combo_cache_algorithm.addItem(tr("Least recently used"));
+    combo_cache_algorithm.addItem(tr("Largest contiguous"));
+    combo_cache_algorithm.addItem(tr("Avoid readback"));
+    combo_cache_algorithm.setCurrentIndex(qBound(0, pref.diskCacheFlushAlgorithm(), 2));
+    setRow(DISK_CACHE_ALGORITHM, tr("Disk cache flush algorithm"), &combo_cache_algorithm);
+    // Disk cache allocation chunk
+    spin_cache_chunk_size.setMinimum(1);
+    spin_cache_chunk_size.setMaximum(1024);
+    spin_cache_chunk_size.setValue(pref.diskCacheChunkSize());
+    spin_cache_chunk_size.setSuffix(tr(" blocks"));
+    setRow(DISK_CACHE_CHUNK_SIZE, tr("Disk cache allocation chunk"), &spin_cache_chunk_size);
+    // Coalesce reads & writes
+    cb_coalesce_reads_writes.setChecked(pref.coalesceDiskReadsWrites());
+    setRow(COALESCE_READS_WRITES, tr("Coalesce disk reads & writes"), &cb_coalesce_reads_writes);
+    // Open files limit
+    spin_file_pool_size.setMinimum(1);
+    spin_file_pool_size.setMaximum(4096);
+    spin_file_pool_size.setValue(pref.filePoolSize());
+    setRow(FILE_POOL_SIZE, tr("Maximum number of open files"), &spin_file_pool_size);
+    // Disk write queue
+    spin_max_queued_disk_bytes.setMinimum(16);
+    spin_max_queued_disk_bytes.setMaximum(1024 * 1024);
+    spin_max_queued_disk_bytes.setValue(pref.maxQueuedDiskBytes());
+    spin_max_queued_disk_bytes.setSuffix(tr(" KiB"));
+    setRow(MAX_QUEUED_DISK_BYTES, tr("Maximum queued disk write buffer"), &spin_max_queued_disk_bytes);
     // Outgoing port Min
     outgoing_ports_min.setMinimum(0);
     outgoing_ports_min.setMaximum(65535);
@@ -267,6 +316,17 @@ private slots:
     // Announce to all trackers
     cb_announce_all_trackers.setChecked(pref.announceToAllTrackers());
     setRow(ANNOUNCE_ALL_TRACKERS, tr("Always announce to all trackers"), &cb_announce_all_trackers);
+    // Performance profile, in PerformanceProfile::Profile order
+    combo_performance_profile.addItem(tr("Default"));
+    combo_performance_profile.addItem(tr("Seedbox (thousands of seeding torrents)"));
+    combo_performance_profile.setCurrentIndex(qBound<int>(PerformanceProfile::DEFAULT, pref.getPerformanceProfile(), PerformanceProfile::SEEDBOX));
+    // Show the values libtorrent currently applies
+    QStringList effective;
+    const QVariantMap settings = QBtSession::instance()->getEffectiveSettings();
+    for (QVariantMap::const_iterator it = settings.begin(); it != settings.end(); ++it)
+      effective << it.key() + QString::fromUtf8(": ") + it.value().toString();
+    combo_performance_profile.setToolTip(tr("Effective settings:") + QString::fromUtf8("\n") + effective.join(QString::fromUtf8("\n")));
+    setRow(PERFORMANCE_PROFILE, tr("Performance profile"), &combo_performance_profile);
   }
 
 };
@@ -621,6 +621,16 @@ void options_imp::loadOptions() {
   schedule_from->setTime(pref.getSchedulerStartTime());
   schedule_to->setTime(pref.getSchedulerEndTime());
   schedule_days->setCurrentIndex((int)pref.getSchedulerDays());
+  if (!pref.getSchedulerRules().isEmpty()) {
+    // The custom rules, set through the Web UI, replace the single window
+    const QString note = tr("Custom scheduler rules are in use, this time window is ignored.");
+    schedule_from->setEnabled(false);
+    schedule_from->setToolTip(note);
+    schedule_to->setEnabled(false);
+    schedule_to->setToolTip(note);
+    schedule_days->setEnabled(false);
+    schedule_days->setToolTip(note);
+  }
 
   intValue = pref.getProxyType();
   switch(intValue) {
@@ -1355,7 +1365,8 @@ void options_imp::toggleAnonymousMode(bool enabled)
 bool options_imp::schedTimesOk() {
   QString msg;
 
-  if (schedule_from->time() == schedule_to->time())
+  // Not editable while the custom rules are in use
+  if (Preferences().getSchedulerRules().isEmpty() && schedule_from->time() == schedule_to->time())
     msg = tr("The start time and the end time can't be the same.");
 
   if (!msg.isEmpty()) {
@@ -61,6 +61,9 @@ enum Style { NORMAL = 0, MONO_DARK, MONO_LIGHT };
 namespace DNS {
 enum Service { DYNDNS, NOIP, NONE = -1 };
 }
+namespace PerformanceProfile {
+enum Profile { DEFAULT, SEEDBOX };
+}
 
 class Preferences : private QIniSettings {
   Q_DISABLE_COPY(Preferences)
@@ -480,6 +483,15 @@ public:
     setValue("Preferences/Connection/GlobalUPLimitAlt", limit);
   }
 
+  // Label -> bandwidth class, see LabelLimits
+  QVariantMap getLabelBandwidthClasses() const {
+    return value(QString::fromUtf8("Preferences/Connection/LabelBandwidthClasses")).toMap();
+  }
+
+  void setLabelBandwidthClasses(const QVariantMap &classes) {
+    setValue(QString::fromUtf8("Preferences/Connection/LabelBandwidthClasses"), classes);
+  }
+
   bool isAltBandwidthEnabled() const {
     return value("Preferences/Connection/alt_speeds_on", false).toBool();
   }
@@ -520,6 +532,16 @@ public:
     setValue(QString::fromUtf8("Preferences/Scheduler/days"), (int)days);
   }
 
+  // Weekly rules, see BandwidthRule. The single window above is only
+  // used while there are none.
+  QVariantList getSchedulerRules() const {
+    return value(QString::fromUtf8("Preferences/Scheduler/Rules")).toList();
+  }
+
+  void setSchedulerRules(const QVariantList &rules) {
+    setValue(QString::fromUtf8("Preferences/Scheduler/Rules"), rules);
+  }
+
   // Proxy options
   bool isProxyEnabled() const {
     return value(QString::fromUtf8("Preferences/Connection/ProxyType"), 0).toInt() > 0;
@@ -736,6 +758,24 @@ public:
     setValue(QString::fromUtf8("Preferences/Search/SearchEnabled"), enabled);
   }
 
+  // Number of search plugins running at the same time
+  int searchMaxConcurrentEngines() const {
+    return qMax(1, value(QString::fromUtf8("Preferences/Search/MaxConcurrentEngines"), 4).toInt());
+  }
+
+  void setSearchMaxConcurrentEngines(int count) {
+    setValue(QString::fromUtf8("Preferences/Search/MaxConcurrentEngines"), count);
+  }
+
+  // Seconds after which a search plugin gets killed
+  int searchEngineTimeout() const {
+    return qMax(5, value(QString::fromUtf8("Preferences/Search/EngineTimeout"), 60).toInt());
+  }
+
+  void setSearchEngineTimeout(int secs) {
+    setValue(QString::fromUtf8("Preferences/Search/EngineTimeout"), secs);
+  }
+
   // Execution Log
 
   bool isExecutionLogEnabled() const {
@@ -746,6 +786,16 @@ public:
     setValue(QString::fromUtf8("Preferences/ExecutionLog/enabled"), b);
   }
 
+  // Traced operations taking longer (in ms) are logged, 0 to disable.
+  // Only used by the builds with tracing.
+  int traceSlowThreshold() const {
+    return qMax(0, value(QString::fromUtf8("Preferences/ExecutionLog/TraceSlowThreshold"), 100).toInt());
+  }
+
+  void setTraceSlowThreshold(int msecs) {
+    setValue(QString::fromUtf8("Preferences/ExecutionLog/TraceSlowThreshold"), msecs);
+  }
+
   // Queueing system
   bool isQueueingSystemEnabled() const {
     return value("Preferences/Queueing/QueueingEnabled", false).toBool();
@@ -918,6 +968,25 @@ public:
     setValue("Preferences/DynDNS/Password", password);
   }
 
+  // Local control socket, access is restricted to the user by the
+  // file permissions
+  bool isControlSocketEnabled() const {
+    return value("Preferences/ControlSocket/Enabled", false).toBool();
+  }
+
+  void setControlSocketEnabled(bool enabled) {
+    setValue("Preferences/ControlSocket/Enabled", enabled);
+  }
+
+  // Empty for the default location, in the cache folder
+  QString getControlSocketPath() const {
+    return value("Preferences/ControlSocket/Path").toString();
+  }
+
+  void setControlSocketPath(const QString &path) {
+    setValue("Preferences/ControlSocket/Path", path);
+  }
+
   // Advanced settings
 
   void setUILockPassword(const QString &clear_password) {
@@ -999,6 +1068,88 @@ public:
     setValue(QString::fromUtf8("Preferences/Downloads/DiskWriteCacheTTL"), ttl);
   }
 
+  // Resizes the disk cache from the read hit rate and the free memory,
+  // diskCacheSize() is then the upper bound (0: a quarter of the memory)
+  bool isDiskCacheAdaptive() const {
+    return value(QString::fromUtf8("Preferences/Downloads/DiskCacheAdaptive"), false).toBool();
+  }
+
+  void setDiskCacheAdaptive(bool enabled) {
+    setValue(QString::fromUtf8("Preferences/Downloads/DiskCacheAdaptive"), enabled);
+  }
+
+  bool useDiskReadCache() const {
+    return value(QString::fromUtf8("Preferences/Downloads/DiskReadCache"), true).toBool();
+  }
+
+  void setUseDiskReadCache(bool use) {
+    setValue(QString::fromUtf8("Preferences/Downloads/DiskReadCache"), use);
+  }
+
+  // Read cache blocks are evicted as soon as they have been sent
+  bool isDiskReadCacheVolatile() const {
+    return value(QString::fromUtf8("Preferences/Downloads/DiskReadCacheVolatile"), false).toBool();
+  }
+
+  void setDiskReadCacheVolatile(bool enabled) {
+    setValue(QString::fromUtf8("Preferences/Downloads/DiskReadCacheVolatile"), enabled);
+  }
+
+  // 0: least recently used, 1: largest contiguous, 2: avoid read back
+  int diskCacheFlushAlgorithm() const {
+    return value(QString::fromUtf8("Preferences/Downloads/DiskCacheFlushAlgorithm"), 2).toInt();
+  }
+
+  void setDiskCacheFlushAlgorithm(int algorithm) {
+    setValue(QString::fromUtf8("Preferences/Downloads/DiskCacheFlushAlgorithm"), algorithm);
+  }
+
+  // In 16 KiB blocks
+  uint diskCacheChunkSize() const {
+    return value(QString::fromUtf8("Preferences/Downloads/DiskCacheChunkSize"), 16).toUInt();
+  }
+
+  void setDiskCacheChunkSize(uint blocks) {
+    setValue(QString::fromUtf8("Preferences/Downloads/DiskCacheChunkSize"), blocks);
+  }
+
+  bool coalesceDiskReadsWrites() const {
+    return value(QString::fromUtf8("Preferences/Downloads/CoalesceReadsWrites"), false).toBool();
+  }
+
+  void setCoalesceDiskReadsWrites(bool enabled) {
+    setValue(QString::fromUtf8("Preferences/Downloads/CoalesceReadsWrites"), enabled);
+  }
+
+  // Files kept open at the same time
+  uint filePoolSize() const {
+    return value(QString::fromUtf8("Preferences/Downloads/FilePoolSize"), 40).toUInt();
+  }
+
+  void setFilePoolSize(uint size) {
+    setValue(QString::fromUtf8("Preferences/Downloads/FilePoolSize"), size);
+  }
+
+  // In KiB
+  uint maxQueuedDiskBytes() const {
+    return value(QString::fromUtf8("Preferences/Downloads/MaxQueuedDiskBytes"), 1024).toUInt();
+  }
+
+  void setMaxQueuedDiskBytes(uint kib) {
+    setValue(QString::fromUtf8("Preferences/Downloads/MaxQueuedDiskBytes"), kib);
+  }
+
+  int getPerformanceProfile() const {
+    return qBound<int>(PerformanceProfile::DEFAULT,
+                       value(QString::fromUtf8("Preferences/Advanced/PerformanceProfile"), PerformanceProfile::DEFAULT).toInt(),
+                       PerformanceProfile::SEEDBOX);
+  }
+
+  void setPerformanceProfile(int profile) {
+    setValue(QString::fromUtf8("Preferences/Advanced/PerformanceProfile"),
+             qBound<int>(PerformanceProfile::DEFAULT, profile, PerformanceProfile::SEEDBOX));
+  }
+
   uint outgoingPortsMin() const {
     return value(QString::fromUtf8("Preferences/Advanced/OutgoingPortsMin"), 0).toUInt();
   }
@@ -29,6 +29,9 @@
  */
 
 #include "downloadedpiecesbar.h"
+#include "piecesbarkernels.h"
+
+#include <cstring>
 
 //#include <QDebug>
 
@@ -44,12 +47,12 @@ DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent): QWidget(parent)
   updatePieceColors();
 }
 
-std::vector<float> DownloadedPiecesBar::bitfieldToFloatVector(const libtorrent::bitfield &vecin, int reqSize)
+void DownloadedPiecesBar::bitfieldToFloatVector(const libtorrent::bitfield &vecin, int reqSize, std::vector<float> &result)
 {
-  std::vector<float> result(reqSize, 0.0);
+  result.assign(reqSize, 0.0);
 
   if (vecin.empty())
-    return result;
+    return;
 
   const float ratio = vecin.size() / (float)reqSize;
 
@@ -103,10 +106,10 @@ std::vector<float> DownloadedPiecesBar::bitfieldToFloatVector(const libtorrent::
       }
 
       // subcase (16 >= x < 17)
-      for (; x2 < toCMinusOne; ++x2) {
-        if (vecin[x2]) {
-          value += 1.0;
-        }
+      // popcount over whole words, gives the same value as adding 1.0 per set bit
+      if (x2 < toCMinusOne) {
+        value = piecesbar::accumulateBits(value, vecin.bytes(), x2, toCMinusOne);
+        x2 = toCMinusOne;
       }
 
       // subcase (17 >= x < 17.8)
@@ -126,8 +129,14 @@ std::vector<float> DownloadedPiecesBar::bitfieldToFloatVector(const libtorrent::
 
     result[x] = value;
   }
+}
 
-  return result;
+bool DownloadedPiecesBar::sameBitfield(const libtorrent::bitfield &a, const libtorrent::bitfield &b)
+{
+  if (a.size() != b.size())
+    return false;
+  // libtorrent keeps the trailing bits cleared
+  return a.empty() || memcmp(a.bytes(), b.bytes(), (a.size() + 7) / 8) == 0;
 }
 
 
@@ -152,43 +161,51 @@ int DownloadedPiecesBar::mixTwoColors(int &rgb1, int &rgb2, float ratio)
 void DownloadedPiecesBar::updateImage()
 {
   //  qDebug() << "updateImage";
-  QImage image2(width() - 2, 1, QImage::Format_RGB888);
+  const int imageWidth = width() - 2;
+  // reuse the previous frame buffer when the size didn't change
+  if (image.width() != imageWidth || image.format() != QImage::Format_RGB888)
+    image = QImage(imageWidth, 1, QImage::Format_RGB888);
 
   if (pieces.empty()) {
-    image2.fill(0xffffff);
-    image = image2;
+    image.fill(0xffffff);
     update();
     return;
   }
 
-  std::vector<float> scaled_pieces = bitfieldToFloatVector(pieces, image2.width());
-  std::vector<float> scaled_pieces_dl = bitfieldToFloatVector(pieces_dl, image2.width());
+  bitfieldToFloatVector(pieces, imageWidth, scaled_pieces);
+  bitfieldToFloatVector(pieces_dl, imageWidth, scaled_pieces_dl);
 
-  // filling image
+  // filling image, straight into the scanline instead of setPixel()
+  uchar *line = image.scanLine(0);
   for (unsigned int x = 0; x < scaled_pieces.size(); ++x)
   {
-    float pieces2_val = scaled_pieces.at(x);
-    float pieces2_val_dl = scaled_pieces_dl.at(x);
+    float pieces2_val = scaled_pieces[x];
+    float pieces2_val_dl = scaled_pieces_dl[x];
+    int color;
     if (pieces2_val_dl != 0)
     {
       float fill_ratio = pieces2_val + pieces2_val_dl;
       float ratio = pieces2_val_dl / fill_ratio;
 
-      int mixedColor = mixTwoColors(piece_color, piece_color_dl, ratio);
-      mixedColor = mixTwoColors(bg_color, mixedColor, fill_ratio);
-
-      image2.setPixel(x, 0, mixedColor);
+      color = mixTwoColors(piece_color, piece_color_dl, ratio);
+      color = mixTwoColors(bg_color, color, fill_ratio);
     }
     else
     {
-      image2.setPixel(x, 0, piece_colors[pieces2_val * 255]);
+      color = piece_colors[pieces2_val * 255];
     }
+    line[3 * x] = qRed(color);
+    line[3 * x + 1] = qGreen(color);
+    line[3 * x + 2] = qBlue(color);
   }
-  image = image2;
 }
 
 void DownloadedPiecesBar::setProgress(const libtorrent::bitfield &bf, const libtorrent::bitfield &bf_dl)
 {
+  // nothing to redraw, paintEvent() takes care of resizes
+  if (!image.isNull() && sameBitfield(bf, pieces) && sameBitfield(bf_dl, pieces_dl))
+    return;
+
   pieces = libtorrent::bitfield(bf);
   pieces_dl = libtorrent::bitfield(bf_dl);
 
@@ -208,6 +225,8 @@ void DownloadedPiecesBar::updatePieceColors()
 void DownloadedPiecesBar::clear()
 {
   image = QImage();
+  pieces = libtorrent::bitfield();
+  pieces_dl = libtorrent::bitfield();
   update();
 }
 
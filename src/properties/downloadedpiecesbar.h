@@ -64,8 +64,13 @@ private:
   libtorrent::bitfield pieces;
   libtorrent::bitfield pieces_dl;
 
+  // scaled vectors reused between frames
+  std::vector<float> scaled_pieces;
+  std::vector<float> scaled_pieces_dl;
+
   // scale bitfield vector to float vector
-  std::vector<float> bitfieldToFloatVector(const libtorrent::bitfield &vecin, int reqSize);
+  void bitfieldToFloatVector(const libtorrent::bitfield &vecin, int reqSize, std::vector<float> &result);
+  static bool sameBitfield(const libtorrent::bitfield &a, const libtorrent::bitfield &b);
   // mix two colors by light model, ratio <0, 1>
   int mixTwoColors(int &rgb1, int &rgb2, float ratio);
   // draw new image and replace actual image
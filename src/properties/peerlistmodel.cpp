@@ -0,0 +1,441 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "peerlistmodel.h"
+#include "peerlistdelegate.h"
+#include "geoipmanager.h"
+#include "misc.h"
+
+#include <QCoreApplication>
+
+#include <cstring>
+
+#include <libtorrent/version.hpp>
+
+using namespace libtorrent;
+
+namespace boost {
+namespace asio {
+namespace ip {
+  // Found through ADL by the QHash below
+  inline uint qHash(const tcp::endpoint &ep)
+  {
+    if (ep.address().is_v4())
+      return ::qHash((quint32) ep.address().to_v4().to_ulong()) ^ ep.port();
+    const address_v6::bytes_type bytes = ep.address().to_v6().to_bytes();
+    return ::qHash(QByteArray::fromRawData(reinterpret_cast<const char*>(bytes.data()), bytes.size())) ^ ep.port();
+  }
+}
+}
+}
+
+PeerListModel::PeerListModel(QObject *parent)
+  : QAbstractTableModel(parent), m_displayFlags(false)
+{
+}
+
+int PeerListModel::rowCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : m_rows.size();
+}
+
+int PeerListModel::columnCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : PeerListDelegate::COL_COUNT;
+}
+
+QVariant PeerListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  switch(section) {
+  case PeerListDelegate::IP:
+    return QCoreApplication::translate("PeerListWidget", "IP");
+  case PeerListDelegate::FLAGS:
+    return QCoreApplication::translate("PeerListWidget", "Flags");
+  case PeerListDelegate::CONNECTION:
+    return QCoreApplication::translate("PeerListWidget", "Connection");
+  case PeerListDelegate::CLIENT:
+    return QCoreApplication::translate("PeerListWidget", "Client", "i.e.: Client application");
+  case PeerListDelegate::PROGRESS:
+    return QCoreApplication::translate("PeerListWidget", "Progress", "i.e: % downloaded");
+  case PeerListDelegate::DOWN_SPEED:
+    return QCoreApplication::translate("PeerListWidget", "Down Speed", "i.e: Download speed");
+  case PeerListDelegate::UP_SPEED:
+    return QCoreApplication::translate("PeerListWidget", "Up Speed", "i.e: Upload speed");
+  case PeerListDelegate::TOT_DOWN:
+    return QCoreApplication::translate("PeerListWidget", "Downloaded", "i.e: total data downloaded");
+  case PeerListDelegate::TOT_UP:
+    return QCoreApplication::translate("PeerListWidget", "Uploaded", "i.e: total data uploaded");
+  default:
+    // Country flag column
+    return QVariant();
+  }
+}
+
+QVariant PeerListModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || index.row() >= m_rows.size())
+    return QVariant();
+  const PeerRow &row = m_rows.at(index.row());
+  switch(index.column()) {
+  case PeerListDelegate::COUNTRY:
+    if (m_displayFlags && (role == Qt::DecorationRole || role == Qt::ToolTipRole)) {
+      const QIcon icon = countryIcon(row);
+      if (!icon.isNull())
+        return role == Qt::DecorationRole ? QVariant(icon) : QVariant(GeoIPManager::CountryISOCodeToName(row.country));
+    }
+    return QVariant();
+  case PeerListDelegate::IP:
+    if (role == Qt::DisplayRole)
+      return row.hostname.isEmpty() ? row.ip : row.hostname;
+    if (role == Qt::ToolTipRole)
+      return row.ip;
+    return QVariant();
+  case PeerListDelegate::IP_HIDDEN:
+    return role == Qt::DisplayRole ? row.ip : QVariant();
+  case PeerListDelegate::CONNECTION:
+    return role == Qt::DisplayRole ? connectionString(row) : QVariant();
+  case PeerListDelegate::FLAGS:
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
+      QString flags, tooltip;
+      flagsString(row, flags, tooltip);
+      return role == Qt::DisplayRole ? flags : tooltip;
+    }
+    return QVariant();
+  default:
+    break;
+  }
+  if (role != Qt::DisplayRole)
+    return QVariant();
+  switch(index.column()) {
+  case PeerListDelegate::CLIENT:
+    return misc::toQStringU(row.client);
+  case PeerListDelegate::PROGRESS:
+    return (qreal) row.progress;
+  case PeerListDelegate::DOWN_SPEED:
+    return row.downSpeed;
+  case PeerListDelegate::UP_SPEED:
+    return row.upSpeed;
+  case PeerListDelegate::TOT_DOWN:
+    return (qulonglong) row.totalDown;
+  case PeerListDelegate::TOT_UP:
+    return (qulonglong) row.totalUp;
+  default:
+    return QVariant();
+  }
+}
+
+void PeerListModel::update(const std::vector<peer_info> &peers, QStringList &addedIps)
+{
+  QHash<boost::asio::ip::tcp::endpoint, const peer_info*> incoming;
+  incoming.reserve(peers.size());
+  std::vector<peer_info>::const_iterator it = peers.begin();
+  std::vector<peer_info>::const_iterator itend = peers.end();
+  for ( ; it != itend; ++it)
+    incoming.insert(it->ip, &(*it));
+
+  // Remove the departed peers, one range at a time from the bottom
+  for (int row = m_rows.size() - 1; row >= 0; --row) {
+    if (incoming.contains(m_rows.at(row).endpoint))
+      continue;
+    const int last = row;
+    while (row > 0 && !incoming.contains(m_rows.at(row - 1).endpoint))
+      --row;
+    beginRemoveRows(QModelIndex(), row, last);
+    m_rows.remove(row, last - row + 1);
+    endRemoveRows();
+  }
+
+  // Update the remaining peers, the changed rows are reported in ranges
+  int first_changed = -1;
+  for (int row = 0; row < m_rows.size(); ++row) {
+    const peer_info *peer = incoming.take(m_rows.at(row).endpoint);
+    Q_ASSERT(peer);
+    if (updateRow(m_rows[row], *peer)) {
+      if (first_changed < 0)
+        first_changed = row;
+    } else if (first_changed >= 0) {
+      emit dataChanged(index(first_changed, 0), index(row - 1, PeerListDelegate::COL_COUNT - 1));
+      first_changed = -1;
+    }
+  }
+  if (first_changed >= 0)
+    emit dataChanged(index(first_changed, 0), index(m_rows.size() - 1, PeerListDelegate::COL_COUNT - 1));
+
+  // Append the new peers, in the order of the session
+  QVector<PeerRow> added;
+  boost::system::error_code ec;
+  for (it = peers.begin(); it != itend; ++it) {
+    if (!incoming.contains(it->ip))
+      continue;
+    const std::string ip_str = it->ip.address().to_string(ec);
+    if (ec || ip_str.empty())
+      continue;
+    PeerRow row;
+    row.endpoint = it->ip;
+    row.ip = misc::toQString(ip_str);
+    updateRow(row, *it);
+    added << row;
+    addedIps << row.ip;
+  }
+  if (!added.isEmpty()) {
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + added.size() - 1);
+    m_rows += added;
+    endInsertRows();
+  }
+}
+
+void PeerListModel::clear()
+{
+  if (m_rows.isEmpty())
+    return;
+  qDebug("Cleared %d peers", m_rows.size());
+  beginRemoveRows(QModelIndex(), 0, m_rows.size() - 1);
+  m_rows.clear();
+  endRemoveRows();
+}
+
+void PeerListModel::setDisplayFlags(bool display)
+{
+  if (m_displayFlags == display)
+    return;
+  m_displayFlags = display;
+  if (!m_rows.isEmpty())
+    emit dataChanged(index(0, PeerListDelegate::COUNTRY), index(m_rows.size() - 1, PeerListDelegate::COUNTRY));
+}
+
+void PeerListModel::setHostNames(const QHash<QString, QString> &hostnames)
+{
+  for (int row = 0; row < m_rows.size(); ++row) {
+    PeerRow &peer = m_rows[row];
+    const QHash<QString, QString>::ConstIterator it = hostnames.constFind(peer.ip);
+    if (it == hostnames.constEnd() || it.value() == peer.hostname)
+      continue;
+    qDebug("Resolved %s -> %s", qPrintable(peer.ip), qPrintable(it.value()));
+    peer.hostname = it.value();
+    const QModelIndex cell = index(row, PeerListDelegate::IP);
+    emit dataChanged(cell, cell);
+  }
+}
+
+QString PeerListModel::ip(int row) const
+{
+  return m_rows.at(row).ip;
+}
+
+boost::asio::ip::tcp::endpoint PeerListModel::endpoint(int row) const
+{
+  return m_rows.at(row).endpoint;
+}
+
+QStringList PeerListModel::ips() const
+{
+  QStringList result;
+  foreach (const PeerRow &row, m_rows)
+    result << row.ip;
+  return result;
+}
+
+bool PeerListModel::updateRow(PeerRow &row, const peer_info &peer)
+{
+  const bool changed = memcmp(row.country, peer.country, sizeof(row.country)) != 0
+      || row.flags != (unsigned int) peer.flags
+      || row.source != (int) peer.source
+      || row.connectionType != (int) peer.connection_type
+      || row.progress != peer.progress
+      || row.downSpeed != peer.payload_down_speed
+      || row.upSpeed != peer.payload_up_speed
+      || row.totalDown != (qint64) peer.total_download
+      || row.totalUp != (qint64) peer.total_upload
+      || row.client != peer.client;
+  memcpy(row.country, peer.country, sizeof(row.country));
+  row.flags = peer.flags;
+  row.source = peer.source;
+  row.connectionType = peer.connection_type;
+  row.progress = peer.progress;
+  row.downSpeed = peer.payload_down_speed;
+  row.upSpeed = peer.payload_up_speed;
+  row.totalDown = peer.total_download;
+  row.totalUp = peer.total_upload;
+  if (row.client != peer.client)
+    row.client = peer.client;
+  return changed;
+}
+
+QIcon PeerListModel::countryIcon(const PeerRow &row) const
+{
+  const QString code = QString::fromLatin1(row.country, sizeof(row.country));
+  QHash<QString, QIcon>::ConstIterator it = m_flagIcons.constFind(code);
+  if (it == m_flagIcons.constEnd())
+    it = m_flagIcons.insert(code, GeoIPManager::CountryISOCodeToIcon(row.country));
+  return it.value();
+}
+
+QString PeerListModel::connectionString(const PeerRow &row)
+{
+#if LIBTORRENT_VERSION_NUM < 10000
+  if (row.connectionType & peer_info::bittorrent_utp) {
+#else
+  if (row.flags & peer_info::utp_socket) {
+#endif
+    return QString::fromUtf8("μTP");
+  }
+
+  QString connection;
+  switch(row.connectionType) {
+  case peer_info::http_seed:
+  case peer_info::web_seed:
+    connection = "Web";
+    break;
+  default:
+    connection = "BT";
+    break;
+  }
+  return connection;
+}
+
+void PeerListModel::flagsString(const PeerRow &row, QString &flags, QString &tooltip)
+{
+  if (row.flags & peer_info::interesting) {
+    //d = Your client wants to download, but peer doesn't want to send (interested and choked)
+    if (row.flags & peer_info::remote_choked) {
+      flags += "d ";
+      tooltip += QCoreApplication::translate("PeerListWidget", "interested(local) and choked(peer)");
+      tooltip += ", ";
+    }
+    else {
+      //D = Currently downloading (interested and not choked)
+      flags += "D ";
+      tooltip += QCoreApplication::translate("PeerListWidget", "interested(local) and unchoked(peer)");
+      tooltip += ", ";
+    }
+  }
+
+  if (row.flags & peer_info::remote_interested) {
+    //u = Peer wants your client to upload, but your client doesn't want to (interested and choked)
+    if (row.flags & peer_info::choked) {
+      flags += "u ";
+      tooltip += QCoreApplication::translate("PeerListWidget", "interested(peer) and choked(local)");
+      tooltip += ", ";
+    }
+    else {
+      //U = Currently uploading (interested and not choked)
+      flags += "U ";
+      tooltip += QCoreApplication::translate("PeerListWidget", "interested(peer) and unchoked(local)");
+      tooltip += ", ";
+    }
+  }
+
+  //O = Optimistic unchoke
+  if (row.flags & peer_info::optimistic_unchoke) {
+    flags += "O ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "optimistic unchoke");
+    tooltip += ", ";
+  }
+
+  //S = Peer is snubbed
+  if (row.flags & peer_info::snubbed) {
+    flags += "S ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "peer snubbed");
+    tooltip += ", ";
+  }
+
+  //I = Peer is an incoming connection
+  if ((row.flags & peer_info::local_connection) == 0 ) {
+    flags += "I ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "incoming connection");
+    tooltip += ", ";
+  }
+
+  //K = Peer is unchoking your client, but your client is not interested
+  if (((row.flags & peer_info::remote_choked) == 0) && ((row.flags & peer_info::interesting) == 0)) {
+    flags += "K ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "not interested(local) and unchoked(peer)");
+    tooltip += ", ";
+  }
+
+  //? = Your client unchoked the peer but the peer is not interested
+  if (((row.flags & peer_info::choked) == 0) && ((row.flags & peer_info::remote_interested) == 0)) {
+    flags += "? ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "not interested(peer) and unchoked(local)");
+    tooltip += ", ";
+  }
+
+  //X = Peer was included in peerlists obtained through Peer Exchange (PEX)
+  if (row.source & peer_info::pex) {
+    flags += "X ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "peer from PEX");
+    tooltip += ", ";
+  }
+
+  //H = Peer was obtained through DHT
+  if (row.source & peer_info::dht) {
+    flags += "H ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "peer from DHT");
+    tooltip += ", ";
+  }
+
+  //E = Peer is using Protocol Encryption (all traffic)
+  if (row.flags & peer_info::rc4_encrypted) {
+    flags += "E ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "encrypted traffic");
+    tooltip += ", ";
+  }
+
+  //e = Peer is using Protocol Encryption (handshake)
+  if (row.flags & peer_info::plaintext_encrypted) {
+    flags += "e ";
+    tooltip += QCoreApplication::translate("PeerListWidget", "encrypted handshake");
+    tooltip += ", ";
+  }
+
+  //P = Peer is using uTorrent uTP
+#if LIBTORRENT_VERSION_NUM < 10000
+  if (row.connectionType & peer_info::bittorrent_utp) {
+#else
+  if (row.flags & peer_info::utp_socket) {
+#endif
+    flags += "P ";
+    tooltip += QString::fromUtf8("μTP");
+    tooltip += ", ";
+  }
+
+  //L = Peer is local
+  if (row.source & peer_info::lsd) {
+    flags += "L";
+    tooltip += QCoreApplication::translate("PeerListWidget", "peer from LSD");
+  }
+
+  flags = flags.trimmed();
+  tooltip = tooltip.trimmed();
+  if (tooltip.endsWith(',', Qt::CaseInsensitive))
+    tooltip.chop(1);
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef PEERLISTMODEL_H
+#define PEERLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QIcon>
+#include <QStringList>
+#include <QVector>
+
+#include <string>
+#include <vector>
+
+#include <libtorrent/peer_info.hpp>
+
+#include <boost/version.hpp>
+#if BOOST_VERSION < 103500
+#include <libtorrent/asio/ip/tcp.hpp>
+#else
+#include <boost/asio/ip/tcp.hpp>
+#endif
+
+// Peers of the current torrent, one row per endpoint.
+// update() diffs the new peer list against the current rows and only emits
+// the removed, inserted and changed row ranges. The raw values are kept and
+// the cells are formatted when the view asks for them.
+class PeerListModel : public QAbstractTableModel {
+  Q_OBJECT
+  Q_DISABLE_COPY(PeerListModel)
+
+public:
+  explicit PeerListModel(QObject *parent = 0);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+  // addedIps receives the addresses of the new rows
+  void update(const std::vector<libtorrent::peer_info> &peers, QStringList &addedIps);
+  void clear();
+  void setDisplayFlags(bool display);
+  void setHostNames(const QHash<QString, QString> &hostnames);
+
+  QString ip(int row) const;
+  boost::asio::ip::tcp::endpoint endpoint(int row) const;
+  QStringList ips() const;
+
+private:
+  struct PeerRow {
+    PeerRow(): flags(0), source(0), connectionType(0), progress(0), downSpeed(0), upSpeed(0),
+      totalDown(0), totalUp(0) { country[0] = country[1] = 0; }
+    boost::asio::ip::tcp::endpoint endpoint;
+    QString ip;
+    QString hostname;
+    char country[2];
+    unsigned int flags;
+    int source;
+    int connectionType;
+    float progress;
+    int downSpeed;
+    int upSpeed;
+    qint64 totalDown;
+    qint64 totalUp;
+    std::string client;
+  };
+
+  static bool updateRow(PeerRow &row, const libtorrent::peer_info &peer);
+  static QString connectionString(const PeerRow &row);
+  static void flagsString(const PeerRow &row, QString &flags, QString &tooltip);
+  QIcon countryIcon(const PeerRow &row) const;
+
+private:
+  QVector<PeerRow> m_rows;
+  bool m_displayFlags;
+  mutable QHash<QString, QIcon> m_flagIcons;
+};
+
+#endif // PEERLISTMODEL_H
@@ -30,6 +30,7 @@
 
 #include "peerlistwidget.h"
 #include "peerlistdelegate.h"
+#include "peerlistmodel.h"
 #include "reverseresolution.h"
 #include "preferences.h"
 #include "propertieswidget.h"
@@ -37,12 +38,12 @@
 #include "peeraddition.h"
 #include "speedlimitdlg.h"
 #include "iconprovider.h"
-#include <QStandardItemModel>
 #include <QSortFilterProxyModel>
 #include <QSet>
 #include <QHeaderView>
 #include <QMenu>
 #include <QClipboard>
+#include <QScrollBar>
 #include <vector>
 #include "qinisettings.h"
 
@@ -60,17 +61,7 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent):
   setAllColumnsShowFocus(true);
   setSelectionMode(QAbstractItemView::ExtendedSelection);
   // List Model
-  m_listModel = new QStandardItemModel(0, PeerListDelegate::COL_COUNT);
-  m_listModel->setHeaderData(PeerListDelegate::COUNTRY, Qt::Horizontal, QVariant()); // Country flag column
-  m_listModel->setHeaderData(PeerListDelegate::IP, Qt::Horizontal, tr("IP"));
-  m_listModel->setHeaderData(PeerListDelegate::FLAGS, Qt::Horizontal, tr("Flags"));
-  m_listModel->setHeaderData(PeerListDelegate::CONNECTION, Qt::Horizontal, tr("Connection"));
-  m_listModel->setHeaderData(PeerListDelegate::CLIENT, Qt::Horizontal, tr("Client", "i.e.: Client application"));
-  m_listModel->setHeaderData(PeerListDelegate::PROGRESS, Qt::Horizontal, tr("Progress", "i.e: % downloaded"));
-  m_listModel->setHeaderData(PeerListDelegate::DOWN_SPEED, Qt::Horizontal, tr("Down Speed", "i.e: Download speed"));
-  m_listModel->setHeaderData(PeerListDelegate::UP_SPEED, Qt::Horizontal, tr("Up Speed", "i.e: Upload speed"));
-  m_listModel->setHeaderData(PeerListDelegate::TOT_DOWN, Qt::Horizontal, tr("Downloaded", "i.e: total data downloaded"));
-  m_listModel->setHeaderData(PeerListDelegate::TOT_UP, Qt::Horizontal, tr("Uploaded", "i.e: total data uploaded"));
+  m_listModel = new PeerListModel();
   // Proxy model to support sorting without actually altering the underlying model
   m_proxyModel = new PeerListSortModel();
   m_proxyModel->setDynamicSortFilter(true);
@@ -104,6 +95,7 @@ PeerListWidget::PeerListWidget(PropertiesWidget *parent):
   updatePeerHostNameResolutionState();
   // SIGNAL/SLOT
   connect(header(), SIGNAL(sectionClicked(int)), SLOT(handleSortColumnChanged(int)));
+  connect(verticalScrollBar(), SIGNAL(valueChanged(int)), SLOT(prioritizeVisiblePeers()));
   handleSortColumnChanged(header()->sortIndicatorSection());
 }
 
@@ -114,20 +106,23 @@ PeerListWidget::~PeerListWidget()
   delete m_listModel;
   delete m_listDelegate;
   if (m_resolver)
-    delete m_resolver;
+    m_resolver->cancelPending();
 }
 
 void PeerListWidget::updatePeerHostNameResolutionState()
 {
   if (Preferences().resolvePeerHostNames()) {
     if (!m_resolver) {
-      m_resolver = new ReverseResolution(this);
-      connect(m_resolver, SIGNAL(ip_resolved(QString,QString)), SLOT(handleResolved(QString,QString)));
+      m_resolver = ReverseResolution::instance();
+      connect(m_resolver, SIGNAL(ipsResolved(QHash<QString,QString>)), SLOT(handleResolved(QHash<QString,QString>)));
       loadPeers(m_properties->getCurrentTorrent(), true);
     }
   } else {
-    if (m_resolver)
-      delete m_resolver;
+    if (m_resolver) {
+      disconnect(m_resolver, 0, this, 0);
+      m_resolver->cancelPending();
+      m_resolver = 0;
+    }
   }
 }
 
@@ -135,8 +130,7 @@ void PeerListWidget::updatePeerCountryResolutionState()
 {
   if (Preferences().resolvePeerCountries() != m_displayFlags) {
     m_displayFlags = !m_displayFlags;
-    if (m_displayFlags)
-      loadPeers(m_properties->getCurrentTorrent());
+    m_listModel->setDisplayFlags(m_displayFlags);
   }
 }
 
@@ -148,10 +142,11 @@ void PeerListWidget::showPeerListMenu(const QPoint&)
   if (!h.is_valid()) return;
   QModelIndexList selectedIndexes = selectionModel()->selectedRows();
   QStringList selectedPeerIPs;
+  QList<boost::asio::ip::tcp::endpoint> selectedPeers;
   foreach (const QModelIndex &index, selectedIndexes) {
     int row = m_proxyModel->mapToSource(index).row();
-    QString myip = m_listModel->data(m_listModel->index(row, PeerListDelegate::IP_HIDDEN)).toString();
-    selectedPeerIPs << myip;
+    selectedPeerIPs << m_listModel->ip(row);
+    selectedPeers << m_listModel->endpoint(row);
   }
   // Add Peer Action
   QAction *addPeerAct = 0;
@@ -196,11 +191,11 @@ void PeerListWidget::showPeerListMenu(const QPoint&)
   }
 #if LIBTORRENT_VERSION_NUM < 10000
   if (act == upLimitAct) {
-    limitUpRateSelectedPeers(selectedPeerIPs);
+    limitUpRateSelectedPeers(selectedPeers);
     return;
   }
   if (act == dlLimitAct) {
-    limitDlRateSelectedPeers(selectedPeerIPs);
+    limitDlRateSelectedPeers(selectedPeers);
     return;
   }
 #endif
@@ -236,20 +231,16 @@ void PeerListWidget::banSelectedPeers(const QStringList& peer_ips)
 }
 
 #if LIBTORRENT_VERSION_NUM < 10000
-void PeerListWidget::limitUpRateSelectedPeers(const QStringList& peer_ips)
+void PeerListWidget::limitUpRateSelectedPeers(const QList<boost::asio::ip::tcp::endpoint>& peers)
 {
-  if (peer_ips.empty())
+  if (peers.empty())
     return;
   QTorrentHandle h = m_properties->getCurrentTorrent();
   if (!h.is_valid())
     return;
 
   bool ok = false;
-  int cur_limit = -1;
-  boost::asio::ip::tcp::endpoint first_ep = m_peerEndpoints.value(peer_ips.first(),
-                                                                  boost::asio::ip::tcp::endpoint());
-  if (first_ep != boost::asio::ip::tcp::endpoint())
-    cur_limit = h.get_peer_upload_limit(first_ep);
+  int cur_limit = h.get_peer_upload_limit(peers.first());
   long limit = SpeedLimitDialog::askSpeedLimit(&ok,
                                                tr("Upload rate limiting"),
                                                cur_limit,
@@ -257,47 +248,35 @@ void PeerListWidget::limitUpRateSelectedPeers(const QStringList& peer_ips)
   if (!ok)
     return;
 
-  foreach (const QString &ip, peer_ips) {
-    boost::asio::ip::tcp::endpoint ep = m_peerEndpoints.value(ip, boost::asio::ip::tcp::endpoint());
-    if (ep != boost::asio::ip::tcp::endpoint()) {
-      qDebug("Settings Upload limit of %.1f Kb/s to peer %s", limit/1024., ip.toLocal8Bit().data());
-      try {
-        h.set_peer_upload_limit(ep, limit);
-      } catch(std::exception) {
-        std::cerr << "Impossible to apply upload limit to peer" << std::endl;
-      }
-    } else {
-      qDebug("The selected peer no longer exists...");
+  foreach (const boost::asio::ip::tcp::endpoint &ep, peers) {
+    qDebug("Settings Upload limit of %.1f Kb/s to peer %s", limit/1024., ep.address().to_string().c_str());
+    try {
+      h.set_peer_upload_limit(ep, limit);
+    } catch(std::exception) {
+      std::cerr << "Impossible to apply upload limit to peer" << std::endl;
     }
   }
 }
 
-void PeerListWidget::limitDlRateSelectedPeers(const QStringList& peer_ips)
+void PeerListWidget::limitDlRateSelectedPeers(const QList<boost::asio::ip::tcp::endpoint>& peers)
 {
+  if (peers.empty())
+    return;
   QTorrentHandle h = m_properties->getCurrentTorrent();
   if (!h.is_valid())
     return;
   bool ok = false;
-  int cur_limit = -1;
-  boost::asio::ip::tcp::endpoint first_ep = m_peerEndpoints.value(peer_ips.first(),
-                                                                  boost::asio::ip::tcp::endpoint());
-  if (first_ep != boost::asio::ip::tcp::endpoint())
-    cur_limit = h.get_peer_download_limit(first_ep);
+  int cur_limit = h.get_peer_download_limit(peers.first());
   long limit = SpeedLimitDialog::askSpeedLimit(&ok, tr("Download rate limiting"), cur_limit, Preferences().getGlobalDownloadLimit()*1024.);
   if (!ok)
     return;
 
-  foreach (const QString &ip, peer_ips) {
-    boost::asio::ip::tcp::endpoint ep = m_peerEndpoints.value(ip, boost::asio::ip::tcp::endpoint());
-    if (ep != boost::asio::ip::tcp::endpoint()) {
-      qDebug("Settings Download limit of %.1f Kb/s to peer %s", limit/1024., ip.toLocal8Bit().data());
-      try {
-        h.set_peer_download_limit(ep, limit);
-      }catch(std::exception) {
-        std::cerr << "Impossible to apply download limit to peer" << std::endl;
-      }
-    } else {
-      qDebug("The selected peer no longer exists...");
+  foreach (const boost::asio::ip::tcp::endpoint &ep, peers) {
+    qDebug("Settings Download limit of %.1f Kb/s to peer %s", limit/1024., ep.address().to_string().c_str());
+    try {
+      h.set_peer_download_limit(ep, limit);
+    }catch(std::exception) {
+      std::cerr << "Impossible to apply download limit to peer" << std::endl;
     }
   }
 }
@@ -305,14 +284,7 @@ void PeerListWidget::limitDlRateSelectedPeers(const QStringList& peer_ips)
 
 void PeerListWidget::clear() {
   qDebug("clearing peer list");
-  m_peerItems.clear();
-  m_peerEndpoints.clear();
-  m_missingFlags.clear();
-  int nbrows = m_listModel->rowCount();
-  if (nbrows > 0) {
-    qDebug("Cleared %d peers", nbrows);
-    m_listModel->removeRows(0,  nbrows);
-  }
+  m_listModel->clear();
 }
 
 void PeerListWidget::loadSettings() {
@@ -328,108 +300,31 @@ void PeerListWidget::saveSettings() const {
 void PeerListWidget::loadPeers(const QTorrentHandle &h, bool force_hostname_resolution) {
   if (!h.is_valid())
     return;
-  boost::system::error_code ec;
   std::vector<peer_info> peers;
   h.get_peer_info(peers);
-  QSet<QString> old_peers_set = m_peerItems.keys().toSet();
-
-  std::vector<peer_info>::const_iterator itr = peers.begin();
-  std::vector<peer_info>::const_iterator itrend = peers.end();
-  for ( ; itr != itrend; ++itr) {
-    peer_info peer = *itr;
-    std::string ip_str = peer.ip.address().to_string(ec);
-    if (ec || ip_str.empty())
-      continue;
-    QString peer_ip = misc::toQString(ip_str);
-    if (m_peerItems.contains(peer_ip)) {
-      // Update existing peer
-      updatePeer(peer_ip, peer);
-      old_peers_set.remove(peer_ip);
-      if (force_hostname_resolution && m_resolver) {
-        m_resolver->resolve(peer_ip);
-      }
-    } else {
-      // Add new peer
-      m_peerItems[peer_ip] = addPeer(peer_ip, peer);
-      m_peerEndpoints[peer_ip] = peer.ip;
-      // Resolve peer host name is asked
-      if (m_resolver)
-        m_resolver->resolve(peer_ip);
-    }
-  }
-  // Delete peers that are gone
-  QSetIterator<QString> it(old_peers_set);
-  while(it.hasNext()) {
-    const QString& ip = it.next();
-    m_missingFlags.remove(ip);
-    m_peerEndpoints.remove(ip);
-    QStandardItem *item = m_peerItems.take(ip);
-    m_listModel->removeRow(item->row());
-  }
+  QStringList new_ips;
+  m_listModel->update(peers, new_ips);
+  // Resolve peer host names if asked
+  if (m_resolver) {
+    foreach (const QString &ip, force_hostname_resolution ? m_listModel->ips() : new_ips)
+      m_resolver->resolve(ip);
+  }
+  prioritizeVisiblePeers();
 }
 
-QStandardItem* PeerListWidget::addPeer(const QString& ip, const peer_info& peer) {
-  int row = m_listModel->rowCount();
-  // Adding Peer to peer list
-  m_listModel->insertRow(row);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), ip);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), ip, Qt::ToolTipRole);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP_HIDDEN), ip);
-  if (m_displayFlags) {
-    const QIcon ico = GeoIPManager::CountryISOCodeToIcon(peer.country);
-    if (!ico.isNull()) {
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::COUNTRY), ico, Qt::DecorationRole);
-      const QString country_name = GeoIPManager::CountryISOCodeToName(peer.country);
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::COUNTRY), country_name, Qt::ToolTipRole);
-    } else {
-      m_missingFlags.insert(ip);
-    }
-  }
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CONNECTION), getConnectionString(peer));
-  QString flags, tooltip;
-  getFlags(peer, flags, tooltip);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::FLAGS), flags);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::FLAGS), tooltip, Qt::ToolTipRole);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CLIENT), misc::toQStringU(peer.client));
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::PROGRESS), peer.progress);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::DOWN_SPEED), peer.payload_down_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::UP_SPEED), peer.payload_up_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_DOWN), (qulonglong)peer.total_download);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_UP), (qulonglong)peer.total_upload);
-  return m_listModel->item(row, PeerListDelegate::IP);
+void PeerListWidget::handleResolved(const QHash<QString, QString> &hostnames) {
+  m_listModel->setHostNames(hostnames);
 }
 
-void PeerListWidget::updatePeer(const QString& ip, const peer_info& peer) {
-  QStandardItem *item = m_peerItems.value(ip);
-  int row = item->row();
-  if (m_displayFlags) {
-    const QIcon ico = GeoIPManager::CountryISOCodeToIcon(peer.country);
-    if (!ico.isNull()) {
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::COUNTRY), ico, Qt::DecorationRole);
-      const QString country_name = GeoIPManager::CountryISOCodeToName(peer.country);
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::COUNTRY), country_name, Qt::ToolTipRole);
-      m_missingFlags.remove(ip);
-    }
-  }
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CONNECTION), getConnectionString(peer));
-  QString flags, tooltip;
-  getFlags(peer, flags, tooltip);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::FLAGS), flags);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::FLAGS), tooltip, Qt::ToolTipRole);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CLIENT), misc::toQStringU(peer.client));
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::PROGRESS), peer.progress);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::DOWN_SPEED), peer.payload_down_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::UP_SPEED), peer.payload_up_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_DOWN), (qulonglong)peer.total_download);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_UP), (qulonglong)peer.total_upload);
-}
-
-void PeerListWidget::handleResolved(const QString &ip, const QString &hostname) {
-  QStandardItem *item = m_peerItems.value(ip, 0);
-  if (item) {
-    qDebug("Resolved %s -> %s", qPrintable(ip), qPrintable(hostname));
-    item->setData(hostname, Qt::DisplayRole);
-  }
+void PeerListWidget::prioritizeVisiblePeers() {
+  if (!m_resolver)
+    return;
+  // Resolve the peers on screen first
+  QStringList visible_ips;
+  const int viewport_height = viewport()->height();
+  for (QModelIndex index = indexAt(QPoint(0, 0)); index.isValid() && visualRect(index).top() < viewport_height; index = indexBelow(index))
+    visible_ips << m_proxyModel->index(index.row(), PeerListDelegate::IP_HIDDEN).data().toString();
+  m_resolver->prioritize(visible_ips);
 }
 
 void PeerListWidget::handleSortColumnChanged(int col)
@@ -441,144 +336,3 @@ void PeerListWidget::handleSortColumnChanged(int col)
     m_proxyModel->setSortRole(Qt::DisplayRole);
   }
 }
-
-QString PeerListWidget::getConnectionString(const peer_info& peer)
-{
-#if LIBTORRENT_VERSION_NUM < 10000
-  if (peer.connection_type & peer_info::bittorrent_utp) {
-#else
-  if (peer.flags & peer_info::utp_socket) {
-#endif
-    return QString::fromUtf8("μTP");
-  }
-
-  QString connection;
-  switch(peer.connection_type) {
-  case peer_info::http_seed:
-  case peer_info::web_seed:
-    connection = "Web";
-    break;
-  default:
-    connection = "BT";
-    break;
-  }
-  return connection;
-}
-
-void PeerListWidget::getFlags(const peer_info& peer, QString& flags, QString& tooltip)
-{  
-  if (peer.flags & peer_info::interesting) {
-    //d = Your client wants to download, but peer doesn't want to send (interested and choked)
-    if (peer.flags & peer_info::remote_choked) {
-      flags += "d ";
-      tooltip += tr("interested(local) and choked(peer)");
-      tooltip += ", ";
-    }
-    else {
-      //D = Currently downloading (interested and not choked)
-      flags += "D ";
-      tooltip += tr("interested(local) and unchoked(peer)");
-      tooltip += ", ";
-    }
-  }
-
-  if (peer.flags & peer_info::remote_interested) {
-    //u = Peer wants your client to upload, but your client doesn't want to (interested and choked)
-    if (peer.flags & peer_info::choked) {
-      flags += "u ";
-      tooltip += tr("interested(peer) and choked(local)");
-      tooltip += ", ";
-    }
-    else {
-      //U = Currently uploading (interested and not choked)
-      flags += "U ";
-      tooltip += tr("interested(peer) and unchoked(local)");
-      tooltip += ", ";
-    }
-  }
-
-  //O = Optimistic unchoke
-  if (peer.flags & peer_info::optimistic_unchoke) {
-    flags += "O ";
-    tooltip += tr("optimistic unchoke");
-    tooltip += ", ";
-  }
-
-  //S = Peer is snubbed
-  if (peer.flags & peer_info::snubbed) {
-    flags += "S ";
-    tooltip += tr("peer snubbed");
-    tooltip += ", ";
-  }
-
-  //I = Peer is an incoming connection
-  if ((peer.flags & peer_info::local_connection) == 0 ) {
-    flags += "I ";
-    tooltip += tr("incoming connection");
-    tooltip += ", ";
-  }
-
-  //K = Peer is unchoking your client, but your client is not interested
-  if (((peer.flags & peer_info::remote_choked) == 0) && ((peer.flags & peer_info::interesting) == 0)) {
-    flags += "K ";
-    tooltip += tr("not interested(local) and unchoked(peer)");
-    tooltip += ", ";
-  }
-
-  //? = Your client unchoked the peer but the peer is not interested
-  if (((peer.flags & peer_info::choked) == 0) && ((peer.flags & peer_info::remote_interested) == 0)) {
-    flags += "? ";
-    tooltip += tr("not interested(peer) and unchoked(local)");
-    tooltip += ", ";
-  }
-
-  //X = Peer was included in peerlists obtained through Peer Exchange (PEX)
-  if (peer.source & peer_info::pex) {
-    flags += "X ";
-    tooltip += tr("peer from PEX");
-    tooltip += ", ";
-  }
-
-  //H = Peer was obtained through DHT
-  if (peer.source & peer_info::dht) {
-    flags += "H ";
-    tooltip += tr("peer from DHT");
-    tooltip += ", ";
-  }
-
-  //E = Peer is using Protocol Encryption (all traffic)
-  if (peer.flags & peer_info::rc4_encrypted) {
-    flags += "E ";
-    tooltip += tr("encrypted traffic");
-    tooltip += ", ";
-  }
-
-  //e = Peer is using Protocol Encryption (handshake)
-  if (peer.flags & peer_info::plaintext_encrypted) {
-    flags += "e ";
-    tooltip += tr("encrypted handshake");
-    tooltip += ", ";
-  }
-
-  //P = Peer is using uTorrent uTP
-#if LIBTORRENT_VERSION_NUM < 10000
-  if (peer.connection_type & peer_info::bittorrent_utp) {
-#else
-  if (peer.flags & peer_info::utp_socket) {
-#endif
-    flags += "P ";
-    tooltip += QString::fromUtf8("μTP");
-    tooltip += ", ";
-  }
-
-  //L = Peer is local
-  if (peer.source & peer_info::lsd) {
-    flags += "L";
-    tooltip += tr("peer from LSD");
-  }
-
-  flags = flags.trimmed();
-  tooltip = tooltip.trimmed();
-  if (tooltip.endsWith(',', Qt::CaseInsensitive))
-    tooltip.chop(1);
-}
@@ -41,13 +41,12 @@
 #include "misc.h"
 
 class PeerListDelegate;
+class PeerListModel;
 class ReverseResolution;
 class PropertiesWidget;
 
 QT_BEGIN_NAMESPACE
 class QSortFilterProxyModel;
-class QStandardItem;
-class QStandardItemModel;
 QT_END_NAMESPACE
 
 #include <boost/version.hpp>
@@ -66,9 +65,7 @@ public:
 
 public slots:
   void loadPeers(const QTorrentHandle &h, bool force_hostname_resolution = false);
-  QStandardItem*  addPeer(const QString& ip, const libtorrent::peer_info& peer);
-  void updatePeer(const QString& ip, const libtorrent::peer_info& peer);
-  void handleResolved(const QString &ip, const QString &hostname);
+  void handleResolved(const QHash<QString, QString> &hostnames);
   void updatePeerHostNameResolutionState();
   void updatePeerCountryResolutionState();
   void clear();
@@ -79,24 +76,18 @@ protected slots:
   void showPeerListMenu(const QPoint&);
 
 #if LIBTORRENT_VERSION_NUM < 10000
-  void limitUpRateSelectedPeers(const QStringList& peer_ips);
-  void limitDlRateSelectedPeers(const QStringList& peer_ips);
+  void limitUpRateSelectedPeers(const QList<boost::asio::ip::tcp::endpoint>& peers);
+  void limitDlRateSelectedPeers(const QList<boost::asio::ip::tcp::endpoint>& peers);
 #endif
 
   void banSelectedPeers(const QStringList& peer_ips);
   void handleSortColumnChanged(int col);
+  void prioritizeVisiblePeers();
 
 private:
-  static QString getConnectionString(const libtorrent::peer_info &peer);
-  static void getFlags(const libtorrent::peer_info& peer, QString& flags, QString& tooltip);
-
-private:
-  QStandardItemModel *m_listModel;
+  PeerListModel *m_listModel;
   PeerListDelegate *m_listDelegate;
   PeerListSortModel *m_proxyModel;
-  QHash<QString, QStandardItem*> m_peerItems;
-  QHash<QString, boost::asio::ip::tcp::endpoint> m_peerEndpoints;
-  QSet<QString> m_missingFlags;
   QPointer<ReverseResolution> m_resolver;
   PropertiesWidget *m_properties;
   bool m_displayFlags;
@@ -29,6 +29,7 @@
  */
 
 #include "pieceavailabilitybar.h"
+#include "piecesbarkernels.h"
 
 //#include <QDebug>
 
@@ -44,12 +45,12 @@ PieceAvailabilityBar::PieceAvailabilityBar(QWidget *parent) :
   updatePieceColors();
 }
 
-std::vector<float> PieceAvailabilityBar::intToFloatVector(const std::vector<int> &vecin, int reqSize)
+void PieceAvailabilityBar::intToFloatVector(const std::vector<int> &vecin, int reqSize, std::vector<float> &result)
 {
-  std::vector<float> result(reqSize, 0.0);
+  result.assign(reqSize, 0.0);
 
   if (vecin.empty())
-    return result;
+    return;
 
   const float ratio = vecin.size() / (float)reqSize;
 
@@ -60,7 +61,7 @@ std::vector<float> PieceAvailabilityBar::intToFloatVector(const std::vector<int>
   // const int maxElement = qMax(*std::max_element(avail.begin(), avail.end()), 1);
 
   if (maxElement == 0)
-    return result;
+    return;
 
   // simple linear transformation algorithm
   // for example:
@@ -112,10 +113,10 @@ std::vector<float> PieceAvailabilityBar::intToFloatVector(const std::vector<int>
       }
 
       // subcase (16 >= x < 17)
-      for (; x2 < toCMinusOne; ++x2) {
-        if (vecin[x2]) {
-          value += vecin[x2];
-        }
+      // vectorized block sums, gives the same value as adding one by one
+      if (x2 < toCMinusOne) {
+        value = piecesbar::accumulateInts(value, &vecin[x2], toCMinusOne - x2);
+        x2 = toCMinusOne;
       }
 
       // subcase (17 >= x < 17.8)
@@ -135,8 +136,6 @@ std::vector<float> PieceAvailabilityBar::intToFloatVector(const std::vector<int>
 
     result[x] = value;
   }
-
-  return result;
 }
 
 int PieceAvailabilityBar::mixTwoColors(int &rgb1, int &rgb2, float ratio)
@@ -160,28 +159,36 @@ int PieceAvailabilityBar::mixTwoColors(int &rgb1, int &rgb2, float ratio)
 void PieceAvailabilityBar::updateImage()
 {
   //  qDebug() << "updateImageAv";
-  QImage image2(width() - 2, 1, QImage::Format_RGB888);
+  const int imageWidth = width() - 2;
+  // reuse the previous frame buffer when the size didn't change
+  if (image.width() != imageWidth || image.format() != QImage::Format_RGB888)
+    image = QImage(imageWidth, 1, QImage::Format_RGB888);
 
   if (pieces.empty()) {
-    image2.fill(0xffffff);
-    image = image2;
+    image.fill(0xffffff);
     update();
     return;
   }
 
-  std::vector<float> scaled_pieces = intToFloatVector(pieces, image2.width());
+  intToFloatVector(pieces, imageWidth, scaled_pieces);
 
-  // filling image
+  // filling image, straight into the scanline instead of setPixel()
+  uchar *line = image.scanLine(0);
   for (unsigned int x = 0; x < scaled_pieces.size(); ++x)
   {
-    float pieces2_val = scaled_pieces.at(x);
-    image2.setPixel(x, 0, piece_colors[pieces2_val * 255]);
+    const int color = piece_colors[scaled_pieces[x] * 255];
+    line[3 * x] = qRed(color);
+    line[3 * x + 1] = qGreen(color);
+    line[3 * x + 2] = qBlue(color);
   }
-  image = image2;
 }
 
 void PieceAvailabilityBar::setAvailability(const std::vector<int>& avail)
 {
+  // nothing to redraw, paintEvent() takes care of resizes
+  if (!image.isNull() && avail == pieces)
+    return;
+
   pieces = std::vector<int>(avail);
 
   updateImage();
@@ -200,6 +207,7 @@ void PieceAvailabilityBar::updatePieceColors()
 void PieceAvailabilityBar::clear()
 {
   image = QImage();
+  pieces.clear();
   update();
 }
 
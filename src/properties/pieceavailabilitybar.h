@@ -61,8 +61,11 @@ private:
   // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
   std::vector<int> pieces;
 
+  // scaled vector reused between frames
+  std::vector<float> scaled_pieces;
+
   // scale int vector to float vector
-  std::vector<float> intToFloatVector(const std::vector<int> &vecin, int reqSize);
+  void intToFloatVector(const std::vector<int> &vecin, int reqSize, std::vector<float> &result);
 
   // mix two colors by light model, ratio <0, 1>
   int mixTwoColors(int &rgb1, int &rgb2, float ratio);
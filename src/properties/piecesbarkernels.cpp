@@ -0,0 +1,188 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "piecesbarkernels.h"
+
+#include <QtGlobal>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PIECESBAR_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PIECESBAR_SSE2
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace {
+
+  // Every integer below 2^24 is representable as float
+  const double EXACT_INT_LIMIT = 16777216.0;
+  // Number of ints summed at once by accumulateInts()
+  const int INT_BLOCK = 16;
+
+  // Adding a non negative integer n to 'value' is exact as long as
+  // value + n stays below the returned bound: integers are on the float
+  // grid up to 2^24 and a fractional value keeps its precision until
+  // it reaches the next power of two.
+  inline double exactBound(float value)
+  {
+    if (value == std::floor(value))
+      return EXACT_INT_LIMIT;
+    int exp;
+    std::frexp(value, &exp);
+    return std::ldexp(1.0, exp);
+  }
+
+  inline bool testBit(const char *bytes, int index)
+  {
+    return (bytes[index / 8] & (0x80 >> (index & 7))) != 0;
+  }
+
+  inline int popcount64(quint64 v)
+  {
+#if defined(__GNUC__)
+    return __builtin_popcountll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(v));
+#else
+    v = v - ((v >> 1) & Q_UINT64_C(0x5555555555555555));
+    v = (v & Q_UINT64_C(0x3333333333333333)) + ((v >> 2) & Q_UINT64_C(0x3333333333333333));
+    v = (v + (v >> 4)) & Q_UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return static_cast<int>((v * Q_UINT64_C(0x0101010101010101)) >> 56);
+#endif
+  }
+
+#if defined(PIECESBAR_AVX2) || defined(PIECESBAR_SSE2)
+  inline int horizontalSum(__m128i s)
+  {
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+  }
+#endif
+
+  // Sum of INT_BLOCK consecutive ints
+  inline int blockSum(const int *v)
+  {
+#if defined(PIECESBAR_AVX2)
+    const __m256i s = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + 8)));
+    return horizontalSum(_mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+#elif defined(PIECESBAR_SSE2)
+    const __m128i *p = reinterpret_cast<const __m128i*>(v);
+    const __m128i s = _mm_add_epi32(_mm_add_epi32(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                    _mm_add_epi32(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+    return horizontalSum(s);
+#else
+    int s = 0;
+    for (int i = 0; i < INT_BLOCK; ++i)
+      s += v[i];
+    return s;
+#endif
+  }
+
+  inline float addBitsSlow(float value, const char *bytes, int from, int to)
+  {
+    for (int i = from; i < to; ++i) {
+      if (testBit(bytes, i))
+        value += 1.0;
+    }
+    return value;
+  }
+
+  inline float addIntsSlow(float value, const int *values, int count)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (values[i])
+        value += values[i];
+    }
+    return value;
+  }
+
+}
+
+namespace piecesbar {
+
+  float accumulateBits(float value, const char *bytes, int from, int to)
+  {
+    // Leading bits up to the first 64 bits boundary
+    const int head = qMin(to, (from + 63) & ~63);
+    value = addBitsSlow(value, bytes, from, head);
+
+    int i = head;
+    for (; i + 64 <= to; i += 64) {
+      quint64 word;
+      memcpy(&word, bytes + i / 8, sizeof(word));
+      const int count = popcount64(word);
+      if (!count)
+        continue;
+      if (static_cast<double>(value) + count < exactBound(value))
+        value += count;
+      else
+        value = addBitsSlow(value, bytes, i, i + 64);
+    }
+
+    return addBitsSlow(value, bytes, i, to);
+  }
+
+  float accumulateInts(float value, const int *values, int count)
+  {
+    int i = 0;
+    for (; i + INT_BLOCK <= count; i += INT_BLOCK) {
+      const int sum = blockSum(values + i);
+      if (!sum)
+        continue;
+      if (static_cast<double>(value) + sum < exactBound(value))
+        value += sum;
+      else
+        value = addIntsSlow(value, values + i, INT_BLOCK);
+    }
+
+    return addIntsSlow(value, values + i, count - i);
+  }
+
+  const char* kernelName()
+  {
+#if defined(PIECESBAR_AVX2)
+    return "AVX2";
+#elif defined(PIECESBAR_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+  }
+
+}
@@ -0,0 +1,52 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef PIECESBARKERNELS_H
+#define PIECESBARKERNELS_H
+
+// Range accumulation kernels shared by the pieces bars.
+// Both functions return exactly what adding the elements one by one to
+// 'value' (in float precision) would return, they only skip the per
+// element work whenever the block sum can be added without rounding.
+namespace piecesbar {
+
+  // Adds 1.0 to 'value' for every bit set in [from, to) of the
+  // libtorrent bitfield storage 'bytes' (most significant bit first)
+  float accumulateBits(float value, const char *bytes, int from, int to);
+
+  // Adds values[0] ... values[count - 1] (non negative) to 'value'
+  float accumulateInts(float value, const int *values, int count);
+
+  // Name of the code path compiled in, for the benchmarks
+  const char* kernelName();
+
+}
+
+#endif // PIECESBARKERNELS_H
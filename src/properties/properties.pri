@@ -6,6 +6,7 @@ FORMS += $$PWD/propertieswidget.ui \
 
 HEADERS += $$PWD/propertieswidget.h \
            $$PWD/peerlistwidget.h \
+           $$PWD/peerlistmodel.h \
            $$PWD/proplistdelegate.h \
            $$PWD/trackerlist.h \
            $$PWD/downloadedpiecesbar.h \
@@ -14,11 +15,14 @@ HEADERS += $$PWD/propertieswidget.h \
            $$PWD/peeraddition.h \
            $$PWD/trackersadditiondlg.h \
            $$PWD/pieceavailabilitybar.h \
+           $$PWD/piecesbarkernels.h \
            $$PWD/proptabbar.h
 
 SOURCES += $$PWD/propertieswidget.cpp \
            $$PWD/peerlistwidget.cpp \
+           $$PWD/peerlistmodel.cpp \
            $$PWD/trackerlist.cpp \
            $$PWD/proptabbar.cpp \
            $$PWD/downloadedpiecesbar.cpp \
-           $$PWD/pieceavailabilitybar.cpp
+           $$PWD/pieceavailabilitybar.cpp \
+           $$PWD/piecesbarkernels.cpp
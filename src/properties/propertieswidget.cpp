@@ -58,6 +58,7 @@
 #include "lineedit.h"
 #include "fs_utils.h"
 #include "autoexpandabledialog.h"
+#include "tracer.h"
 
 using namespace libtorrent;
 
@@ -313,6 +314,7 @@ void PropertiesWidget::reloadPreferences() {
 }
 
 void PropertiesWidget::loadDynamicData() {
+  QBT_TRACE_SCOPE("PropertiesWidget::loadDynamicData");
   // Refresh only if the torrent handle is valid and if visible
   if (!h.is_valid() || main_window->getCurrentTabWidget() != transferList || state != VISIBLE) return;
   try {
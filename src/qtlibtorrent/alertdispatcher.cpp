@@ -80,6 +80,11 @@ void QAlertDispatcher::getPendingAlerts(std::deque<libtorrent::alert*>& out, uns
   event_posted = false;
 }
 
+int QAlertDispatcher::pendingAlertCount() {
+  QMutexLocker lock(&alerts_mutex);
+  return alerts.size();
+}
+
 void QAlertDispatcher::dispatch(QSharedPointer<QAtomicPointer<QAlertDispatcher> > tag,
                                 std::auto_ptr<libtorrent::alert> alert_ptr) {
   QAlertDispatcher* that = *tag;
@@ -48,6 +48,7 @@ public:
 
   void getPendingAlertsNoWait(std::deque<libtorrent::alert*>&);
   void getPendingAlerts(std::deque<libtorrent::alert*>&, unsigned long time = ULONG_MAX);
+  int pendingAlertCount();
 
 signals:
   void alertsReceived();
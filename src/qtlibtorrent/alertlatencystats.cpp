@@ -0,0 +1,94 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "alertlatencystats.h"
+
+#include <QMutexLocker>
+
+AlertLatencyStats::AlertLatencyStats()
+{
+}
+
+const QVector<qint64>& AlertLatencyStats::bucketBounds()
+{
+  static QVector<qint64> bounds;
+  static QMutex boundsMutex;
+  QMutexLocker locker(&boundsMutex);
+  if (bounds.isEmpty()) {
+    bounds << 50 << 100 << 250 << 500
+           << 1000 << 2500 << 5000 << 10000
+           << 25000 << 50000 << 100000 << 250000
+           << 500000 << 1000000;
+  }
+  return bounds;
+}
+
+QString AlertLatencyStats::stageName(Stage stage)
+{
+  return stage == WorkerStage ? QString::fromLatin1("worker") : QString::fromLatin1("dispatch");
+}
+
+void AlertLatencyStats::record(const char *alert, Stage stage, qint64 usecs)
+{
+  if (usecs < 0)
+    usecs = 0;
+  const QVector<qint64>& bounds = bucketBounds();
+  int bucket = 0;
+  while (bucket < bounds.size() && usecs > bounds[bucket])
+    ++bucket;
+
+  const QString name = QString::fromLatin1(alert);
+  const QString key = name + QLatin1Char('/') + stageName(stage);
+
+  QMutexLocker locker(&m_mutex);
+  Histogram &h = m_histograms[key];
+  if (h.buckets.isEmpty()) {
+    h.alert = name;
+    h.stage = stage;
+    h.buckets.fill(0, bounds.size() + 1);
+  }
+  ++h.count;
+  h.sumUsecs += usecs;
+  if ((quint64)usecs > h.maxUsecs)
+    h.maxUsecs = usecs;
+  ++h.buckets[bucket];
+}
+
+QList<AlertLatencyStats::Histogram> AlertLatencyStats::histograms() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_histograms.values();
+}
+
+void AlertLatencyStats::reset()
+{
+  QMutexLocker locker(&m_mutex);
+  m_histograms.clear();
+}
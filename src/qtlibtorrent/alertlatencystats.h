@@ -0,0 +1,78 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef ALERTLATENCYSTATS_H
+#define ALERTLATENCYSTATS_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// Per alert type handling latency histograms.
+// Samples are recorded from the main thread (dispatch stage) and from
+// the alert worker threads (worker stage), so every access is locked.
+class AlertLatencyStats {
+  Q_DISABLE_COPY(AlertLatencyStats)
+
+public:
+  enum Stage {
+    DispatchStage,
+    WorkerStage
+  };
+
+  struct Histogram {
+    Histogram(): stage(DispatchStage), count(0), sumUsecs(0), maxUsecs(0) {}
+    QString alert;
+    Stage stage;
+    quint64 count;
+    quint64 sumUsecs;
+    quint64 maxUsecs;
+    // One counter per bucketBounds() entry, plus the overflow bucket
+    QVector<quint64> buckets;
+  };
+
+  AlertLatencyStats();
+
+  void record(const char *alert, Stage stage, qint64 usecs);
+  QList<Histogram> histograms() const;
+  void reset();
+
+  // Upper bounds (inclusive, in microseconds) of the histogram buckets
+  static const QVector<qint64>& bucketBounds();
+  static QString stageName(Stage stage);
+
+private:
+  mutable QMutex m_mutex;
+  QHash<QString, Histogram> m_histograms;
+};
+
+#endif // ALERTLATENCYSTATS_H
@@ -0,0 +1,189 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "alertworkerpool.h"
+#include "alertlatencystats.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+struct AlertJob {
+  QString hash;
+  const char *alert;
+  AlertWorkerPool::Job job;
+};
+
+class AlertWorkerThread : public QThread {
+public:
+  explicit AlertWorkerThread(AlertLatencyStats *stats)
+    : m_stats(stats), m_running(true), m_busy(false)
+  {
+    start(QThread::LowPriority);
+  }
+
+  ~AlertWorkerThread()
+  {
+    m_mutex.lock();
+    m_running = false;
+    m_jobAvailable.wakeOne();
+    m_mutex.unlock();
+    wait();
+  }
+
+  void enqueue(const AlertJob &job)
+  {
+    QMutexLocker locker(&m_mutex);
+    m_queue.enqueue(job);
+    if (m_queue.count() == 1)
+      m_jobAvailable.wakeOne();
+  }
+
+  void cancel(const QString &hash)
+  {
+    QMutexLocker locker(&m_mutex);
+    QQueue<AlertJob>::iterator it = m_queue.begin();
+    while (it != m_queue.end()) {
+      if (it->hash == hash)
+        it = m_queue.erase(it);
+      else
+        ++it;
+    }
+    while (m_busy && m_currentHash == hash)
+      m_jobDone.wait(&m_mutex);
+  }
+
+  void waitForDone()
+  {
+    QMutexLocker locker(&m_mutex);
+    while (m_busy || !m_queue.isEmpty())
+      m_jobDone.wait(&m_mutex);
+  }
+
+  int pendingJobs() const
+  {
+    QMutexLocker locker(&m_mutex);
+    return m_queue.count() + (m_busy ? 1 : 0);
+  }
+
+protected:
+  void run()
+  {
+    m_mutex.lock();
+    // Keep draining the queue on shutdown so that no resume data is lost
+    while (m_running || !m_queue.isEmpty()) {
+      if (m_queue.isEmpty()) {
+        m_jobAvailable.wait(&m_mutex);
+        continue;
+      }
+      const AlertJob job = m_queue.dequeue();
+      m_busy = true;
+      m_currentHash = job.hash;
+      m_mutex.unlock();
+
+      QElapsedTimer timer;
+      timer.start();
+      try {
+        job.job();
+      } catch (const std::exception &e) {
+        qWarning() << "Caught exception in alert worker:" << e.what();
+      }
+      if (m_stats)
+        m_stats->record(job.alert, AlertLatencyStats::WorkerStage, timer.nsecsElapsed() / 1000);
+
+      m_mutex.lock();
+      m_busy = false;
+      m_currentHash.clear();
+      m_jobDone.wakeAll();
+    }
+    m_mutex.unlock();
+  }
+
+private:
+  AlertLatencyStats *m_stats;
+  mutable QMutex m_mutex;
+  QWaitCondition m_jobAvailable;
+  QWaitCondition m_jobDone;
+  QQueue<AlertJob> m_queue;
+  QString m_currentHash;
+  bool m_running;
+  bool m_busy;
+};
+
+AlertWorkerPool::AlertWorkerPool(AlertLatencyStats *stats, int workerCount)
+{
+  if (workerCount <= 0)
+    workerCount = qBound(2, QThread::idealThreadCount(), 4);
+  for (int i = 0; i < workerCount; ++i)
+    m_workers << new AlertWorkerThread(stats);
+}
+
+AlertWorkerPool::~AlertWorkerPool()
+{
+  qDeleteAll(m_workers);
+}
+
+AlertWorkerThread* AlertWorkerPool::workerFor(const QString &hash) const
+{
+  return m_workers.at(qHash(hash) % m_workers.size());
+}
+
+void AlertWorkerPool::enqueue(const QString &hash, const char *alert, const Job &job)
+{
+  AlertJob j;
+  j.hash = hash;
+  j.alert = alert;
+  j.job = job;
+  workerFor(hash)->enqueue(j);
+}
+
+void AlertWorkerPool::cancel(const QString &hash)
+{
+  workerFor(hash)->cancel(hash);
+}
+
+void AlertWorkerPool::waitForDone()
+{
+  foreach (AlertWorkerThread *worker, m_workers)
+    worker->waitForDone();
+}
+
+int AlertWorkerPool::pendingJobs() const
+{
+  int count = 0;
+  foreach (const AlertWorkerThread *worker, m_workers)
+    count += worker->pendingJobs();
+  return count;
+}
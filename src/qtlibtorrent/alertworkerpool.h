@@ -0,0 +1,70 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef ALERTWORKERPOOL_H
+#define ALERTWORKERPOOL_H
+
+#include <QList>
+#include <QString>
+#include <boost/function.hpp>
+
+class AlertLatencyStats;
+class AlertWorkerThread;
+
+// Runs the disk and CPU bound parts of the alert handlers away from
+// the main thread. Jobs belonging to the same torrent always land on
+// the same worker so they are executed in the order they were queued.
+// Results that need to reach the GUI must be posted back by the job
+// itself (e.g. with a queued QMetaObject::invokeMethod()).
+class AlertWorkerPool {
+  Q_DISABLE_COPY(AlertWorkerPool)
+
+public:
+  typedef boost::function<void ()> Job;
+
+  explicit AlertWorkerPool(AlertLatencyStats *stats, int workerCount = 0);
+  // Drains every pending job before returning
+  ~AlertWorkerPool();
+
+  void enqueue(const QString &hash, const char *alert, const Job &job);
+  // Drops the queued jobs of the torrent and waits for the running one
+  void cancel(const QString &hash);
+  // Blocks until every queued job has been executed
+  void waitForDone();
+  int pendingJobs() const;
+
+private:
+  AlertWorkerThread* workerFor(const QString &hash) const;
+
+private:
+  QList<AlertWorkerThread*> m_workers;
+};
+
+#endif // ALERTWORKERPOOL_H
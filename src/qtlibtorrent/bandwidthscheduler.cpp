@@ -0,0 +1,224 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "bandwidthscheduler.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+
+#include "preferences.h"
+
+namespace {
+  const int DAY_SECS = 24 * 60 * 60;
+  const int WEEK_SECS = 7 * DAY_SECS;
+  // The timer is armed for the next transition, but wakes up at least
+  // this often to notice the clock changes
+  const int MAX_WAIT_MSECS = 60 * 60 * 1000;
+  const QString TIME_FORMAT = QString::fromUtf8("hh:mm");
+
+  int daysFromSchedulerDays(scheduler_days days) {
+    switch(days) {
+    case EVERY_DAY:
+      return 0x7f;
+    case WEEK_DAYS:
+      return 0x1f;
+    case WEEK_ENDS:
+      return 0x60;
+    default:
+      return 1 << (days - MON);
+    }
+  }
+}
+
+BandwidthRule BandwidthRule::fromVariant(const QVariantMap &map)
+{
+  BandwidthRule rule;
+  rule.days = map.value("days", rule.days).toInt() & 0x7f;
+  rule.start = QTime::fromString(map.value("start").toString(), TIME_FORMAT);
+  rule.end = QTime::fromString(map.value("end").toString(), TIME_FORMAT);
+  rule.alternative = map.value("alternative", rule.alternative).toBool();
+  rule.downloadLimit = LabelLimits::boundRate(map.value("dl_limit", rule.downloadLimit).toInt());
+  rule.uploadLimit = LabelLimits::boundRate(map.value("up_limit", rule.uploadLimit).toInt());
+  rule.maxConnections = map.value("max_connec", rule.maxConnections).toInt();
+  const QVariantMap labels = map.value("labels").toMap();
+  for (QVariantMap::const_iterator it = labels.begin(); it != labels.end(); ++it) {
+    const QVariantMap limits = it.value().toMap();
+    LabelLimits &labelLimits = rule.labelLimits[it.key()];
+    labelLimits.downloadLimit = LabelLimits::boundRate(limits.value("dl_limit").toInt());
+    labelLimits.uploadLimit = LabelLimits::boundRate(limits.value("up_limit").toInt());
+  }
+  return rule;
+}
+
+QVariantMap BandwidthRule::toVariant() const
+{
+  QVariantMap map;
+  map["days"] = days;
+  map["start"] = start.toString(TIME_FORMAT);
+  map["end"] = end.toString(TIME_FORMAT);
+  map["alternative"] = alternative;
+  map["dl_limit"] = downloadLimit;
+  map["up_limit"] = uploadLimit;
+  map["max_connec"] = maxConnections;
+  QVariantMap labels;
+  QHash<QString, LabelLimits>::const_iterator it = labelLimits.begin();
+  QHash<QString, LabelLimits>::const_iterator itend = labelLimits.end();
+  for ( ; it != itend; ++it) {
+    QVariantMap limits;
+    limits["dl_limit"] = it.value().downloadLimit;
+    limits["up_limit"] = it.value().uploadLimit;
+    labels[it.key()] = limits;
+  }
+  map["labels"] = labels;
+  return map;
+}
+
+BandwidthScheduler::BandwidthScheduler(QObject *parent)
+  : QTimer(parent)
+  , m_active(-1)
+{
+  Q_ASSERT(Preferences().isSchedulerEnabled());
+  // Signal shot, we arm the timer for each transition
+  setSingleShot(true);
+  // Connect Signals/Slots
+  connect(this, SIGNAL(timeout()), this, SLOT(evaluate()));
+}
+
+const BandwidthRule* BandwidthScheduler::activeRule() const
+{
+  if (m_active < 0 || m_active >= m_rules.size())
+    return 0;
+  return &m_rules.at(m_active);
+}
+
+QList<BandwidthRule> BandwidthScheduler::loadRules(const Preferences &pref)
+{
+  QList<BandwidthRule> rules;
+  const QVariantList stored = pref.getSchedulerRules();
+  foreach (const QVariant &rule, stored) {
+    const BandwidthRule r = BandwidthRule::fromVariant(rule.toMap());
+    if (r.days && r.start.isValid() && r.end.isValid())
+      rules << r;
+  }
+  if (rules.isEmpty() && stored.isEmpty()) {
+    BandwidthRule rule;
+    rule.days = daysFromSchedulerDays(pref.getSchedulerDays());
+    rule.start = pref.getSchedulerStartTime();
+    rule.end = pref.getSchedulerEndTime();
+    // The single window never applied when it was empty
+    if (rule.start != rule.end)
+      rules << rule;
+  }
+  return rules;
+}
+
+void BandwidthScheduler::start()
+{
+  const Preferences pref;
+  Q_ASSERT(pref.isSchedulerEnabled());
+  m_rules = loadRules(pref);
+  buildTransitions();
+  // Not a rule index, nor -1, so that evaluate() notifies
+  m_active = -2;
+  evaluate();
+}
+
+void BandwidthScheduler::buildTransitions()
+{
+  QList<int> points;
+  points << 0;
+  foreach (const BandwidthRule &rule, m_rules) {
+    const int start = QTime(0, 0).secsTo(rule.start);
+    const int end = QTime(0, 0).secsTo(rule.end);
+    for (int day = 0; day < 7; ++day) {
+      if (!(rule.days & (1 << day)))
+        continue;
+      points << day * DAY_SECS + start;
+      points << (day * DAY_SECS + end + (end <= start ? DAY_SECS : 0)) % WEEK_SECS;
+    }
+  }
+  std::sort(points.begin(), points.end());
+
+  m_transitions.clear();
+  int previous = -1;
+  foreach (int point, points) {
+    if (previous == point)
+      continue;
+    previous = point;
+    const int rule = ruleAt(point);
+    if (m_transitions.isEmpty() || m_transitions.last().second != rule)
+      m_transitions << qMakePair(point, rule);
+  }
+  qDebug() << Q_FUNC_INFO << m_rules.size() << "rules," << m_transitions.size() << "transitions";
+}
+
+int BandwidthScheduler::ruleAt(int secs) const
+{
+  for (int i = m_rules.size() - 1; i >= 0; --i) {
+    const BandwidthRule &rule = m_rules.at(i);
+    const int start = QTime(0, 0).secsTo(rule.start);
+    int end = QTime(0, 0).secsTo(rule.end);
+    if (end <= start)
+      end += DAY_SECS;
+    for (int day = 0; day < 7; ++day) {
+      if (!(rule.days & (1 << day)))
+        continue;
+      const int from = day * DAY_SECS + start;
+      const int to = day * DAY_SECS + end;
+      // Sunday night rules wrap to Monday morning
+      if ((secs >= from && secs < to) || secs + WEEK_SECS < to)
+        return i;
+    }
+  }
+  return -1;
+}
+
+void BandwidthScheduler::evaluate()
+{
+  const QDateTime now = QDateTime::currentDateTime();
+  const int secs = (now.date().dayOfWeek() - 1) * DAY_SECS + QTime(0, 0).secsTo(now.time());
+  // The table always starts at 0
+  int i = 0;
+  while (i + 1 < m_transitions.size() && m_transitions.at(i + 1).first <= secs)
+    ++i;
+  const int next = (i + 1 < m_transitions.size()) ? m_transitions.at(i + 1).first : WEEK_SECS;
+  const int active = m_transitions.isEmpty() ? -1 : m_transitions.at(i).second;
+
+  if (active != m_active) {
+    m_active = active;
+    emit ruleChanged();
+  }
+
+  const qint64 wait = qint64(next - secs) * 1000 - now.time().msec() + 10;
+  QTimer::start(qBound<qint64>(10, wait, MAX_WAIT_MSECS));
+}
@@ -1,79 +1,75 @@
 #ifndef BANDWIDTHSCHEDULER_H
 #define BANDWIDTHSCHEDULER_H
 
-#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QPair>
 #include <QTime>
-#include <QDateTime>
-#include "preferences.h"
-#include <iostream>
+#include <QTimer>
+#include <QVariant>
+#include <QVector>
+
+#include "labelbandwidth.h"
+
+class Preferences;
 
+// A weekly bandwidth rule, in local time. A rule whose end isn't after
+// its start runs past midnight into the next day.
+struct BandwidthRule {
+  BandwidthRule(): days(0x7f), alternative(true), downloadLimit(0), uploadLimit(0), maxConnections(-1) {}
+
+  // Bit 0 is Monday, bit 6 is Sunday
+  int days;
+  QTime start;
+  QTime end;
+  // Switch to the alternative speed limits instead of the limits below
+  bool alternative;
+  // KiB/s, 0 is unlimited
+  int downloadLimit;
+  int uploadLimit;
+  // -1 keeps the configured limit
+  int maxConnections;
+  QHash<QString, LabelLimits> labelLimits;
+
+  static BandwidthRule fromVariant(const QVariantMap &map);
+  QVariantMap toVariant() const;
+};
 
+// Applies the weekly bandwidth rules. The rule in effect for each second
+// of the week is precomputed as a transition table, and the timer is only
+// armed for the next transition. When several rules overlap, the last
+// one wins.
 class BandwidthScheduler: public QTimer {
   Q_OBJECT
 
 public:
-  BandwidthScheduler(QObject *parent): QTimer(parent) {
-    Q_ASSERT(Preferences().isSchedulerEnabled());
-    // Signal shot, we call start() again manually
-    setSingleShot(true);
-    // Connect Signals/Slots
-    connect(this, SIGNAL(timeout()), this, SLOT(start()));
-  }
+  BandwidthScheduler(QObject *parent);
 
-public slots:
-  void start() {
-    const Preferences pref;
-    Q_ASSERT(pref.isSchedulerEnabled());
-    bool alt_bw_enabled = pref.isAltBandwidthEnabled();
-
-    QTime start = pref.getSchedulerStartTime();
-    QTime end = pref.getSchedulerEndTime();
-    QTime now = QTime::currentTime();
-    int sched_days = pref.getSchedulerDays();
-    int day = QDateTime::currentDateTime().toLocalTime().date().dayOfWeek();
-    bool new_mode = false;
-    bool reverse = false;
-
-    if (start > end) {
-      QTime temp = start;
-      start = end;
-      end = temp;
-      reverse = true;
-    }
+  // The rule in effect, 0 if there is none
+  const BandwidthRule* activeRule() const;
+  // The configured rules, or the single alternative speed window of the
+  // older settings when there are none
+  static QList<BandwidthRule> loadRules(const Preferences &pref);
 
-    if (start <= now && end >= now) {
-      switch(sched_days) {
-      case EVERY_DAY:
-        new_mode = true;
-        break;
-      case WEEK_ENDS:
-        if (day == 6 || day == 7)
-          new_mode = true;
-        break;
-      case WEEK_DAYS:
-        if (day != 6 && day != 7)
-          new_mode = true;
-        break;
-      default:
-        if (day == sched_days - 2)
-          new_mode = true;
-        break;
-      }
-    }
+public slots:
+  // Reloads the rules, then emits ruleChanged()
+  void start();
 
-    if (reverse)
-      new_mode = !new_mode;
+signals:
+  void ruleChanged();
 
-    if (new_mode != alt_bw_enabled)
-      emit switchToAlternativeMode(new_mode);
+private slots:
+  void evaluate();
 
-    // Timeout regularly to accomodate for external system clock changes
-    // eg from the user or from a timesync utility
-    QTimer::start(1500);
-  }
+private:
+  void buildTransitions();
+  int ruleAt(int secs) const;
 
-signals:
-  void switchToAlternativeMode(bool alternative);
+private:
+  QList<BandwidthRule> m_rules;
+  // Second of the week (from Monday 00:00) -> rule index, -1 for none
+  QVector<QPair<int, int> > m_transitions;
+  int m_active;
 };
 
 #endif // BANDWIDTHSCHEDULER_H
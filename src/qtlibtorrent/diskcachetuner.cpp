@@ -0,0 +1,164 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "diskcachetuner.h"
+
+#include <QFile>
+
+#include <libtorrent/session.hpp>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#include "qbtsession.h"
+#include "sessionsnapshot.h"
+
+using namespace libtorrent;
+
+namespace {
+  const int EVALUATION_INTERVAL = 30000; // 30 seconds
+  const int MIN_SIZE = 16;
+  const int INITIAL_SIZE = 64;
+  // Memory that must stay available to the rest of the system
+  const qint64 LOW_MEMORY = 256;
+  // Don't judge the hit rate on fewer block reads than this (16 MiB)
+  const quint64 MIN_BLOCK_READS = 1024;
+  const double GROW_BELOW_HIT_RATE = 0.5;
+  // Limit used when the available memory can't be read
+  const int FALLBACK_MAX_SIZE = 256;
+  // libtorrent counts the cache in 16 KiB blocks
+  const int BLOCKS_PER_MIB = 64;
+}
+
+DiskCacheTuner::DiskCacheTuner(QBtSession *session, QObject *parent)
+  : QObject(parent)
+  , m_session(session)
+  , m_size(INITIAL_SIZE)
+  , m_maxSize(0)
+  , m_lastBlocksRead(0)
+  , m_lastBlocksReadHit(0)
+{
+  const cache_status &cache = m_session->sessionSnapshot()->cache;
+  m_lastBlocksRead = cache.blocks_read;
+  m_lastBlocksReadHit = cache.blocks_read_hit;
+  connect(&m_timer, SIGNAL(timeout()), SLOT(evaluate()));
+  m_timer.start(EVALUATION_INTERVAL);
+}
+
+void DiskCacheTuner::setMaxSize(int mib)
+{
+  m_maxSize = qMax(0, mib);
+  m_size = qBound(MIN_SIZE, m_size, ceiling());
+}
+
+qint64 DiskCacheTuner::availableMemory()
+{
+#if defined(Q_OS_WIN)
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if (!GlobalMemoryStatusEx(&status))
+    return -1;
+  return status.ullAvailPhys / (1024 * 1024);
+#elif defined(Q_OS_LINUX)
+  QFile meminfo(QString::fromUtf8("/proc/meminfo"));
+  if (!meminfo.open(QIODevice::ReadOnly | QIODevice::Text))
+    return -1;
+  while (!meminfo.atEnd()) {
+    const QByteArray line = meminfo.readLine();
+    // MemAvailable:    1234567 kB
+    if (line.startsWith("MemAvailable:")) {
+      bool ok;
+      const qint64 kib = line.mid(13).trimmed().split(' ').first().toLongLong(&ok);
+      return ok ? kib / 1024 : -1;
+    }
+  }
+  return -1;
+#else
+  return -1;
+#endif
+}
+
+int DiskCacheTuner::ceiling() const
+{
+  if (m_maxSize > 0)
+    return qMax(MIN_SIZE, m_maxSize);
+  const qint64 available = availableMemory();
+  if (available < 0)
+    return FALLBACK_MAX_SIZE;
+  // The memory already held by the cache counts as available
+  return qMax<qint64>(MIN_SIZE, (available + m_size) / 4);
+}
+
+void DiskCacheTuner::evaluate()
+{
+  const SessionSnapshotPtr snapshot = m_session->sessionSnapshot();
+  const cache_status &cache = snapshot->cache;
+  const quint64 reads = cache.blocks_read - m_lastBlocksRead;
+  const quint64 hits = cache.blocks_read_hit - m_lastBlocksReadHit;
+  m_lastBlocksRead = cache.blocks_read;
+  m_lastBlocksReadHit = cache.blocks_read_hit;
+  const double hitRate = reads ? (double) hits / reads : 1.;
+  const int used = cache.cache_size / BLOCKS_PER_MIB;
+  const qint64 available = availableMemory();
+
+  if (available >= 0 && available < LOW_MEMORY) {
+    if (m_size > MIN_SIZE)
+      resize(qMax(MIN_SIZE, m_size * 3 / 4), tr("low memory, %1 MiB available").arg(available));
+    return;
+  }
+
+  const int limit = ceiling();
+  if (m_size > limit) {
+    resize(limit, tr("above the limit of %1 MiB").arg(limit));
+    return;
+  }
+
+  if (reads >= MIN_BLOCK_READS && hitRate < GROW_BELOW_HIT_RATE && used * 10 >= m_size * 9) {
+    if (m_size < limit)
+      resize(qMin(limit, m_size * 5 / 4), tr("read hit rate of %1%").arg(qRound(hitRate * 100)));
+    return;
+  }
+
+  if (used * 2 < m_size && m_size > MIN_SIZE)
+    resize(qMax(MIN_SIZE, m_size * 3 / 4), tr("%1 MiB in use").arg(used));
+}
+
+void DiskCacheTuner::resize(int mib, const QString &reason)
+{
+  if (mib == m_size)
+    return;
+  session *s = m_session->getSession();
+  session_settings settings = s->settings();
+  settings.cache_size = mib * BLOCKS_PER_MIB;
+  s->set_settings(settings);
+  m_session->addConsoleMessage(tr("Disk cache resized from %1 MiB to %2 MiB (%3)").arg(m_size).arg(mib).arg(reason));
+  m_size = mib;
+}
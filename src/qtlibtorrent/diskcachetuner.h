@@ -0,0 +1,74 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef DISKCACHETUNER_H
+#define DISKCACHETUNER_H
+
+#include <QObject>
+#include <QTimer>
+
+class QBtSession;
+
+// Resizes the disk cache of the session when the adaptive cache is
+// enabled. The cache grows while it is full and the read hit rate is
+// low, and shrinks when it stays mostly unused or when the system runs
+// short of memory. Sizes are in MiB.
+class DiskCacheTuner : public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(DiskCacheTuner)
+
+public:
+  DiskCacheTuner(QBtSession *session, QObject *parent = 0);
+
+  inline int size() const { return m_size; }
+  // 0 lets the cache use up to a quarter of the available memory
+  void setMaxSize(int mib);
+
+  // Available physical memory in MiB, -1 when unknown
+  static qint64 availableMemory();
+
+private slots:
+  void evaluate();
+
+private:
+  int ceiling() const;
+  void resize(int mib, const QString &reason);
+
+private:
+  QBtSession *m_session;
+  QTimer m_timer;
+  int m_size;
+  int m_maxSize;
+  quint64 m_lastBlocksRead;
+  quint64 m_lastBlocksReadHit;
+};
+
+#endif // DISKCACHETUNER_H
@@ -0,0 +1,425 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "labelbandwidth.h"
+
+#include <QDebug>
+#include <QPair>
+#include <QStringList>
+#include <QtAlgorithms>
+
+#include <limits>
+
+#include <libtorrent/session.hpp>
+
+#include "qbtsession.h"
+#include "misc.h"
+#include "preferences.h"
+#include "torrentpersistentdata.h"
+
+using namespace libtorrent;
+
+namespace {
+  const int REDISTRIBUTE_INTERVAL = 3000;
+  // Smallest share, and the headroom of the torrents below their share
+  const int MIN_SHARE = 2048;
+}
+
+bool LabelLimits::isNull() const
+{
+  return downloadLimit <= 0 && uploadLimit <= 0 && maxConnections < 0 && weight <= 0;
+}
+
+int LabelLimits::boundRate(int rate)
+{
+  return qBound(0, rate, std::numeric_limits<int>::max() / 1024);
+}
+
+LabelLimits LabelLimits::fromVariant(const QVariantMap &map)
+{
+  LabelLimits limits;
+  limits.downloadLimit = boundRate(map.value("dl_limit", limits.downloadLimit).toInt());
+  limits.uploadLimit = boundRate(map.value("up_limit", limits.uploadLimit).toInt());
+  limits.maxConnections = qMax(-1, map.value("max_connec", limits.maxConnections).toInt());
+  limits.weight = qBound(0, map.value("weight", limits.weight).toInt(), 255);
+  return limits;
+}
+
+QVariantMap LabelLimits::toVariant() const
+{
+  QVariantMap map;
+  map["dl_limit"] = downloadLimit;
+  map["up_limit"] = uploadLimit;
+  map["max_connec"] = maxConnections;
+  map["weight"] = weight;
+  return map;
+}
+
+LabelBandwidth::SavedLimits LabelBandwidth::SavedLimits::fromVariant(const QVariant &value)
+{
+  const QVariantList list = value.toList();
+  SavedLimits limits;
+  // The bandwidth scheduler saves only the rate limits
+  if (list.size() >= 2) {
+    limits.downloadLimit = list.at(0).toInt();
+    limits.uploadLimit = list.at(1).toInt();
+  }
+  if (list.size() >= 3)
+    limits.maxConnections = list.at(2).toInt();
+  return limits;
+}
+
+QVariant LabelBandwidth::SavedLimits::toVariant() const
+{
+  QVariantList list;
+  list << downloadLimit << uploadLimit << maxConnections;
+  return list;
+}
+
+LabelBandwidth::LabelBandwidth(QBtSession *session, QObject *parent)
+  : QObject(parent)
+  , m_session(session)
+  , m_restorePending(true)
+{
+  loadClasses();
+  m_applyTimer.setSingleShot(true);
+  m_applyTimer.setInterval(1000);
+  connect(&m_applyTimer, SIGNAL(timeout()), SLOT(apply()));
+  connect(&m_redistributeTimer, SIGNAL(timeout()), SLOT(redistribute()));
+  connect(m_session, SIGNAL(addedTorrent(QTorrentHandle)), SLOT(scheduleApply()));
+  connect(m_session, SIGNAL(deletedTorrent(QString)), SLOT(scheduleApply()));
+  connect(m_session, SIGNAL(stateUpdate(std::vector<libtorrent::torrent_status>)), SLOT(handleStateUpdate(std::vector<libtorrent::torrent_status>)));
+}
+
+LabelLimits LabelBandwidth::labelClass(const QString &label) const
+{
+  return m_classes.value(label);
+}
+
+void LabelBandwidth::setLabelClass(const QString &label, const LabelLimits &limits)
+{
+  if (label.isEmpty())
+    return;
+  if (limits.isNull()) {
+    if (!m_classes.remove(label))
+      return;
+  } else {
+    m_classes.insert(label, limits);
+  }
+  saveClasses();
+  apply();
+}
+
+void LabelBandwidth::setScheduledLimits(const QHash<QString, LabelLimits> &limits)
+{
+  if (limits.isEmpty() && m_scheduled.isEmpty())
+    return;
+  m_scheduled = limits;
+  apply();
+}
+
+LabelLimits LabelBandwidth::effectiveLimits(const QString &label) const
+{
+  LabelLimits limits = m_classes.value(label);
+  QHash<QString, LabelLimits>::const_iterator scheduled = m_scheduled.find(label);
+  if (scheduled != m_scheduled.end()) {
+    if (scheduled.value().downloadLimit > 0)
+      limits.downloadLimit = scheduled.value().downloadLimit;
+    if (scheduled.value().uploadLimit > 0)
+      limits.uploadLimit = scheduled.value().uploadLimit;
+  }
+  return limits;
+}
+
+QVariantList LabelBandwidth::status() const
+{
+  QStringList labels = m_classes.keys() + m_scheduled.keys();
+  labels.removeDuplicates();
+  labels.sort();
+  QVariantList ret;
+  foreach (const QString &label, labels) {
+    QVariantMap entry = m_classes.value(label).toVariant();
+    const LabelLimits effective = effectiveLimits(label);
+    entry["label"] = label;
+    entry["effective_dl_limit"] = effective.downloadLimit;
+    entry["effective_up_limit"] = effective.uploadLimit;
+    const QHash<QString, Member> members = m_members.value(label);
+    qlonglong downloadRate = 0;
+    qlonglong uploadRate = 0;
+    foreach (const Member &member, members) {
+      downloadRate += member.downloadRate;
+      uploadRate += member.uploadRate;
+    }
+    entry["torrents"] = members.size();
+    // The cap can't go below 2 connections per torrent
+    entry["effective_max_connec"] = effective.maxConnections >= 0 ? qMax(effective.maxConnections, 2 * members.size()) : -1;
+    entry["dl_rate"] = downloadRate;
+    entry["up_rate"] = uploadRate;
+    ret << entry;
+  }
+  return ret;
+}
+
+void LabelBandwidth::scheduleApply()
+{
+  if (m_restorePending || !m_classes.isEmpty() || !m_scheduled.isEmpty() || !m_savedLimits.isEmpty())
+    m_applyTimer.start();
+}
+
+void LabelBandwidth::apply()
+{
+  m_applyTimer.stop();
+  QHash<QString, QHash<QString, Member> > members;
+  QHash<QString, QString> memberLabels;
+  QHash<QString, SavedLimits> saved;
+  // Own limits to save or forget with the torrent data
+  QHash<QString, QVariant> persisted;
+  // Read once, not once per torrent
+  const QHash<QString, QVariant> allData = TorrentPersistentData::getAllData();
+  const std::vector<torrent_handle> torrents = m_session->getSession()->get_torrents();
+  std::vector<torrent_handle>::const_iterator it = torrents.begin();
+  std::vector<torrent_handle>::const_iterator itend = torrents.end();
+  for ( ; it != itend; ++it) {
+    const QTorrentHandle h(*it);
+    if (!h.is_valid())
+      continue;
+    const QString hash = h.hash();
+    const QHash<QString, QVariant> data = allData.value(hash).toHash();
+    const QString label = data.value("label").toString();
+    const QVariant ownLimits = data.value("own_limits");
+    if (!label.isEmpty() && !effectiveLimits(label).isNull()) {
+      Member member;
+      // Keep the rates of the torrents staying in their label
+      if (m_memberLabels.value(hash) == label)
+        member = m_members[label].value(hash);
+      member.handle = *it;
+      member.downloadAssigned = UNASSIGNED;
+      member.uploadAssigned = UNASSIGNED;
+      members[label].insert(hash, member);
+      memberLabels.insert(hash, label);
+      if (m_savedLimits.contains(hash)) {
+        saved.insert(hash, m_savedLimits.value(hash));
+      } else if (ownLimits.isValid()) {
+        // Saved by a previous run, the handle has the class limits
+        saved.insert(hash, SavedLimits::fromVariant(ownLimits));
+      } else {
+        // Only the torrents joining a class are queried
+        SavedLimits own;
+        own.downloadLimit = h.download_limit();
+        own.uploadLimit = h.upload_limit();
+        own.maxConnections = h.max_connections();
+        saved.insert(hash, own);
+        persisted.insert(hash, own.toVariant());
+      }
+    } else if (m_savedLimits.contains(hash)) {
+      // No longer limited by its label
+      restore(*it, m_savedLimits.value(hash));
+      persisted.insert(hash, QVariant());
+    } else if (ownLimits.isValid()) {
+      // Left its class while qBittorrent wasn't running
+      restore(*it, SavedLimits::fromVariant(ownLimits));
+      persisted.insert(hash, QVariant());
+    }
+  }
+  if (!persisted.isEmpty())
+    TorrentPersistentData::saveOwnLimits(persisted);
+  m_restorePending = false;
+  m_members = members;
+  m_memberLabels = memberLabels;
+  m_savedLimits = saved;
+
+  // Connection caps and weights, the rates follow
+  QHash<QString, QHash<QString, Member> >::const_iterator group = m_members.constBegin();
+  QHash<QString, QHash<QString, Member> >::const_iterator groupend = m_members.constEnd();
+  for ( ; group != groupend; ++group) {
+    const LabelLimits limits = effectiveLimits(group.key());
+    const int count = group.value().size();
+    QHash<QString, Member>::const_iterator member = group.value().constBegin();
+    QHash<QString, Member>::const_iterator memberend = group.value().constEnd();
+    for ( ; member != memberend; ++member) {
+      const SavedLimits own = m_savedLimits.value(member.key());
+      // libtorrent keeps at least 2 connections per torrent
+      member.value().handle.set_max_connections(limits.maxConnections >= 0 ? qMax(2, limits.maxConnections / count) : own.maxConnections);
+      member.value().handle.set_priority(limits.weight);
+    }
+  }
+  redistribute();
+
+  if (m_members.isEmpty())
+    m_redistributeTimer.stop();
+  else if (!m_redistributeTimer.isActive())
+    m_redistributeTimer.start(REDISTRIBUTE_INTERVAL);
+  qDebug() << Q_FUNC_INFO << m_members.size() << "limited labels," << m_memberLabels.size() << "torrents";
+}
+
+void LabelBandwidth::handleStateUpdate(const std::vector<libtorrent::torrent_status> &statuses)
+{
+  if (m_memberLabels.isEmpty())
+    return;
+  std::vector<torrent_status>::const_iterator it = statuses.begin();
+  std::vector<torrent_status>::const_iterator end = statuses.end();
+  for ( ; it != end; ++it) {
+    const QString hash = misc::toQString(it->handle.info_hash());
+    QHash<QString, QString>::const_iterator label = m_memberLabels.find(hash);
+    if (label == m_memberLabels.end())
+      continue;
+    QHash<QString, Member> &members = m_members[label.value()];
+    QHash<QString, Member>::iterator member = members.find(hash);
+    if (member == members.end())
+      continue;
+    member.value().downloadRate = it->download_payload_rate;
+    member.value().uploadRate = it->upload_payload_rate;
+  }
+}
+
+void LabelBandwidth::redistribute()
+{
+  QHash<QString, QHash<QString, Member> >::iterator group = m_members.begin();
+  QHash<QString, QHash<QString, Member> >::iterator groupend = m_members.end();
+  for ( ; group != groupend; ++group) {
+    const LabelLimits limits = effectiveLimits(group.key());
+    QList<Member*> members;
+    QStringList hashes;
+    QList<int> downloadDemands;
+    QList<int> uploadDemands;
+    QHash<QString, Member>::iterator it = group.value().begin();
+    QHash<QString, Member>::iterator itend = group.value().end();
+    for ( ; it != itend; ++it) {
+      members << &it.value();
+      hashes << it.key();
+      downloadDemands << demand(it.value().downloadRate, it.value().downloadAssigned);
+      uploadDemands << demand(it.value().uploadRate, it.value().uploadAssigned);
+    }
+    const QList<int> downloadShares = shareBudget(budgetBytes(limits.downloadLimit), downloadDemands);
+    const QList<int> uploadShares = shareBudget(budgetBytes(limits.uploadLimit), uploadDemands);
+
+    for (int i = 0; i < members.size(); ++i) {
+      Member *member = members[i];
+      const SavedLimits own = m_savedLimits.value(hashes.at(i));
+      // An unlimited direction keeps the torrent's own limit
+      const int download = limits.downloadLimit > 0 ? downloadShares.at(i) : own.downloadLimit;
+      if (needsUpdate(member->downloadAssigned, download)) {
+        member->handle.set_download_limit(download);
+        member->downloadAssigned = download;
+      }
+      const int upload = limits.uploadLimit > 0 ? uploadShares.at(i) : own.uploadLimit;
+      if (needsUpdate(member->uploadAssigned, upload)) {
+        member->handle.set_upload_limit(upload);
+        member->uploadAssigned = upload;
+      }
+    }
+  }
+}
+
+void LabelBandwidth::loadClasses()
+{
+  m_classes.clear();
+  const QVariantMap classes = Preferences().getLabelBandwidthClasses();
+  for (QVariantMap::const_iterator it = classes.begin(); it != classes.end(); ++it) {
+    const LabelLimits limits = LabelLimits::fromVariant(it.value().toMap());
+    if (!limits.isNull())
+      m_classes.insert(it.key(), limits);
+  }
+}
+
+void LabelBandwidth::saveClasses() const
+{
+  QVariantMap classes;
+  QHash<QString, LabelLimits>::const_iterator it = m_classes.begin();
+  QHash<QString, LabelLimits>::const_iterator itend = m_classes.end();
+  for ( ; it != itend; ++it)
+    classes[it.key()] = it.value().toVariant();
+  Preferences().setLabelBandwidthClasses(classes);
+}
+
+void LabelBandwidth::restore(const torrent_handle &h, const SavedLimits &saved) const
+{
+  h.set_download_limit(saved.downloadLimit);
+  h.set_upload_limit(saved.uploadLimit);
+  h.set_max_connections(saved.maxConnections);
+  h.set_priority(0);
+}
+
+// A torrent using most of its share may use more, the others need
+// what they use plus some headroom
+int LabelBandwidth::demand(int rate, int assigned)
+{
+  if (assigned > 0 && rate * 10 >= assigned * 9)
+    return std::numeric_limits<int>::max();
+  return rate + qMax(rate / 4, MIN_SHARE);
+}
+
+// The limits don't all come through LabelLimits::fromVariant()
+int LabelBandwidth::budgetBytes(int rate)
+{
+  return (int) qBound<qint64>(0, (qint64) rate * 1024, std::numeric_limits<int>::max());
+}
+
+// Avoids flooding the network thread with small limit changes
+bool LabelBandwidth::needsUpdate(int assigned, int target)
+{
+  if (assigned == target)
+    return false;
+  if (assigned <= 0 || target <= 0)
+    return true;
+  return qAbs(target - assigned) * 20 > assigned;
+}
+
+// Water filling: the demands are served from the smallest, each one up
+// to an even share of what remains. What is left once all of them are
+// served is split evenly, so the torrents can grow.
+QList<int> LabelBandwidth::shareBudget(int budget, const QList<int> &demands)
+{
+  QList<int> shares;
+  if (budget <= 0 || demands.isEmpty())
+    return shares;
+  const int count = demands.size();
+  QList<QPair<int, int> > order;
+  for (int i = 0; i < count; ++i) {
+    order << qMakePair(demands.at(i), i);
+    shares << 0;
+  }
+  qSort(order);
+
+  qint64 remaining = budget;
+  for (int k = 0; k < count; ++k) {
+    const qint64 even = remaining / (count - k);
+    const qint64 share = qMin<qint64>(order.at(k).first, even);
+    shares[order.at(k).second] = share;
+    remaining -= share;
+  }
+  const int extra = remaining / count;
+  // The floor stays within the budget, except when it is below 1 B/s
+  // per torrent since libtorrent takes 0 as unlimited
+  const int floor = qMax(1, qMin(MIN_SHARE, budget / count));
+  for (int i = 0; i < count; ++i)
+    shares[i] = qMax(floor, shares.at(i) + extra);
+  return shares;
+}
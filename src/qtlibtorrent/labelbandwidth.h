@@ -0,0 +1,160 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef LABELBANDWIDTH_H
+#define LABELBANDWIDTH_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+
+#include <vector>
+
+#include <libtorrent/torrent_handle.hpp>
+
+class QBtSession;
+class QTorrentHandle;
+
+// Bandwidth class of a label
+struct LabelLimits {
+  LabelLimits(): downloadLimit(0), uploadLimit(0), maxConnections(-1), weight(0) {}
+
+  // KiB/s, 0 is unlimited
+  int downloadLimit;
+  int uploadLimit;
+  // Shared evenly by the torrents of the label, -1 is unlimited. It is
+  // approximate: each torrent keeps at least 2 connections, so a label
+  // with many torrents can exceed it.
+  int maxConnections;
+  // Bandwidth priority of the torrents of the label, 0 to 255
+  int weight;
+
+  bool isNull() const;
+  // Keeps a rate limit in KiB/s within what fits in bytes/s
+  static int boundRate(int rate);
+  static LabelLimits fromVariant(const QVariantMap &map);
+  QVariantMap toVariant() const;
+};
+
+// Enforces the label bandwidth classes. libtorrent can't throttle a
+// group of torrents together, so the rate limits of a label are shared
+// between its torrents as per torrent limits. They are redistributed
+// on each tick following the transfer rates: the torrents using less
+// than an even share keep what they use plus some headroom, and the
+// rest is split between the others. The torrent limits in place before
+// are restored once their label is no longer limited.
+class LabelBandwidth : public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(LabelBandwidth)
+
+public:
+  LabelBandwidth(QBtSession *session, QObject *parent = 0);
+
+  // Classes configured by the user, saved in the preferences
+  inline QHash<QString, LabelLimits> labelClasses() const { return m_classes; }
+  LabelLimits labelClass(const QString &label) const;
+  // A null class removes the label's class
+  void setLabelClass(const QString &label, const LabelLimits &limits);
+  // Rate limits set by the bandwidth scheduler, they override the
+  // rates of the classes
+  void setScheduledLimits(const QHash<QString, LabelLimits> &limits);
+  LabelLimits effectiveLimits(const QString &label) const;
+  // Per label limits, torrent count and transfer rates
+  QVariantList status() const;
+
+public slots:
+  // Call when the label of a torrent changed
+  void scheduleApply();
+  void apply();
+
+private slots:
+  void handleStateUpdate(const std::vector<libtorrent::torrent_status> &statuses);
+  void redistribute();
+
+private:
+  // Not a libtorrent rate limit, forces the next assignment
+  enum { UNASSIGNED = -2 };
+
+  struct Member {
+    Member(): downloadRate(0), uploadRate(0), downloadAssigned(UNASSIGNED), uploadAssigned(UNASSIGNED) {}
+
+    libtorrent::torrent_handle handle;
+    // Payload rates, bytes/s
+    int downloadRate;
+    int uploadRate;
+    // Limits last set, bytes/s
+    int downloadAssigned;
+    int uploadAssigned;
+  };
+
+  struct SavedLimits {
+    SavedLimits(): downloadLimit(0), uploadLimit(0), maxConnections(-1) {}
+
+    int downloadLimit;
+    int uploadLimit;
+    int maxConnections;
+
+    static SavedLimits fromVariant(const QVariant &value);
+    QVariant toVariant() const;
+  };
+
+  void loadClasses();
+  void saveClasses() const;
+  void restore(const libtorrent::torrent_handle &h, const SavedLimits &saved) const;
+  static int demand(int rate, int assigned);
+  static bool needsUpdate(int assigned, int target);
+  static int budgetBytes(int rate);
+  static QList<int> shareBudget(int budget, const QList<int> &demands);
+
+private:
+  QBtSession *m_session;
+  // Coalesces the torrent additions, removals and label changes
+  QTimer m_applyTimer;
+  QTimer m_redistributeTimer;
+  QHash<QString, LabelLimits> m_classes;
+  QHash<QString, LabelLimits> m_scheduled;
+  // Torrents of the limited labels, by label then by hash
+  QHash<QString, QHash<QString, Member> > m_members;
+  // Label of each member torrent
+  QHash<QString, QString> m_memberLabels;
+  // Torrent limits saved before a label limit replaced them. They are
+  // also kept with the torrent data, as libtorrent saves the replaced
+  // limits in the fast resume data.
+  QHash<QString, SavedLimits> m_savedLimits;
+  // Until the first pass, which restores the limits saved by a previous
+  // run for the torrents no longer in a class
+  bool m_restorePending;
+};
+
+#endif // LABELBANDWIDTH_H
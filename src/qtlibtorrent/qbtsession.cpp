@@ -35,11 +35,14 @@
 #include <QHostAddress>
 #include <QNetworkAddressEntry>
 #include <QProcess>
+#include <QElapsedTimer>
 
 #include "smtp.h"
 #include "filesystemwatcher.h"
 #include "torrentspeedmonitor.h"
 #include "torrentstatistics.h"
+#include "alertworkerpool.h"
+#include "alertlatencystats.h"
 #include "qbtsession.h"
 #include "misc.h"
 #include "fs_utils.h"
@@ -53,8 +56,12 @@
 #endif
 #include "torrentpersistentdata.h"
 #include "httpserver.h"
+#include "controlserver.h"
+#include "diskcachetuner.h"
 #include "qinisettings.h"
 #include "bandwidthscheduler.h"
+#include "labelbandwidth.h"
+#include <boost/bind.hpp>
 #include <libtorrent/version.hpp>
 #include <libtorrent/extensions/ut_metadata.hpp>
 #include <libtorrent/version.hpp>
@@ -72,6 +79,7 @@
 #include <queue>
 #include <string.h>
 #include "dnsupdater.h"
+#include "tracer.h"
 
 #if LIBTORRENT_VERSION_NUM < 10000
 #include <libtorrent/upnp.hpp>
@@ -116,11 +124,22 @@ QBtSession::QBtSession()
   #endif
   , m_dynDNSUpdater(0)
   , m_alertDispatcher(0)
+  , m_alertLatencyStats(0)
+  , m_alertWorkers(0)
+  , m_snapshots(0)
+  , m_labelBandwidth(0)
+  , m_ipFilterRuleCount(0)
 {
   BigRatioTimer = new QTimer(this);
   BigRatioTimer->setInterval(10000);
   connect(BigRatioTimer, SIGNAL(timeout()), SLOT(processBigRatios()));
   Preferences pref;
+#ifdef QBT_TRACING
+  // Created here, in the main thread, before the alert workers start
+  Tracer::instance()->setSlowThreshold(pref.traceSlowThreshold());
+  connect(Tracer::instance(), SIGNAL(slowEvent(QString, qint64)), SLOT(handleSlowTraceEvent(QString, qint64)));
+  connect(Tracer::instance(), SIGNAL(traceDumped(QString)), SLOT(handleTraceDumped(QString)));
+#endif
   // Creating Bittorrent session
   QList<int> version;
   version << VERSION_MAJOR;
@@ -149,8 +168,12 @@ QBtSession::QBtSession()
     PeXEnabled = false;
   }
   s->add_extension(&create_smart_ban_plugin);
+  m_alertLatencyStats = new AlertLatencyStats;
+  m_alertWorkers = new AlertWorkerPool(m_alertLatencyStats);
   m_alertDispatcher = new QAlertDispatcher(s, this);
   connect(m_alertDispatcher, SIGNAL(alertsReceived()), SLOT(readAlerts()));
+  m_snapshots = new SessionSnapshotService(this, this);
+  m_labelBandwidth = new LabelBandwidth(this, this);
   appendLabelToSavePath = pref.appendTorrentLabel();
   appendqBExtension = pref.useIncompleteFilesExtension();
   connect(m_scanFolders, SIGNAL(torrentsAdded(QStringList&)), SLOT(addTorrentsFromScanFolder(QStringList&)));
@@ -190,10 +213,18 @@ QBtSession::~QBtSession() {
   // HTTP Server
   if (httpServer)
     delete httpServer;
+  if (m_controlServer)
+    delete m_controlServer;
+  // Finish the pending alert jobs before the handles go away
+  delete m_alertWorkers;
   delete m_alertDispatcher;
+  delete m_alertLatencyStats;
   delete m_torrentStatistics;
   qDebug("Deleting the session");
   delete s;
+#ifdef QBT_TRACING
+  Tracer::drop();
+#endif
   qDebug("BTSession destructor OUT");
 #ifndef DISABLE_GUI
   if (m_shutdownAct != NO_SHUTDOWN) {
@@ -287,6 +318,8 @@ void QBtSession::configureSession() {
     pref.setSessionPort(rand() % USHRT_MAX + 1025);
   }
 
+  m_snapshots->setInterval(pref.getRefreshInterval());
+
   const unsigned short old_listenPort = getListenPort();
   const unsigned short new_listenPort = pref.getSessionPort();
   if (old_listenPort != new_listenPort) {
@@ -349,11 +382,11 @@ void QBtSession::configureSession() {
   if (pref.isSchedulerEnabled()) {
     if (!bd_scheduler) {
       bd_scheduler = new BandwidthScheduler(this);
-      connect(bd_scheduler, SIGNAL(switchToAlternativeMode(bool)), this, SLOT(useAlternativeSpeedsLimit(bool)));
+      connect(bd_scheduler, SIGNAL(ruleChanged()), SLOT(applyBandwidthRule()));
     }
-    bd_scheduler->start();
   } else {
     delete bd_scheduler;
+    m_labelBandwidth->setScheduledLimits(QHash<QString, LabelLimits>());
   }
 #ifndef DISABLE_GUI
   // Resolve countries
@@ -408,9 +441,28 @@ void QBtSession::configureSession() {
   sessionSettings.announce_to_all_tiers = announce_to_all;
   sessionSettings.auto_scrape_min_interval = 900; // 15 minutes
   int cache_size = pref.diskCacheSize();
-  sessionSettings.cache_size = cache_size ? cache_size * 64 : -1;
+  if (pref.isDiskCacheAdaptive()) {
+    // The configured size becomes the upper bound of the tuner
+    if (!m_cacheTuner)
+      m_cacheTuner = new DiskCacheTuner(this, this);
+    m_cacheTuner->setMaxSize(cache_size);
+    sessionSettings.cache_size = m_cacheTuner->size() * 64;
+    qDebug() << "Using an adaptive disk cache of" << m_cacheTuner->size() << "MiB";
+  } else {
+    if (m_cacheTuner)
+      delete m_cacheTuner;
+    sessionSettings.cache_size = cache_size ? cache_size * 64 : -1;
+    qDebug() << "Using a disk cache size of" << cache_size << "MiB";
+  }
   sessionSettings.cache_expiry = pref.diskCacheTTL();
-  qDebug() << "Using a disk cache size of" << cache_size << "MiB";
+  sessionSettings.use_read_cache = pref.useDiskReadCache();
+  sessionSettings.volatile_read_cache = pref.isDiskReadCacheVolatile();
+  sessionSettings.disk_cache_algorithm = (session_settings::disk_cache_algo_t) qBound(0, pref.diskCacheFlushAlgorithm(), 2);
+  sessionSettings.cache_buffer_chunk_size = pref.diskCacheChunkSize();
+  sessionSettings.coalesce_reads = pref.coalesceDiskReadsWrites();
+  sessionSettings.coalesce_writes = pref.coalesceDiskReadsWrites();
+  sessionSettings.file_pool_size = pref.filePoolSize();
+  sessionSettings.max_queued_disk_bytes = pref.maxQueuedDiskBytes() * 1024;
   sessionSettings.anonymous_mode = pref.isAnonymousModeEnabled();
   if (sessionSettings.anonymous_mode) {
     addConsoleMessage(tr("Anonymous mode [ON]"), "blue");
@@ -479,8 +531,16 @@ void QBtSession::configureSession() {
   else
     sessionSettings.mixed_mode_algorithm = session_settings::peer_proportional;
   sessionSettings.connection_speed = 20; //default is 10
+  // Performance profile, applied last as it raises some of the limits above
+  const int profile = pref.getPerformanceProfile();
+  applyPerformanceProfile(sessionSettings, profile);
+  if (profile == PerformanceProfile::SEEDBOX)
+    addConsoleMessage(tr("Performance profile: seedbox"), QString::fromUtf8("blue"));
   qDebug() << "Settings SessionSettings";
   setSessionSettings(sessionSettings);
+  // The scheduled limits override the ones above
+  if (bd_scheduler)
+    bd_scheduler->start();
   // Bittorrent
   // * Max connections per torrent limit
   setMaxConnectionsPerTorrent(pref.getMaxConnecsPerTorrent());
@@ -560,6 +620,7 @@ void QBtSession::configureSession() {
   // Update Web UI
   // Use a QTimer because the function can be called from qBtSession constructor
   QTimer::singleShot(0, this, SLOT(initWebUi()));
+  initControlSocket();
   // * Proxy settings
   proxy_settings proxySettings;
   if (pref.isProxyEnabled()) {
@@ -690,6 +751,31 @@ void QBtSession::initWebUi() {
   }
 }
 
+void QBtSession::initControlSocket() {
+  Preferences pref;
+  if (!pref.isControlSocketEnabled()) {
+    if (m_controlServer)
+      delete m_controlServer;
+    return;
+  }
+
+  QString path = pref.getControlSocketPath();
+  if (path.isEmpty())
+    path = ControlServer::defaultPath();
+  if (m_controlServer) {
+    if (m_controlServer->fullServerName() == path)
+      return;
+    delete m_controlServer;
+  }
+  m_controlServer = new ControlServer(this);
+  if (m_controlServer->start(path)) {
+    addConsoleMessage(tr("The control socket is listening on %1").arg(path));
+  } else {
+    addConsoleMessage(tr("Couldn't create the control socket %1: %2").arg(path).arg(m_controlServer->errorString()), "red");
+    delete m_controlServer;
+  }
+}
+
 void QBtSession::useAlternativeSpeedsLimit(bool alternative) {
   qDebug() << Q_FUNC_INFO << alternative;
   // Save new state to remember it on startup
@@ -718,6 +804,31 @@ void QBtSession::useAlternativeSpeedsLimit(bool alternative) {
   emit alternativeSpeedsModeChanged(alternative);
 }
 
+void QBtSession::applyBandwidthRule() {
+  if (!bd_scheduler)
+    return;
+  const BandwidthRule *rule = bd_scheduler->activeRule();
+  qDebug() << Q_FUNC_INFO << (rule ? rule->start.toString() : QString());
+  if (!rule || rule->alternative) {
+    useAlternativeSpeedsLimit(rule != 0);
+  } else {
+    // Leave the alternative mode first, so that the status bar follows
+    useAlternativeSpeedsLimit(false);
+    setDownloadRateLimit(rule->downloadLimit > 0 ? rule->downloadLimit * 1024 : -1);
+    setUploadRateLimit(rule->uploadLimit > 0 ? rule->uploadLimit * 1024 : -1);
+  }
+  // Connections limit
+  const Preferences pref;
+  session_settings sessionSettings = s->settings();
+  sessionSettings.connections_limit = pref.getMaxConnecs();
+  applyPerformanceProfile(sessionSettings, pref.getPerformanceProfile());
+  if (rule && rule->maxConnections >= 0)
+    sessionSettings.connections_limit = rule->maxConnections;
+  setSessionSettings(sessionSettings);
+  // Label limits
+  m_labelBandwidth->setScheduledLimits(rule ? rule->labelLimits : QHash<QString, LabelLimits>());
+}
+
 // Return the torrent handle, given its hash
 QTorrentHandle QBtSession::getTorrentHandle(const QString &hash) const {
   return QTorrentHandle(s->find_torrent(QStringToSha1(hash)));
@@ -799,6 +910,8 @@ void QBtSession::deleteTorrent(const QString &hash, bool delete_local_files) {
       QDir().rmpath(parent_folder);
     }
   }
+  // Make sure no pending alert job writes the backup files again
+  m_alertWorkers->cancel(hash);
   // Remove it from torrent backup directory
   QDir torrentBackup(fsutils::BTBackupLocation());
   QStringList filters;
@@ -1411,6 +1524,78 @@ void QBtSession::exportTorrentFiles(QString path) {
   }
 }
 
+// The defaults are restored first, so switching back from a profile at
+// runtime doesn't leave its values behind. The user limits are only raised.
+void QBtSession::applyPerformanceProfile(session_settings &settings, int profile) {
+  const session_settings defaults;
+  settings.max_failcount = defaults.max_failcount;
+  settings.listen_queue_size = defaults.listen_queue_size;
+  settings.max_allowed_in_request_queue = defaults.max_allowed_in_request_queue;
+  settings.max_out_request_queue = defaults.max_out_request_queue;
+  settings.send_buffer_low_watermark = defaults.send_buffer_low_watermark;
+  settings.send_buffer_watermark = defaults.send_buffer_watermark;
+  settings.send_buffer_watermark_factor = defaults.send_buffer_watermark_factor;
+  settings.choking_algorithm = defaults.choking_algorithm;
+  settings.seed_choking_algorithm = defaults.seed_choking_algorithm;
+  settings.peer_tos = defaults.peer_tos;
+  settings.suggest_mode = defaults.suggest_mode;
+  settings.use_disk_read_ahead = defaults.use_disk_read_ahead;
+  settings.read_cache_line_size = defaults.read_cache_line_size;
+  if (profile != PerformanceProfile::SEEDBOX)
+    return;
+
+  // Thousands of seeding torrents, after libtorrent's high_performance_seed()
+  if (settings.connections_limit >= 0)
+    settings.connections_limit = qMax(settings.connections_limit, 8000);
+  if (settings.unchoke_slots_limit >= 0)
+    settings.unchoke_slots_limit = qMax(settings.unchoke_slots_limit, 500);
+  // Give up on unreachable peers quickly
+  settings.max_failcount = 1;
+  settings.listen_queue_size = 200;
+  settings.max_allowed_in_request_queue = 2000;
+  settings.max_out_request_queue = 1500;
+  // Keep enough data queued on the sockets of fast peers
+  settings.send_buffer_low_watermark = 1024 * 1024;
+  settings.send_buffer_watermark = 3 * 1024 * 1024;
+  settings.send_buffer_watermark_factor = 150;
+  settings.choking_algorithm = session_settings::fixed_slots_choker;
+  settings.seed_choking_algorithm = session_settings::fastest_upload;
+  // DSCP CS1, bulk traffic
+  settings.peer_tos = 0x20;
+  // Suggest the pieces already in the read cache, and read ahead
+  settings.suggest_mode = session_settings::suggest_read_cache;
+  settings.use_disk_read_ahead = true;
+  settings.read_cache_line_size = 128;
+  settings.max_queued_disk_bytes = qMax(settings.max_queued_disk_bytes, 7 * 1024 * 1024);
+  settings.file_pool_size = qMax(settings.file_pool_size, 500);
+}
+
+QVariantMap QBtSession::getEffectiveSettings() const {
+  const session_settings settings = s->settings();
+  QVariantMap values;
+  values["performance_profile"] = Preferences().getPerformanceProfile() == PerformanceProfile::SEEDBOX ? "seedbox" : "default";
+  values["connections_limit"] = settings.connections_limit;
+  values["unchoke_slots_limit"] = settings.unchoke_slots_limit;
+  values["half_open_limit"] = settings.half_open_limit;
+  values["max_failcount"] = settings.max_failcount;
+  values["listen_queue_size"] = settings.listen_queue_size;
+  values["max_allowed_in_request_queue"] = settings.max_allowed_in_request_queue;
+  values["max_out_request_queue"] = settings.max_out_request_queue;
+  values["send_buffer_low_watermark"] = settings.send_buffer_low_watermark;
+  values["send_buffer_watermark"] = settings.send_buffer_watermark;
+  values["send_buffer_watermark_factor"] = settings.send_buffer_watermark_factor;
+  values["choking_algorithm"] = settings.choking_algorithm;
+  values["seed_choking_algorithm"] = settings.seed_choking_algorithm;
+  values["peer_tos"] = (int) (unsigned char) settings.peer_tos;
+  values["suggest_mode"] = settings.suggest_mode;
+  values["use_disk_read_ahead"] = settings.use_disk_read_ahead;
+  values["read_cache_line_size"] = settings.read_cache_line_size;
+  values["cache_size"] = settings.cache_size;
+  values["max_queued_disk_bytes"] = settings.max_queued_disk_bytes;
+  values["file_pool_size"] = settings.file_pool_size;
+  return values;
+}
+
 void QBtSession::setMaxConnectionsPerTorrent(int max) {
   qDebug() << Q_FUNC_INFO << max;
   // Apply this to all session torrents
@@ -1610,6 +1795,8 @@ void QBtSession::saveFastResumeData() {
   qDebug("Saving fast resume data...");
   // Stop listening for alerts
   resumeDataTimer.stop();
+  // Older resume data may still be queued for writing
+  m_alertWorkers->waitForDone();
   int num_resume_data = 0;
   // Pause session
   s->pause();
@@ -2036,6 +2223,7 @@ void QBtSession::disableIPFilter() {
     delete filterParser;
   }
   filterPath = "";
+  m_ipFilterRuleCount = 0;
 }
 
 // Set BT session settings (user_agent)
@@ -2124,20 +2312,63 @@ void QBtSession::sendNotificationEmail(const QTorrentHandle &h) {
   content += tr("Save path: %1").arg(TorrentPersistentData::getSavePath(h.hash())) + "\n\n";
   content += tr("The torrent was downloaded in %1.", "The torrent was downloaded in 1 hour and 20 seconds").arg(misc::userFriendlyDuration(status.active_time)) + "\n\n\n";
   content += tr("Thank you for using qBittorrent.") + "\n";
+  // The Smtp object must live in the main thread
+  QMetaObject::invokeMethod(this, "deliverNotificationEmail", Qt::QueuedConnection,
+                            Q_ARG(QString, tr("[qBittorrent] %1 has finished downloading").arg(h.name())),
+                            Q_ARG(QString, content));
+}
+
+void QBtSession::deliverNotificationEmail(const QString &subject, const QString &content) {
   // Send the notification email
   Smtp *sender = new Smtp(this);
-  sender->sendMail("notification@qbittorrent.org", Preferences().getMailNotificationEmail(), tr("[qBittorrent] %1 has finished downloading").arg(h.name()), content);
+  sender->sendMail("notification@qbittorrent.org", Preferences().getMailNotificationEmail(), subject, content);
+}
+
+void QBtSession::notifyRecursiveTorrentDownload(const QString &hash) {
+  const QTorrentHandle h = getTorrentHandle(hash);
+  if (h.is_valid()) {
+    qDebug("emitting recursiveTorrentDownloadPossible()");
+    emit recursiveTorrentDownloadPossible(h);
+  }
+}
+
+void QBtSession::postConsoleMessage(const QString &msg, const QString &color) {
+#ifdef DISABLE_GUI
+  QMetaObject::invokeMethod(this, "addConsoleMessage", Qt::QueuedConnection,
+                            Q_ARG(QString, msg), Q_ARG(QString, color));
+#else
+  QMetaObject::invokeMethod(this, "addConsoleMessage", Qt::QueuedConnection,
+                            Q_ARG(QString, msg), Q_ARG(QColor, QColor(color)));
+#endif
+}
+
+// Writes the resume data of a torrent, called from an alert worker
+static void writeFastResumeFile(const QString &filepath, boost::shared_ptr<libtorrent::entry> data) {
+  vector<char> out;
+  bencode(back_inserter(out), *data);
+  QFile resume_file(filepath);
+  if (resume_file.exists())
+    fsutils::forceRemove(filepath);
+  qDebug("Saving fastresume data in %s", qPrintable(filepath));
+  if (!out.empty() && resume_file.open(QIODevice::WriteOnly)) {
+    resume_file.write(&out[0], out.size());
+    resume_file.close();
+  }
 }
 
 // Read alerts sent by the Bittorrent session
 void QBtSession::readAlerts() {
+  QBT_TRACE_SCOPE("QBtSession::readAlerts");
 
   typedef std::deque<alert*> alerts_t;
   alerts_t alerts;
   m_alertDispatcher->getPendingAlertsNoWait(alerts);
 
+  QElapsedTimer timer;
   for (alerts_t::const_iterator i = alerts.begin(), end = alerts.end(); i != end; ++i) {
+    timer.start();
     handleAlert(*i);
+    m_alertLatencyStats->record((*i)->what(), AlertLatencyStats::DispatchStage, timer.nsecsElapsed() / 1000);
     delete *i;
   }
 }
@@ -2236,28 +2467,6 @@ void QBtSession::handleTorrentFinishedAlert(libtorrent::torrent_finished_alert*
     qDebug("Was already seeded: %d", was_already_seeded);
     if (!was_already_seeded) {
       h.save_resume_data();
-      qDebug("Checking if the torrent contains torrent files to download");
-      // Check if there are torrent files inside
-      for (int i=0; i<h.num_files(); ++i) {
-        const QString torrent_relpath = h.filepath_at(i);
-        qDebug() << "File path:" << torrent_relpath;
-        if (torrent_relpath.endsWith(".torrent", Qt::CaseInsensitive)) {
-          qDebug("Found possible recursive torrent download.");
-          const QString torrent_fullpath = h.save_path()+"/"+torrent_relpath;
-          qDebug("Full subtorrent path is %s", qPrintable(torrent_fullpath));
-          try {
-            boost::intrusive_ptr<torrent_info> t = new torrent_info(fsutils::toNativePath(torrent_fullpath).toUtf8().constData());
-            if (t->is_valid()) {
-              qDebug("emitting recursiveTorrentDownloadPossible()");
-              emit recursiveTorrentDownloadPossible(h);
-              break;
-            }
-          } catch(std::exception&) {
-            qDebug("Caught error loading torrent");
-            addConsoleMessage(tr("Unable to decode %1 torrent file.").arg(fsutils::toNativePath(torrent_fullpath)), QString::fromUtf8("red"));
-          }
-        }
-      }
       // Move to download directory if necessary
       if (!defaultTempPath.isEmpty()) {
         // Check if directory is different
@@ -2287,15 +2496,13 @@ void QBtSession::handleTorrentFinishedAlert(libtorrent::torrent_finished_alert*
 #else
       bool will_shutdown = false;
 #endif
-      // AutoRun program
-      if (pref.isAutoRunEnabled())
-        autoRunExternalProgram(h);
-      // Move .torrent file to another folder
-      if (pref.isFinishedTorrentExportEnabled())
-          exportTorrentFile(h, FinishedTorrentExportFolder);
-      // Mail notification
-      if (pref.isMailNotificationEnabled())
-        sendNotificationEmail(h);
+      // Scan for embedded torrents, AutoRun program, move .torrent file to
+      // another folder and mail notification are done by an alert worker
+      m_alertWorkers->enqueue(hash, p->what(),
+                              boost::bind(&QBtSession::processFinishedTorrent, this, h,
+                                          pref.isAutoRunEnabled(),
+                                          pref.isFinishedTorrentExportEnabled(),
+                                          pref.isMailNotificationEnabled()));
 #ifndef DISABLE_GUI
       // Auto-Shutdown
       if (will_shutdown) {
@@ -2333,22 +2540,49 @@ void QBtSession::handleTorrentFinishedAlert(libtorrent::torrent_finished_alert*
   }
 }
 
+void QBtSession::processFinishedTorrent(const QTorrentHandle &h, bool autoRun, bool exportTorrent, bool sendMail) {
+  if (!h.is_valid())
+    return;
+  qDebug("Checking if the torrent contains torrent files to download");
+  // Check if there are torrent files inside
+  for (int i=0; i<h.num_files(); ++i) {
+    const QString torrent_relpath = h.filepath_at(i);
+    qDebug() << "File path:" << torrent_relpath;
+    if (torrent_relpath.endsWith(".torrent", Qt::CaseInsensitive)) {
+      qDebug("Found possible recursive torrent download.");
+      const QString torrent_fullpath = h.save_path()+"/"+torrent_relpath;
+      qDebug("Full subtorrent path is %s", qPrintable(torrent_fullpath));
+      try {
+        boost::intrusive_ptr<torrent_info> t = new torrent_info(fsutils::toNativePath(torrent_fullpath).toUtf8().constData());
+        if (t->is_valid()) {
+          QMetaObject::invokeMethod(this, "notifyRecursiveTorrentDownload", Qt::QueuedConnection, Q_ARG(QString, h.hash()));
+          break;
+        }
+      } catch(std::exception&) {
+        qDebug("Caught error loading torrent");
+        postConsoleMessage(tr("Unable to decode %1 torrent file.").arg(fsutils::toNativePath(torrent_fullpath)), QString::fromUtf8("red"));
+      }
+    }
+  }
+  // AutoRun program
+  if (autoRun)
+    autoRunExternalProgram(h);
+  // Move .torrent file to another folder
+  if (exportTorrent)
+    exportTorrentFile(h, FinishedTorrentExportFolder);
+  // Mail notification
+  if (sendMail)
+    sendNotificationEmail(h);
+}
+
 void QBtSession::handleSaveResumeDataAlert(libtorrent::save_resume_data_alert* p) {
-  const QDir torrentBackup(fsutils::BTBackupLocation());
   const QTorrentHandle h(p->handle);
   if (h.is_valid() && p->resume_data) {
-    const QString filepath = torrentBackup.absoluteFilePath(h.hash()+".fastresume");
-    QFile resume_file(filepath);
-    if (resume_file.exists())
-      fsutils::forceRemove(filepath);
-    qDebug("Saving fastresume data in %s", qPrintable(filepath));
-    backupPersistentData(h.hash(), p->resume_data);
-    vector<char> out;
-    bencode(back_inserter(out), *p->resume_data);
-    if (!out.empty() && resume_file.open(QIODevice::WriteOnly)) {
-      resume_file.write(&out[0], out.size());
-      resume_file.close();
-    }
+    const QString hash = h.hash();
+    const QString filepath = QDir(fsutils::BTBackupLocation()).absoluteFilePath(hash+".fastresume");
+    backupPersistentData(hash, p->resume_data);
+    // The resume data outlives the alert, bencoding and writing it is left to a worker
+    m_alertWorkers->enqueue(hash, p->what(), boost::bind(&writeFastResumeFile, filepath, p->resume_data));
   }
 }
 
@@ -2445,13 +2679,9 @@ void QBtSession::handleMetadataReceivedAlert(libtorrent::metadata_received_alert
       h.pause();
     }
     qDebug("Received metadata for %s", qPrintable(h.hash()));
-    // Save metadata
-    const QDir torrentBackup(fsutils::BTBackupLocation());
-    if (!QFile::exists(torrentBackup.absoluteFilePath(h.hash()+QString(".torrent"))))
-      h.save_torrent_file(torrentBackup.absoluteFilePath(h.hash()+QString(".torrent")));
-    // Copy the torrent file to the export folder
-    if (m_torrentExportEnabled)
-      exportTorrentFile(h);
+    // Save metadata and copy the torrent file to the export folder
+    m_alertWorkers->enqueue(hash, p->what(),
+                            boost::bind(&QBtSession::processReceivedMetadata, this, h, m_torrentExportEnabled));
     // Append .!qB to incomplete files
     if (appendqBExtension)
       appendqBextensionToTorrent(h, true);
@@ -2469,6 +2699,16 @@ void QBtSession::handleMetadataReceivedAlert(libtorrent::metadata_received_alert
   }
 }
 
+void QBtSession::processReceivedMetadata(const QTorrentHandle &h, bool exportTorrent) {
+  if (!h.is_valid())
+    return;
+  const QDir torrentBackup(fsutils::BTBackupLocation());
+  if (!QFile::exists(torrentBackup.absoluteFilePath(h.hash()+QString(".torrent"))))
+    h.save_torrent_file(torrentBackup.absoluteFilePath(h.hash()+QString(".torrent")));
+  if (exportTorrent)
+    exportTorrentFile(h);
+}
+
 void QBtSession::handleFileErrorAlert(libtorrent::file_error_alert* p) {
   QTorrentHandle h(p->handle);
   if (h.is_valid()) {
@@ -2714,8 +2954,13 @@ int QBtSession::getListenPort() const {
   return s->listen_port();
 }
 
+// From the latest snapshot, it doesn't wait for the network thread
 session_status QBtSession::getSessionStatus() const {
-  return s->status();
+  return m_snapshots->snapshot()->status;
+}
+
+SessionSnapshotPtr QBtSession::sessionSnapshot() const {
+  return m_snapshots->snapshot();
 }
 
 QString QBtSession::getSavePath(const QString &hash, bool fromScanDir, QString filePath) {
@@ -2838,14 +3083,14 @@ void QBtSession::processDownloadedFile(QString url, QString file_path) {
 // session. Payload means that it only take into
 // account "useful" part of the rate
 qreal QBtSession::getPayloadDownloadRate() const {
-  return s->status().payload_download_rate;
+  return m_snapshots->snapshot()->status.payload_download_rate;
 }
 
 // Return current upload rate for the BT
 // session. Payload means that it only take into
 // account "useful" part of the rate
 qreal QBtSession::getPayloadUploadRate() const {
-  return s->status().payload_upload_rate;
+  return m_snapshots->snapshot()->status.payload_upload_rate;
 }
 
 void QBtSession::applyEncryptionSettings(pe_settings se) {
@@ -2938,22 +3183,40 @@ quint64 QBtSession::getAlltimeUL() const {
   return m_torrentStatistics->getAlltimeUL();
 }
 
-void QBtSession::postTorrentUpdate() {
-  s->post_torrent_updates();
+int QBtSession::pendingAlerts() const {
+  return m_alertDispatcher->pendingAlertCount();
+}
+
+int QBtSession::pendingAlertJobs() const {
+  return m_alertWorkers->pendingJobs();
 }
 
 void QBtSession::handleIPFilterParsed(int ruleCount)
 {
+  m_ipFilterRuleCount = ruleCount;
   addConsoleMessage(tr("Successfully parsed the provided IP filter: %1 rules were applied.", "%1 is a number").arg(ruleCount));
   emit ipFilterParsed(false, ruleCount);
 }
 
 void QBtSession::handleIPFilterError()
 {
+  m_ipFilterRuleCount = 0;
   addConsoleMessage(tr("Error: Failed to parse the provided IP filter."), "red");
   emit ipFilterParsed(true, 0);
 }
 
+#ifdef QBT_TRACING
+void QBtSession::handleSlowTraceEvent(const QString &name, qint64 usecs)
+{
+  addConsoleMessage(tr("Slow operation: %1 took %2 ms").arg(name).arg(usecs / 1000), "red");
+}
+
+void QBtSession::handleTraceDumped(const QString &path)
+{
+  addConsoleMessage(tr("Trace written to %1").arg(fsutils::toNativePath(path)));
+}
+#endif
+
 void QBtSession::recoverPersistentData(const QString &hash, const std::vector<char> &buf) {
   if (TorrentPersistentData::isKnownTorrent(hash) || TorrentTempData::hasTempData(hash) || buf.empty())
     return;
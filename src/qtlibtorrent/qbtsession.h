@@ -34,6 +34,7 @@
 #include <QHash>
 #include <QUrl>
 #include <QStringList>
+#include <QVariant>
 #ifdef DISABLE_GUI
 #include <QCoreApplication>
 #else
@@ -53,17 +54,23 @@
 #include "qtorrenthandle.h"
 #include "trackerinfos.h"
 #include "alertdispatcher.h"
+#include "sessionsnapshot.h"
 
 #define MAX_SAMPLES 20
 
 class DownloadThread;
 class FilterParserThread;
 class HttpServer;
+class ControlServer;
+class DiskCacheTuner;
 class BandwidthScheduler;
+class LabelBandwidth;
 class ScanFoldersModel;
 class TorrentSpeedMonitor;
 class TorrentStatistics;
 class DNSUpdater;
+class AlertWorkerPool;
+class AlertLatencyStats;
 
 const int MAX_LOG_MESSAGES = 1000;
 
@@ -94,6 +101,9 @@ public:
   qreal getPayloadDownloadRate() const;
   qreal getPayloadUploadRate() const;
   libtorrent::session_status getSessionStatus() const;
+  SessionSnapshotPtr sessionSnapshot() const;
+  // The session settings covered by the performance profiles, as applied
+  QVariantMap getEffectiveSettings() const;
   int getListenPort() const;
   qreal getRealRatio(const libtorrent::torrent_status &status) const;
   QHash<QString, TrackerInfos> getTrackersInfo(const QString &hash) const;
@@ -107,13 +117,19 @@ public:
   inline bool useTemporaryFolder() const { return !defaultTempPath.isEmpty(); }
   inline QString getDefaultSavePath() const { return defaultSavePath; }
   inline ScanFoldersModel* getScanFoldersModel() const {  return m_scanFolders; }
+  inline SessionSnapshotService* getSnapshotService() const { return m_snapshots; }
+  inline LabelBandwidth* getLabelBandwidth() const { return m_labelBandwidth; }
   inline bool isDHTEnabled() const { return DHTEnabled; }
   inline bool isLSDEnabled() const { return LSDEnabled; }
   inline bool isPexEnabled() const { return PeXEnabled; }
   inline bool isQueueingEnabled() const { return queueingEnabled; }
   quint64 getAlltimeDL() const;
   quint64 getAlltimeUL() const;
-  void postTorrentUpdate();
+  inline const AlertLatencyStats* alertLatencyStats() const { return m_alertLatencyStats; }
+  // Alerts waiting for the main thread, and alert jobs waiting for a worker
+  int pendingAlerts() const;
+  int pendingAlertJobs() const;
+  inline int ipFilterRuleCount() const { return m_ipFilterRuleCount; }
 
 public slots:
   QTorrentHandle addTorrent(QString path, bool fromScanDir = false, QString from_url = QString(), bool resumed = false);
@@ -134,6 +150,8 @@ public slots:
   /* End Web UI */
   void preAllocateAllFiles(bool b);
   void saveFastResumeData();
+  // Only for the torrents whose resume data changed, without pausing the session
+  void saveTempFastResumeData();
   void enableIPFilter(const QString &filter_path, bool force=false);
   void disableIPFilter();
   void setQueueingEnabled(bool enable);
@@ -192,6 +210,7 @@ private:
   void loadTorrentTempData(QTorrentHandle &h, QString savePath, bool magnet);
   void initializeAddTorrentParams(const QString &hash, libtorrent::add_torrent_params &p);
   void updateRatioTimer();
+  static void applyPerformanceProfile(libtorrent::session_settings &settings, int profile);
   void recoverPersistentData(const QString &hash, const std::vector<char> &buf);
   void backupPersistentData(const QString &hash, boost::shared_ptr<libtorrent::entry> data);
   void handleAlert(libtorrent::alert* a);
@@ -219,21 +238,32 @@ private:
   void handleExternalIPAlert(libtorrent::external_ip_alert *p);
   void handleStateUpdateAlert(libtorrent::state_update_alert *p);
   void handleStatsAlert(libtorrent::stats_alert *p);
+  // Executed on the alert worker threads
+  void processFinishedTorrent(const QTorrentHandle &h, bool autoRun, bool exportTorrent, bool sendMail);
+  void processReceivedMetadata(const QTorrentHandle &h, bool exportTorrent);
+  void sendNotificationEmail(const QTorrentHandle &h);
+  void postConsoleMessage(const QString &msg, const QString &color);
 
 private slots:
   void addTorrentsFromScanFolder(QStringList&);
   void readAlerts();
   void processBigRatios();
   void exportTorrentFiles(QString path);
-  void saveTempFastResumeData();
-  void sendNotificationEmail(const QTorrentHandle &h);
+  void deliverNotificationEmail(const QString &subject, const QString &content);
+  void notifyRecursiveTorrentDownload(const QString &hash);
   void autoRunExternalProgram(const QTorrentHandle &h);
   void mergeTorrents(QTorrentHandle& h_ex, boost::intrusive_ptr<libtorrent::torrent_info> t);
   void mergeTorrents(QTorrentHandle& h_ex, const QString& magnet_uri);
   void exportTorrentFile(const QTorrentHandle &h, TorrentExportFolder folder = RegularTorrentExportFolder);
   void initWebUi();
+  void initControlSocket();
   void handleIPFilterParsed(int ruleCount);
   void handleIPFilterError();
+  void applyBandwidthRule();
+#ifdef QBT_TRACING
+  void handleSlowTraceEvent(const QString &name, qint64 usecs);
+  void handleTraceDumped(const QString &path);
+#endif
 
 signals:
   void addedTorrent(const QTorrentHandle& h);
@@ -300,6 +330,7 @@ private:
   QString filterPath;
   // Web UI
   QPointer<HttpServer> httpServer;
+  QPointer<ControlServer> m_controlServer;
   QList<QUrl> url_skippingDlg;
   // GeoIP
 #ifndef DISABLE_GUI
@@ -318,7 +349,13 @@ private:
   // DynDNS
   DNSUpdater *m_dynDNSUpdater;
   QAlertDispatcher* m_alertDispatcher;
+  AlertLatencyStats* m_alertLatencyStats;
+  AlertWorkerPool* m_alertWorkers;
   TorrentStatistics* m_torrentStatistics;
+  SessionSnapshotService* m_snapshots;
+  QPointer<DiskCacheTuner> m_cacheTuner;
+  LabelBandwidth* m_labelBandwidth;
+  int m_ipFilterRuleCount;
 };
 
 #endif
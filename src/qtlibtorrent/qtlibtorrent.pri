@@ -7,13 +7,24 @@ HEADERS += $$PWD/qbtsession.h \
            $$PWD/torrentspeedmonitor.h \
            $$PWD/filterparserthread.h \
            $$PWD/alertdispatcher.h \
-           $$PWD/torrentstatistics.h
+           $$PWD/alertworkerpool.h \
+           $$PWD/alertlatencystats.h \
+           $$PWD/torrentstatistics.h \
+           $$PWD/sessionsnapshot.h \
+           $$PWD/diskcachetuner.h \
+           $$PWD/labelbandwidth.h
 
 SOURCES += $$PWD/qbtsession.cpp \
            $$PWD/qtorrenthandle.cpp \
            $$PWD/torrentspeedmonitor.cpp \
            $$PWD/alertdispatcher.cpp \
-           $$PWD/torrentstatistics.cpp
+           $$PWD/alertworkerpool.cpp \
+           $$PWD/alertlatencystats.cpp \
+           $$PWD/torrentstatistics.cpp \
+           $$PWD/sessionsnapshot.cpp \
+           $$PWD/diskcachetuner.cpp \
+           $$PWD/bandwidthscheduler.cpp \
+           $$PWD/labelbandwidth.cpp
 
 !contains(DEFINES, DISABLE_GUI) {
   HEADERS += $$PWD/torrentmodel.h \
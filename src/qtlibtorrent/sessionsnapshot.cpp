@@ -0,0 +1,136 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "sessionsnapshot.h"
+
+#include <QDateTime>
+
+#include <libtorrent/session.hpp>
+
+#include "qbtsession.h"
+#include "qtorrenthandle.h"
+#include "misc.h"
+
+SessionSnapshotService::SessionSnapshotService(QBtSession *session, QObject *parent)
+  : QObject(parent)
+  , m_session(session)
+  , m_snapshot(new SessionSnapshot)
+  , m_torrentPeers(0)
+{
+  connect(m_session, SIGNAL(stateUpdate(std::vector<libtorrent::torrent_status>)), SLOT(handleStateUpdate(std::vector<libtorrent::torrent_status>)));
+  connect(m_session, SIGNAL(deletedTorrent(QString)), SLOT(handleTorrentRemoved(QString)));
+  connect(&m_timer, SIGNAL(timeout()), SLOT(refresh()));
+  m_timer.start(1500);
+  refresh();
+}
+
+void SessionSnapshotService::setInterval(int msecs)
+{
+  if (msecs > 0 && msecs != m_timer.interval())
+    m_timer.start(msecs);
+}
+
+/**
+ * Returns "downloading", "stalledDL", "uploading", "stalledUP",
+ * "pausedDL", "pausedUP", "queuedDL", "queuedUP", "checkingDL",
+ * "checkingUP" or "error".
+ */
+QString SessionSnapshotService::torrentState(const libtorrent::torrent_status &status)
+{
+  if (QTorrentHandle::is_paused(status)) {
+    if (QTorrentHandle::has_error(status))
+      return "error";
+    return QTorrentHandle::is_seed(status) ? "pausedUP" : "pausedDL";
+  }
+  if (QBtSession::instance()->isQueueingEnabled() && QTorrentHandle::is_queued(status))
+    return QTorrentHandle::is_seed(status) ? "queuedUP" : "queuedDL";
+  switch (status.state) {
+  case libtorrent::torrent_status::finished:
+  case libtorrent::torrent_status::seeding:
+    return status.upload_payload_rate > 0 ? "uploading" : "stalledUP";
+  case libtorrent::torrent_status::allocating:
+  case libtorrent::torrent_status::checking_files:
+  case libtorrent::torrent_status::queued_for_checking:
+  case libtorrent::torrent_status::checking_resume_data:
+    return QTorrentHandle::is_seed(status) ? "checkingUP" : "checkingDL";
+  case libtorrent::torrent_status::downloading:
+  case libtorrent::torrent_status::downloading_metadata:
+    return status.download_payload_rate > 0 ? "downloading" : "stalledDL";
+  default:
+    qWarning("Unrecognized torrent status, should not happen!!! status was %d", status.state);
+  }
+  return QString();
+}
+
+void SessionSnapshotService::refresh()
+{
+  libtorrent::session *s = m_session->getSession();
+  // Answered by a state_update_alert, used by the next snapshot
+  s->post_torrent_updates();
+
+  SessionSnapshot *snapshot = new SessionSnapshot;
+  snapshot->status = s->status();
+  snapshot->cache = s->get_cache_status();
+  snapshot->listening = s->is_listening();
+  snapshot->torrentPeers = m_torrentPeers;
+  snapshot->torrentStates = m_stateCounts;
+  snapshot->timestamp = QDateTime::currentMSecsSinceEpoch();
+  m_snapshot = SessionSnapshotPtr(snapshot);
+  emit snapshotUpdated();
+}
+
+void SessionSnapshotService::handleStateUpdate(const std::vector<libtorrent::torrent_status> &statuses)
+{
+  // Only the torrents that changed since the previous update are listed
+  std::vector<libtorrent::torrent_status>::const_iterator it = statuses.begin();
+  std::vector<libtorrent::torrent_status>::const_iterator end = statuses.end();
+  for ( ; it != end; ++it) {
+    const QString hash = misc::toQString(it->handle.info_hash());
+    int &peers = m_peers[hash];
+    m_torrentPeers += it->num_peers - peers;
+    peers = it->num_peers;
+    const QString state = torrentState(*it);
+    QString &previous = m_states[hash];
+    if (previous != state) {
+      if (!previous.isNull() && --m_stateCounts[previous] <= 0)
+        m_stateCounts.remove(previous);
+      ++m_stateCounts[state];
+      previous = state;
+    }
+  }
+}
+
+void SessionSnapshotService::handleTorrentRemoved(const QString &hash)
+{
+  m_torrentPeers -= m_peers.take(hash);
+  const QString state = m_states.take(hash);
+  if (!state.isNull() && --m_stateCounts[state] <= 0)
+    m_stateCounts.remove(state);
+}
@@ -0,0 +1,103 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QTimer>
+
+#include <vector>
+
+#include <libtorrent/session_status.hpp>
+#include <libtorrent/disk_io_thread.hpp>
+#include <libtorrent/torrent_handle.hpp>
+
+class QBtSession;
+
+// Session wide state, never modified once published
+struct SessionSnapshot {
+  SessionSnapshot(): listening(false), torrentPeers(0), timestamp(0) {}
+
+  libtorrent::session_status status;
+  libtorrent::cache_status cache;
+  bool listening;
+  // Sum of the torrents num_peers
+  int torrentPeers;
+  // Torrent count per state, as shown by the Web UI
+  QHash<QString, int> torrentStates;
+  // Milliseconds since the epoch
+  qint64 timestamp;
+};
+
+typedef QSharedPointer<const SessionSnapshot> SessionSnapshotPtr;
+
+// Takes the session snapshot once per tick, so the GUI, the status bar,
+// the tray icon and the Web UI don't query the libtorrent network thread
+// on their own. The torrent peers come from the state updates posted on
+// each tick, which arrive asynchronously through the alerts.
+class SessionSnapshotService : public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(SessionSnapshotService)
+
+public:
+  SessionSnapshotService(QBtSession *session, QObject *parent = 0);
+
+  // The latest snapshot, it stays valid as long as it is referenced
+  inline SessionSnapshotPtr snapshot() const { return m_snapshot; }
+  void setInterval(int msecs);
+  // State of a torrent as shown by the Web UI and counted in the snapshot
+  static QString torrentState(const libtorrent::torrent_status &status);
+
+public slots:
+  void refresh();
+
+signals:
+  void snapshotUpdated();
+
+private slots:
+  void handleStateUpdate(const std::vector<libtorrent::torrent_status> &statuses);
+  void handleTorrentRemoved(const QString &hash);
+
+private:
+  QBtSession *m_session;
+  QTimer m_timer;
+  SessionSnapshotPtr m_snapshot;
+  QHash<QString, int> m_peers;
+  int m_torrentPeers;
+  QHash<QString, QString> m_states;
+  QHash<QString, int> m_stateCounts;
+};
+
+#endif // SESSIONSNAPSHOT_H
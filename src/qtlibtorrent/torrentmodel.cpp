@@ -33,7 +33,9 @@
 #include "torrentmodel.h"
 #include "torrentpersistentdata.h"
 #include "qbtsession.h"
+#include "labelbandwidth.h"
 #include "fs_utils.h"
+#include "tracer.h"
 
 using namespace libtorrent;
 
@@ -456,8 +458,8 @@ void TorrentModel::setRefreshInterval(int refreshInterval)
 
 void TorrentModel::forceModelRefresh()
 {
+  // The state updates are posted by the session snapshot service
   emit dataChanged(index(0, 0), index(rowCount()-1, columnCount()-1));
-  QBtSession::instance()->postTorrentUpdate();
 }
 
 TorrentStatusReport TorrentModel::getTorrentStatusReport() const
@@ -515,6 +517,8 @@ Qt::ItemFlags TorrentModel::flags(const QModelIndex &index) const
 void TorrentModel::handleTorrentLabelChange(QString previous, QString current)
 {
   emit torrentChangedLabel(static_cast<TorrentModelItem*>(sender()), previous, current);
+  // The torrent may join or leave a label bandwidth class
+  QBtSession::instance()->getLabelBandwidth()->scheduleApply();
 }
 
 QString TorrentModel::torrentHash(int row) const
@@ -533,6 +537,7 @@ void TorrentModel::handleTorrentAboutToBeRemoved(const QTorrentHandle &h)
 }
 
 void TorrentModel::stateUpdated(const std::vector<libtorrent::torrent_status> &statuses) {
+  QBT_TRACE_SCOPE("TorrentModel::stateUpdated");
   typedef std::vector<libtorrent::torrent_status> statuses_t;
 
   for (statuses_t::const_iterator i = statuses.begin(), end = statuses.end(); i != end; ++i) {
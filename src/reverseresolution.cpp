@@ -0,0 +1,164 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+
+#include "reverseresolution.h"
+
+#include <QDebug>
+#include <QHostInfo>
+
+namespace {
+  const int CACHE_SIZE = 10000;
+  const int MAX_CONCURRENT_LOOKUPS = 8;
+  const qint64 POSITIVE_TTL = 60 * 60 * 1000; // 1 hour
+  const qint64 NEGATIVE_TTL = 5 * 60 * 1000; // 5 min
+  const int FLUSH_DELAY = 250; // msecs
+}
+
+ReverseResolution* ReverseResolution::m_instance = 0;
+
+ReverseResolution::ReverseResolution()
+{
+  m_cache.setMaxCost(CACHE_SIZE);
+  m_clock.start();
+  m_flushTimer.setSingleShot(true);
+  connect(&m_flushTimer, SIGNAL(timeout()), SLOT(flushResolved()));
+}
+
+ReverseResolution::~ReverseResolution()
+{
+  qDebug("Deleting host name resolver...");
+  foreach (int lookup_id, m_lookups.keys())
+    QHostInfo::abortHostLookup(lookup_id);
+}
+
+ReverseResolution* ReverseResolution::instance()
+{
+  if (!m_instance)
+    m_instance = new ReverseResolution;
+  return m_instance;
+}
+
+void ReverseResolution::drop()
+{
+  if (m_instance) {
+    delete m_instance;
+    m_instance = 0;
+  }
+}
+
+void ReverseResolution::resolve(const QString &ip)
+{
+  if (m_inFlight.contains(ip) || m_queued.contains(ip))
+    return;
+  const CacheEntry *entry = m_cache.object(ip);
+  if (entry) {
+    if (entry->expires > m_clock.elapsed()) {
+      qDebug() << "Resolved host name using cache: " << ip << " -> " << entry->hostname;
+      reportResolved(ip, entry->hostname);
+      return;
+    }
+    m_cache.remove(ip);
+  }
+  m_queue << ip;
+  m_queued << ip;
+  startLookups();
+}
+
+void ReverseResolution::prioritize(const QStringList &ips)
+{
+  for (int i = ips.size() - 1; i >= 0; --i) {
+    const QString &ip = ips.at(i);
+    if (m_queued.contains(ip) && m_queue.removeOne(ip))
+      m_queue.prepend(ip);
+  }
+}
+
+void ReverseResolution::cancelPending()
+{
+  m_queue.clear();
+  m_queued.clear();
+  m_resolved.clear();
+  m_flushTimer.stop();
+}
+
+void ReverseResolution::startLookups()
+{
+  while (m_lookups.size() < MAX_CONCURRENT_LOOKUPS && !m_queue.isEmpty()) {
+    const QString ip = m_queue.takeFirst();
+    m_queued.remove(ip);
+    m_inFlight << ip;
+    m_lookups.insert(QHostInfo::lookupHost(ip, this, SLOT(hostResolved(QHostInfo))), ip);
+  }
+}
+
+void ReverseResolution::hostResolved(const QHostInfo &host)
+{
+  const QString ip = m_lookups.take(host.lookupId());
+  Q_ASSERT(!ip.isNull());
+  m_inFlight.remove(ip);
+
+  CacheEntry *entry = new CacheEntry;
+  if (host.error() != QHostInfo::NoError) {
+    qDebug() << "DNS Reverse resolution error: " << host.errorString();
+    entry->expires = m_clock.elapsed() + NEGATIVE_TTL;
+  } else {
+    qDebug() << Q_FUNC_INFO << ip << QString("->") << host.hostName();
+    entry->hostname = host.hostName();
+    entry->expires = m_clock.elapsed() + (isUsefulHostName(entry->hostname, ip) ? POSITIVE_TTL : NEGATIVE_TTL);
+  }
+  const QString hostname = entry->hostname;
+  m_cache.insert(ip, entry);
+  reportResolved(ip, hostname);
+  startLookups();
+}
+
+void ReverseResolution::reportResolved(const QString &ip, const QString &hostname)
+{
+  if (!isUsefulHostName(hostname, ip))
+    return;
+  m_resolved.insert(ip, hostname);
+  if (!m_flushTimer.isActive())
+    m_flushTimer.start(FLUSH_DELAY);
+}
+
+void ReverseResolution::flushResolved()
+{
+  if (m_resolved.isEmpty())
+    return;
+  const QHash<QString, QString> resolved = m_resolved;
+  m_resolved.clear();
+  emit ipsResolved(resolved);
+}
+
+bool ReverseResolution::isUsefulHostName(const QString &hostname, const QString &ip)
+{
+  return (!hostname.isEmpty() && hostname != ip);
+}
@@ -28,78 +28,71 @@
  * Contact : chris@qbittorrent.org
  */
 
+
 #ifndef REVERSERESOLUTION_H
 #define REVERSERESOLUTION_H
 
-#include <QList>
 #include <QCache>
-#include <QDebug>
-#include <QHostInfo>
-#include "misc.h"
-
-#include <boost/version.hpp>
-#if BOOST_VERSION < 103500
-#include <libtorrent/asio/ip/tcp.hpp>
-#else
-#include <boost/asio/ip/tcp.hpp>
-#endif
-
-const int CACHE_SIZE = 500;
-
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QHostInfo;
+QT_END_NAMESPACE
+
+// Shared reverse DNS resolver for the peer lists.
+// Requests for an address which is already queued or being looked up are
+// coalesced, at most MAX_CONCURRENT_LOOKUPS lookups run at the same time and
+// the results (including the failures) are cached for a limited time.
+// Resolved host names are reported in batches.
 class ReverseResolution: public QObject {
   Q_OBJECT
   Q_DISABLE_COPY(ReverseResolution)
 
 public:
-  explicit ReverseResolution(QObject* parent): QObject(parent) {
-    m_cache.setMaxCost(CACHE_SIZE);
-  }
-
-  ~ReverseResolution() {
-    qDebug("Deleting host name resolver...");
-  }
+  static ReverseResolution* instance();
+  static void drop();
 
-  void resolve(const QString &ip) {
-    if (m_cache.contains(ip)) {
-      const QString& hostname = *m_cache.object(ip);
-      qDebug() << "Resolved host name using cache: " << ip << " -> " << hostname;
-      if (isUsefulHostName(hostname, ip))
-        emit ip_resolved(ip, hostname);
-      return;
-    }
-    // Actually resolve the ip
-    m_lookups.insert(QHostInfo::lookupHost(ip, this, SLOT(hostResolved(QHostInfo))), ip);
-  }
+  void resolve(const QString &ip);
+  // Moves the given addresses to the front of the queue
+  void prioritize(const QStringList &ips);
+  // Forgets the queued requests, the running lookups still complete
+  void cancelPending();
 
 signals:
-  void ip_resolved(const QString &ip, const QString &hostname);
+  void ipsResolved(const QHash<QString, QString> &hostnames);
 
 private slots:
-  void hostResolved(const QHostInfo& host) {
-    const QString& ip = m_lookups.take(host.lookupId());
-    Q_ASSERT(!ip.isNull());
+  void hostResolved(const QHostInfo &host);
+  void flushResolved();
 
-    if (host.error() != QHostInfo::NoError) {
-      qDebug() << "DNS Reverse resolution error: " << host.errorString();
-      return;
-    }
+private:
+  struct CacheEntry {
+    // Empty if the address could not be resolved
+    QString hostname;
+    qint64 expires;
+  };
 
-    const QString& hostname = host.hostName();
+  ReverseResolution();
+  ~ReverseResolution();
 
-    qDebug() << Q_FUNC_INFO << ip << QString("->") << hostname;
-    m_cache.insert(ip, new QString(hostname));
-    if (isUsefulHostName(hostname, ip))
-      emit ip_resolved(ip, hostname);
-  }
+  void startLookups();
+  void reportResolved(const QString &ip, const QString &hostname);
+  static bool isUsefulHostName(const QString &hostname, const QString &ip);
 
 private:
-  static inline bool isUsefulHostName(const QString& hostname, const QString& ip) {
-    return (!hostname.isEmpty() && hostname != ip);
-  }
-
+  static ReverseResolution *m_instance;
+  QList<QString> m_queue;
+  QSet<QString> m_queued;
   QHash<int /* LookupID */, QString /* IP */> m_lookups;
-  QCache<QString /* IP */, QString /* HostName */> m_cache;
+  QSet<QString> m_inFlight;
+  QCache<QString /* IP */, CacheEntry> m_cache;
+  QElapsedTimer m_clock;
+  QHash<QString, QString> m_resolved;
+  QTimer m_flushTimer;
 };
 
-
 #endif // REVERSERESOLUTION_H
@@ -8,10 +8,12 @@ HEADERS +=    $$PWD/rss_imp.h \
               $$PWD/rssfolder.h \
               $$PWD/rssfile.h \
               $$PWD/rssarticle.h \
+              $$PWD/rssarticlestore.h \
               $$PWD/automatedrssdownloader.h \
               $$PWD/rsssettings.h \
               $$PWD/rssdownloadrule.h \
               $$PWD/rssdownloadrulelist.h \
+              $$PWD/rssliteralmatcher.h \
               $$PWD/cookiesdlg.h \
               $$PWD/rssparser.h
 
@@ -22,9 +24,11 @@ SOURCES +=   $$PWD/rss_imp.cpp \
              $$PWD/rssfeed.cpp \
              $$PWD/rssfolder.cpp \
              $$PWD/rssarticle.cpp \
+             $$PWD/rssarticlestore.cpp \
              $$PWD/automatedrssdownloader.cpp \
              $$PWD/rssdownloadrule.cpp \
              $$PWD/rssdownloadrulelist.cpp \
+             $$PWD/rssliteralmatcher.cpp \
              $$PWD/cookiesdlg.cpp \
              $$PWD/rssfile.cpp \
              $$PWD/rssparser.cpp
@@ -51,6 +51,7 @@
 #include "automatedrssdownloader.h"
 #include "iconprovider.h"
 #include "autoexpandabledialog.h"
+#include "misc.h"
 
 namespace Article {
 enum ArticleRoles {
@@ -639,6 +640,12 @@ void RSSImp::updateFeedInfos(const QString& url, const QString& display_name, ui
   item->setText(0, display_name + QString::fromUtf8("  (") + QString::number(nbUnread)+ QString(")"));
   if (!stream->isLoading())
     item->setData(0, Qt::DecorationRole, QVariant(stream->icon()));
+  const RssFeedFetchStats& stats = stream->fetchStats();
+  item->setToolTip(0, tr("Requests: %1 (not modified: %2, failed: %3)\nReceived: %4\nLast parse time: %5 ms\nNext refresh: %6")
+                   .arg(stats.requests).arg(stats.notModified).arg(stats.failures)
+                   .arg(misc::friendlyUnit(stats.bytesReceived))
+                   .arg(stats.lastParseTime)
+                   .arg(stream->nextRefresh().toString(Qt::DefaultLocaleShortDate)));
   // Update parent
   if (item->parent())
     updateItemInfos(item->parent());
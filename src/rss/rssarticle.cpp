@@ -34,10 +34,12 @@
 
 #include "rssarticle.h"
 #include "rssfeed.h"
+#include "rssarticlestore.h"
 
 // public constructor
 RssArticle::RssArticle(RssFeed* parent, const QString& guid):
-  m_parent(parent), m_guid(guid), m_read(false) {}
+  m_parent(parent), m_guid(guid), m_descriptionLoaded(true),
+  m_descriptionOffset(-1), m_descriptionSize(0), m_read(false) {}
 
 bool RssArticle::hasAttachment() const {
   return !m_torrentUrl.isEmpty();
@@ -49,13 +51,41 @@ QVariantHash RssArticle::toHash() const {
   item["id"] = m_guid;
   item["torrent_url"] = m_torrentUrl;
   item["news_link"] = m_link;
-  item["description"] = m_description;
+  item["description"] = description();
   item["date"] = m_date;
   item["author"] = m_author;
   item["read"] = m_read;
   return item;
 }
 
+RssArticleRecord RssArticle::toRecord() const {
+  RssArticleRecord record;
+  record.guid = m_guid;
+  record.title = m_title;
+  record.torrentUrl = m_torrentUrl;
+  record.link = m_link;
+  record.author = m_author;
+  record.date = m_date;
+  record.read = m_read;
+  record.descriptionOffset = m_descriptionOffset;
+  record.descriptionSize = m_descriptionSize;
+  // Only descriptions that are not stored yet need to be written
+  if (m_descriptionOffset < 0)
+    record.description = m_description;
+  return record;
+}
+
+void RssArticle::setDescriptionLocation(qint64 offset, qint32 size) {
+  if (offset == m_descriptionOffset && size == m_descriptionSize)
+    return;
+  m_descriptionOffset = offset;
+  m_descriptionSize = size;
+  if (offset >= 0) {
+    m_description.clear();
+    m_descriptionLoaded = false;
+  }
+}
+
 RssArticlePtr hashToRssArticle(RssFeed* parent, const QVariantHash& h) {
   const QString guid = h.value("id").toString();
   if (guid.isEmpty())
@@ -73,6 +103,25 @@ RssArticlePtr hashToRssArticle(RssFeed* parent, const QVariantHash& h) {
   return art;
 }
 
+RssArticlePtr recordToRssArticle(RssFeed* parent, const RssArticleRecord& r) {
+  if (r.guid.isEmpty())
+    return RssArticlePtr();
+
+  RssArticlePtr art(new RssArticle(parent, r.guid));
+  art->m_title = r.title;
+  art->m_torrentUrl = r.torrentUrl;
+  art->m_link = r.link;
+  art->m_description = r.description;
+  art->m_descriptionOffset = r.descriptionOffset;
+  art->m_descriptionSize = r.descriptionSize;
+  art->m_descriptionLoaded = r.descriptionOffset < 0;
+  art->m_date = r.date;
+  art->m_author = r.author;
+  art->m_read = r.read;
+
+  return art;
+}
+
 RssFeed* RssArticle::parent() const {
   return m_parent;
 }
@@ -91,6 +140,10 @@ const QString& RssArticle::link() const {
 
 QString RssArticle::description() const
 {
+  if (!m_descriptionLoaded) {
+    m_description = m_parent->articleStore().readDescription(m_descriptionOffset, m_descriptionSize);
+    m_descriptionLoaded = true;
+  }
   return m_description.isNull() ? "" : m_description;
 }
 
@@ -38,6 +38,7 @@
 
 class RssFeed;
 class RssArticle;
+struct RssArticleRecord;
 
 typedef QSharedPointer<RssArticle> RssArticlePtr;
 
@@ -62,6 +63,10 @@ public:
   void markAsRead();
   // Serialization
   QVariantHash toHash() const;
+  RssArticleRecord toRecord() const;
+  // Called once the description has been written to the article store,
+  // it is then dropped from memory and read back on demand
+  void setDescriptionLocation(qint64 offset, qint32 size);
 
 signals:
   void articleWasRead();
@@ -70,6 +75,7 @@ public slots:
   void handleTorrentDownloadSuccess(const QString& url);
 
   friend RssArticlePtr hashToRssArticle(RssFeed* parent, const QVariantHash& hash);
+  friend RssArticlePtr recordToRssArticle(RssFeed* parent, const RssArticleRecord& record);
 
 private:
   RssFeed* m_parent;
@@ -77,12 +83,16 @@ private:
   QString m_title;
   QString m_torrentUrl;
   QString m_link;
-  QString m_description;
+  mutable QString m_description;
+  mutable bool m_descriptionLoaded;
+  qint64 m_descriptionOffset;
+  qint32 m_descriptionSize;
   QDateTime m_date;
   QString m_author;
   bool m_read;
 };
 
 RssArticlePtr hashToRssArticle(RssFeed* parent, const QVariantHash& hash);
+RssArticlePtr recordToRssArticle(RssFeed* parent, const RssArticleRecord& record);
 
 #endif // RSSARTICLE_H
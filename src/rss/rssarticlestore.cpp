@@ -0,0 +1,288 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QVariant>
+
+#include "rssarticlestore.h"
+#include "fs_utils.h"
+#include "qinisettings.h"
+
+static const quint32 INDEX_MAGIC = 0x51425241; // "QBRA"
+static const quint32 INDEX_VERSION = 2;
+// Description files smaller than this are never compacted
+static const qint64 MIN_COMPACTION_SIZE = 256 * 1024;
+
+RssArticleStore::RssArticleStore(const QString &feedUrl):
+  m_generation(0)
+{
+  const QByteArray hash = QCryptographicHash::hash(feedUrl.toUtf8(), QCryptographicHash::Sha1);
+  m_path = storageLocation() + QLatin1Char('/') + QString::fromLatin1(hash.toHex());
+}
+
+QString RssArticleStore::storageLocation()
+{
+  return fsutils::expandPathAbs(fsutils::QDesktopServicesDataLocation() + "rss/articles");
+}
+
+QString RssArticleStore::indexPath() const
+{
+  return m_path + QLatin1String("/articles.idx");
+}
+
+QString RssArticleStore::descriptionsPath(quint32 generation) const
+{
+  return m_path + QString::fromLatin1("/descriptions-%1.dat").arg(generation);
+}
+
+QList<RssArticleRecord> RssArticleStore::load()
+{
+  QList<RssArticleRecord> records;
+  QFile index(indexPath());
+  // A crash between removing the old index and renaming the new one
+  // leaves only the temporary file behind
+  if (!index.exists())
+    index.setFileName(indexPath() + QLatin1String(".tmp"));
+  if (!index.open(QIODevice::ReadOnly))
+    return records;
+
+  QDataStream in(&index);
+  in.setVersion(QDataStream::Qt_4_5);
+  quint32 magic, version;
+  qint32 count;
+  in >> magic >> version;
+  if (magic != INDEX_MAGIC || version > INDEX_VERSION) {
+    qWarning() << "Unsupported RSS article index:" << index.fileName();
+    return records;
+  }
+  in >> m_generation;
+  // Version 1 had no feed data
+  if (version >= 2)
+    in >> m_feedData;
+  in >> count;
+  for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    RssArticleRecord r;
+    in >> r.guid >> r.title >> r.torrentUrl >> r.link >> r.author >> r.date >> r.read
+       >> r.descriptionOffset >> r.descriptionSize;
+    if (in.status() == QDataStream::Ok)
+      records << r;
+  }
+  if (in.status() != QDataStream::Ok)
+    qWarning() << "Truncated RSS article index:" << index.fileName();
+  return records;
+}
+
+bool RssArticleStore::save(QList<RssArticleRecord> &records)
+{
+  QDir().mkpath(m_path);
+  if (!appendDescriptions(records))
+    return false;
+
+  qint64 liveSize = 0;
+  foreach (const RssArticleRecord &r, records) {
+    if (r.descriptionOffset >= 0)
+      liveSize += r.descriptionSize;
+  }
+  const qint64 fileSize = QFileInfo(descriptionsPath(m_generation)).size();
+  if (fileSize > MIN_COMPACTION_SIZE && liveSize * 2 < fileSize)
+    return compactDescriptions(records);
+
+  return writeIndex(records);
+}
+
+bool RssArticleStore::appendDescriptions(QList<RssArticleRecord> &records)
+{
+  QFile data(descriptionsPath(m_generation));
+  qint64 offset = data.size();
+  QByteArray pending;
+  QList<RssArticleRecord>::Iterator it = records.begin();
+  QList<RssArticleRecord>::Iterator itend = records.end();
+  for ( ; it != itend; ++it) {
+    if (it->descriptionOffset >= 0 || it->description.isEmpty())
+      continue;
+    const QByteArray utf8 = it->description.toUtf8();
+    it->descriptionOffset = offset + pending.size();
+    it->descriptionSize = utf8.size();
+    pending += utf8;
+  }
+  if (pending.isEmpty())
+    return true;
+
+  bool ok = data.open(QIODevice::WriteOnly | QIODevice::Append)
+      && data.write(pending) == pending.size();
+  data.close();
+  for (it = records.begin(); it != itend; ++it) {
+    if (it->description.isEmpty())
+      continue;
+    if (ok)
+      it->description.clear();
+    else
+      it->descriptionOffset = -1;
+  }
+  if (!ok)
+    qWarning() << "Failed to write RSS article descriptions to" << data.fileName();
+  return ok;
+}
+
+bool RssArticleStore::compactDescriptions(QList<RssArticleRecord> &records)
+{
+  const quint32 oldGeneration = m_generation;
+  QFile oldData(descriptionsPath(oldGeneration));
+  if (!oldData.open(QIODevice::ReadOnly))
+    return writeIndex(records);
+  const QByteArray oldContent = oldData.readAll();
+  oldData.close();
+
+  QByteArray newContent;
+  QList<RssArticleRecord> compacted = records;
+  QList<RssArticleRecord>::Iterator it = compacted.begin();
+  QList<RssArticleRecord>::Iterator itend = compacted.end();
+  for ( ; it != itend; ++it) {
+    if (it->descriptionOffset < 0)
+      continue;
+    const qint64 newOffset = newContent.size();
+    newContent += oldContent.mid(it->descriptionOffset, it->descriptionSize);
+    it->descriptionOffset = newOffset;
+  }
+
+  QFile newData(descriptionsPath(oldGeneration + 1));
+  if (!newData.open(QIODevice::WriteOnly | QIODevice::Truncate)
+      || newData.write(newContent) != newContent.size()) {
+    qWarning() << "Failed to compact RSS article descriptions into" << newData.fileName();
+    newData.close();
+    newData.remove();
+    return writeIndex(records);
+  }
+  newData.close();
+
+  m_generation = oldGeneration + 1;
+  if (!writeIndex(compacted)) {
+    m_generation = oldGeneration;
+    newData.remove();
+    return false;
+  }
+  records = compacted;
+  oldData.remove();
+  qDebug("Compacted RSS descriptions of %s: %d -> %d bytes", qPrintable(m_path),
+         oldContent.size(), newContent.size());
+  return true;
+}
+
+bool RssArticleStore::writeIndex(const QList<RssArticleRecord> &records)
+{
+  const QString tmpPath = indexPath() + QLatin1String(".tmp");
+  QFile tmp(tmpPath);
+  if (!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "Failed to write RSS article index" << tmpPath;
+    return false;
+  }
+  QDataStream out(&tmp);
+  out.setVersion(QDataStream::Qt_4_5);
+  out << INDEX_MAGIC << INDEX_VERSION << m_generation << m_feedData << (qint32) records.size();
+  foreach (const RssArticleRecord &r, records) {
+    out << r.guid << r.title << r.torrentUrl << r.link << r.author << r.date << r.read
+        << r.descriptionOffset << r.descriptionSize;
+  }
+  tmp.close();
+  if (out.status() != QDataStream::Ok) {
+    tmp.remove();
+    return false;
+  }
+  // QFile::rename() does not overwrite existing files
+  QFile::remove(indexPath());
+  return QFile::rename(tmpPath, indexPath());
+}
+
+QString RssArticleStore::readDescription(qint64 offset, qint32 size) const
+{
+  if (offset < 0 || size <= 0)
+    return QString();
+  QFile data(descriptionsPath(m_generation));
+  if (!data.open(QIODevice::ReadOnly) || !data.seek(offset))
+    return QString();
+  return QString::fromUtf8(data.read(size));
+}
+
+void RssArticleStore::remove()
+{
+  QDir dir(m_path);
+  if (!dir.exists())
+    return;
+  foreach (const QString &file, dir.entryList(QDir::Files))
+    fsutils::forceRemove(dir.absoluteFilePath(file));
+  dir.rmdir(m_path);
+}
+
+void RssArticleStore::migrateFromSettings()
+{
+  QIniSettings qBTRSS("qBittorrent", "qBittorrent-rss");
+  if (!qBTRSS.contains("old_items"))
+    return;
+
+  const QVariantHash all_old_items = qBTRSS.value("old_items").toHash();
+  bool ok = true;
+  QVariantHash::ConstIterator it = all_old_items.begin();
+  QVariantHash::ConstIterator itend = all_old_items.end();
+  for ( ; it != itend; ++it) {
+    QList<RssArticleRecord> records;
+    foreach (const QVariant &var_it, it.value().toList()) {
+      const QVariantHash h = var_it.toHash();
+      RssArticleRecord r;
+      r.guid = h.value("id").toString();
+      if (r.guid.isEmpty())
+        continue;
+      r.title = h.value("title").toString();
+      r.torrentUrl = h.value("torrent_url").toString();
+      r.link = h.value("news_link").toString();
+      r.author = h.value("author").toString();
+      r.date = h.value("date").toDateTime();
+      r.read = h.value("read", false).toBool();
+      r.description = h.value("description").toString();
+      records << r;
+    }
+    RssArticleStore store(it.key());
+    store.remove();
+    if (!store.save(records))
+      ok = false;
+  }
+
+  if (ok) {
+    qDebug("Migrated RSS articles of %d feeds to the article store", all_old_items.size());
+    qBTRSS.remove("old_items");
+  }
+  else {
+    qWarning("Failed to migrate the RSS articles to the article store, keeping the old data");
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef RSSARTICLESTORE_H
+#define RSSARTICLESTORE_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QVariantHash>
+
+// Serialized form of an RssArticle. The description is only held in
+// memory until it has been appended to the description file, after
+// which it is referenced by offset/size and read back on demand.
+struct RssArticleRecord {
+  RssArticleRecord(): read(false), descriptionOffset(-1), descriptionSize(0) {}
+  QString guid;
+  QString title;
+  QString torrentUrl;
+  QString link;
+  QString author;
+  QDateTime date;
+  bool read;
+  QString description;
+  qint64 descriptionOffset;
+  qint32 descriptionSize;
+};
+
+// On-disk article storage of a single RSS feed.
+//
+// Each feed gets its own directory (named after the SHA-1 of its URL) with:
+//  - articles.idx: article metadata without descriptions. It is small and
+//    rewritten atomically whenever the feed is saved.
+//  - descriptions-<generation>.dat: append-only UTF-8 descriptions. Once
+//    most of it is unreferenced it is compacted into a new generation and
+//    the index is switched over to it.
+//
+// Saving a feed therefore never touches the data of the other feeds, and
+// loading a feed does not need to parse every description.
+class RssArticleStore {
+public:
+  explicit RssArticleStore(const QString &feedUrl);
+
+  QList<RssArticleRecord> load();
+  // Appends pending descriptions and rewrites the index. The records are
+  // updated in place with their new description locations.
+  bool save(QList<RssArticleRecord> &records);
+  QString readDescription(qint64 offset, qint32 size) const;
+  // Feed level data saved along with the index (e.g. HTTP validators)
+  const QVariantHash& feedData() const { return m_feedData; }
+  void setFeedData(const QVariantHash &data) { m_feedData = data; }
+  void remove();
+
+  // One-time conversion of the legacy "old_items" hash stored in
+  // qBittorrent-rss.ini. Must be called before the feeds are loaded.
+  static void migrateFromSettings();
+
+private:
+  QString indexPath() const;
+  QString descriptionsPath(quint32 generation) const;
+  bool appendDescriptions(QList<RssArticleRecord> &records);
+  bool compactDescriptions(QList<RssArticleRecord> &records);
+  bool writeIndex(const QList<RssArticleRecord> &records);
+  static QString storageLocation();
+
+private:
+  QString m_path;
+  quint32 m_generation;
+  QVariantHash m_feedData;
+};
+
+#endif // RSSARTICLESTORE_H
@@ -37,27 +37,84 @@
 #include "rssfeed.h"
 #include "rssarticle.h"
 
-RssDownloadRule::RssDownloadRule(): m_enabled(false), m_useRegex(false)
+RssDownloadRule::RssDownloadRule(): m_enabled(false), m_useRegex(false), m_revision(0), m_compiled(false)
 {
 }
 
-bool RssDownloadRule::matches(const QString &article_title) const
+// A wildcard token without any special character is a plain substring
+bool RssDownloadRule::isLiteralToken(const QString &token)
 {
+  static const QString wildcardChars = QString::fromLatin1("*?[]\\");
+  for (int i = 0; i < token.size(); ++i) {
+    if (wildcardChars.contains(token.at(i)))
+      return false;
+  }
+  return true;
+}
+
+void RssDownloadRule::compile() const
+{
+  m_literalMustContain.clear();
+  m_patternMustContain.clear();
+  m_literalMustNotContain.clear();
+  m_patternMustNotContain.clear();
+  const QRegExp::PatternSyntax syntax = m_useRegex ? QRegExp::RegExp : QRegExp::Wildcard;
+
   foreach (const QString& token, m_mustContain) {
-    if (!token.isEmpty()) {
-      QRegExp reg(token, Qt::CaseInsensitive, m_useRegex ? QRegExp::RegExp : QRegExp::Wildcard);
-      if (reg.indexIn(article_title) < 0)
-        return false;
-    }
+    if (token.isEmpty())
+      continue;
+    if (!m_useRegex && isLiteralToken(token))
+      m_literalMustContain << token.toLower();
+    else
+      m_patternMustContain << QRegExp(token, Qt::CaseInsensitive, syntax);
+  }
+  foreach (const QString& token, m_mustNotContain) {
+    if (token.isEmpty())
+      continue;
+    if (!m_useRegex && isLiteralToken(token))
+      m_literalMustNotContain << token.toLower();
+    else
+      m_patternMustNotContain << QRegExp(token, Qt::CaseInsensitive, syntax);
+  }
+  m_compiled = true;
+}
+
+QStringList RssDownloadRule::literalMustContain() const
+{
+  if (!m_compiled)
+    compile();
+  return m_literalMustContain;
+}
+
+bool RssDownloadRule::matches(const QString &article_title) const
+{
+  if (!m_compiled)
+    compile();
+  const QString lowered_title = article_title.toLower();
+  foreach (const QString& token, m_literalMustContain) {
+    if (!lowered_title.contains(token))
+      return false;
+  }
+  return matchesRemainingTokens(article_title, lowered_title);
+}
+
+bool RssDownloadRule::matchesRemainingTokens(const QString &article_title, const QString &lowered_title) const
+{
+  if (!m_compiled)
+    compile();
+  for (int i = 0; i < m_patternMustContain.size(); ++i) {
+    if (m_patternMustContain[i].indexIn(article_title) < 0)
+      return false;
   }
   qDebug("Checking not matching tokens");
   // Checking not matching
-  foreach (const QString& token, m_mustNotContain) {
-    if (!token.isEmpty()) {
-      QRegExp reg(token, Qt::CaseInsensitive, m_useRegex ? QRegExp::RegExp : QRegExp::Wildcard);
-      if (reg.indexIn(article_title) > -1)
-        return false;
-    }
+  foreach (const QString& token, m_literalMustNotContain) {
+    if (lowered_title.contains(token))
+      return false;
+  }
+  for (int i = 0; i < m_patternMustNotContain.size(); ++i) {
+    if (m_patternMustNotContain[i].indexIn(article_title) > -1)
+      return false;
   }
   return true;
 }
@@ -68,6 +125,8 @@ void RssDownloadRule::setMustContain(const QString &tokens)
     m_mustContain = QStringList() << tokens;
   else
     m_mustContain = tokens.split(" ");
+  m_compiled = false;
+  ++m_revision;
 }
 
 void RssDownloadRule::setMustNotContain(const QString &tokens)
@@ -76,6 +135,15 @@ void RssDownloadRule::setMustNotContain(const QString &tokens)
     m_mustNotContain = QStringList() << tokens;
   else
     m_mustNotContain = tokens.split(QRegExp("[\\s|]"));
+  m_compiled = false;
+  ++m_revision;
+}
+
+void RssDownloadRule::setUseRegex(bool enabled)
+{
+  m_useRegex = enabled;
+  m_compiled = false;
+  ++m_revision;
 }
 
 RssDownloadRulePtr RssDownloadRule::fromVariantHash(const QVariantHash &rule_hash)
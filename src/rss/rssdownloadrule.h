@@ -34,6 +34,7 @@
 #include <QStringList>
 #include <QVariantHash>
 #include <QSharedPointer>
+#include <QRegExp>
 
 class RssFeed;
 typedef QSharedPointer<RssFeed> RssFeedPtr;
@@ -49,10 +50,17 @@ public:
   static RssDownloadRulePtr fromVariantHash(const QVariantHash &rule_hash);
   QVariantHash toVariantHash() const;
   bool matches(const QString &article_title) const;
+  // Same as matches() except that the literal must-contain tokens are
+  // assumed to be already checked (see RssDownloadRuleList)
+  bool matchesRemainingTokens(const QString &article_title, const QString &lowered_title) const;
+  // Lowercase must-contain tokens without any wildcard
+  QStringList literalMustContain() const;
+  // Incremented every time the matching criteria change
+  inline uint revision() const { return m_revision; }
   void setMustContain(const QString &tokens);
   void setMustNotContain(const QString &tokens);
   inline QStringList rssFeeds() const { return m_rssFeeds; }
-  inline void setRssFeeds(const QStringList& rss_feeds) { m_rssFeeds = rss_feeds; }
+  inline void setRssFeeds(const QStringList& rss_feeds) { m_rssFeeds = rss_feeds; ++m_revision; }
   inline QString name() const { return m_name; }
   inline void setName(const QString &name) { m_name = name; }
   inline QString savePath() const { return m_savePath; }
@@ -60,15 +68,19 @@ public:
   inline QString label() const { return m_label; }
   inline void setLabel(const QString &_label) { m_label = _label; }
   inline bool isEnabled() const { return m_enabled; }
-  inline void setEnabled(bool enable) { m_enabled = enable; }
+  inline void setEnabled(bool enable) { m_enabled = enable; ++m_revision; }
   inline QString mustContain() const { return m_mustContain.join(" "); }
   inline QString mustNotContain() const { return m_mustNotContain.join(" "); }
   inline bool useRegex() const { return m_useRegex; }
-  inline void setUseRegex(bool enabled) { m_useRegex = enabled; }
+  void setUseRegex(bool enabled);
   QStringList findMatchingArticles(const RssFeedPtr& feed) const;
   // Operators
   bool operator==(const RssDownloadRule &other) const;
 
+private:
+  void compile() const;
+  static bool isLiteralToken(const QString &token);
+
 private:
   QString m_name;
   QStringList m_mustContain;
@@ -78,6 +90,13 @@ private:
   bool m_enabled;
   QStringList m_rssFeeds;
   bool m_useRegex;
+  uint m_revision;
+  // Matchers built from the tokens, only compiled on first use
+  mutable bool m_compiled;
+  mutable QStringList m_literalMustContain;
+  mutable QList<QRegExp> m_patternMustContain;
+  mutable QStringList m_literalMustNotContain;
+  mutable QList<QRegExp> m_patternMustNotContain;
 };
 
 #endif // RSSDOWNLOADRULE_H
@@ -44,17 +44,72 @@ RssDownloadRuleList::RssDownloadRuleList()
 RssDownloadRulePtr RssDownloadRuleList::findMatchingRule(const QString &feed_url, const QString &article_title) const
 {
   Q_ASSERT(RssSettings().isRssDownloadingEnabled());
-  QStringList rule_names = m_feedRules.value(feed_url);
-  foreach (const QString &rule_name, rule_names) {
-    RssDownloadRulePtr rule = m_rules[rule_name];
-    if (rule->isEnabled() && rule->matches(article_title)) return rule;
+  const CompiledFeedRulesPtr compiled = compiledRules(feed_url);
+  if (compiled->rules.isEmpty())
+    return RssDownloadRulePtr();
+
+  // Find all the literal tokens contained in the title at once
+  const QString lowered_title = article_title.toLower();
+  QVector<bool> found(compiled->literals.patternCount(), false);
+  compiled->literals.findAll(lowered_title, found);
+
+  for (int i = 0; i < compiled->rules.size(); ++i) {
+    const RssDownloadRulePtr &rule = compiled->rules.at(i);
+    if (!rule->isEnabled())
+      continue;
+    bool candidate = true;
+    foreach (int id, compiled->requiredLiterals.at(i)) {
+      if (!found.at(id)) {
+        candidate = false;
+        break;
+      }
+    }
+    if (!candidate)
+      continue;
+    if (rule->matchesRemainingTokens(article_title, lowered_title))
+      return rule;
   }
   return RssDownloadRulePtr();
 }
 
+bool RssDownloadRuleList::isUpToDate(const CompiledFeedRules &compiled) const
+{
+  // Rules are shared with the editable copy of the list and may have
+  // been modified in place
+  for (int i = 0; i < compiled.rules.size(); ++i) {
+    if (compiled.rules.at(i)->revision() != compiled.revisions.at(i))
+      return false;
+  }
+  return true;
+}
+
+RssDownloadRuleList::CompiledFeedRulesPtr RssDownloadRuleList::compiledRules(const QString &feed_url) const
+{
+  CompiledFeedRulesPtr compiled = m_compiledFeedRules.value(feed_url);
+  if (compiled && isUpToDate(*compiled))
+    return compiled;
+
+  compiled = CompiledFeedRulesPtr(new CompiledFeedRules);
+  foreach (const QString &rule_name, m_feedRules.value(feed_url)) {
+    const RssDownloadRulePtr rule = m_rules.value(rule_name);
+    if (!rule)
+      continue;
+    compiled->rules << rule;
+    compiled->revisions << rule->revision();
+    QVector<int> ids;
+    foreach (const QString &token, rule->literalMustContain())
+      ids << compiled->literals.addPattern(token);
+    compiled->requiredLiterals << ids;
+  }
+  compiled->literals.build();
+  m_compiledFeedRules.insert(feed_url, compiled);
+  return compiled;
+}
+
 void RssDownloadRuleList::replace(RssDownloadRuleList *other) {
   m_rules.clear();
   m_feedRules.clear();
+  m_compiledFeedRules.clear();
   foreach (const QString& name, other->ruleNames()) {
     saveRule(other->getRule(name));
   }
@@ -104,6 +159,7 @@ void RssDownloadRuleList::saveRule(const RssDownloadRulePtr &rule)
   // Update feedRules hashtable
   foreach (const QString &feed_url, rule->rssFeeds()) {
     m_feedRules[feed_url].append(rule->name());
+    m_compiledFeedRules.remove(feed_url);
   }
   qDebug() << Q_FUNC_INFO << "EXIT";
 }
@@ -116,6 +172,7 @@ void RssDownloadRuleList::removeRule(const QString &name)
   // Update feedRules hashtable
   foreach (const QString &feed_url, rule->rssFeeds()) {
     m_feedRules[feed_url].removeOne(rule->name());
+    m_compiledFeedRules.remove(feed_url);
   }
 }
 
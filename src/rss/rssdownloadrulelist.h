@@ -35,6 +35,7 @@
 #include <QHash>
 #include <QVariantHash>
 #include "rssdownloadrule.h"
+#include "rssliteralmatcher.h"
 
 class RssDownloadRuleList
 {
@@ -60,9 +61,22 @@ private:
   void loadRulesFromVariantHash(const QVariantHash& l);
   QVariantHash toVariantHash() const;
 
+  // Rules of a feed compiled for matching every article in one pass
+  struct CompiledFeedRules {
+    QList<RssDownloadRulePtr> rules;
+    QVector<uint> revisions;
+    // Ids in 'literals' of the literal must-contain tokens of each rule
+    QList<QVector<int> > requiredLiterals;
+    RssLiteralMatcher literals;
+  };
+  typedef QSharedPointer<CompiledFeedRules> CompiledFeedRulesPtr;
+  CompiledFeedRulesPtr compiledRules(const QString &feed_url) const;
+  bool isUpToDate(const CompiledFeedRules &compiled) const;
+
 private:
   QHash<QString, RssDownloadRulePtr> m_rules;
   QHash<QString, QStringList> m_feedRules;
+  mutable QHash<QString, CompiledFeedRulesPtr> m_compiledFeedRules;
 
 };
 
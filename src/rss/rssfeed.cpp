@@ -41,6 +41,10 @@
 #include "downloadthread.h"
 #include "fs_utils.h"
 
+static const qint64 MSECS_PER_MIN = 60000;
+// The refresh hints of a feed can't delay it by more than a day
+static const qint64 MAX_HINTED_INTERVAL = 24 * 60 * MSECS_PER_MIN;
+
 bool rssArticleDateRecentThan(const RssArticlePtr& left, const RssArticlePtr& right)
 {
   return left->date() > right->date();
@@ -54,15 +58,21 @@ RssFeed::RssFeed(RssManager* manager, RssFolder* parent, const QString& url):
   m_unreadCount(0),
   m_dirty(false),
   m_inErrorState(false),
-  m_loading(false)
+  m_loading(false),
+  m_ttl(0),
+  m_maxAge(0),
+  m_store(m_url)
 {
   qDebug() << Q_FUNC_INFO << m_url;
   // Listen for new RSS downloads
   connect(manager->rssDownloader(), SIGNAL(downloadFinished(QString,QString)), SLOT(handleFinishedDownload(QString,QString)));
+  connect(manager->rssDownloader(), SIGNAL(downloadToMemoryFinished(QString,QByteArray,QVariantHash)), SLOT(handleFinishedDownload(QString,QByteArray,QVariantHash)));
   connect(manager->rssDownloader(), SIGNAL(downloadFailure(QString,QString)), SLOT(handleDownloadFailure(QString,QString)));
   connect(manager->rssParser(), SIGNAL(feedTitle(QString,QString)), SLOT(handleFeedTitle(QString,QString)));
+  connect(manager->rssParser(), SIGNAL(feedTtl(QString,int)), SLOT(handleFeedTtl(QString,int)));
   connect(manager->rssParser(), SIGNAL(newArticle(QString,QVariantHash)), SLOT(handleNewArticle(QString,QVariantHash)));
   connect(manager->rssParser(), SIGNAL(feedParsingFinished(QString,QString)), SLOT(handleFeedParsingFinished(QString,QString)));
+  connect(manager->rssParser(), SIGNAL(feedParsingTime(QString,int)), SLOT(handleFeedParsingTime(QString,int)));
 
   // Download the RSS Feed icon
   m_iconUrl = iconUrl();
@@ -85,33 +95,40 @@ void RssFeed::saveItemsToDisk()
     return;
   markAsDirty(false);
 
-  QIniSettings qBTRSS("qBittorrent", "qBittorrent-rss");
-  QVariantList old_items;
-
-  RssArticleHash::ConstIterator it = m_articles.begin();
-  RssArticleHash::ConstIterator itend = m_articles.end();
-  for ( ; it != itend; ++it) {
-    old_items << it.value()->toHash();
+  saveFeedData();
+  QList<RssArticleRecord> records;
+  foreach (const RssArticlePtr& article, m_articlesByDate)
+    records << article->toRecord();
+  qDebug("Saving %d old items for feed %s", records.size(), qPrintable(displayName()));
+  if (!m_store.save(records)) {
+    // Try again on next save
+    markAsDirty();
+    return;
   }
-  qDebug("Saving %d old items for feed %s", old_items.size(), qPrintable(displayName()));
-  QHash<QString, QVariant> all_old_items = qBTRSS.value("old_items", QHash<QString, QVariant>()).toHash();
-  all_old_items[m_url] = old_items;
-  qBTRSS.setValue("old_items", all_old_items);
+
+  for (int i = 0; i < records.size(); ++i)
+    m_articlesByDate[i]->setDescriptionLocation(records[i].descriptionOffset, records[i].descriptionSize);
 }
 
 void RssFeed::loadItemsFromDisk()
 {
-  QIniSettings qBTRSS("qBittorrent", "qBittorrent-rss");
-  QHash<QString, QVariant> all_old_items = qBTRSS.value("old_items", QHash<QString, QVariant>()).toHash();
-  const QVariantList old_items = all_old_items.value(m_url, QVariantList()).toList();
-  qDebug("Loading %d old items for feed %s", old_items.size(), qPrintable(displayName()));
+  const QList<RssArticleRecord> records = m_store.load();
+  qDebug("Loading %d old items for feed %s", records.size(), qPrintable(displayName()));
+  const QVariantHash feedData = m_store.feedData();
+  m_etag = feedData.value("etag").toString();
+  m_lastModified = feedData.value("last_modified").toString();
+  m_ttl = feedData.value("ttl", 0).toInt();
+  m_maxAge = feedData.value("max_age", 0).toInt();
 
-  foreach (const QVariant& var_it, old_items) {
-    QVariantHash item = var_it.toHash();
-    RssArticlePtr rss_item = hashToRssArticle(this, item);
+  foreach (const RssArticleRecord& record, records) {
+    RssArticlePtr rss_item = recordToRssArticle(this, record);
     if (rss_item)
       addArticle(rss_item);
   }
+  // The loaded articles are already stored, unless some of them were
+  // dropped because of the max articles setting
+  if (count() == (uint) records.size())
+    markAsDirty(false);
 }
 
 void RssFeed::addArticle(const RssArticlePtr& article) {
@@ -170,11 +187,73 @@ bool RssFeed::refresh()
     return false;
   }
   m_loading = true;
-  // Download the RSS again
-  m_manager->rssDownloader()->downloadUrl(m_url, feedCookies());
+  m_fetchStats.lastRequest = QDateTime::currentDateTime();
+  ++m_fetchStats.requests;
+  // Download the RSS again, unless it did not change since last time.
+  // Without any article left a "not modified" answer would be useless.
+  QHash<QByteArray, QByteArray> headers;
+  if (!m_articles.isEmpty()) {
+    if (!m_etag.isEmpty())
+      headers.insert("If-None-Match", m_etag.toLatin1());
+    if (!m_lastModified.isEmpty())
+      headers.insert("If-Modified-Since", m_lastModified.toLatin1());
+  }
+  m_manager->rssDownloader()->downloadUrlToMemory(m_url, feedCookies(), headers);
   return true;
 }
 
+qint64 RssFeed::refreshInterval() const
+{
+  const qint64 interval = qMax((qint64) m_manager->refreshInterval() * MSECS_PER_MIN, MSECS_PER_MIN);
+  // Honor the hints of the feed and of the server, within reason
+  qint64 hinted = qMax((qint64) m_ttl * MSECS_PER_MIN, (qint64) m_maxAge * 1000);
+  hinted = qMin(hinted, qMax(interval, MAX_HINTED_INTERVAL));
+  return qMax(interval, hinted);
+}
+
+QDateTime RssFeed::nextRefresh() const
+{
+  const qint64 interval = refreshInterval();
+  // Each feed is refreshed at its own fixed phase within the interval so
+  // that the feeds are spread over the interval instead of all firing at
+  // once, even after a "refresh all".
+  const qint64 phase = qHash(m_url) % interval;
+  const qint64 last = m_fetchStats.lastRequest.isValid() ? m_fetchStats.lastRequest.toMSecsSinceEpoch()
+                                                         : QDateTime::currentMSecsSinceEpoch();
+  // Next slot of this feed, at least half an interval after the last request
+  const qint64 earliest = last + interval / 2;
+  qint64 next = (earliest - phase) / interval * interval + phase;
+  if (next < earliest)
+    next += interval;
+  return QDateTime::fromMSecsSinceEpoch(next);
+}
+
+void RssFeed::updateCacheHints(const QVariantHash &replyInfo)
+{
+  int maxAge = 0;
+  foreach (const QString& directive, replyInfo.value("cache-control").toString().split(',', QString::SkipEmptyParts)) {
+    const QString d = directive.trimmed().toLower();
+    if (d.startsWith("max-age=")) {
+      maxAge = qMax(0, d.mid(8).toInt());
+      break;
+    }
+  }
+  if (maxAge != m_maxAge) {
+    m_maxAge = maxAge;
+    markAsDirty();
+  }
+}
+
+void RssFeed::saveFeedData()
+{
+  QVariantHash feedData;
+  feedData["etag"] = m_etag;
+  feedData["last_modified"] = m_lastModified;
+  feedData["ttl"] = m_ttl;
+  feedData["max_age"] = m_maxAge;
+  m_store.setFeedData(feedData);
+}
+
 void RssFeed::removeAllSettings()
 {
   qDebug() << "Removing all settings / history for feed: " << m_url;
@@ -189,11 +268,7 @@ void RssFeed::removeAllSettings()
     all_feeds_filters.remove(m_url);
     qBTRSS.setValue("feed_filters", all_feeds_filters);
   }
-  QVariantHash all_old_items = qBTRSS.value("old_items", QVariantHash()).toHash();
-  if (all_old_items.contains(m_url)) {
-      all_old_items.remove(m_url);
-      qBTRSS.setValue("old_items", all_old_items);
-  }
+  m_store.remove();
 }
 
 bool RssFeed::isLoading() const
@@ -305,13 +380,34 @@ QString RssFeed::iconUrl() const
 }
 
 // read and store the downloaded rss' informations
+void RssFeed::handleFinishedDownload(const QString& url, const QByteArray& data, const QVariantHash& replyInfo)
+{
+  if (url != m_url)
+    return;
+
+  updateCacheHints(replyInfo);
+  if (replyInfo.value("status").toInt() == 304) {
+    // Nothing to parse nor to match against the download rules
+    qDebug() << Q_FUNC_INFO << "RSS feed at" << url << "was not modified";
+    ++m_fetchStats.notModified;
+    m_loading = false;
+    m_inErrorState = false;
+    m_manager->forwardFeedInfosChanged(m_url, displayName(), m_unreadCount);
+    return;
+  }
+
+  qDebug() << Q_FUNC_INFO << "Successfully downloaded RSS feed at" << url;
+  m_fetchStats.bytesReceived += data.size();
+  // The validators are only kept once the document was parsed successfully
+  m_pendingEtag = replyInfo.value("etag").toString();
+  m_pendingLastModified = replyInfo.value("last-modified").toString();
+  // Parse the download RSS
+  m_manager->rssParser()->parseRssData(m_url, data);
+}
+
 void RssFeed::handleFinishedDownload(const QString& url, const QString& filePath)
 {
-  if (url == m_url) {
-    qDebug() << Q_FUNC_INFO << "Successfully downloaded RSS feed at" << url;
-    // Parse the download RSS
-    m_manager->rssParser()->parseRssFile(m_url, filePath);
-  } else if (url == m_iconUrl) {
+  if (url == m_iconUrl) {
     m_icon = filePath;
     qDebug() << Q_FUNC_INFO << "icon path:" << m_icon;
     m_manager->forwardFeedIconChanged(m_url, m_icon);
@@ -325,6 +421,7 @@ void RssFeed::handleDownloadFailure(const QString& url, const QString& error)
 
   m_inErrorState = true;
   m_loading = false;
+  ++m_fetchStats.failures;
   m_manager->forwardFeedInfosChanged(m_url, displayName(), m_unreadCount);
   qWarning() << "Failed to download RSS feed at" << url;
   qWarning() << "Reason:" << error;
@@ -345,6 +442,15 @@ void RssFeed::handleFeedTitle(const QString& feedUrl, const QString& title)
     m_manager->forwardFeedInfosChanged(feedUrl, title, m_unreadCount);
 }
 
+void RssFeed::handleFeedTtl(const QString& feedUrl, int minutes)
+{
+  if (feedUrl != m_url || m_ttl == minutes)
+    return;
+
+  m_ttl = minutes;
+  markAsDirty();
+}
+
 void RssFeed::downloadArticleTorrentIfMatching(RssDownloadRuleList* rules, const RssArticlePtr& article)
 {
   Q_ASSERT(RssSettings().isRssDownloadingEnabled());
@@ -404,6 +510,13 @@ void RssFeed::handleFeedParsingFinished(const QString& feedUrl, const QString& e
 
   m_loading = false;
   m_inErrorState = !error.isEmpty();
+  if (m_inErrorState) {
+    ++m_fetchStats.failures;
+  } else if (m_etag != m_pendingEtag || m_lastModified != m_pendingLastModified) {
+    m_etag = m_pendingEtag;
+    m_lastModified = m_pendingLastModified;
+    markAsDirty();
+  }
 
   m_manager->forwardFeedInfosChanged(m_url, displayName(), m_unreadCount);
   // XXX: Would not be needed if we did this in handleNewArticle() instead
@@ -412,6 +525,12 @@ void RssFeed::handleFeedParsingFinished(const QString& feedUrl, const QString& e
   saveItemsToDisk();
 }
 
+void RssFeed::handleFeedParsingTime(const QString& feedUrl, int msecs)
+{
+  if (feedUrl == m_url)
+    m_fetchStats.lastParseTime = msecs;
+}
+
 void RssFeed::handleArticleStateChanged() {
   m_manager->forwardFeedInfosChanged(m_url, displayName(), m_unreadCount);
 }
@@ -38,6 +38,7 @@
 #include <QNetworkCookie>
 
 #include "rssfile.h"
+#include "rssarticlestore.h"
 
 class RssFeed;
 class RssManager;
@@ -49,6 +50,17 @@ typedef QList<RssFeedPtr> RssFeedList;
 
 bool rssArticleDateRecentThan(const RssArticlePtr& left, const RssArticlePtr& right);
 
+struct RssFeedFetchStats {
+  RssFeedFetchStats(): requests(0), notModified(0), failures(0), bytesReceived(0), lastParseTime(-1) {}
+  uint requests;
+  uint notModified;
+  uint failures;
+  qint64 bytesReceived;
+  // Time spent parsing the last downloaded document, -1 if none yet
+  int lastParseTime;
+  QDateTime lastRequest;
+};
+
 class RssFeed: public QObject, public RssFile {
   Q_OBJECT
 
@@ -76,16 +88,22 @@ public:
   virtual uint unreadCount() const;
   virtual RssArticleList articleListByDateDesc() const;
   const RssArticleHash& articleHash() const { return m_articles; }
+  const RssArticleStore& articleStore() const { return m_store; }
   virtual RssArticleList unreadArticleListByDateDesc() const;
   void decrementUnreadCount();
   void recheckRssItemsForDownload();
+  const RssFeedFetchStats& fetchStats() const { return m_fetchStats; }
+  QDateTime nextRefresh() const;
 
 private slots:
   void handleFinishedDownload(const QString& url, const QString &file_path);
+  void handleFinishedDownload(const QString& url, const QByteArray &data, const QVariantHash &replyInfo);
   void handleDownloadFailure(const QString &url, const QString& error);
   void handleFeedTitle(const QString& feedUrl, const QString& title);
+  void handleFeedTtl(const QString& feedUrl, int minutes);
   void handleNewArticle(const QString& feedUrl, const QVariantHash& article);
   void handleFeedParsingFinished(const QString& feedUrl, const QString& error);
+  void handleFeedParsingTime(const QString& feedUrl, int msecs);
   void handleArticleStateChanged();
 
 private:
@@ -94,6 +112,9 @@ private:
   void addArticle(const RssArticlePtr& article);
   void downloadArticleTorrentIfMatching(RssDownloadRuleList* rules, const RssArticlePtr& article);
   QList<QNetworkCookie> feedCookies() const;
+  qint64 refreshInterval() const;
+  void updateCacheHints(const QVariantHash &replyInfo);
+  void saveFeedData();
 
 private:
   RssManager* m_manager;
@@ -109,6 +130,16 @@ private:
   bool m_dirty;
   bool m_inErrorState;
   bool m_loading;
+  // HTTP validators of the last successfully parsed document
+  QString m_etag;
+  QString m_lastModified;
+  QString m_pendingEtag;
+  QString m_pendingLastModified;
+  // Refresh hints from the feed (<ttl>, in minutes) and the server (max-age, in seconds)
+  int m_ttl;
+  int m_maxAge;
+  RssFeedFetchStats m_fetchStats;
+  RssArticleStore m_store;
 
 };
 
@@ -0,0 +1,118 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QQueue>
+
+#include "rssliteralmatcher.h"
+
+RssLiteralMatcher::RssLiteralMatcher()
+{
+  clear();
+}
+
+void RssLiteralMatcher::clear()
+{
+  m_patterns.clear();
+  m_nodes.clear();
+  // Root node
+  m_nodes.append(Node());
+}
+
+int RssLiteralMatcher::addPattern(const QString &pattern)
+{
+  Q_ASSERT(!pattern.isEmpty());
+  QHash<QString, int>::ConstIterator it = m_patterns.find(pattern);
+  if (it != m_patterns.constEnd())
+    return it.value();
+
+  const int id = m_patterns.size();
+  m_patterns.insert(pattern, id);
+
+  int state = 0;
+  for (int i = 0; i < pattern.size(); ++i) {
+    const ushort c = pattern.at(i).unicode();
+    int next = m_nodes[state].next.value(c, -1);
+    if (next < 0) {
+      next = m_nodes.size();
+      m_nodes.append(Node());
+      m_nodes[state].next.insert(c, next);
+    }
+    state = next;
+  }
+  m_nodes[state].outputs << id;
+  return id;
+}
+
+void RssLiteralMatcher::build()
+{
+  // Breadth-first computation of the failure links
+  QQueue<int> queue;
+  foreach (int child, m_nodes[0].next) {
+    m_nodes[child].fail = 0;
+    queue.enqueue(child);
+  }
+
+  while (!queue.isEmpty()) {
+    const int state = queue.dequeue();
+    QHash<ushort, int>::ConstIterator it = m_nodes[state].next.constBegin();
+    QHash<ushort, int>::ConstIterator itend = m_nodes[state].next.constEnd();
+    for ( ; it != itend; ++it) {
+      const ushort c = it.key();
+      const int child = it.value();
+      int fail = m_nodes[state].fail;
+      while (fail > 0 && !m_nodes[fail].next.contains(c))
+        fail = m_nodes[fail].fail;
+      const int target = m_nodes[fail].next.value(c, 0);
+      m_nodes[child].fail = (target == child) ? 0 : target;
+      // Inherit the matches of the longest proper suffix
+      m_nodes[child].outputs += m_nodes[m_nodes[child].fail].outputs;
+      queue.enqueue(child);
+    }
+  }
+}
+
+void RssLiteralMatcher::findAll(const QString &text, QVector<bool> &found) const
+{
+  Q_ASSERT(found.size() >= m_patterns.size());
+  if (m_patterns.isEmpty())
+    return;
+
+  int state = 0;
+  const QChar *data = text.constData();
+  for (int i = 0, end = text.size(); i < end; ++i) {
+    const ushort c = data[i].unicode();
+    int next;
+    while ((next = m_nodes[state].next.value(c, -1)) < 0 && state > 0)
+      state = m_nodes[state].fail;
+    state = next < 0 ? 0 : next;
+    foreach (int id, m_nodes[state].outputs)
+      found[id] = true;
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef RSSLITERALMATCHER_H
+#define RSSLITERALMATCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// Aho-Corasick automaton over a set of literal strings.
+// It is used to find in a single pass over an article title which of the
+// literal tokens of all the download rules of a feed it contains.
+// Both the patterns and the searched text are expected to be lowercase.
+class RssLiteralMatcher
+{
+public:
+  RssLiteralMatcher();
+
+  void clear();
+  // Returns the id of the pattern, identical patterns share the same id
+  int addPattern(const QString &pattern);
+  // Must be called after the last addPattern() and before findAll()
+  void build();
+  inline int patternCount() const { return m_patterns.size(); }
+  // Sets found[id] to true for every pattern contained in text
+  void findAll(const QString &text, QVector<bool> &found) const;
+
+private:
+  struct Node {
+    Node(): fail(0) {}
+    QHash<ushort, int> next;
+    int fail;
+    QList<int> outputs;
+  };
+
+  QVector<Node> m_nodes;
+  QHash<QString, int> m_patterns;
+};
+
+#endif // RSSLITERALMATCHER_H
@@ -34,20 +34,23 @@
 #include "qbtsession.h"
 #include "rssfeed.h"
 #include "rssarticle.h"
+#include "rssarticlestore.h"
 #include "rssdownloadrulelist.h"
 #include "rssparser.h"
 #include "downloadthread.h"
 
 static const int MSECS_PER_MIN = 60000;
+// Upper bound of the refresh timer, the feeds are rechecked at least this often
+static const qint64 MAX_TIMER_INTERVAL = 60 * MSECS_PER_MIN;
 
 RssManager::RssManager():
   m_rssDownloader(new DownloadThread(this)),
   m_downloadRules(new RssDownloadRuleList),
   m_rssParser(new RssParser(this))
 {
-  connect(&m_refreshTimer, SIGNAL(timeout()), SLOT(refresh()));
+  m_refreshTimer.setSingleShot(true);
+  connect(&m_refreshTimer, SIGNAL(timeout()), SLOT(refreshDueFeeds()));
   m_refreshInterval = RssSettings().getRSSRefreshInterval();
-  m_refreshTimer.start(m_refreshInterval * MSECS_PER_MIN);
 }
 
 RssManager::~RssManager()
@@ -74,13 +77,42 @@ void RssManager::updateRefreshInterval(uint val)
 {
   if (m_refreshInterval != val) {
     m_refreshInterval = val;
-    m_refreshTimer.start(m_refreshInterval*60000);
+    scheduleRefresh();
     qDebug("New RSS refresh interval is now every %dmin", m_refreshInterval);
   }
 }
 
+// Every feed has its own schedule (see RssFeed::nextRefresh()), the timer
+// is armed for the earliest one.
+void RssManager::scheduleRefresh()
+{
+  const RssFeedList feeds = getAllFeeds();
+  if (feeds.isEmpty()) {
+    m_refreshTimer.stop();
+    return;
+  }
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  qint64 next = now + MAX_TIMER_INTERVAL;
+  foreach (const RssFeedPtr& feed, feeds)
+    next = qMin(next, feed->nextRefresh().toMSecsSinceEpoch());
+  m_refreshTimer.start(qMax(next - now, (qint64) 1000));
+}
+
+void RssManager::refreshDueFeeds()
+{
+  const QDateTime now = QDateTime::currentDateTime();
+  foreach (const RssFeedPtr& feed, getAllFeeds()) {
+    if (!feed->isLoading() && feed->nextRefresh() <= now)
+      feed->refresh();
+  }
+  scheduleRefresh();
+}
+
 void RssManager::loadStreamList()
 {
+  // Convert the articles of older versions before loading the feeds
+  RssArticleStore::migrateFromSettings();
+
   RssSettings settings;
   const QStringList streamsUrl = settings.getRssFeedsUrls();
   const QStringList aliases =  settings.getRssFeedsAliases();
@@ -111,6 +143,7 @@ void RssManager::loadStreamList()
     ++i;
   }
   qDebug("NB RSS streams loaded: %d", streamsUrl.size());
+  scheduleRefresh();
 }
 
 void RssManager::forwardFeedContentChanged(const QString& url)
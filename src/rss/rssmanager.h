@@ -53,6 +53,8 @@ public:
   DownloadThread* rssDownloader() const;
   RssParser* rssParser() const;
   RssDownloadRuleList* downloadRules() const;
+  // Global refresh interval, in minutes
+  uint refreshInterval() const { return m_refreshInterval; }
 
 public slots:
   void loadStreamList();
@@ -63,11 +65,17 @@ public slots:
   void moveFile(const RssFilePtr& file, const RssFolderPtr& destinationFolder);
   void updateRefreshInterval(uint val);
 
+private slots:
+  void refreshDueFeeds();
+
 signals:
   void feedContentChanged(const QString& url);
   void feedInfosChanged(const QString& url, const QString& displayName, uint unreadCount);
   void feedIconChanged(const QString& url, const QString& iconPath);
 
+private:
+  void scheduleRefresh();
+
 private:
   QTimer m_refreshTimer;
   uint m_refreshInterval;
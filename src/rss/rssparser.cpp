@@ -29,18 +29,79 @@
  */
 
 #include "rssparser.h"
-#include "downloadthread.h"
-#include "fs_utils.h"
 #include <QDebug>
-#include <QFile>
-#include <QRegExp>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QQueue>
 #include <QStringList>
+#include <QThread>
 #include <QVariant>
+#include <QWaitCondition>
 #include <QTextDocument>
 
 struct ParsingJob {
   QString feedUrl;
-  QString filePath;
+  QByteArray data;
+};
+
+class RssParserWorker : public QThread {
+public:
+  explicit RssParserWorker(RssParser *parser)
+    : m_parser(parser), m_running(true)
+  {
+    start(QThread::LowPriority);
+  }
+
+  ~RssParserWorker()
+  {
+    m_mutex.lock();
+    m_running = false;
+    m_jobAvailable.wakeOne();
+    m_mutex.unlock();
+    wait();
+  }
+
+  void enqueue(const ParsingJob &job)
+  {
+    QMutexLocker locker(&m_mutex);
+    // A newer document supersedes the one still waiting for the same
+    // feed, so the queue never holds more than one job per feed
+    QQueue<ParsingJob>::iterator it = m_queue.begin();
+    QQueue<ParsingJob>::iterator itend = m_queue.end();
+    for ( ; it != itend; ++it) {
+      if (it->feedUrl == job.feedUrl) {
+        it->data = job.data;
+        return;
+      }
+    }
+    m_queue.enqueue(job);
+    if (m_queue.count() == 1)
+      m_jobAvailable.wakeOne();
+  }
+
+protected:
+  void run()
+  {
+    m_mutex.lock();
+    while (m_running) {
+      if (m_queue.isEmpty()) {
+        m_jobAvailable.wait(&m_mutex);
+        continue;
+      }
+      const ParsingJob job = m_queue.dequeue();
+      m_mutex.unlock();
+      m_parser->parseFeed(job);
+      m_mutex.lock();
+    }
+    m_mutex.unlock();
+  }
+
+private:
+  RssParser *m_parser;
+  QMutex m_mutex;
+  QWaitCondition m_jobAvailable;
+  QQueue<ParsingJob> m_queue;
+  bool m_running;
 };
 
 static const char shortDay[][4] = {
@@ -65,53 +126,191 @@ static const char longMonth[][10] = {
   "October", "November", "December"
 };
 
+struct DateParts {
+  QString weekDay;
+  QString day;
+  QString month;
+  QString year;
+  QString hour;
+  QString minute;
+  QString second;
+  QString zone;
+};
+
+// Minimal cursor used to scan the dates without any regular expression,
+// the parser runs concurrently on every worker and for every article.
+class DateScanner {
+public:
+  explicit DateScanner(const QString &str): m_str(str), m_pos(0) {}
+
+  bool atEnd() const { return m_pos >= m_str.size(); }
+  int pos() const { return m_pos; }
+  void setPos(int pos) { m_pos = pos; }
+
+  static bool isDigit(QChar c) { return c >= QLatin1Char('0') && c <= QLatin1Char('9'); }
+
+  int skipSpaces()
+  {
+    const int start = m_pos;
+    while (!atEnd() && m_str.at(m_pos).isSpace())
+      ++m_pos;
+    return m_pos - start;
+  }
+
+  bool skipChar(char c)
+  {
+    if (atEnd() || m_str.at(m_pos) != QLatin1Char(c))
+      return false;
+    ++m_pos;
+    return true;
+  }
+
+  // Between min and max ASCII digits
+  QString digits(int min, int max)
+  {
+    const int start = m_pos;
+    while (!atEnd() && m_pos - start < max && isDigit(m_str.at(m_pos)))
+      ++m_pos;
+    if (m_pos - start < min) {
+      m_pos = start;
+      return QString();
+    }
+    return m_str.mid(start, m_pos - start);
+  }
+
+  // A capitalized word: [A-Z][a-z]+
+  QString capitalizedWord()
+  {
+    const int start = m_pos;
+    if (atEnd() || m_str.at(m_pos) < QLatin1Char('A') || m_str.at(m_pos) > QLatin1Char('Z'))
+      return QString();
+    ++m_pos;
+    while (!atEnd() && m_str.at(m_pos) >= QLatin1Char('a') && m_str.at(m_pos) <= QLatin1Char('z'))
+      ++m_pos;
+    if (m_pos - start < 2) {
+      m_pos = start;
+      return QString();
+    }
+    return m_str.mid(start, m_pos - start);
+  }
+
+  // Everything up to the next space (or dash if stopAtDash is set)
+  QString token(bool stopAtDash)
+  {
+    const int start = m_pos;
+    while (!atEnd() && !m_str.at(m_pos).isSpace() && !(stopAtDash && m_str.at(m_pos) == QLatin1Char('-')))
+      ++m_pos;
+    return m_str.mid(start, m_pos - start);
+  }
+
+  // Separator between the day, month and year: either spaces or a dash
+  // 0: no separator, 1: spaces, 2: dash
+  int dateSeparator()
+  {
+    if (skipSpaces())
+      return 1;
+    return skipChar('-') ? 2 : 0;
+  }
+
+private:
+  const QString &m_str;
+  int m_pos;
+};
+
+// "[Weekday, ]DD Mon YY[YY] HH:MM[:SS] zone", also accepting the obsolete
+// form "Weekday, DD-Mon-YY HH:MM:SS zone"
+static bool scanRfc822Date(const QString &str, DateParts &parts)
+{
+  DateScanner s(str);
+  const QString weekDay = s.capitalizedWord();
+  if (!weekDay.isEmpty() && s.skipChar(',')) {
+    parts.weekDay = weekDay;
+    s.skipSpaces();
+  } else {
+    s.setPos(0);
+  }
+  parts.day = s.digits(1, 2);
+  if (parts.day.isEmpty())
+    return false;
+  const int sep1 = s.dateSeparator();
+  if (!sep1)
+    return false;
+  parts.month = s.token(true);
+  if (parts.month.isEmpty())
+    return false;
+  const int sep2 = s.dateSeparator();
+  if (!sep2)
+    return false;
+  // If the date has '-' separators, both separators must be '-'
+  if ((sep1 == 2) != (sep2 == 2))
+    return false;
+  parts.year = s.digits(2, 4);
+  if (parts.year.isEmpty() || !s.skipSpaces())
+    return false;
+  parts.hour = s.digits(2, 2);
+  if (parts.hour.isEmpty() || !s.skipChar(':'))
+    return false;
+  parts.minute = s.digits(2, 2);
+  if (parts.minute.isEmpty())
+    return false;
+  if (s.skipChar(':')) {
+    parts.second = s.digits(2, 2);
+    if (parts.second.isEmpty())
+      return false;
+  }
+  if (!s.skipSpaces())
+    return false;
+  parts.zone = s.token(false);
+  return !parts.zone.isEmpty() && s.atEnd();
+}
+
+// Obsolete form "Wdy Mon DD HH:MM:SS YYYY"
+static bool scanAsctimeDate(const QString &str, DateParts &parts)
+{
+  DateScanner s(str);
+  parts = DateParts();
+  parts.weekDay = s.capitalizedWord();
+  if (parts.weekDay.isEmpty() || !s.skipSpaces())
+    return false;
+  parts.month = s.token(false);
+  if (parts.month.isEmpty() || !s.skipSpaces())
+    return false;
+  parts.day = s.digits(2, 2);
+  if (parts.day.isEmpty() || !s.skipSpaces())
+    return false;
+  parts.hour = s.digits(2, 2);
+  if (parts.hour.isEmpty() || !s.skipChar(':'))
+    return false;
+  parts.minute = s.digits(2, 2);
+  if (parts.minute.isEmpty() || !s.skipChar(':'))
+    return false;
+  parts.second = s.digits(2, 2);
+  if (parts.second.isEmpty() || !s.skipSpaces())
+    return false;
+  parts.year = s.digits(4, 4);
+  return !parts.year.isEmpty() && s.atEnd();
+}
+
 // Ported to Qt4 from KDElibs4
 QDateTime RssParser::parseDate(const QString &string) {
   const QString str = string.trimmed();
   if (str.isEmpty())
     return QDateTime::currentDateTime();
 
-  int nyear  = 6;   // indexes within string to values
-  int nmonth = 4;
-  int nday   = 2;
-  int nwday  = 1;
-  int nhour  = 7;
-  int nmin   = 8;
-  int nsec   = 9;
-  // Also accept obsolete form "Weekday, DD-Mon-YY HH:MM:SS ±hhmm"
-  QRegExp rx("^(?:([A-Z][a-z]+),\\s*)?(\\d{1,2})(\\s+|-)([^-\\s]+)(\\s+|-)(\\d{2,4})\\s+(\\d\\d):(\\d\\d)(?::(\\d\\d))?\\s+(\\S+)$");
-  QStringList parts;
-  if (!str.indexOf(rx)) {
-    // Check that if date has '-' separators, both separators are '-'.
-    parts = rx.capturedTexts();
-    bool h1 = (parts[3] == QLatin1String("-"));
-    bool h2 = (parts[5] == QLatin1String("-"));
-    if (h1 != h2)
-      return QDateTime::currentDateTime();
-  } else {
-    // Check for the obsolete form "Wdy Mon DD HH:MM:SS YYYY"
-    rx = QRegExp("^([A-Z][a-z]+)\\s+(\\S+)\\s+(\\d\\d)\\s+(\\d\\d):(\\d\\d):(\\d\\d)\\s+(\\d\\d\\d\\d)$");
-    if (str.indexOf(rx))
-      return QDateTime::currentDateTime();
-    nyear  = 7;
-    nmonth = 2;
-    nday   = 3;
-    nwday  = 1;
-    nhour  = 4;
-    nmin   = 5;
-    nsec   = 6;
-    parts = rx.capturedTexts();
-  }
+  DateParts parts;
+  if (!scanRfc822Date(str, parts) && !scanAsctimeDate(str, parts))
+    return QDateTime::currentDateTime();
+
   bool ok[4];
-  const int day    = parts[nday].toInt(&ok[0]);
-  int year   = parts[nyear].toInt(&ok[1]);
-  const int hour   = parts[nhour].toInt(&ok[2]);
-  const int minute = parts[nmin].toInt(&ok[3]);
+  const int day    = parts.day.toInt(&ok[0]);
+  int year   = parts.year.toInt(&ok[1]);
+  const int hour   = parts.hour.toInt(&ok[2]);
+  const int minute = parts.minute.toInt(&ok[3]);
   if (!ok[0] || !ok[1] || !ok[2] || !ok[3])
     return QDateTime::currentDateTime();
   int second = 0;
-  if (!parts[nsec].isEmpty()) {
-    second = parts[nsec].toInt(&ok[0]);
+  if (!parts.second.isEmpty()) {
+    second = parts.second.toInt(&ok[0]);
     if (!ok[0])
       return QDateTime::currentDateTime();
   }
@@ -119,18 +318,18 @@ QDateTime RssParser::parseDate(const QString &string) {
   if (leapSecond)
     second = 59;   // apparently a leap second - validate below, once time zone is known
   int month = 0;
-  for ( ;  month < 12  &&  parts[nmonth] != shortMonth[month];  ++month) ;
+  for ( ;  month < 12  &&  parts.month != shortMonth[month];  ++month) ;
   int dayOfWeek = -1;
-  if (!parts[nwday].isEmpty()) {
+  if (!parts.weekDay.isEmpty()) {
     // Look up the weekday name
-    while (++dayOfWeek < 7  &&  shortDay[dayOfWeek] != parts[nwday]) ;
+    while (++dayOfWeek < 7  &&  shortDay[dayOfWeek] != parts.weekDay) ;
     if (dayOfWeek >= 7)
-      for (dayOfWeek = 0;  dayOfWeek < 7  &&  longDay[dayOfWeek] != parts[nwday];  ++dayOfWeek) ;
+      for (dayOfWeek = 0;  dayOfWeek < 7  &&  longDay[dayOfWeek] != parts.weekDay;  ++dayOfWeek) ;
   }
   //       if (month >= 12 || dayOfWeek >= 7
   //       ||  (dayOfWeek < 0  &&  format == RFCDateDay))
   //         return QDateTime;
-  int i = parts[nyear].size();
+  int i = parts.year.size();
   if (i < 4) {
     // It's an obsolete year specification with less than 4 digits
     year += (i == 2  &&  year < 50) ? 2000: 1900;
@@ -139,22 +338,23 @@ QDateTime RssParser::parseDate(const QString &string) {
   // Parse the UTC offset part
   int offset = 0;           // set default to '-0000'
   bool negOffset = false;
-  if (parts.count() > 10) {
-    rx = QRegExp("^([+-])(\\d\\d)(\\d\\d)$");
-    if (!parts[10].indexOf(rx)) {
+  if (!parts.zone.isEmpty()) {
+    const QString &zoneText = parts.zone;
+    if (zoneText.size() == 5 && (zoneText.at(0) == QLatin1Char('+') || zoneText.at(0) == QLatin1Char('-'))
+        && DateScanner::isDigit(zoneText.at(1)) && DateScanner::isDigit(zoneText.at(2))
+        && DateScanner::isDigit(zoneText.at(3)) && DateScanner::isDigit(zoneText.at(4))) {
       // It's a UTC offset ±hhmm
-      parts = rx.capturedTexts();
-      offset = parts[2].toInt(&ok[0]) * 3600;
-      int offsetMin = parts[3].toInt(&ok[1]);
-      if (!ok[0] || !ok[1] || offsetMin > 59)
+      offset = zoneText.mid(1, 2).toInt() * 3600;
+      int offsetMin = zoneText.mid(3, 2).toInt();
+      if (offsetMin > 59)
         return QDateTime();
       offset += offsetMin * 60;
-      negOffset = (parts[1] == QLatin1String("-"));
+      negOffset = (zoneText.at(0) == QLatin1Char('-'));
       if (negOffset)
         offset = -offset;
     } else {
       // Check for an obsolete time zone name
-      QByteArray zone = parts[10].toLatin1();
+      QByteArray zone = parts.zone.toLatin1();
       if (zone.length() == 1  &&  isalpha(zone[0])  &&  toupper(zone[0]) != 'J')
         negOffset = true;    // military zone: RFC 2822 treats as '-0000'
       else if (zone != "UT" && zone != "GMT") {    // treated as '+0000'
@@ -198,30 +398,28 @@ QDateTime RssParser::parseDate(const QString &string) {
 }
 
 RssParser::RssParser(QObject *parent) :
-  QThread(parent), m_running(true)
+  QObject(parent)
 {
-  start();
+  const int workerCount = qMax(1, QThread::idealThreadCount());
+  for (int i = 0; i < workerCount; ++i)
+    m_workers << new RssParserWorker(this);
 }
 
 RssParser::~RssParser()
 {
-  m_running = false;
-  m_waitCondition.wakeOne();
-  wait();
+  qDeleteAll(m_workers);
 }
 
-void RssParser::parseRssFile(const QString& feedUrl, const QString& filePath)
+RssParserWorker* RssParser::workerFor(const QString& feedUrl) const
 {
-  qDebug() << Q_FUNC_INFO << feedUrl << filePath;
-  m_mutex.lock();
-  ParsingJob job = { feedUrl, fsutils::fromNativePath(filePath) };
-  m_queue.enqueue(job);
-  // Wake up thread.
-  if (m_queue.count() == 1) {
-    qDebug() << Q_FUNC_INFO << "Waking up thread";
-    m_waitCondition.wakeOne();
-  }
-  m_mutex.unlock();
+  return m_workers.at(qHash(feedUrl) % m_workers.size());
+}
+
+void RssParser::parseRssData(const QString& feedUrl, const QByteArray& data)
+{
+  qDebug() << Q_FUNC_INFO << feedUrl << data.size();
+  ParsingJob job = { feedUrl, data };
+  workerFor(feedUrl)->enqueue(job);
 }
 
 void RssParser::clearFeedData(const QString &feedUrl)
@@ -231,23 +429,6 @@ void RssParser::clearFeedData(const QString &feedUrl)
   m_mutex.unlock();
 }
 
-void RssParser::run()
-{
-  while (m_running) {
-    m_mutex.lock();
-    if (!m_queue.empty()) {
-      ParsingJob job = m_queue.dequeue();
-      m_mutex.unlock();
-      parseFeed(job);
-    } else {
-      qDebug() << Q_FUNC_INFO << "Thread is waiting.";
-      m_waitCondition.wait(&m_mutex);
-      qDebug() << Q_FUNC_INFO << "Thread woke up.";
-      m_mutex.unlock();
-    }
-  }
-}
-
 void RssParser::parseRssArticle(QXmlStreamReader& xml, const QString& feedUrl)
 {
   QVariantHash article;
@@ -310,6 +491,12 @@ void RssParser::parseRSSChannel(QXmlStreamReader& xml, const QString& feedUrl)
         QString title = xml.readElementText();
         emit feedTitle(feedUrl, title);
       }
+      else if (xml.name() == "ttl") {
+        bool ok;
+        const int ttl = xml.readElementText().trimmed().toInt(&ok);
+        if (ok && ttl > 0)
+          emit feedTtl(feedUrl, ttl);
+      }
       else if (xml.name() == "lastBuildDate") {
         QString lastBuildDate = xml.readElementText();
         if (!lastBuildDate.isEmpty()) {
@@ -452,13 +639,10 @@ void RssParser::parseAtomChannel(QXmlStreamReader& xml, const QString& feedUrl)
 // read and create items from a rss document
 void RssParser::parseFeed(const ParsingJob& job)
 {
-  qDebug() << Q_FUNC_INFO << job.feedUrl << job.filePath;
-  QFile fileRss(job.filePath);
-  if (!fileRss.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    reportFailure(job, tr("Failed to open downloaded RSS file."));
-    return;
-  }
-  QXmlStreamReader xml(&fileRss);
+  qDebug() << Q_FUNC_INFO << job.feedUrl << job.data.size();
+  QElapsedTimer timer;
+  timer.start();
+  QXmlStreamReader xml(job.data);
 
   bool found_channel = false;
   while (xml.readNextStartElement()) {
@@ -486,6 +670,10 @@ void RssParser::parseFeed(const ParsingJob& job)
     }
   }
 
+  const int elapsed = timer.elapsed();
+  qDebug("Parsed RSS feed %s (%d bytes) in %d ms", qPrintable(job.feedUrl), job.data.size(), elapsed);
+  emit feedParsingTime(job.feedUrl, elapsed);
+
   if (xml.hasError()) {
     reportFailure(job, xml.errorString());
     return;
@@ -496,14 +684,10 @@ void RssParser::parseFeed(const ParsingJob& job)
     return;
   }
 
-  // Clean up
-  fileRss.close();
   emit feedParsingFinished(job.feedUrl, QString());
-  fsutils::forceRemove(job.filePath);
 }
 
 void RssParser::reportFailure(const ParsingJob& job, const QString& error)
 {
   emit feedParsingFinished(job.feedUrl, error);
-  fsutils::forceRemove(job.filePath);
 }
@@ -32,16 +32,20 @@
 #define RSSPARSER_H
 
 #include "rssarticle.h"
+#include <QHash>
+#include <QList>
 #include <QMutex>
-#include <QQueue>
-#include <QThread>
-#include <QWaitCondition>
 
 struct ParsingJob;
+class RssParserWorker;
 
-class RssParser : public QThread
+// Parses the downloaded feeds on a pool of worker threads sized to the
+// number of cores. All the documents of a feed are handled by the same
+// worker so that its signals are always emitted in order.
+class RssParser : public QObject
 {
   Q_OBJECT
+  friend class RssParserWorker;
 
 public:
   explicit RssParser(QObject *parent = 0);
@@ -50,14 +54,15 @@ public:
 signals:
   void newArticle(const QString& feedUrl, const QVariantHash& rssArticle);
   void feedTitle(const QString& feedUrl, const QString& title);
+  void feedTtl(const QString& feedUrl, int minutes);
   void feedParsingFinished(const QString& feedUrl, const QString& error);
+  void feedParsingTime(const QString& feedUrl, int msecs);
 
 public slots:
-  void parseRssFile(const QString& feedUrl, const QString& filePath);
+  void parseRssData(const QString& feedUrl, const QByteArray& data);
   void clearFeedData(const QString& feedUrl);
 
 protected:
-  virtual void run();
   static QDateTime parseDate(const QString& string);
   void parseRssArticle(QXmlStreamReader& xml, const QString& feedUrl);
   void parseRSSChannel(QXmlStreamReader& xml, const QString& feedUrl);
@@ -67,10 +72,11 @@ protected:
   void reportFailure(const ParsingJob& job, const QString& error);
 
 private:
-  bool m_running;
+  RssParserWorker* workerFor(const QString& feedUrl) const;
+
+private:
+  QList<RssParserWorker*> m_workers;
   QMutex m_mutex;
-  QQueue<ParsingJob> m_queue;
-  QWaitCondition m_waitCondition;
   QHash<QString/*feedUrl*/, QString/*lastBuildDate*/> m_lastBuildDates; // Optimization
 };
 
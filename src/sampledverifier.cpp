@@ -0,0 +1,254 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtAlgorithms>
+
+#include <libtorrent/hasher.hpp>
+
+#include "sampledverifier.h"
+#include "fs_utils.h"
+#include "misc.h"
+
+using namespace libtorrent;
+
+namespace {
+  // Pieces left to check, shared by the readers
+  class SampleJobs {
+  public:
+    explicit SampleJobs(const QList<int> &pieces): m_pieces(pieces), m_next(0), m_checked(0) {}
+
+    bool take(int &piece)
+    {
+      QMutexLocker locker(&m_mutex);
+      if (m_next >= m_pieces.size())
+        return false;
+      piece = m_pieces.at(m_next++);
+      return true;
+    }
+
+    void markChecked()
+    {
+      QMutexLocker locker(&m_mutex);
+      ++m_checked;
+    }
+
+    int checked() const
+    {
+      QMutexLocker locker(&m_mutex);
+      return m_checked;
+    }
+
+  private:
+    mutable QMutex m_mutex;
+    const QList<int> m_pieces;
+    int m_next;
+    int m_checked;
+  };
+
+  class SampleReader : public QThread {
+  public:
+    SampleReader(SampledVerifier *verifier, const boost::intrusive_ptr<torrent_info> &t,
+                 const QStringList &filePaths, SampleJobs *jobs, const volatile bool &abort)
+      : m_verifier(verifier), m_torrent(t), m_filePaths(filePaths), m_jobs(jobs), m_abort(abort) {}
+
+  protected:
+    void run()
+    {
+      QHash<int, QFile*> files;
+      int piece;
+      while (!m_abort && m_jobs->take(piece)) {
+        checkPiece(piece, files);
+        m_jobs->markChecked();
+      }
+      qDeleteAll(files);
+    }
+
+  private:
+    void checkPiece(int piece, QHash<int, QFile*> &files)
+    {
+      hasher h;
+      const std::vector<file_slice> slices = m_torrent->map_block(piece, 0, m_torrent->piece_size(piece));
+      std::vector<file_slice>::const_iterator it = slices.begin();
+      std::vector<file_slice>::const_iterator itend = slices.end();
+      for ( ; it != itend; ++it) {
+        if (m_torrent->file_at(it->file_index).pad_file) {
+          const QByteArray zeros(it->size, 0);
+          h.update(zeros.constData(), zeros.size());
+          continue;
+        }
+        QFile *file = files.value(it->file_index);
+        if (!file) {
+          file = new QFile(m_filePaths.at(it->file_index));
+          files.insert(it->file_index, file);
+          file->open(QIODevice::ReadOnly);
+        }
+        const QByteArray data = file->seek(it->offset) ? file->read(it->size) : QByteArray();
+        if (data.size() != it->size) {
+          m_verifier->addFailure(it->file_index, SampledVerifier::tr("Read error: %1").arg(file->errorString()));
+          return;
+        }
+        h.update(data.constData(), data.size());
+      }
+
+      if (h.final() == m_torrent->hash_for_piece(piece))
+        return;
+      for (it = slices.begin(); it != itend; ++it) {
+        if (!m_torrent->file_at(it->file_index).pad_file)
+          m_verifier->addFailure(it->file_index, SampledVerifier::tr("Piece %1 does not match").arg(piece));
+      }
+    }
+
+  private:
+    SampledVerifier *m_verifier;
+    const boost::intrusive_ptr<torrent_info> m_torrent;
+    const QStringList m_filePaths;
+    SampleJobs *m_jobs;
+    const volatile bool &m_abort;
+  };
+}
+
+SampledVerifier::SampledVerifier(const boost::intrusive_ptr<torrent_info> &t, const QStringList &filePaths,
+                                 int samplesPerFile, QObject *parent)
+  : QThread(parent), m_torrent(t), m_filePaths(filePaths), m_samplesPerFile(qMax(samplesPerFile, 0)),
+    m_abort(false), m_completed(false)
+{
+}
+
+SampledVerifier::~SampledVerifier()
+{
+  abort();
+  wait();
+}
+
+void SampledVerifier::abort()
+{
+  m_abort = true;
+}
+
+bool SampledVerifier::passed() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_completed && m_failures.isEmpty();
+}
+
+QStringList SampledVerifier::failures() const
+{
+  QMutexLocker locker(&m_mutex);
+  QStringList result;
+  QMap<int, QString>::ConstIterator it = m_failures.begin();
+  QMap<int, QString>::ConstIterator itend = m_failures.end();
+  for ( ; it != itend; ++it)
+    result << fsutils::toNativePath(m_filePaths.at(it.key())) + ": " + it.value();
+  return result;
+}
+
+void SampledVerifier::addFailure(int fileIndex, const QString &reason)
+{
+  QMutexLocker locker(&m_mutex);
+  // Only keep the first reason for each file
+  if (!m_failures.contains(fileIndex))
+    m_failures.insert(fileIndex, reason);
+}
+
+bool SampledVerifier::checkFileSizes()
+{
+  for (int i = 0; i < m_torrent->num_files(); ++i) {
+    const file_entry entry = m_torrent->file_at(i);
+    if (entry.pad_file)
+      continue;
+    const QFileInfo info(m_filePaths.at(i));
+    if (!info.isFile())
+      addFailure(i, tr("The file is missing"));
+    else if (info.size() != entry.size)
+      addFailure(i, tr("Size mismatch: %1 instead of %2").arg(misc::friendlyUnit(info.size())).arg(misc::friendlyUnit(entry.size)));
+  }
+  QMutexLocker locker(&m_mutex);
+  return m_failures.isEmpty();
+}
+
+QList<int> SampledVerifier::samplePieces() const
+{
+  QSet<int> pieces;
+  const int piece_length = m_torrent->piece_length();
+  for (int i = 0; i < m_torrent->num_files(); ++i) {
+    const file_entry entry = m_torrent->file_at(i);
+    if (entry.pad_file || entry.size == 0)
+      continue;
+    const int first = entry.offset / piece_length;
+    const int last = (entry.offset + entry.size - 1) / piece_length;
+    const int span = last - first + 1;
+    if (span <= m_samplesPerFile + 2) {
+      for (int piece = first; piece <= last; ++piece)
+        pieces << piece;
+      continue;
+    }
+    pieces << first << last;
+    for (int n = 0; n < m_samplesPerFile; ++n)
+      pieces << first + 1 + qrand() % (span - 2);
+  }
+  // Sorted so that every reader moves forward through the files
+  QList<int> result = pieces.toList();
+  qSort(result);
+  return result;
+}
+
+void SampledVerifier::run()
+{
+  if (!checkFileSizes() || m_abort)
+    return;
+
+  qsrand(QDateTime::currentDateTime().toTime_t() ^ (uint) (quintptr) this);
+  const QList<int> pieces = samplePieces();
+  qDebug("Verifying %d of the %d pieces of %s", pieces.size(), m_torrent->num_pieces(), m_torrent->name().c_str());
+  SampleJobs jobs(pieces);
+  QList<SampleReader*> readers;
+  // Mostly I/O bound, a few readers are enough to keep the disks busy
+  const int readerCount = qBound(2, QThread::idealThreadCount(), 8);
+  for (int i = 0; i < readerCount; ++i) {
+    readers << new SampleReader(this, m_torrent, m_filePaths, &jobs, m_abort);
+    readers.last()->start();
+  }
+  foreach (SampleReader *reader, readers) {
+    while (!reader->wait(100))
+      emit progress(jobs.checked(), pieces.size());
+  }
+  qDeleteAll(readers);
+  emit progress(jobs.checked(), pieces.size());
+
+  QMutexLocker locker(&m_mutex);
+  m_completed = !m_abort;
+}
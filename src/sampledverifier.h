@@ -0,0 +1,83 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef SAMPLEDVERIFIER_H
+#define SAMPLEDVERIFIER_H
+
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+#include <libtorrent/torrent_info.hpp>
+
+// Quick verification of existing data before seeding it.
+// The size of every file is checked first, then the first, the last and
+// a random sample of the pieces of each file are read and hashed by a
+// pool of reader threads. The data should only be trusted if passed().
+class SampledVerifier : public QThread {
+  Q_OBJECT
+  Q_DISABLE_COPY(SampledVerifier)
+
+public:
+  // filePaths holds the absolute path of every file of the torrent
+  SampledVerifier(const boost::intrusive_ptr<libtorrent::torrent_info> &t, const QStringList &filePaths,
+                  int samplesPerFile, QObject *parent = 0);
+  ~SampledVerifier();
+
+  void abort();
+  bool passed() const;
+  // Files that failed the verification, with the reason
+  QStringList failures() const;
+
+  // Called from the reader threads
+  void addFailure(int fileIndex, const QString &reason);
+
+signals:
+  void progress(int checkedPieces, int totalPieces);
+
+protected:
+  void run();
+
+private:
+  bool checkFileSizes();
+  QList<int> samplePieces() const;
+
+private:
+  boost::intrusive_ptr<libtorrent::torrent_info> m_torrent;
+  QStringList m_filePaths;
+  int m_samplesPerFile;
+  volatile bool m_abort;
+  mutable QMutex m_mutex;
+  QMap<int, QString> m_failures;
+  bool m_completed;
+};
+
+#endif // SAMPLEDVERIFIER_H
@@ -0,0 +1,62 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "sdnotify.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool sdnotify::notify(const QByteArray &state)
+{
+  const QByteArray path = qgetenv("NOTIFY_SOCKET");
+  struct sockaddr_un addr;
+  if (path.isEmpty() || (path[0] != '/' && path[0] != '@')
+      || path.size() >= (int) sizeof(addr.sun_path))
+    return false;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, path.constData(), path.size());
+  // '@' stands for the Linux abstract namespace
+  if (addr.sun_path[0] == '@')
+    addr.sun_path[0] = '\0';
+
+  const int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (fd < 0)
+    return false;
+  const ssize_t sent = ::sendto(fd, state.constData(), state.size(), 0,
+                                reinterpret_cast<struct sockaddr*>(&addr),
+                                offsetof(struct sockaddr_un, sun_path) + path.size());
+  ::close(fd);
+  return sent == state.size();
+}
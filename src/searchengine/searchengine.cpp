@@ -28,7 +28,6 @@
  * Contact : chris@qbittorrent.org
  */
 
-#include <QStandardItemModel>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QTemporaryFile>
@@ -39,7 +38,6 @@
 #include <QMenu>
 #include <QClipboard>
 #include <QMimeData>
-#include <QSortFilterProxyModel>
 #include <QFileDialog>
 #include <QDesktopServices>
 
@@ -83,15 +81,16 @@ SearchEngine::SearchEngine(MainWindow* parent)
 #ifdef Q_OS_WIN
   has_python = addPythonPathToEnv();
 #endif
-  searchProcess = new QProcess(this);
-  searchProcess->setEnvironment(QProcess::systemEnvironment());
-  connect(searchProcess, SIGNAL(started()), this, SLOT(searchStarted()));
-  connect(searchProcess, SIGNAL(readyReadStandardOutput()), this, SLOT(readSearchOutput()));
-  connect(searchProcess, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(searchFinished(int,QProcess::ExitStatus)));
+  // One process per engine, see SearchProcessPool
+  searchPool = new SearchProcessPool(this);
+  connect(searchPool, SIGNAL(resultsReceived(QString, QList<SearchResult>)), this, SLOT(appendSearchResults(QString, QList<SearchResult>)));
+  connect(searchPool, SIGNAL(engineFinished(QString)), this, SLOT(updateEngineStats()));
+  connect(searchPool, SIGNAL(finished()), this, SLOT(searchFinished()));
   connect(tabWidget, SIGNAL(currentChanged(int)), this, SLOT(tab_changed(int)));
-  searchTimeout = new QTimer(this);
-  searchTimeout->setSingleShot(true);
-  connect(searchTimeout, SIGNAL(timeout()), this, SLOT(on_search_button_clicked()));
+  resultsLabelTimer = new QTimer(this);
+  resultsLabelTimer->setSingleShot(true);
+  resultsLabelTimer->setInterval(250);
+  connect(resultsLabelTimer, SIGNAL(timeout()), this, SLOT(updateResultsLabel()));
   // Update nova.py search plugin if necessary
   updateNova();
   supported_engines = new SupportedEngines(
@@ -180,8 +179,9 @@ QString SearchEngine::selectedCategory() const {
 
 SearchEngine::~SearchEngine() {
   qDebug("Search destruction");
-  searchProcess->kill();
-  searchProcess->waitForFinished();
+  // We are going away, don't get notified
+  searchPool->disconnect(this);
+  searchPool->cancel();
   foreach (QProcess *downloader, downloaders) {
     // Make sure we disconnect the SIGNAL/SLOT first
     // To avoid qreal free
@@ -191,8 +191,8 @@ SearchEngine::~SearchEngine() {
     delete downloader;
   }
   delete search_pattern;
-  delete searchTimeout;
-  delete searchProcess;
+  delete resultsLabelTimer;
+  delete searchPool;
   delete supported_engines;
 }
 
@@ -238,24 +238,15 @@ void SearchEngine::on_search_button_clicked() {
     return;
   }
 #endif
-  if (searchProcess->state() != QProcess::NotRunning) {
-#ifdef Q_OS_WIN
-    searchProcess->kill();
-#else
-    searchProcess->terminate();
-#endif
+  if (searchPool->isRunning()) {
     search_stopped = true;
-    if (searchTimeout->isActive()) {
-      searchTimeout->stop();
-    }
-    if (search_button->text() != tr("Search")) {
+    const bool stop_requested = search_button->text() != tr("Search");
+    searchPool->cancel();
+    if (stop_requested) {
       search_button->setText(tr("Search"));
       return;
     }
   }
-  searchProcess->waitForFinished();
-  // Reload environment variables (proxy)
-  searchProcess->setEnvironment(QProcess::systemEnvironment());
 
   const QString pattern = search_pattern->text().trimmed();
   // No search pattern entered
@@ -272,23 +263,22 @@ void SearchEngine::on_search_button_clicked() {
   tabWidget->addTab(currentSearchTab, tabName);
   tabWidget->setCurrentWidget(currentSearchTab);
 
-  // Getting checked search engines
-  QStringList params;
   search_stopped = false;
-  params << fsutils::toNativePath(fsutils::searchEngineLocation() + "/nova2.py");
-  params << supported_engines->enginesEnabled().join(",");
   qDebug("Search with category: %s", qPrintable(selectedCategory()));
-  params << selectedCategory();
-  params << pattern.split(" ");
   // Update SearchEngine widgets
   no_search_results = true;
   nb_search_results = 0;
-  search_result_line_truncated.clear();
   //on change le texte du label courrant
   currentSearchTab->getCurrentLabel()->setText(tr("Results")+" <i>(0)</i>:");
-  // Launch search
-  searchProcess->start("python", params, QIODevice::ReadOnly);
-  searchTimeout->start(180000); // 3min
+  // Launch search, one process per checked search engine
+  const Preferences pref;
+  searchPool->setMaxConcurrent(pref.searchMaxConcurrentEngines());
+  searchPool->setEngineTimeout(pref.searchEngineTimeout());
+  searchPool->start(supported_engines->enginesEnabled(), selectedCategory(), pattern.split(" "));
+  if (searchPool->isRunning()) {
+    searchStarted();
+    updateEngineStats();
+  }
 }
 
 void SearchEngine::propagateSectionResized(int index, int , int newsize) {
@@ -358,25 +348,61 @@ void SearchEngine::searchStarted() {
   search_button->setText(tr("Stop"));
 }
 
-// search Qprocess return output as soon as it gets new
-// stuff to read. We split it into lines and add each
-// line to search results calling appendSearchResult().
-void SearchEngine::readSearchOutput() {
-  QByteArray output = searchProcess->readAllStandardOutput();
-  output.replace("\r", "");
-  QList<QByteArray> lines_list = output.split('\n');
-  if (!search_result_line_truncated.isEmpty()) {
-    QByteArray end_of_line = lines_list.takeFirst();
-    lines_list.prepend(search_result_line_truncated+end_of_line);
-  }
-  search_result_line_truncated = lines_list.takeLast().trimmed();
-  foreach (const QByteArray &line, lines_list) {
-    appendSearchResult(QString::fromUtf8(line));
+// The search processes return output as soon as they get
+// new stuff to read. SearchProcessPool parses every chunk
+// and we hand it to the results model at once.
+void SearchEngine::appendSearchResults(const QString &engine, const QList<SearchResult> &results) {
+  Q_UNUSED(engine);
+  if (!currentSearchTab) {
+    // The tab was closed, no need to go on
+    search_stopped = true;
+    searchPool->cancel();
+    return;
   }
+
+  const int added = currentSearchTab->getCurrentSearchListModel()->appendResults(results);
+  if (!added)
+    return;
+  no_search_results = false;
+  nb_search_results += added;
+  // Enable clear & download buttons
+  download_button->setEnabled(true);
+  goToDescBtn->setEnabled(true);
+  if (!resultsLabelTimer->isActive())
+    resultsLabelTimer->start();
+}
+
+void SearchEngine::updateResultsLabel() {
   if (currentSearchTab)
     currentSearchTab->getCurrentLabel()->setText(tr("Results")+QString::fromUtf8(" <i>(")+QString::number(nb_search_results)+QString::fromUtf8(")</i>:"));
 }
 
+// Per engine latency and result count, as the results label tooltip
+void SearchEngine::updateEngineStats() {
+  const QList<SearchProcessPool::EngineStats> stats = searchPool->stats();
+  int done = 0;
+  QString html = QString::fromUtf8("<table><tr><th align=\"left\">") + tr("Search engine") + QString::fromUtf8("</th><th>")
+      + tr("Results") + QString::fromUtf8("</th><th>") + tr("First result") + QString::fromUtf8("</th><th>")
+      + tr("Duration") + QString::fromUtf8("</th><th>") + tr("Status") + QString::fromUtf8("</th></tr>");
+  foreach (const SearchProcessPool::EngineStats &engine, stats) {
+    if (engine.state != SearchProcessPool::Queued && engine.state != SearchProcessPool::Running)
+      ++done;
+    const SupportedEngine *supported = supported_engines->value(engine.engine, 0);
+    const QString name = supported ? supported->getFullName() : engine.engine;
+    html += QString::fromUtf8("<tr><td>") + name + QString::fromUtf8("</td><td align=\"right\">")
+        + QString::number(engine.results) + QString::fromUtf8("</td><td align=\"right\">")
+        + (engine.firstResultMs < 0 ? QString::fromUtf8("-") : tr("%1 ms").arg(engine.firstResultMs))
+        + QString::fromUtf8("</td><td align=\"right\">")
+        + (engine.elapsedMs < 0 ? QString::fromUtf8("-") : tr("%1 ms").arg(engine.elapsedMs))
+        + QString::fromUtf8("</td><td>") + SearchProcessPool::stateName(engine.state) + QString::fromUtf8("</td></tr>");
+  }
+  html += QString::fromUtf8("</table>");
+  if (currentSearchTab)
+    currentSearchTab->getCurrentLabel()->setToolTip(html);
+  if (searchPool->isRunning())
+    search_status->setText(tr("Searching... (%1/%2 engines done)").arg(done).arg(stats.size()));
+}
+
 void SearchEngine::downloadFinished(int exitcode, QProcess::ExitStatus) {
   QProcess *downloadProcess = (QProcess*)sender();
   if (exitcode == 0) {
@@ -479,19 +505,26 @@ void SearchEngine::updateNova() {
   }
 }
 
-// Slot called when search is Finished
+// Slot called when all the search engines are done
 // Search can be finished for 3 reasons :
 // Error | Stopped by user | Finished normally
-void SearchEngine::searchFinished(int exitcode,QProcess::ExitStatus) {
-  if (searchTimeout->isActive()) {
-    searchTimeout->stop();
+void SearchEngine::searchFinished() {
+  resultsLabelTimer->stop();
+  updateEngineStats();
+  // Only report an error when no engine could complete
+  bool error = true;
+  foreach (const SearchProcessPool::EngineStats &engine, searchPool->stats()) {
+    if (engine.state == SearchProcessPool::Finished) {
+      error = false;
+      break;
+    }
   }
   QIniSettings settings;
   bool useNotificationBalloons = settings.value("Preferences/General/NotificationBaloons", true).toBool();
   if (useNotificationBalloons && mp_mainWindow->getCurrentTabWidget() != this) {
     mp_mainWindow->showNotificationBaloon(tr("Search Engine"), tr("Search has finished"));
   }
-  if (exitcode) {
+  if (error && !search_stopped) {
 #ifdef Q_OS_WIN
     search_status->setText(tr("Search aborted"));
 #else
@@ -513,71 +546,12 @@ void SearchEngine::searchFinished(int exitcode,QProcess::ExitStatus) {
   search_button->setText(tr("Search"));
 }
 
-// SLOT to append one line to search results list
-// Line is in the following form :
-// file url | file name | file size | nb seeds | nb leechers | Search engine url
-void SearchEngine::appendSearchResult(const QString &line) {
-  if (!currentSearchTab) {
-    if (searchProcess->state() != QProcess::NotRunning) {
-      searchProcess->terminate();
-    }
-    if (searchTimeout->isActive()) {
-      searchTimeout->stop();
-    }
-    search_stopped = true;
-    return;
-  }
-  const QStringList parts = line.split("|");
-  const int nb_fields = parts.size();
-  if (nb_fields < NB_PLUGIN_COLUMNS-1) { //-1 because desc_link is optional
-    return;
-  }
-  Q_ASSERT(currentSearchTab);
-  // Add item to search result list
-  QStandardItemModel* cur_model = currentSearchTab->getCurrentSearchListModel();
-  Q_ASSERT(cur_model);
-  int row = cur_model->rowCount();
-  cur_model->insertRow(row);
-
-  cur_model->setData(cur_model->index(row, SearchSortModel::DL_LINK), parts.at(PL_DL_LINK).trimmed()); // download URL
-  cur_model->setData(cur_model->index(row, SearchSortModel::NAME), parts.at(PL_NAME).trimmed()); // Name
-  cur_model->setData(cur_model->index(row, SearchSortModel::SIZE), parts.at(PL_SIZE).trimmed().toLongLong()); // Size
-  bool ok = false;
-  qlonglong nb_seeders = parts.at(PL_SEEDS).trimmed().toLongLong(&ok);
-  if (!ok || nb_seeders < 0) {
-    cur_model->setData(cur_model->index(row, SearchSortModel::SEEDS), tr("Unknown")); // Seeders
-  } else {
-    cur_model->setData(cur_model->index(row, SearchSortModel::SEEDS), nb_seeders); // Seeders
-  }
-  qlonglong nb_leechers = parts.at(PL_LEECHS).trimmed().toLongLong(&ok);
-  if (!ok || nb_leechers < 0) {
-    cur_model->setData(cur_model->index(row, SearchSortModel::LEECHS), tr("Unknown")); // Leechers
-  } else {
-    cur_model->setData(cur_model->index(row, SearchSortModel::LEECHS), nb_leechers); // Leechers
-  }
-  cur_model->setData(cur_model->index(row, SearchSortModel::ENGINE_URL), parts.at(PL_ENGINE_URL).trimmed()); // Engine URL
-  // Description Link
-  if (nb_fields == NB_PLUGIN_COLUMNS)
-    cur_model->setData(cur_model->index(row, SearchSortModel::DESC_LINK), parts.at(PL_DESC_LINK).trimmed());
-
-  no_search_results = false;
-  ++nb_search_results;
-  // Enable clear & download buttons
-  download_button->setEnabled(true);
-  goToDescBtn->setEnabled(true);
-}
-
 void SearchEngine::closeTab(int index) {
   if (index == tabWidget->indexOf(currentSearchTab)) {
     qDebug("Deleted current search Tab");
-    if (searchProcess->state() != QProcess::NotRunning) {
-      searchProcess->terminate();
-    }
-    if (searchTimeout->isActive()) {
-      searchTimeout->stop();
-    }
     search_stopped = true;
     currentSearchTab = 0;
+    searchPool->cancel();
   }
   delete all_tab.takeAt(index);
   if (!all_tab.size()) {
@@ -591,11 +565,11 @@ void SearchEngine::on_download_button_clicked() {
   //QModelIndexList selectedIndexes = currentSearchTab->getCurrentTreeView()->selectionModel()->selectedIndexes();
   QModelIndexList selectedIndexes = all_tab.at(tabWidget->currentIndex())->getCurrentTreeView()->selectionModel()->selectedIndexes();
   foreach (const QModelIndex &index, selectedIndexes) {
-    if (index.column() == SearchSortModel::NAME) {
+    if (index.column() == SearchResultsModel::NAME) {
       // Get Item url
-      QSortFilterProxyModel* model = all_tab.at(tabWidget->currentIndex())->getCurrentSearchListProxy();
-      QString torrent_url = model->data(model->index(index.row(), URL_COLUMN)).toString();
-      QString engine_url = model->data(model->index(index.row(), ENGINE_URL_COLUMN)).toString();
+      SearchResultsModel* model = all_tab.at(tabWidget->currentIndex())->getCurrentSearchListModel();
+      QString torrent_url = model->data(model->index(index.row(), SearchResultsModel::DL_LINK)).toString();
+      QString engine_url = model->data(model->index(index.row(), SearchResultsModel::ENGINE_URL)).toString();
       downloadTorrent(engine_url, torrent_url);
       all_tab.at(tabWidget->currentIndex())->setRowColor(index.row(), "red");
     }
@@ -606,9 +580,9 @@ void SearchEngine::on_goToDescBtn_clicked()
 {
   QModelIndexList selectedIndexes = all_tab.at(tabWidget->currentIndex())->getCurrentTreeView()->selectionModel()->selectedIndexes();
   foreach (const QModelIndex &index, selectedIndexes) {
-    if (index.column() == SearchSortModel::NAME) {
-      QSortFilterProxyModel* model = all_tab.at(tabWidget->currentIndex())->getCurrentSearchListProxy();
-      const QString desc_url = model->data(model->index(index.row(), SearchSortModel::DESC_LINK)).toString();
+    if (index.column() == SearchResultsModel::NAME) {
+      SearchResultsModel* model = all_tab.at(tabWidget->currentIndex())->getCurrentSearchListModel();
+      const QString desc_url = model->data(model->index(index.row(), SearchResultsModel::DESC_LINK)).toString();
       if (!desc_url.isEmpty())
         QDesktopServices::openUrl(QUrl::fromEncoded(desc_url.toUtf8()));
     }
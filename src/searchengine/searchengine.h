@@ -40,6 +40,7 @@
 #include "engineselectdlg.h"
 #include "searchtab.h"
 #include "supportedengines.h"
+#include "searchprocesspool.h"
 
 class DownloadThread;
 class SearchEngine;
@@ -54,9 +55,6 @@ class SearchEngine : public QWidget, public Ui::search_engine{
   Q_OBJECT
   Q_DISABLE_COPY(SearchEngine)
 
-private:
-  enum PluginColumn { PL_DL_LINK, PL_NAME, PL_SIZE, PL_SEEDS, PL_LEECHS, PL_ENGINE_URL, PL_DESC_LINK, NB_PLUGIN_COLUMNS };
-
 public:
   SearchEngine(MainWindow *mp_mainWindow);
   ~SearchEngine();
@@ -94,9 +92,10 @@ protected slots:
   void tab_changed(int);//to prevent the use of the download button when the tab is empty
   void on_search_button_clicked();
   void closeTab(int index);
-  void appendSearchResult(const QString &line);
-  void searchFinished(int exitcode,QProcess::ExitStatus);
-  void readSearchOutput();
+  void searchFinished();
+  void appendSearchResults(const QString &engine, const QList<SearchResult> &results);
+  void updateResultsLabel();
+  void updateEngineStats();
   void searchStarted();
   void updateNova();
   void on_enginesButton_clicked();
@@ -118,14 +117,14 @@ private slots:
 private:
   // Search related
   LineEdit* search_pattern;
-  QProcess *searchProcess;
+  SearchProcessPool *searchPool;
   QList<QProcess*> downloaders;
   bool search_stopped;
   bool no_search_results;
-  QByteArray search_result_line_truncated;
   unsigned long nb_search_results;
   SupportedEngines *supported_engines;
-  QTimer *searchTimeout;
+  // Coalesces the results label updates while results stream in
+  QTimer *resultsLabelTimer;
   QPointer<SearchTab> currentSearchTab;
   QList<QPointer<SearchTab> > all_tab; // To store all tabs
   const SearchCategories full_cat_names;
@@ -10,10 +10,13 @@ HEADERS += $$PWD/searchengine.h \
            $$PWD/pluginsource.h \
            $$PWD/searchlistdelegate.h \
            $$PWD/supportedengines.h \
-           $$PWD/searchsortmodel.h
+           $$PWD/searchresultsmodel.h \
+           $$PWD/searchprocesspool.h
 
 SOURCES += $$PWD/searchengine.cpp \
            $$PWD/searchtab.cpp \
+           $$PWD/searchresultsmodel.cpp \
+           $$PWD/searchprocesspool.cpp \
            $$PWD/engineselectdlg.cpp
 
 RESOURCES += $$PWD/search.qrc
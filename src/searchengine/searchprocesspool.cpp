@@ -0,0 +1,323 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "searchprocesspool.h"
+#include "fs_utils.h"
+
+#include <QTimer>
+
+SearchProcessPool::SearchProcessPool(QObject *parent)
+  : QObject(parent)
+  , m_maxConcurrent(4)
+  , m_running(0)
+  , m_timeoutSecs(60)
+{
+}
+
+SearchProcessPool::~SearchProcessPool()
+{
+  cancel();
+  qDeleteAll(m_runs);
+}
+
+void SearchProcessPool::setMaxConcurrent(int count)
+{
+  m_maxConcurrent = qMax(1, count);
+  launchQueued();
+}
+
+void SearchProcessPool::setEngineTimeout(int secs)
+{
+  m_timeoutSecs = secs;
+}
+
+void SearchProcessPool::start(const QStringList &engines, const QString &category, const QStringList &keywords)
+{
+  cancel();
+  clearRuns();
+
+  m_category = category;
+  m_keywords = keywords;
+  foreach (const QString &engine, engines) {
+    EngineRun *run = new EngineRun;
+    run->stats.engine = engine;
+    m_runs << run;
+    m_queue << run;
+  }
+
+  launchQueued();
+  if (m_runs.isEmpty())
+    emit finished();
+}
+
+void SearchProcessPool::launchQueued()
+{
+  while (m_running < m_maxConcurrent && !m_queue.isEmpty()) {
+    EngineRun *run = m_queue.takeFirst();
+
+    run->process = new QProcess(this);
+    // Reload environment variables (proxy)
+    run->process->setEnvironment(QProcess::systemEnvironment());
+    connect(run->process, SIGNAL(readyReadStandardOutput()), SLOT(readOutput()));
+    connect(run->process, SIGNAL(finished(int, QProcess::ExitStatus)), SLOT(processFinished(int, QProcess::ExitStatus)));
+    connect(run->process, SIGNAL(error(QProcess::ProcessError)), SLOT(processError(QProcess::ProcessError)));
+    m_runByObject.insert(run->process, run);
+
+    run->timer = new QTimer(this);
+    run->timer->setSingleShot(true);
+    connect(run->timer, SIGNAL(timeout()), SLOT(engineTimedOut()));
+    m_runByObject.insert(run->timer, run);
+
+    run->stats.state = Running;
+    ++m_running;
+
+    QStringList params;
+    params << fsutils::toNativePath(fsutils::searchEngineLocation() + "/nova2.py");
+    params << run->stats.engine;
+    params << m_category;
+    params << m_keywords;
+    qDebug("Launching search plugin %s", qPrintable(run->stats.engine));
+    run->clock.start();
+    run->timer->start(m_timeoutSecs * 1000);
+    run->process->start("python", params, QIODevice::ReadOnly);
+  }
+}
+
+void SearchProcessPool::readOutput()
+{
+  EngineRun *run = runOf(sender());
+  if (!run || !run->process)
+    return;
+  parseOutput(run, run->process->readAllStandardOutput());
+}
+
+// Plugins print one result per line, output chunks can end in the
+// middle of a line so the tail is kept until the next chunk.
+void SearchProcessPool::parseOutput(EngineRun *run, const QByteArray &output)
+{
+  QByteArray data = output;
+  data.replace("\r", "");
+  QList<QByteArray> lines_list = data.split('\n');
+  if (!run->truncatedLine.isEmpty()) {
+    QByteArray end_of_line = lines_list.takeFirst();
+    lines_list.prepend(run->truncatedLine + end_of_line);
+  }
+  run->truncatedLine = lines_list.takeLast().trimmed();
+
+  QList<SearchResult> results;
+  SearchResult result;
+  foreach (const QByteArray &line, lines_list) {
+    if (SearchResultsModel::parseLine(line, result))
+      results << result;
+  }
+  if (results.isEmpty())
+    return;
+
+  if (run->stats.firstResultMs < 0)
+    run->stats.firstResultMs = run->clock.elapsed();
+  run->stats.results += results.size();
+  emit resultsReceived(run->stats.engine, results);
+}
+
+void SearchProcessPool::processFinished(int exitcode, QProcess::ExitStatus status)
+{
+  EngineRun *run = runOf(sender());
+  if (!run || !run->process)
+    return;
+  parseOutput(run, run->process->readAllStandardOutput());
+  // A last line without end of line
+  if (!run->truncatedLine.isEmpty())
+    parseOutput(run, "\n");
+  finishRun(run, (exitcode == 0 && status == QProcess::NormalExit) ? Finished : Failed);
+}
+
+void SearchProcessPool::processError(QProcess::ProcessError error)
+{
+  // Other errors are followed by finished()
+  if (error != QProcess::FailedToStart)
+    return;
+  EngineRun *run = runOf(sender());
+  if (!run)
+    return;
+  qWarning("Search plugin %s could not be started", qPrintable(run->stats.engine));
+  finishRun(run, Failed);
+}
+
+void SearchProcessPool::engineTimedOut()
+{
+  EngineRun *run = runOf(sender());
+  if (!run || run->stats.state != Running)
+    return;
+  qWarning("Search plugin %s timed out", qPrintable(run->stats.engine));
+  stopProcess(run);
+  finishRun(run, TimedOut);
+}
+
+void SearchProcessPool::cancelEngine(const QString &engine)
+{
+  foreach (EngineRun *run, m_runs) {
+    if (run->stats.engine != engine)
+      continue;
+    if (run->stats.state == Queued) {
+      m_queue.removeOne(run);
+      run->stats.state = Canceled;
+      emit engineFinished(engine);
+      if (!m_running && m_queue.isEmpty())
+        emit finished();
+    }
+    else if (run->stats.state == Running) {
+      stopProcess(run);
+      finishRun(run, Canceled);
+    }
+    return;
+  }
+}
+
+void SearchProcessPool::cancel()
+{
+  if (!isRunning())
+    return;
+  const bool launched = m_running > 0;
+
+  foreach (EngineRun *run, m_queue)
+    run->stats.state = Canceled;
+  m_queue.clear();
+
+  // The last one emits finished()
+  foreach (EngineRun *run, m_runs) {
+    if (run->stats.state == Running) {
+      stopProcess(run);
+      finishRun(run, Canceled);
+    }
+  }
+  if (!launched)
+    emit finished();
+}
+
+// Asks the process to quit without blocking, it deletes itself once done
+void SearchProcessPool::stopProcess(EngineRun *run)
+{
+  QProcess *process = run->process;
+  if (!process)
+    return;
+  process->disconnect(this);
+  m_runByObject.remove(process);
+  run->process = 0;
+  if (process->state() == QProcess::NotRunning) {
+    process->deleteLater();
+    return;
+  }
+  connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), process, SLOT(deleteLater()));
+#ifdef Q_OS_WIN
+  process->kill();
+#else
+  process->terminate();
+  QTimer::singleShot(5000, process, SLOT(kill()));
+#endif
+}
+
+void SearchProcessPool::finishRun(EngineRun *run, EngineState state)
+{
+  if (run->stats.state != Running)
+    return;
+
+  run->stats.state = state;
+  run->stats.elapsedMs = run->clock.elapsed();
+  if (run->process)
+    stopProcess(run);
+  if (run->timer) {
+    m_runByObject.remove(run->timer);
+    run->timer->stop();
+    run->timer->deleteLater();
+    run->timer = 0;
+  }
+  --m_running;
+
+  emit engineFinished(run->stats.engine);
+  launchQueued();
+  if (!m_running && m_queue.isEmpty())
+    emit finished();
+}
+
+SearchProcessPool::EngineRun* SearchProcessPool::runOf(QObject *object) const
+{
+  return m_runByObject.value(object, 0);
+}
+
+void SearchProcessPool::clearRuns()
+{
+  qDeleteAll(m_runs);
+  m_runs.clear();
+  m_queue.clear();
+  m_runByObject.clear();
+}
+
+bool SearchProcessPool::isRunning() const
+{
+  return m_running > 0 || !m_queue.isEmpty();
+}
+
+int SearchProcessPool::engineCount() const
+{
+  return m_runs.size();
+}
+
+int SearchProcessPool::pendingCount() const
+{
+  return m_running + m_queue.size();
+}
+
+QList<SearchProcessPool::EngineStats> SearchProcessPool::stats() const
+{
+  QList<EngineStats> stats;
+  foreach (const EngineRun *run, m_runs)
+    stats << run->stats;
+  return stats;
+}
+
+QString SearchProcessPool::stateName(EngineState state)
+{
+  switch(state) {
+  case Queued:
+    return tr("Queued");
+  case Running:
+    return tr("Running");
+  case Finished:
+    return tr("Finished");
+  case Failed:
+    return tr("Failed");
+  case TimedOut:
+    return tr("Timed out");
+  case Canceled:
+    return tr("Canceled");
+  default:
+    return QString();
+  }
+}
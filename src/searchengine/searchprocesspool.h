@@ -0,0 +1,130 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef SEARCHPROCESSPOOL_H
+#define SEARCHPROCESSPOOL_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+#include "searchresultsmodel.h"
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+// Runs one nova2.py process per search engine, at most maxConcurrent at
+// a time, and multiplexes their output as it arrives. Every engine has
+// its own timeout so a stalled plugin doesn't hold back the others.
+class SearchProcessPool : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY(SearchProcessPool)
+
+public:
+  enum EngineState {
+    Queued,
+    Running,
+    Finished,
+    Failed,
+    TimedOut,
+    Canceled
+  };
+
+  struct EngineStats {
+    EngineStats(): state(Queued), firstResultMs(-1), elapsedMs(-1), results(0) {}
+    QString engine;
+    EngineState state;
+    // Milliseconds from the process start, -1 when not known (yet)
+    qint64 firstResultMs;
+    qint64 elapsedMs;
+    int results;
+  };
+
+  explicit SearchProcessPool(QObject *parent = 0);
+  ~SearchProcessPool();
+
+  void start(const QStringList &engines, const QString &category, const QStringList &keywords);
+  // Kills every process and drops the queued engines
+  void cancel();
+  void cancelEngine(const QString &engine);
+  void setMaxConcurrent(int count);
+  void setEngineTimeout(int secs);
+
+  bool isRunning() const;
+  int engineCount() const;
+  int pendingCount() const;
+  QList<EngineStats> stats() const;
+
+  static QString stateName(EngineState state);
+
+signals:
+  void resultsReceived(const QString &engine, const QList<SearchResult> &results);
+  void engineFinished(const QString &engine);
+  void finished();
+
+private slots:
+  void readOutput();
+  void processFinished(int exitcode, QProcess::ExitStatus status);
+  void processError(QProcess::ProcessError error);
+  void engineTimedOut();
+
+private:
+  struct EngineRun {
+    EngineRun(): process(0), timer(0) {}
+    EngineStats stats;
+    QProcess *process;
+    QTimer *timer;
+    QElapsedTimer clock;
+    QByteArray truncatedLine;
+  };
+
+  void launchQueued();
+  void parseOutput(EngineRun *run, const QByteArray &output);
+  void finishRun(EngineRun *run, EngineState state);
+  void stopProcess(EngineRun *run);
+  EngineRun* runOf(QObject *object) const;
+  void clearRuns();
+
+  QList<EngineRun*> m_runs;
+  QList<EngineRun*> m_queue;
+  QHash<QObject*, EngineRun*> m_runByObject;
+  QString m_category;
+  QStringList m_keywords;
+  int m_maxConcurrent;
+  int m_running;
+  int m_timeoutSecs;
+};
+
+#endif // SEARCHPROCESSPOOL_H
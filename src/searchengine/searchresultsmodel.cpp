@@ -0,0 +1,313 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "searchresultsmodel.h"
+#include "misc.h"
+
+#include <QCoreApplication>
+#include <QList>
+#include <algorithm>
+
+class SearchResultLessThan {
+public:
+  explicit SearchResultLessThan(const SearchResultsModel *model): m_model(model) {}
+  bool operator()(int left, int right) const { return m_model->lessThan(left, right); }
+
+private:
+  const SearchResultsModel *m_model;
+};
+
+namespace {
+
+  int compareNumbers(qlonglong left, qlonglong right)
+  {
+    return left < right ? -1 : (left > right ? 1 : 0);
+  }
+
+  int compareNames(const QString &left, const QString &right)
+  {
+    bool res = false;
+    if (misc::naturalSort(left, right, res))
+      return res ? -1 : 1;
+    return left.compare(right);
+  }
+
+}
+
+SearchResultsModel::SearchResultsModel(QObject *parent)
+  : QAbstractTableModel(parent)
+  , m_sortColumn(-1)
+  , m_sortOrder(Qt::AscendingOrder)
+{
+}
+
+int SearchResultsModel::rowCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : m_order.size();
+}
+
+int SearchResultsModel::columnCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : NB_SEARCH_COLUMNS;
+}
+
+QVariant SearchResultsModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || index.row() >= m_order.size())
+    return QVariant();
+  const int i = m_order.at(index.row());
+
+  if (role == Qt::ForegroundRole) {
+    QHash<int, QColor>::const_iterator it = m_colors.constFind(i);
+    if (it != m_colors.constEnd())
+      return it.value();
+    return QVariant();
+  }
+  if (role != Qt::DisplayRole && role != Qt::EditRole)
+    return QVariant();
+
+  switch(index.column()) {
+  case NAME:
+    return m_names.at(i);
+  case SIZE:
+    return m_sizes.at(i);
+  case SEEDS:
+    if (m_seeds.at(i) < 0)
+      return QCoreApplication::translate("SearchEngine", "Unknown");
+    return m_seeds.at(i);
+  case LEECHS:
+    if (m_leechers.at(i) < 0)
+      return QCoreApplication::translate("SearchEngine", "Unknown");
+    return m_leechers.at(i);
+  case ENGINE_URL:
+    return m_engineUrls.at(i);
+  case DL_LINK:
+    return m_dlLinks.at(i);
+  case DESC_LINK:
+    return m_descLinks.at(i);
+  default:
+    return QVariant();
+  }
+}
+
+bool SearchResultsModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+  if (role != Qt::ForegroundRole || !index.isValid() || index.row() >= m_order.size())
+    return false;
+  setRowColor(index.row(), value.value<QColor>());
+  return true;
+}
+
+QVariant SearchResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+
+  switch(section) {
+  case NAME:
+    return QCoreApplication::translate("SearchTab", "Name", "i.e: file name");
+  case SIZE:
+    return QCoreApplication::translate("SearchTab", "Size", "i.e: file size");
+  case SEEDS:
+    return QCoreApplication::translate("SearchTab", "Seeders", "i.e: Number of full sources");
+  case LEECHS:
+    return QCoreApplication::translate("SearchTab", "Leechers", "i.e: Number of partial sources");
+  case ENGINE_URL:
+    return QCoreApplication::translate("SearchTab", "Search engine");
+  default:
+    return QVariant();
+  }
+}
+
+Qt::ItemFlags SearchResultsModel::flags(const QModelIndex &index) const
+{
+  if (!index.isValid())
+    return 0;
+  return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void SearchResultsModel::setRowColor(int row, const QColor &color)
+{
+  if (row < 0 || row >= m_order.size())
+    return;
+  m_colors.insert(m_order.at(row), color);
+  emit dataChanged(index(row, 0), index(row, NB_SEARCH_COLUMNS - 1));
+}
+
+bool SearchResultsModel::lessThan(int left, int right) const
+{
+  int res = 0;
+  switch(m_sortColumn) {
+  case NAME:
+    res = compareNames(m_names.at(left), m_names.at(right));
+    break;
+  case SIZE:
+    res = compareNumbers(m_sizes.at(left), m_sizes.at(right));
+    break;
+  case SEEDS:
+    res = compareNumbers(m_seeds.at(left), m_seeds.at(right));
+    break;
+  case LEECHS:
+    res = compareNumbers(m_leechers.at(left), m_leechers.at(right));
+    break;
+  case ENGINE_URL:
+    res = compareNames(m_engineUrls.at(left), m_engineUrls.at(right));
+    break;
+  case DL_LINK:
+    res = m_dlLinks.at(left).compare(m_dlLinks.at(right));
+    break;
+  case DESC_LINK:
+    res = m_descLinks.at(left).compare(m_descLinks.at(right));
+    break;
+  default:
+    break;
+  }
+  // Equal rows keep their arrival order, whatever the sort order
+  if (res == 0)
+    return left < right;
+  return m_sortOrder == Qt::AscendingOrder ? res < 0 : res > 0;
+}
+
+void SearchResultsModel::sort(int column, Qt::SortOrder order)
+{
+  if (column == m_sortColumn && order == m_sortOrder)
+    return;
+
+  emit layoutAboutToBeChanged();
+  m_sortColumn = column;
+  m_sortOrder = order;
+
+  const QModelIndexList oldPersistent = persistentIndexList();
+  QVector<int> persistentItems(oldPersistent.size());
+  for (int i = 0; i < oldPersistent.size(); ++i)
+    persistentItems[i] = m_order.at(oldPersistent.at(i).row());
+
+  if (m_sortColumn >= 0)
+    std::sort(m_order.begin(), m_order.end(), SearchResultLessThan(this));
+  else
+    std::sort(m_order.begin(), m_order.end());
+
+  QVector<int> rowOf(m_order.size());
+  for (int row = 0; row < m_order.size(); ++row)
+    rowOf[m_order.at(row)] = row;
+  QModelIndexList newPersistent;
+  for (int i = 0; i < oldPersistent.size(); ++i)
+    newPersistent << index(rowOf.at(persistentItems.at(i)), oldPersistent.at(i).column());
+  changePersistentIndexList(oldPersistent, newPersistent);
+  emit layoutChanged();
+}
+
+int SearchResultsModel::appendResults(const QList<SearchResult> &results)
+{
+  const int first = m_names.size();
+  foreach (const SearchResult &result, results) {
+    if (m_knownLinks.contains(result.dlLink))
+      continue;
+    m_knownLinks.insert(result.dlLink);
+    m_names << result.name;
+    m_sizes << result.size;
+    m_seeds << result.seeds;
+    m_leechers << result.leechers;
+    m_engineUrls << result.engineUrl;
+    m_dlLinks << result.dlLink;
+    m_descLinks << result.descLink;
+  }
+
+  const int added = m_names.size() - first;
+  if (added)
+    insertSorted(first);
+  return added;
+}
+
+// Makes the stored results from 'first' on visible
+void SearchResultsModel::insertSorted(int first)
+{
+  const int last = m_names.size();
+
+  if (m_sortColumn < 0) {
+    beginInsertRows(QModelIndex(), m_order.size(), m_order.size() + last - first - 1);
+    for (int i = first; i < last; ++i)
+      m_order << i;
+    endInsertRows();
+    return;
+  }
+
+  const SearchResultLessThan cmp(this);
+  QVector<int> added;
+  added.reserve(last - first);
+  for (int i = first; i < last; ++i)
+    added << i;
+  std::sort(added.begin(), added.end(), cmp);
+
+  // Merge the sorted batch into the current order, run by run.
+  // Every run lands at its final row since the previous runs are above it.
+  int searchFrom = 0;
+  int i = 0;
+  while (i < added.size()) {
+    const int pos = std::upper_bound(m_order.begin() + searchFrom, m_order.end(), added.at(i), cmp) - m_order.begin();
+    int j = i + 1;
+    while (j < added.size() && (pos == m_order.size() || cmp(added.at(j), m_order.at(pos))))
+      ++j;
+
+    beginInsertRows(QModelIndex(), pos, pos + j - i - 1);
+    m_order.insert(pos, j - i, 0);
+    std::copy(added.begin() + i, added.begin() + j, m_order.begin() + pos);
+    endInsertRows();
+
+    searchFrom = pos + j - i;
+    i = j;
+  }
+}
+
+bool SearchResultsModel::parseLine(const QByteArray &line, SearchResult &result)
+{
+  const QList<QByteArray> parts = line.split('|');
+  const int nbFields = parts.size();
+  // desc_link is optional
+  if (nbFields < NB_PLUGIN_COLUMNS - 1)
+    return false;
+
+  result.dlLink = QString::fromUtf8(parts.at(PL_DL_LINK).trimmed());
+  result.name = QString::fromUtf8(parts.at(PL_NAME).trimmed());
+  result.size = parts.at(PL_SIZE).trimmed().toLongLong();
+  bool ok = false;
+  result.seeds = parts.at(PL_SEEDS).trimmed().toLongLong(&ok);
+  if (!ok || result.seeds < 0)
+    result.seeds = -1;
+  result.leechers = parts.at(PL_LEECHS).trimmed().toLongLong(&ok);
+  if (!ok || result.leechers < 0)
+    result.leechers = -1;
+  result.engineUrl = QString::fromUtf8(parts.at(PL_ENGINE_URL).trimmed());
+  if (nbFields == NB_PLUGIN_COLUMNS)
+    result.descLink = QString::fromUtf8(parts.at(PL_DESC_LINK).trimmed());
+  else
+    result.descLink.clear();
+  return true;
+}
@@ -0,0 +1,109 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef SEARCHRESULTSMODEL_H
+#define SEARCHRESULTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+struct SearchResult {
+  SearchResult(): size(0), seeds(-1), leechers(-1) {}
+  QString dlLink;
+  QString name;
+  qlonglong size;
+  // -1 when the engine didn't report it
+  qlonglong seeds;
+  qlonglong leechers;
+  QString engineUrl;
+  QString descLink;
+};
+
+// Results of one search, stored column by column.
+// Rows are only ever appended, in batches: the new rows are inserted at
+// their sorted position (one beginInsertRows() per contiguous run, a
+// single one when the view isn't sorted) so no proxy model is needed.
+// Results already received from another engine (same download link) are
+// dropped.
+class SearchResultsModel : public QAbstractTableModel {
+  Q_OBJECT
+  Q_DISABLE_COPY(SearchResultsModel)
+
+public:
+  enum SearchColumn { NAME, SIZE, SEEDS, LEECHS, ENGINE_URL, DL_LINK, DESC_LINK, NB_SEARCH_COLUMNS };
+
+  explicit SearchResultsModel(QObject *parent = 0);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+  bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+  Qt::ItemFlags flags(const QModelIndex &index) const;
+  void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+  // Returns the number of rows actually added
+  int appendResults(const QList<SearchResult> &results);
+  void setRowColor(int row, const QColor &color);
+
+  // Parses a "link|name|size|seeds|leechers|engine_url[|desc_link]" line
+  static bool parseLine(const QByteArray &line, SearchResult &result);
+
+private:
+  // Field order of the plugins output
+  enum PluginColumn { PL_DL_LINK, PL_NAME, PL_SIZE, PL_SEEDS, PL_LEECHS, PL_ENGINE_URL, PL_DESC_LINK, NB_PLUGIN_COLUMNS };
+
+  friend class SearchResultLessThan;
+  bool lessThan(int left, int right) const;
+  void insertSorted(int first);
+
+  // Columns, indexed by storage position
+  QVector<QString> m_names;
+  QVector<qlonglong> m_sizes;
+  QVector<qlonglong> m_seeds;
+  QVector<qlonglong> m_leechers;
+  QVector<QString> m_engineUrls;
+  QVector<QString> m_dlLinks;
+  QVector<QString> m_descLinks;
+  QHash<int, QColor> m_colors;
+  // Visible row -> storage position
+  QVector<int> m_order;
+  QSet<QString> m_knownLinks;
+  int m_sortColumn;
+  Qt::SortOrder m_sortOrder;
+};
+
+#endif // SEARCHRESULTSMODEL_H
@@ -30,9 +30,7 @@
 
 #include <QDir>
 #include <QTreeView>
-#include <QStandardItemModel>
 #include <QHeaderView>
-#include <QSortFilterProxyModel>
 
 #include "searchtab.h"
 #include "searchlistdelegate.h"
@@ -51,23 +49,15 @@ SearchTab::SearchTab(SearchEngine *parent) : QWidget(), parent(parent)
 
   setLayout(box);
   // Set Search results list model
-  SearchListModel = new QStandardItemModel(0, SearchSortModel::NB_SEARCH_COLUMNS);
-  SearchListModel->setHeaderData(SearchSortModel::NAME, Qt::Horizontal, tr("Name", "i.e: file name"));
-  SearchListModel->setHeaderData(SearchSortModel::SIZE, Qt::Horizontal, tr("Size", "i.e: file size"));
-  SearchListModel->setHeaderData(SearchSortModel::SEEDS, Qt::Horizontal, tr("Seeders", "i.e: Number of full sources"));
-  SearchListModel->setHeaderData(SearchSortModel::LEECHS, Qt::Horizontal, tr("Leechers", "i.e: Number of partial sources"));
-  SearchListModel->setHeaderData(SearchSortModel::ENGINE_URL, Qt::Horizontal, tr("Search engine"));
-
-  proxyModel = new SearchSortModel();
-  proxyModel->setDynamicSortFilter(true);
-  proxyModel->setSourceModel(SearchListModel);
-  resultsBrowser->setModel(proxyModel);
+  // The model sorts itself, new results are inserted at their sorted position
+  SearchListModel = new SearchResultsModel();
+  resultsBrowser->setModel(SearchListModel);
 
   SearchDelegate = new SearchListDelegate();
   resultsBrowser->setItemDelegate(SearchDelegate);
 
-  resultsBrowser->hideColumn(SearchSortModel::DL_LINK); // Hide url column
-  resultsBrowser->hideColumn(SearchSortModel::DESC_LINK);
+  resultsBrowser->hideColumn(SearchResultsModel::DL_LINK); // Hide url column
+  resultsBrowser->hideColumn(SearchResultsModel::DESC_LINK);
 
   resultsBrowser->setRootIsDecorated(false);
   resultsBrowser->setAllColumnsShowFocus(true);
@@ -82,12 +72,12 @@ SearchTab::SearchTab(SearchEngine *parent) : QWidget(), parent(parent)
   }
 
   // Sort by Seeds
-  resultsBrowser->sortByColumn(SearchSortModel::SEEDS, Qt::DescendingOrder);
+  resultsBrowser->sortByColumn(SearchResultsModel::SEEDS, Qt::DescendingOrder);
 }
 
 void SearchTab::downloadSelectedItem(const QModelIndex& index) {
-  QString engine_url = proxyModel->data(proxyModel->index(index.row(), SearchSortModel::ENGINE_URL)).toString();
-  QString torrent_url = proxyModel->data(proxyModel->index(index.row(), SearchSortModel::DL_LINK)).toString();
+  QString engine_url = SearchListModel->data(SearchListModel->index(index.row(), SearchResultsModel::ENGINE_URL)).toString();
+  QString torrent_url = SearchListModel->data(SearchListModel->index(index.row(), SearchResultsModel::DL_LINK)).toString();
   setRowColor(index.row(), "red");
   parent->downloadTorrent(engine_url, torrent_url);
 }
@@ -97,7 +87,6 @@ SearchTab::~SearchTab() {
   delete results_lbl;
   delete resultsBrowser;
   delete SearchListModel;
-  delete proxyModel;
   delete SearchDelegate;
 }
 
@@ -130,23 +119,14 @@ QTreeView* SearchTab::getCurrentTreeView()
   return resultsBrowser;
 }
 
-QSortFilterProxyModel* SearchTab::getCurrentSearchListProxy() const
-{
-  return proxyModel;
-}
-
-QStandardItemModel* SearchTab::getCurrentSearchListModel() const
+SearchResultsModel* SearchTab::getCurrentSearchListModel() const
 {
   return SearchListModel;
 }
 
 // Set the color of a row in data model
 void SearchTab::setRowColor(int row, QString color) {
-  proxyModel->setDynamicSortFilter(false);
-  for (int i=0; i<proxyModel->columnCount(); ++i) {
-    proxyModel->setData(proxyModel->index(row, i), QVariant(QColor(color)), Qt::ForegroundRole);
-  }
-  proxyModel->setDynamicSortFilter(true);
+  SearchListModel->setRowColor(row, QColor(color));
 }
 
 
@@ -32,10 +32,7 @@
 #define SEARCH_TAB_H
 
 #include "ui_search.h"
-#include "searchsortmodel.h"
-
-#define ENGINE_URL_COLUMN 4
-#define URL_COLUMN 5
+#include "searchresultsmodel.h"
 
 class SearchListDelegate;
 class SearchEngine;
@@ -43,7 +40,6 @@ class SearchEngine;
 QT_BEGIN_NAMESPACE
 class QTreeView;
 class QHeaderView;
-class QStandardItemModel;
 QT_END_NAMESPACE
 
 class SearchTab: public QWidget, public Ui::search_engine {
@@ -53,8 +49,7 @@ private:
   QVBoxLayout *box;
   QLabel *results_lbl;
   QTreeView *resultsBrowser;
-  QStandardItemModel *SearchListModel;
-  SearchSortModel *proxyModel;
+  SearchResultsModel *SearchListModel;
   SearchListDelegate *SearchDelegate;
   SearchEngine *parent;
 
@@ -66,8 +61,7 @@ public:
   ~SearchTab();
   bool loadColWidthResultsList();
   QLabel * getCurrentLabel();
-  QStandardItemModel* getCurrentSearchListModel() const;
-  QSortFilterProxyModel* getCurrentSearchListProxy() const;
+  SearchResultsModel* getCurrentSearchListModel() const;
   QTreeView * getCurrentTreeView();
   void setRowColor(int row, QString color);
   QHeaderView* header() const;
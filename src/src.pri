@@ -0,0 +1,208 @@
+# Configuration, modules and source code of qBittorrent, except main.cpp.
+# Shared by src.pro and the benchmarks.
+
+# Windows specific configuration
+win32 {
+  include($$PWD/../winconf.pri)  
+}
+
+# Mac specific configuration
+macx {
+  include($$PWD/../macxconf.pri)
+}
+
+# Unix specific configuration
+unix:!macx {
+  include($$PWD/../unixconf.pri)
+}
+
+# eCS(OS/2) specific configuration
+os2 {
+  include($$PWD/../os2conf.pri)
+}
+
+nox {
+  QT -= gui
+  DEFINES += DISABLE_GUI
+} else {
+  QT += xml
+  CONFIG(static) {
+    DEFINES += QBT_STATIC_QT
+    QTPLUGIN += qico
+  }
+}
+QT += network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+# Disable debug output in release mode
+CONFIG(release, debug|release) {
+   DEFINES += QT_NO_DEBUG_OUTPUT
+}
+
+# VERSION DEFINES
+include($$PWD/../version.pri)
+
+DEFINES += QT_NO_CAST_TO_ASCII
+# Fast concatenation (Qt >= 4.6)
+DEFINES += QT_USE_FAST_CONCATENATION QT_USE_FAST_OPERATOR_PLUS
+
+# Fixes compilation with Boost >= v1.46 where boost
+# filesystem v3 is the default.
+DEFINES += BOOST_FILESYSTEM_VERSION=2
+
+INCLUDEPATH += $$PWD
+
+
+# Source code
+usesystemqtsingleapplication {
+  nox {
+    CONFIG += qtsinglecoreapplication
+  } else {
+    CONFIG += qtsingleapplication
+  }
+} else {
+  nox {
+    include($$PWD/qtsingleapp/qtsinglecoreapplication.pri)
+  } else {
+    include($$PWD/qtsingleapp/qtsingleapplication.pri)
+  }
+}
+
+include($$PWD/qtlibtorrent/qtlibtorrent.pri)
+include($$PWD/webui/webui.pri)
+include($$PWD/control/control.pri)
+include($$PWD/tracker/tracker.pri)
+include($$PWD/preferences/preferences.pri)
+
+!nox {
+  include($$PWD/lineedit/lineedit.pri)
+  include($$PWD/properties/properties.pri)
+  include($$PWD/searchengine/searchengine.pri)
+  include($$PWD/rss/rss.pri)
+  include($$PWD/torrentcreator/torrentcreator.pri)
+  include($$PWD/geoip/geoip.pri)
+  include($$PWD/powermanagement/powermanagement.pri)
+}
+
+HEADERS += $$PWD/misc.h \
+           $$PWD/fs_utils.h \
+           $$PWD/downloadthread.h \
+           $$PWD/stacktrace.h \
+           $$PWD/torrentpersistentdata.h \
+           $$PWD/filesystemwatcher.h \
+           $$PWD/scannedfoldersmodel.h \
+           $$PWD/qinisettings.h \
+           $$PWD/smtp.h \
+           $$PWD/dnsupdater.h
+
+
+SOURCES += $$PWD/filesystemwatcher.cpp \
+           $$PWD/downloadthread.cpp \
+           $$PWD/scannedfoldersmodel.cpp \
+           $$PWD/misc.cpp \
+           $$PWD/fs_utils.cpp \
+           $$PWD/smtp.cpp \
+           $$PWD/dnsupdater.cpp
+
+unix {
+  HEADERS += $$PWD/unixsignalwatcher.h
+  SOURCES += $$PWD/unixsignalwatcher.cpp
+}
+
+# Hot path tracing, enabled with: qmake CONFIG+=tracing
+tracing {
+  DEFINES += QBT_TRACING
+  HEADERS += $$PWD/tracer.h
+  SOURCES += $$PWD/tracer.cpp
+}
+
+nox {
+  HEADERS += $$PWD/headlessloader.h
+  unix {
+    HEADERS += $$PWD/sdnotify.h
+    SOURCES += $$PWD/sdnotify.cpp
+  }
+} else {
+  HEADERS += $$PWD/mainwindow.h \
+              $$PWD/transferlistwidget.h \
+              $$PWD/transferlistdelegate.h \
+              $$PWD/transferlistfilterswidget.h \
+              $$PWD/transferlistsortmodel.h \
+              $$PWD/torrentcontentmodel.h \
+              $$PWD/torrentcontentmodelitem.h \
+              $$PWD/torrentcontentfiltermodel.h \
+              $$PWD/deletionconfirmationdlg.h \
+              $$PWD/statusbar.h \
+              $$PWD/reverseresolution.h \
+              $$PWD/ico.h \
+              $$PWD/speedlimitdlg.h \
+              $$PWD/labelbandwidthdlg.h \
+              $$PWD/about_imp.h \
+              $$PWD/previewselect.h \
+              $$PWD/previewlistdelegate.h \
+              $$PWD/downloadfromurldlg.h \
+              $$PWD/trackerlogin.h \
+              $$PWD/hidabletabwidget.h \
+              $$PWD/sessionapplication.h \
+              $$PWD/torrentimportdlg.h \
+              $$PWD/executionlog.h \
+              $$PWD/iconprovider.h \
+              $$PWD/updownratiodlg.h \
+              $$PWD/loglistwidget.h \
+              $$PWD/addnewtorrentdialog.h \
+              $$PWD/autoexpandabledialog.h \
+              $$PWD/statsdialog.h \
+              $$PWD/messageboxraised.h \
+              $$PWD/hashcache.h \
+              $$PWD/sampledverifier.h
+
+  SOURCES += $$PWD/mainwindow.cpp \
+             $$PWD/ico.cpp \
+             $$PWD/transferlistwidget.cpp \
+             $$PWD/torrentcontentmodel.cpp \
+             $$PWD/torrentcontentfiltermodel.cpp \
+             $$PWD/sessionapplication.cpp \
+             $$PWD/torrentimportdlg.cpp \
+             $$PWD/executionlog.cpp \
+             $$PWD/previewselect.cpp \
+             $$PWD/iconprovider.cpp \
+             $$PWD/updownratiodlg.cpp \
+             $$PWD/labelbandwidthdlg.cpp \
+             $$PWD/loglistwidget.cpp \
+             $$PWD/addnewtorrentdialog.cpp \
+             $$PWD/autoexpandabledialog.cpp \
+             $$PWD/statsdialog.cpp \
+             $$PWD/messageboxraised.cpp \
+             $$PWD/hashcache.cpp \
+             $$PWD/reverseresolution.cpp \
+             $$PWD/sampledverifier.cpp
+
+  win32 {
+    HEADERS += $$PWD/programupdater.h
+    SOURCES += $$PWD/programupdater.cpp
+    DEFINES += NOMINMAX
+  }
+
+  macx {
+    HEADERS += $$PWD/qmacapplication.h \
+               $$PWD/programupdater.h
+
+    SOURCES += $$PWD/qmacapplication.cpp \
+               $$PWD/programupdater.cpp
+  }
+
+  FORMS += $$PWD/mainwindow.ui \
+           $$PWD/about.ui \
+           $$PWD/preview.ui \
+           $$PWD/login.ui \
+           $$PWD/downloadfromurldlg.ui \
+           $$PWD/bandwidth_limit.ui \
+           $$PWD/updownratiodlg.ui \
+           $$PWD/confirmdeletiondlg.ui \
+           $$PWD/torrentimportdlg.ui \
+           $$PWD/executionlog.ui \
+           $$PWD/addnewtorrentdialog.ui \
+           $$PWD/autoexpandabledialog.ui \
+           $$PWD/statsdialog.ui
+}
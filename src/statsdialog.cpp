@@ -39,23 +39,18 @@ StatsDialog::StatsDialog(QWidget *parent) :   QDialog(parent), ui(new Ui::StatsD
   connect(ui->buttonOK, SIGNAL(clicked()), SLOT(close()));
   session = QBtSession::instance();
   updateUI();
-  t = new QTimer(this);
-  t->setInterval(1500);
-  connect(t, SIGNAL(timeout()), SLOT(updateUI()));
-  t->start();
+  connect(session->getSnapshotService(), SIGNAL(snapshotUpdated()), SLOT(updateUI()));
   show();
 }
 
 StatsDialog::~StatsDialog() {
-  t->stop();
-  delete t;
   delete ui;
 }
 
 void StatsDialog::updateUI() {
-  libtorrent::session* s = session->getSession();
-  libtorrent::cache_status cache = s->get_cache_status();
-  libtorrent::session_status ss = s->status();
+  const SessionSnapshotPtr snapshot = session->sessionSnapshot();
+  const libtorrent::cache_status &cache = snapshot->cache;
+  const libtorrent::session_status &ss = snapshot->status;
 
   // Alltime DL/UL
   quint64 atd = session->getAlltimeDL();
@@ -83,12 +78,7 @@ void StatsDialog::updateUI() {
   // to complete before it receives or sends any more data on the socket. It'a a metric of how disk bound you are.
 
   // num_peers is not reliable (adds up peers, which didn't even overcome tcp handshake)
-  const std::vector<libtorrent::torrent_handle> torrents = session->getTorrents();
-  std::vector<libtorrent::torrent_handle>::const_iterator iBegin = torrents.begin();
-  std::vector<libtorrent::torrent_handle>::const_iterator iEnd = torrents.end();
-  quint32 peers = 0;
-  for ( ; iBegin < iEnd ; ++iBegin)
-    peers += (*iBegin).status().num_peers;
+  const int peers = snapshot->torrentPeers;
   ui->labelWriteStarve->setText(
         ( ss.disk_write_queue > 0 && peers > 0 ) ?
           misc::accurateDoubleToString(100. * (qreal)ss.disk_write_queue / (qreal)peers, 2) + "%" :
@@ -32,7 +32,6 @@
 #define STATSDIALOG_H
 
 #include <QDialog>
-#include <QTimer>
 #include "qbtsession.h"
 
 namespace Ui {
@@ -52,7 +51,6 @@ private slots:
 private:
   Ui::StatsDialog *ui;
   QBtSession* session;
-  QTimer* t;
 };
 
 #endif // STATSDIALOG_H
@@ -32,78 +32,103 @@
 #include "misc.h"
 #include "fs_utils.h"
 #include "torrentcontentmodel.h"
-#include "torrentcontentmodelitem.h"
-#include "torrentcontentmodelfolder.h"
-#include "torrentcontentmodelfile.h"
 #include <QDir>
 
+namespace {
+  inline int prioBucket(int prio)
+  {
+    return qBound(0, prio, 7);
+  }
+}
+
+TorrentContentModel::Folder::Folder(int parent, int name, int row)
+  : parent(parent), name(name), row(row), size(0), wantedSize(0), wantedDone(0), fileCount(0)
+{
+  for (int i = 0; i < PRIO_COUNT; ++i)
+    prioCounts[i] = 0;
+}
+
 TorrentContentModel::TorrentContentModel(QObject *parent):
-  QAbstractItemModel(parent),
-    m_rootItem(new TorrentContentModelFolder(QList<QVariant>() << tr("Name") << tr("Size")
-                                         << tr("Progress") << tr("Priority")))
+  QAbstractItemModel(parent)
 {
+  resetData();
 }
 
 TorrentContentModel::~TorrentContentModel()
 {
-  delete m_rootItem;
+}
+
+void TorrentContentModel::resetData()
+{
+  m_names.clear();
+  m_folders.clear();
+  m_folders << Folder();
+  m_materialized = QBitArray(1);
+  m_dirtyFolders.clear();
+  m_fileNames.clear();
+  m_fileFolders.clear();
+  m_filePriorities.clear();
+  m_fileSizes.clear();
+  m_fileDone.clear();
 }
 
 void TorrentContentModel::updateFilesProgress(const std::vector<libtorrent::size_type>& fp)
 {
-  Q_ASSERT(m_filesIndex.size() == (int)fp.size());
+  Q_ASSERT(m_fileDone.size() == (int)fp.size());
   // XXX: Why is this necessary?
-  if (m_filesIndex.size() != (int)fp.size())
+  if (m_fileDone.size() != (int)fp.size())
     return;
 
-  emit layoutAboutToBeChanged();
-  for (uint i = 0; i < fp.size(); ++i) {
-    m_filesIndex[i]->setProgress(fp[i]);
+  for (int i = 0; i < m_fileDone.size(); ++i) {
+    const qulonglong done = fp[i];
+    if (done == m_fileDone[i])
+      continue;
+    const qulonglong old_done = m_fileDone[i];
+    m_fileDone[i] = done;
+    // The progress of ignored files is not displayed
+    if (m_filePriorities[i] == prio::IGNORED)
+      continue;
+    // Update the folders progress up to the root
+    for (int folder = m_fileFolders[i]; folder >= 0; folder = m_folders[folder].parent) {
+      m_folders[folder].wantedDone += done;
+      m_folders[folder].wantedDone -= old_done;
+      m_dirtyFolders << folder;
+    }
   }
-  // Update folders progress in the tree
-  m_rootItem->recalculateProgress();
-  emit dataChanged(index(0,0), index(rowCount(), columnCount()));
+  emitDirtyRows();
 }
 
 void TorrentContentModel::updateFilesPriorities(const std::vector<int>& fprio)
 {
-  Q_ASSERT(m_filesIndex.size() == (int)fprio.size());
+  Q_ASSERT(m_filePriorities.size() == (int)fprio.size());
   // XXX: Why is this necessary?
-  if (m_filesIndex.size() != (int)fprio.size())
+  if (m_filePriorities.size() != (int)fprio.size())
     return;
 
-  emit layoutAboutToBeChanged();
-  for (uint i = 0; i < fprio.size(); ++i) {
-    m_filesIndex[i]->setPriority(fprio[i]);
-  }
-  emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+  for (uint i = 0; i < fprio.size(); ++i)
+    setFilePriority(i, fprio[i]);
+  emitDirtyRows();
 }
 
 std::vector<int> TorrentContentModel::getFilesPriorities() const
 {
-  std::vector<int> prio;
-  prio.reserve(m_filesIndex.size());
-  foreach (const TorrentContentModelFile* file, m_filesIndex) {
-    prio.push_back(file->priority());
-  }
-  return prio;
+  return m_filePriorities.toStdVector();
 }
 
 bool TorrentContentModel::allFiltered() const
 {
-  foreach (const TorrentContentModelFile* fileItem, m_filesIndex) {
-    if (fileItem->priority() != prio::IGNORED)
-      return false;
-  }
-  return true;
+  const Folder &root = m_folders.first();
+  return root.prioCounts[prio::IGNORED] == root.fileCount;
 }
 
-int TorrentContentModel::columnCount(const QModelIndex& parent) const
+qulonglong TorrentContentModel::selectedSize() const
 {
-  if (parent.isValid())
-    return static_cast<TorrentContentModelItem*>(parent.internalPointer())->columnCount();
-  else
-    return m_rootItem->columnCount();
+  return m_folders.first().wantedSize;
+}
+
+int TorrentContentModel::columnCount(const QModelIndex&) const
+{
+  return TorrentContentModelItem::NB_COL;
 }
 
 bool TorrentContentModel::setData(const QModelIndex& index, const QVariant& value, int role)
@@ -111,38 +136,44 @@ bool TorrentContentModel::setData(const QModelIndex& index, const QVariant& valu
   if (!index.isValid())
     return false;
 
+  const quint32 ref = indexRef(index);
   if (index.column() == 0 && role == Qt::CheckStateRole) {
-    TorrentContentModelItem *item = static_cast<TorrentContentModelItem*>(index.internalPointer());
-    qDebug("setData(%s, %d", qPrintable(item->name()), value.toInt());
-    if (item->priority() != value.toInt()) {
+    qDebug("setData(%s, %d", qPrintable(m_names.at(nameOf(ref))), value.toInt());
+    if (priorityOf(ref) != value.toInt()) {
       if (value.toInt() == Qt::PartiallyChecked)
-        item->setPriority(prio::MIXED);
+        setItemPriority(ref, prio::MIXED);
       else if (value.toInt() == Qt::Unchecked)
-        item->setPriority(prio::IGNORED);
+        setItemPriority(ref, prio::IGNORED);
       else
-        item->setPriority(prio::NORMAL);
-      // Update folders progress in the tree
-      m_rootItem->recalculateProgress();
-      emit dataChanged(this->index(0,0), this->index(rowCount()-1, columnCount()-1));
+        setItemPriority(ref, prio::NORMAL);
+      emitDirtyRows();
       emit filteredFilesChanged();
     }
     return true;
   }
 
   if (role == Qt::EditRole) {
-    Q_ASSERT(index.isValid());
-    TorrentContentModelItem* item = static_cast<TorrentContentModelItem*>(index.internalPointer());
     switch(index.column()) {
-    case TorrentContentModelItem::COL_NAME:
-      item->setName(value.toString());
+    case TorrentContentModelItem::COL_NAME: {
+      // Renamed items get their own segment, the interned ones are shared
+      QString name = value.toString();
+      if (name.endsWith(".!qB"))
+        name.chop(4);
+      m_names << name;
+      if (isFolderRef(ref))
+        m_folders[refId(ref)].name = m_names.size() - 1;
+      else
+        m_fileNames[refId(ref)] = m_names.size() - 1;
+      emit dataChanged(index, index);
       break;
+    }
     case TorrentContentModelItem::COL_PRIO:
-      item->setPriority(value.toInt());
+      setItemPriority(ref, value.toInt());
+      emitDirtyRows();
       break;
     default:
       return false;
     }
-    emit dataChanged(index, index);
     return true;
   }
 
@@ -151,14 +182,36 @@ bool TorrentContentModel::setData(const QModelIndex& index, const QVariant& valu
 
 TorrentContentModelItem::ItemType TorrentContentModel::itemType(const QModelIndex& index) const
 {
-  return static_cast<const TorrentContentModelItem*>(index.internalPointer())->itemType();
+  return isFolderRef(indexRef(index)) ? TorrentContentModelItem::FolderType : TorrentContentModelItem::FileType;
 }
 
 int TorrentContentModel::getFileIndex(const QModelIndex& index)
 {
-  TorrentContentModelFile* item = dynamic_cast<TorrentContentModelFile*>(static_cast<TorrentContentModelItem*>(index.internalPointer()));
-  Q_ASSERT(item);
-  return item->fileIndex();
+  const quint32 ref = indexRef(index);
+  Q_ASSERT(!isFolderRef(ref));
+  return isFolderRef(ref) ? -1 : refId(ref);
+}
+
+QList<int> TorrentContentModel::folderFileIndexes(const QModelIndex& index) const
+{
+  QList<int> files;
+  if (!index.isValid())
+    collectFiles(0, files);
+  else if (isFolderRef(indexRef(index)))
+    collectFiles(refId(indexRef(index)), files);
+  else
+    files << refId(indexRef(index));
+  return files;
+}
+
+bool TorrentContentModel::hasSiblingNamed(const QModelIndex& index, const QString& name) const
+{
+  const quint32 ref = indexRef(index);
+  foreach (quint32 sibling, m_folders.at(parentFolderOf(ref)).children) {
+    if (sibling != ref && fsutils::sameFileNames(m_names.at(nameOf(sibling)), name))
+      return true;
+  }
+  return false;
 }
 
 QVariant TorrentContentModel::data(const QModelIndex& index, int role) const
@@ -166,24 +219,36 @@ QVariant TorrentContentModel::data(const QModelIndex& index, int role) const
   if (!index.isValid())
     return QVariant();
 
-  TorrentContentModelItem* item = static_cast<TorrentContentModelItem*>(index.internalPointer());
+  const quint32 ref = indexRef(index);
   if (index.column() == 0 && role == Qt::DecorationRole) {
-    if (item->itemType() == TorrentContentModelItem::FolderType)
+    if (isFolderRef(ref))
       return IconProvider::instance()->getIcon("inode-directory");
     else
       return IconProvider::instance()->getIcon("text-plain");
   }
   if (index.column() == 0 && role == Qt::CheckStateRole) {
-    if (item->data(TorrentContentModelItem::COL_PRIO).toInt() == prio::IGNORED)
+    const int prio = priorityOf(ref);
+    if (prio == prio::IGNORED)
       return Qt::Unchecked;
-    if (item->data(TorrentContentModelItem::COL_PRIO).toInt() == prio::MIXED)
+    if (prio == prio::MIXED)
       return Qt::PartiallyChecked;
     return Qt::Checked;
   }
   if (role != Qt::DisplayRole)
     return QVariant();
 
-  return item->data(index.column());
+  switch(index.column()) {
+  case TorrentContentModelItem::COL_NAME:
+    return m_names.at(nameOf(ref));
+  case TorrentContentModelItem::COL_PRIO:
+    return priorityOf(ref);
+  case TorrentContentModelItem::COL_PROGRESS:
+    return progressOf(ref);
+  case TorrentContentModelItem::COL_SIZE:
+    return sizeOf(ref);
+  default:
+    return QVariant();
+  }
 }
 
 Qt::ItemFlags TorrentContentModel::flags(const QModelIndex& index) const
@@ -199,10 +264,21 @@ Qt::ItemFlags TorrentContentModel::flags(const QModelIndex& index) const
 
 QVariant TorrentContentModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-  if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
-    return m_rootItem->data(section);
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
 
-  return QVariant();
+  switch(section) {
+  case TorrentContentModelItem::COL_NAME:
+    return tr("Name");
+  case TorrentContentModelItem::COL_SIZE:
+    return tr("Size");
+  case TorrentContentModelItem::COL_PROGRESS:
+    return tr("Progress");
+  case TorrentContentModelItem::COL_PRIO:
+    return tr("Priority");
+  default:
+    return QVariant();
+  }
 }
 
 QModelIndex TorrentContentModel::index(int row, int column, const QModelIndex& parent) const
@@ -210,23 +286,22 @@ QModelIndex TorrentContentModel::index(int row, int column, const QModelIndex& p
   if (parent.isValid() && parent.column() != 0)
     return QModelIndex();
 
-  if (column >= TorrentContentModelItem::NB_COL)
+  if (row < 0 || column < 0 || column >= TorrentContentModelItem::NB_COL)
     return QModelIndex();
 
-  TorrentContentModelFolder* parentItem;
-  if (!parent.isValid())
-    parentItem = m_rootItem;
-  else
-    parentItem = static_cast<TorrentContentModelFolder*>(parent.internalPointer());
-  Q_ASSERT(parentItem);
+  int folder = 0;
+  if (parent.isValid()) {
+    if (!isFolderRef(indexRef(parent)))
+      return QModelIndex();
+    folder = refId(indexRef(parent));
+  }
 
-  if (row >= parentItem->childCount())
+  const Folder &parentFolder = m_folders.at(folder);
+  if (row >= parentFolder.children.size())
     return QModelIndex();
 
-  TorrentContentModelItem* childItem = parentItem->child(row);
-  if (childItem)
-    return createIndex(row, column, childItem);
-  return QModelIndex();
+  m_materialized.setBit(folder);
+  return createIndex(row, column, parentFolder.children.at(row));
 }
 
 QModelIndex TorrentContentModel::parent(const QModelIndex& index) const
@@ -234,15 +309,7 @@ QModelIndex TorrentContentModel::parent(const QModelIndex& index) const
   if (!index.isValid())
     return QModelIndex();
 
-  TorrentContentModelItem* childItem = static_cast<TorrentContentModelItem*>(index.internalPointer());
-  if (!childItem)
-    return QModelIndex();
-
-  TorrentContentModelItem *parentItem = childItem->parent();
-  if (parentItem == m_rootItem)
-    return QModelIndex();
-
-  return createIndex(parentItem->row(), 0, parentItem);
+  return folderIndex(parentFolderOf(indexRef(index)));
 }
 
 int TorrentContentModel::rowCount(const QModelIndex& parent) const
@@ -250,21 +317,30 @@ int TorrentContentModel::rowCount(const QModelIndex& parent) const
   if (parent.column() > 0)
     return 0;
 
-  TorrentContentModelFolder* parentItem;
-  if (!parent.isValid())
-    parentItem = m_rootItem;
-  else
-    parentItem = dynamic_cast<TorrentContentModelFolder*>(static_cast<TorrentContentModelItem*>(parent.internalPointer()));
+  int folder = 0;
+  if (parent.isValid()) {
+    if (!isFolderRef(indexRef(parent)))
+      return 0;
+    folder = refId(indexRef(parent));
+  }
 
-  return parentItem ? parentItem->childCount() : 0;
+  m_materialized.setBit(folder);
+  return m_folders.at(folder).children.size();
+}
+
+bool TorrentContentModel::hasChildren(const QModelIndex& parent) const
+{
+  if (!parent.isValid())
+    return !m_folders.first().children.isEmpty();
+  // Folders are never empty, no need to materialize their rows
+  return parent.column() == 0 && isFolderRef(indexRef(parent));
 }
 
 void TorrentContentModel::clear()
 {
   qDebug("clear called");
   beginResetModel();
-  m_filesIndex.clear();
-  m_rootItem->deleteAllChildren();
+  resetData();
   endResetModel();
 }
 
@@ -274,52 +350,202 @@ void TorrentContentModel::setupModelData(const libtorrent::torrent_info& t)
   if (t.num_files() == 0)
     return;
 
-  emit layoutAboutToBeChanged();
-  // Initialize files_index array
-  qDebug("Torrent contains %d files", t.num_files());
-  m_filesIndex.reserve(t.num_files());
-
-  TorrentContentModelFolder* current_parent;
-  // Iterate over files
-  for (int i = 0; i < t.num_files(); ++i) {
+  beginResetModel();
+  resetData();
+  const int nb_files = t.num_files();
+  qDebug("Torrent contains %d files", nb_files);
+  m_fileNames.reserve(nb_files);
+  m_fileFolders.reserve(nb_files);
+  m_fileSizes.reserve(nb_files);
+  m_filePriorities.fill(prio::NORMAL, nb_files);
+  m_fileDone.fill(0, nb_files);
+
+  QHash<QString, int> name_ids;
+  // (parent folder, name) -> folder
+  QHash<quint64, int> folder_ids;
+  for (int i = 0; i < nb_files; ++i) {
     const libtorrent::file_entry& fentry = t.file_at(i);
-    current_parent = m_rootItem;
-    QString path = fsutils::fromNativePath(misc::toQStringU(fentry.path));
-    // Iterate of parts of the path to create necessary folders
-    QStringList pathFolders = path.split("/", QString::SkipEmptyParts);
-    pathFolders.removeLast();
-    foreach (const QString& pathPart, pathFolders) {
-      if (pathPart == ".unwanted")
+    const QString path = fsutils::fromNativePath(misc::toQStringU(fentry.path));
+    // Walk the parts of the path to find or create the folders
+    int folder = 0;
+    int start = 0;
+    for (int end = path.indexOf('/'); end >= 0; start = end + 1, end = path.indexOf('/', start)) {
+      if (end == start)
+        continue;
+      const QString part = path.mid(start, end - start);
+      if (part == ".unwanted")
+        continue;
+      const int name = internName(part, name_ids);
+      const quint64 key = ((quint64) folder << 32) | (quint32) name;
+      const QHash<quint64, int>::ConstIterator it = folder_ids.constFind(key);
+      if (it != folder_ids.constEnd()) {
+        folder = it.value();
         continue;
-      TorrentContentModelFolder* new_parent = current_parent->childFolderWithName(pathPart);
-      if (!new_parent) {
-        new_parent = new TorrentContentModelFolder(pathPart, current_parent);
-        current_parent->appendChild(new_parent);
       }
-      current_parent = new_parent;
+      const int new_folder = m_folders.size();
+      m_folders << Folder(folder, name, m_folders.at(folder).children.size());
+      m_folders[folder].children << folderRef(new_folder);
+      folder_ids.insert(key, new_folder);
+      folder = new_folder;
     }
     // Actually create the file
-    TorrentContentModelFile* fileItem = new TorrentContentModelFile(fentry, current_parent, i);
-    current_parent->appendChild(fileItem);
-    m_filesIndex.push_back(fileItem);
+    const qulonglong size = fentry.size;
+    m_fileNames << internName(path.mid(start), name_ids);
+    m_fileFolders << folder;
+    m_fileSizes << size;
+    m_folders[folder].children << fileRef(i);
+    for ( ; folder >= 0; folder = m_folders.at(folder).parent) {
+      Folder &current = m_folders[folder];
+      current.size += size;
+      current.wantedSize += size;
+      ++current.fileCount;
+      ++current.prioCounts[prio::NORMAL];
+    }
   }
-  emit layoutChanged();
+  m_materialized = QBitArray(m_folders.size());
+  endResetModel();
 }
 
 void TorrentContentModel::selectAll()
 {
-  for (int i=0; i<m_rootItem->childCount(); ++i) {
-    TorrentContentModelItem* child = m_rootItem->child(i);
-    if (child->priority() == prio::IGNORED)
-      child->setPriority(prio::NORMAL);
+  foreach (quint32 child, m_folders.first().children) {
+    if (priorityOf(child) == prio::IGNORED)
+      setItemPriority(child, prio::NORMAL);
   }
-  emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+  emitDirtyRows();
 }
 
 void TorrentContentModel::selectNone()
 {
-  for (int i=0; i<m_rootItem->childCount(); ++i) {
-    m_rootItem->child(i)->setPriority(prio::IGNORED);
+  foreach (quint32 child, m_folders.first().children)
+    setItemPriority(child, prio::IGNORED);
+  emitDirtyRows();
+}
+
+int TorrentContentModel::internName(const QString& name, QHash<QString, int>& ids)
+{
+  QString display_name = name;
+  // Do not display incomplete extensions
+  if (display_name.endsWith(".!qB"))
+    display_name.chop(4);
+  QHash<QString, int>::ConstIterator it = ids.constFind(display_name);
+  if (it != ids.constEnd())
+    return it.value();
+  m_names << display_name;
+  ids.insert(display_name, m_names.size() - 1);
+  return m_names.size() - 1;
+}
+
+int TorrentContentModel::nameOf(quint32 ref) const
+{
+  return isFolderRef(ref) ? m_folders.at(refId(ref)).name : m_fileNames.at(refId(ref));
+}
+
+int TorrentContentModel::parentFolderOf(quint32 ref) const
+{
+  return isFolderRef(ref) ? m_folders.at(refId(ref)).parent : m_fileFolders.at(refId(ref));
+}
+
+QModelIndex TorrentContentModel::folderIndex(int folder) const
+{
+  if (folder <= 0)
+    return QModelIndex();
+  return createIndex(m_folders.at(folder).row, 0, folderRef(folder));
+}
+
+int TorrentContentModel::folderPriority(const Folder& folder) const
+{
+  // If all files have the same priority then the folder has it too
+  for (int prio = 0; prio < PRIO_COUNT; ++prio) {
+    if (folder.prioCounts[prio] == folder.fileCount)
+      return prio;
+  }
+  return prio::MIXED;
+}
+
+int TorrentContentModel::priorityOf(quint32 ref) const
+{
+  return isFolderRef(ref) ? folderPriority(m_folders.at(refId(ref))) : m_filePriorities.at(refId(ref));
+}
+
+qulonglong TorrentContentModel::sizeOf(quint32 ref) const
+{
+  return isFolderRef(ref) ? m_folders.at(refId(ref)).size : m_fileSizes.at(refId(ref));
+}
+
+float TorrentContentModel::progressOf(quint32 ref) const
+{
+  if (priorityOf(ref) == prio::IGNORED)
+    return 0;
+
+  const qulonglong size = sizeOf(ref);
+  if (size == 0)
+    return 1;
+  const qulonglong done = isFolderRef(ref) ? m_folders.at(refId(ref)).wantedDone : m_fileDone.at(refId(ref));
+  return done / (double) size;
+}
+
+void TorrentContentModel::collectFiles(int folder, QList<int>& files) const
+{
+  foreach (quint32 child, m_folders.at(folder).children) {
+    if (isFolderRef(child))
+      collectFiles(refId(child), files);
+    else
+      files << refId(child);
+  }
+}
+
+void TorrentContentModel::setFilePriority(int file, int prio)
+{
+  const int old_prio = m_filePriorities.at(file);
+  if (old_prio == prio || prio == prio::MIXED)
+    return;
+  m_filePriorities[file] = prio;
+
+  const bool was_wanted = (old_prio != prio::IGNORED);
+  const bool wanted = (prio != prio::IGNORED);
+  for (int folder = m_fileFolders.at(file); folder >= 0; folder = m_folders.at(folder).parent) {
+    Folder &current = m_folders[folder];
+    --current.prioCounts[prioBucket(old_prio)];
+    ++current.prioCounts[prioBucket(prio)];
+    if (was_wanted != wanted) {
+      if (wanted) {
+        current.wantedSize += m_fileSizes.at(file);
+        current.wantedDone += m_fileDone.at(file);
+      } else {
+        current.wantedSize -= m_fileSizes.at(file);
+        current.wantedDone -= m_fileDone.at(file);
+      }
+    }
+    m_dirtyFolders << folder;
+  }
+}
+
+void TorrentContentModel::setItemPriority(quint32 ref, int prio)
+{
+  if (!isFolderRef(ref)) {
+    Q_ASSERT(prio != prio::MIXED);
+    setFilePriority(refId(ref), prio);
+    return;
+  }
+  // Mixed is only a consequence of the files priorities
+  if (prio == prio::MIXED)
+    return;
+  QList<int> files;
+  collectFiles(refId(ref), files);
+  foreach (int file, files)
+    setFilePriority(file, prio);
+}
+
+void TorrentContentModel::emitDirtyRows()
+{
+  // Only the folders displayed by a view need to report their rows
+  foreach (int folder, m_dirtyFolders) {
+    const int count = m_folders.at(folder).children.size();
+    if (!count || !m_materialized.testBit(folder))
+      continue;
+    const QModelIndex parent = folderIndex(folder);
+    emit dataChanged(index(0, 0, parent), index(count - 1, TorrentContentModelItem::NB_COL - 1, parent));
   }
- emit dataChanged(index(0, 0), index(rowCount(), columnCount()));
+  m_dirtyFolders.clear();
 }
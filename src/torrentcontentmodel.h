@@ -32,7 +32,12 @@
 #define TORRENTCONTENTMODEL_H
 
 #include <QAbstractItemModel>
+#include <QBitArray>
+#include <QHash>
+#include <QList>
 #include <QModelIndex>
+#include <QSet>
+#include <QStringList>
 #include <QVector>
 #include <QVariant>
 
@@ -40,8 +45,12 @@
 
 #include "torrentcontentmodelitem.h"
 
-class TorrentContentModelFile;
-
+// Files of a torrent shown as a tree.
+// The tree is stored flat: the path segments are interned once, the files
+// are kept in per-file arrays and every folder keeps aggregates (size, done
+// bytes, priority counts) which are updated from the per-file deltas.
+// No object is created per row, the rows of a folder are only reported to
+// the views once they asked for its children (i.e. when it is expanded).
 class TorrentContentModel:  public QAbstractItemModel {
   Q_OBJECT
 
@@ -53,16 +62,23 @@ public:
   void updateFilesPriorities(const std::vector<int> &fprio);
   std::vector<int> getFilesPriorities() const;
   bool allFiltered() const;
+  // Total size of the files which are not ignored
+  qulonglong selectedSize() const;
   virtual int columnCount(const QModelIndex &parent=QModelIndex()) const;
   virtual bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
   TorrentContentModelItem::ItemType itemType(const QModelIndex& index) const;
   int getFileIndex(const QModelIndex& index);
+  // Indexes of the files in the given folder and its subfolders
+  QList<int> folderFileIndexes(const QModelIndex& index) const;
+  // True if another item of the same folder is already called name
+  bool hasSiblingNamed(const QModelIndex& index, const QString& name) const;
   virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
   virtual Qt::ItemFlags flags(const QModelIndex& index) const;
   virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const;
   virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
   virtual QModelIndex parent(const QModelIndex& index) const;
   virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+  virtual bool hasChildren(const QModelIndex& parent = QModelIndex()) const;
   void clear();
   void setupModelData(const libtorrent::torrent_info& t);
 
@@ -74,8 +90,58 @@ public slots:
   void selectNone();
 
 private:
-  TorrentContentModelFolder* m_rootItem;
-  QVector<TorrentContentModelFile*> m_filesIndex;
+  enum { PRIO_COUNT = 8 };
+
+  struct Folder {
+    Folder(int parent = -1, int name = -1, int row = 0);
+    int parent;
+    int name;
+    // Row in the parent folder
+    int row;
+    qulonglong size;
+    // Sizes and done bytes of the files which are not ignored
+    qulonglong wantedSize;
+    qulonglong wantedDone;
+    int fileCount;
+    int prioCounts[PRIO_COUNT];
+    // Children in display order, see fileRef() and folderRef()
+    QVector<quint32> children;
+  };
+
+  static quint32 fileRef(int file) { return (quint32) file << 1; }
+  static quint32 folderRef(int folder) { return ((quint32) folder << 1) | 1; }
+  static bool isFolderRef(quint32 ref) { return ref & 1; }
+  static int refId(quint32 ref) { return ref >> 1; }
+  static quint32 indexRef(const QModelIndex& index) { return (quint32) index.internalId(); }
+
+  void resetData();
+  int internName(const QString& name, QHash<QString, int>& ids);
+  int nameOf(quint32 ref) const;
+  int parentFolderOf(quint32 ref) const;
+  QModelIndex folderIndex(int folder) const;
+  int folderPriority(const Folder& folder) const;
+  int priorityOf(quint32 ref) const;
+  qulonglong sizeOf(quint32 ref) const;
+  float progressOf(quint32 ref) const;
+  void collectFiles(int folder, QList<int>& files) const;
+  void setFilePriority(int file, int prio);
+  void setItemPriority(quint32 ref, int prio);
+  void emitDirtyRows();
+
+private:
+  // Interned path segments
+  QStringList m_names;
+  // Folder 0 is the invisible root
+  QVector<Folder> m_folders;
+  // Folders whose children were requested by a view
+  mutable QBitArray m_materialized;
+  QSet<int> m_dirtyFolders;
+  // Per file data
+  QVector<int> m_fileNames;
+  QVector<int> m_fileFolders;
+  QVector<int> m_filePriorities;
+  QVector<qulonglong> m_fileSizes;
+  QVector<qulonglong> m_fileDone;
 };
 
 #endif // TORRENTCONTENTMODEL_H
@@ -31,53 +31,15 @@
 #ifndef TORRENTCONTENTMODELITEM_H
 #define TORRENTCONTENTMODELITEM_H
 
-#include <QList>
-#include <QVariant>
-
-#include <libtorrent/torrent_info.hpp>
-
 namespace prio {
 enum FilePriority {IGNORED=0, NORMAL=1, HIGH=2, MAXIMUM=7, MIXED=-1};
 }
 
-class TorrentContentModelFolder;
-
+// Columns and item types of the torrent content model
 class TorrentContentModelItem {
 public:
   enum TreeItemColumns {COL_NAME, COL_SIZE, COL_PROGRESS, COL_PRIO, NB_COL};
   enum ItemType { FileType, FolderType };
-
-  TorrentContentModelItem(TorrentContentModelFolder* parent);
-  virtual ~TorrentContentModelItem();
-
-  inline bool isRootItem() const { return !m_parentItem; }
-  TorrentContentModelFolder* parent() const;
-  virtual ItemType itemType() const = 0;
-
-  QString name() const;
-  void setName(const QString& name);
-
-  qulonglong size() const;
-  qulonglong totalDone() const;
-
-  float progress() const;
-
-  int priority() const;
-  virtual void setPriority(int new_prio, bool update_parent = true) = 0;
-
-  int columnCount() const;
-  QVariant data(int column) const;
-  int row() const;
-
-protected:
-  TorrentContentModelFolder* m_parentItem;
-  // Root item members
-  QList<QVariant> m_itemData;
-  // Non-root item members
-  QString m_name;
-  qulonglong m_size;
-  int m_priority;
-  qulonglong m_totalDone;
 };
 
 #endif // TORRENTCONTENTMODELITEM_H
@@ -0,0 +1,393 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/hasher.hpp>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+#include "piecehasher.h"
+#include "fs_utils.h"
+#include "hashcache.h"
+
+using namespace libtorrent;
+
+namespace {
+  // Size of the sequential reads, independently of the piece size
+  const int READ_BLOCK_SIZE = 4 * 1024 * 1024;
+  // Memory used by the pieces waiting to be hashed
+  const int MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+  // Minimum delay between two progress reports
+  const int PROGRESS_INTERVAL = 100;
+
+  struct PieceJob {
+    int piece;
+    QByteArray data;
+  };
+
+  // Bounded queue between the reader and the hashing workers
+  class PieceQueue {
+  public:
+    explicit PieceQueue(int capacity)
+      : m_capacity(capacity), m_closed(false), m_aborted(false), m_hashed(0) {}
+
+    // Blocks while the queue is full, returns false once aborted
+    bool push(const PieceJob &job)
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.size() >= m_capacity && !m_aborted)
+        m_notFull.wait(&m_mutex);
+      if (m_aborted)
+        return false;
+      m_queue.enqueue(job);
+      m_notEmpty.wakeOne();
+      return true;
+    }
+
+    // Blocks while the queue is empty, returns false once there is
+    // nothing left to hash
+    bool pop(PieceJob &job)
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.isEmpty() && !m_closed && !m_aborted)
+        m_notEmpty.wait(&m_mutex);
+      if (m_aborted || m_queue.isEmpty())
+        return false;
+      job = m_queue.dequeue();
+      m_notFull.wakeOne();
+      return true;
+    }
+
+    void markHashed()
+    {
+      QMutexLocker locker(&m_mutex);
+      ++m_hashed;
+    }
+
+    int hashed() const
+    {
+      QMutexLocker locker(&m_mutex);
+      return m_hashed;
+    }
+
+    // No more pieces will be pushed
+    void close()
+    {
+      QMutexLocker locker(&m_mutex);
+      m_closed = true;
+      m_notEmpty.wakeAll();
+    }
+
+    // Drops the queued pieces and releases everybody
+    void abort()
+    {
+      QMutexLocker locker(&m_mutex);
+      m_aborted = true;
+      m_queue.clear();
+      m_notEmpty.wakeAll();
+      m_notFull.wakeAll();
+    }
+
+  private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<PieceJob> m_queue;
+    const int m_capacity;
+    bool m_closed;
+    bool m_aborted;
+    int m_hashed;
+  };
+
+  class HashWorker : public QThread {
+  public:
+    HashWorker(PieceQueue *queue, std::vector<sha1_hash> *hashes)
+      : m_queue(queue), m_hashes(hashes) {}
+
+  protected:
+    void run()
+    {
+      PieceJob job;
+      while (m_queue->pop(job)) {
+        hasher h(job.data.constData(), job.data.size());
+        // Every worker writes to its own pieces, no locking needed
+        (*m_hashes)[job.piece] = h.final();
+        m_queue->markHashed();
+      }
+    }
+
+  private:
+    PieceQueue *m_queue;
+    std::vector<sha1_hash> *m_hashes;
+  };
+
+  // Reads the files of the torrent back to back, as one stream
+  class FileSetReader {
+  public:
+    FileSetReader(const file_storage &fs, const QString &basePath)
+      : m_fs(fs), m_basePath(basePath), m_fileIndex(-1),
+        m_fileRemaining(0), m_padFile(false), m_blockPos(0) {}
+
+    void read(char *dst, int size)
+    {
+      while (size > 0) {
+        if (m_blockPos == m_block.size())
+          readBlock();
+        const int len = qMin(size, m_block.size() - m_blockPos);
+        memcpy(dst, m_block.constData() + m_blockPos, len);
+        m_blockPos += len;
+        dst += len;
+        size -= len;
+      }
+    }
+
+    // Moves forward without reading, e.g. over pieces known from the cache
+    void skip(qint64 size)
+    {
+      while (size > 0) {
+        if (m_blockPos < m_block.size()) {
+          const int len = (int) qMin(size, (qint64) (m_block.size() - m_blockPos));
+          m_blockPos += len;
+          size -= len;
+          continue;
+        }
+        while (m_fileRemaining == 0)
+          openNextFile();
+        const qint64 len = qMin(size, m_fileRemaining);
+        if (!m_padFile && !m_file.seek(m_file.pos() + len))
+          throw std::runtime_error(("Failed to read " + m_file.fileName().toLocal8Bit()).constData());
+        m_fileRemaining -= len;
+        size -= len;
+      }
+    }
+
+  private:
+    void readBlock()
+    {
+      while (m_fileRemaining == 0)
+        openNextFile();
+
+      const int len = (int) qMin(m_fileRemaining, (qint64) READ_BLOCK_SIZE);
+      if (m_padFile) {
+        m_block.fill(0, len);
+      } else {
+        m_block.resize(len);
+        if (m_file.read(m_block.data(), len) != len)
+          throw std::runtime_error(("Failed to read " + m_file.fileName().toLocal8Bit()).constData());
+      }
+      m_fileRemaining -= len;
+      m_blockPos = 0;
+    }
+
+    void openNextFile()
+    {
+      m_file.close();
+      if (++m_fileIndex >= m_fs.num_files())
+        throw std::runtime_error("Unexpected end of the torrent files");
+
+      const file_entry entry = m_fs.at(m_fileIndex);
+      m_fileRemaining = entry.size;
+      m_padFile = entry.pad_file;
+      if (m_padFile || !m_fileRemaining)
+        return;
+
+      m_file.setFileName(m_basePath + QString::fromUtf8(entry.path.c_str()));
+      if (!m_file.open(QIODevice::ReadOnly))
+        throw std::runtime_error(("Failed to open " + m_file.fileName().toLocal8Bit()).constData());
+#ifdef Q_OS_LINUX
+      // The file is read once, front to back
+      posix_fadvise(m_file.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+
+  private:
+    const file_storage &m_fs;
+    const QString m_basePath;
+    int m_fileIndex;
+    QFile m_file;
+    qint64 m_fileRemaining;
+    bool m_padFile;
+    QByteArray m_block;
+    int m_blockPos;
+  };
+
+  // A file starting on a piece boundary, whose pieces can be found in
+  // (and stored to) the hash cache
+  struct CachedFile {
+    CachedFile(): cacheable(false) {}
+    bool cacheable;
+    QString path;
+    HashCache::FileKey key;
+    QByteArray hashes;
+  };
+}
+
+PieceHasher::PieceHasher(create_torrent &t, const QString &basePath, int workerCount)
+  : m_torrent(t), m_basePath(basePath), m_workerCount(workerCount),
+    m_bytesHashed(0), m_throughput(0)
+{
+  if (m_workerCount <= 0)
+    m_workerCount = qMax(1, QThread::idealThreadCount());
+  if (!m_basePath.isEmpty() && !m_basePath.endsWith("/"))
+    m_basePath += "/";
+}
+
+bool PieceHasher::run(const volatile bool &abort, const ProgressCallback &progress)
+{
+  const int numPieces = m_torrent.num_pieces();
+  const int pieceLength = m_torrent.piece_length();
+  const file_storage &fs = m_torrent.files();
+  HashCache *cache = HashCache::instance();
+  QVector<CachedFile> files(fs.num_files());
+  for (int i = 0; i < fs.num_files(); ++i) {
+    const file_entry entry = fs.at(i);
+    if (entry.pad_file || entry.size == 0 || entry.offset % pieceLength)
+      continue;
+    CachedFile &file = files[i];
+    file.cacheable = true;
+    file.path = m_basePath + QString::fromUtf8(entry.path.c_str());
+    file.key = HashCache::fileKey(file.path);
+    file.hashes = cache->blockHashes(file.path, pieceLength);
+  }
+
+  std::vector<sha1_hash> hashes(numPieces);
+  PieceQueue queue(qMax(2 * m_workerCount, MAX_QUEUED_BYTES / qMax(m_torrent.piece_length(), 1)));
+  QList<HashWorker*> workers;
+  for (int i = 0; i < m_workerCount; ++i) {
+    workers << new HashWorker(&queue, &hashes);
+    workers.last()->start();
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  qint64 lastProgress = 0;
+  m_bytesHashed = 0;
+  int reusedPieces = 0;
+  bool aborted = false;
+  try {
+    FileSetReader reader(fs, m_basePath);
+    int fileIndex = 0;
+    for (int piece = 0; piece < numPieces && !aborted; ++piece) {
+      const qint64 pieceStart = (qint64) piece * pieceLength;
+      const int pieceSize = m_torrent.piece_size(piece);
+      // Look for the piece in the cache if it lies within a single file
+      while (fileIndex < fs.num_files() && fs.at(fileIndex).offset + fs.at(fileIndex).size <= pieceStart)
+        ++fileIndex;
+      if (fileIndex < fs.num_files() && files[fileIndex].cacheable
+          && pieceStart + pieceSize <= fs.at(fileIndex).offset + fs.at(fileIndex).size) {
+        const CachedFile &file = files[fileIndex];
+        const int digestPos = (pieceStart - fs.at(fileIndex).offset) / pieceLength * HashCache::DIGEST_SIZE;
+        if (digestPos + HashCache::DIGEST_SIZE <= file.hashes.size()
+            && HashCache::isKnownDigest(file.hashes.constData() + digestPos)) {
+          hashes[piece] = sha1_hash(file.hashes.constData() + digestPos);
+          reader.skip(pieceSize);
+          queue.markHashed();
+          ++reusedPieces;
+          aborted = abort;
+          continue;
+        }
+      }
+
+      PieceJob job;
+      job.piece = piece;
+      job.data.resize(pieceSize);
+      reader.read(job.data.data(), job.data.size());
+      m_bytesHashed += job.data.size();
+      aborted = abort || !queue.push(job);
+
+      if (progress && timer.elapsed() - lastProgress >= PROGRESS_INTERVAL) {
+        lastProgress = timer.elapsed();
+        progress(queue.hashed(), numPieces);
+      }
+    }
+  } catch (...) {
+    queue.abort();
+    foreach (HashWorker *worker, workers)
+      worker->wait();
+    qDeleteAll(workers);
+    throw;
+  }
+
+  if (aborted)
+    queue.abort();
+  else
+    queue.close();
+  foreach (HashWorker *worker, workers)
+    worker->wait();
+  qDeleteAll(workers);
+  if (aborted || abort)
+    return false;
+
+  for (int piece = 0; piece < numPieces; ++piece)
+    m_torrent.set_hash(piece, hashes[piece]);
+
+  // Remember the pieces that are entirely within a cacheable file
+  for (int i = 0; i < files.size(); ++i) {
+    if (!files[i].cacheable)
+      continue;
+    const file_entry entry = fs.at(i);
+    const int numBlocks = (entry.size + pieceLength - 1) / pieceLength;
+    const int firstPiece = entry.offset / pieceLength;
+    QByteArray digests(numBlocks * HashCache::DIGEST_SIZE, 0);
+    for (int block = 0; block < numBlocks; ++block) {
+      const int piece = firstPiece + block;
+      if ((qint64) piece * pieceLength + m_torrent.piece_size(piece) > entry.offset + entry.size)
+        break;
+      memcpy(digests.data() + block * HashCache::DIGEST_SIZE, hashes[piece].begin(), HashCache::DIGEST_SIZE);
+    }
+    cache->storeBlockHashes(files[i].path, pieceLength, files[i].key, digests);
+  }
+  cache->save();
+  if (progress)
+    progress(numPieces, numPieces);
+
+  const qint64 elapsed = qMax(timer.elapsed(), (qint64) 1);
+  m_throughput = m_bytesHashed * 1000. / elapsed;
+  qDebug("Hashed %lld bytes in %lld ms with %d workers (%.1f MB/s), %d/%d pieces from the hash cache",
+         m_bytesHashed, elapsed, m_workerCount, m_throughput / (1024 * 1024), reusedPieces, numPieces);
+  return true;
+}
@@ -0,0 +1,70 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef PIECEHASHER_H
+#define PIECEHASHER_H
+
+#include <QString>
+#include <boost/function.hpp>
+
+namespace libtorrent {
+  class create_torrent;
+}
+
+// Computes the piece hashes of a torrent being created.
+// The files are read sequentially in large blocks by the calling thread
+// while a pool of workers hashes the pieces concurrently. It replaces
+// libtorrent::set_piece_hashes(), which hashes on a single thread.
+class PieceHasher {
+  Q_DISABLE_COPY(PieceHasher)
+
+public:
+  // Called with the number of hashed pieces and the total piece count
+  typedef boost::function<void (int, int)> ProgressCallback;
+
+  PieceHasher(libtorrent::create_torrent &t, const QString &basePath, int workerCount = 0);
+
+  // Hashes every piece and stores the results with create_torrent::set_hash().
+  // Returns false if aborted, throws std::exception on read errors.
+  bool run(const volatile bool &abort, const ProgressCallback &progress);
+
+  qint64 bytesHashed() const { return m_bytesHashed; }
+  // Throughput of the last run, in bytes per second
+  qreal throughput() const { return m_throughput; }
+
+private:
+  libtorrent::create_torrent &m_torrent;
+  QString m_basePath;
+  int m_workerCount;
+  qint64 m_bytesHashed;
+  qreal m_throughput;
+};
+
+#endif // PIECEHASHER_H
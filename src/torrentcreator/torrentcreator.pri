@@ -3,8 +3,10 @@ INCLUDEPATH += $$PWD
 FORMS += $$PWD/createtorrent.ui
 
 HEADERS += $$PWD/torrentcreatordlg.h \
-           $$PWD/torrentcreatorthread.h
+           $$PWD/torrentcreatorthread.h \
+           $$PWD/piecehasher.h
 
 SOURCES += $$PWD/torrentcreatordlg.cpp \
-           $$PWD/torrentcreatorthread.cpp
+           $$PWD/torrentcreatorthread.cpp \
+           $$PWD/piecehasher.cpp
 
@@ -175,8 +175,7 @@ void TorrentCreatorDlg::on_cancelButton_clicked() {
   // End torrent creation thread
   if (creatorThread && creatorThread->isRunning()) {
     creatorThread->abortCreation();
-    creatorThread->terminate();
-    // Wait for termination
+    // Wait for termination, the hashing stops at the next piece
     creatorThread->wait();
   }
   // Close the dialog
@@ -41,6 +41,7 @@
 #include <QDir>
 
 #include "torrentcreatorthread.h"
+#include "piecehasher.h"
 #include "fs_utils.h"
 
 #include <boost/bind.hpp>
@@ -110,7 +111,9 @@ void TorrentCreatorThread::run() {
     if (abort) return;
     // calculate the hash for all pieces
     const QString parent_path = fsutils::branchPath(input_path) + "/";
-    set_piece_hashes(t, fsutils::toNativePath(parent_path).toUtf8().constData(), boost::bind<void>(&sendProgressUpdateSignal, _1, t.num_pieces(), this));
+    PieceHasher hasher(t, parent_path);
+    if (!hasher.run(abort, boost::bind<void>(&sendProgressUpdateSignal, _1, _2, this)))
+      return;
     // Set qBittorrent as creator and add user comment to
     // torrent_info structure
     t.set_creator(creator_str.toUtf8().constData());
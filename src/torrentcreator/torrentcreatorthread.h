@@ -66,7 +66,7 @@ private:
   QString comment;
   bool is_private;
   int piece_size;
-  bool abort;
+  volatile bool abort;
   QDialog *parent;
 };
 
@@ -30,8 +30,12 @@
 
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QEventLoop>
 #include <QDebug>
 
+#include <cstring>
+
 #include "torrentimportdlg.h"
 #include "ui_torrentimportdlg.h"
 #include "qinisettings.h"
@@ -39,6 +43,8 @@
 #include "torrentpersistentdata.h"
 #include "iconprovider.h"
 #include "fs_utils.h"
+#include "hashcache.h"
+#include "sampledverifier.h"
 
 using namespace libtorrent;
 
@@ -51,6 +57,7 @@ TorrentImportDlg::TorrentImportDlg(QWidget *parent) :
   ui->lbl_info->setPixmap(IconProvider::instance()->getIcon("dialog-information").pixmap(ui->lbl_info->height()));
   ui->lbl_info->setFixedWidth(ui->lbl_info->height());
   ui->importBtn->setIcon(IconProvider::instance()->getIcon("document-import"));
+  m_progress = 0;
   // Libtorrent < 0.15 does not support skipping file checking
   loadSettings();
 }
@@ -92,7 +99,7 @@ void TorrentImportDlg::on_browseContentBtn_clicked()
     if (m_contentPath.isEmpty() || !QFile(m_contentPath).exists()) {
       m_contentPath = QString::null;
       ui->importBtn->setEnabled(false);
-      ui->checkSkipCheck->setEnabled(false);
+      setFastSeedingAllowed(false);
       return;
     }
     // Update display
@@ -101,11 +108,10 @@ void TorrentImportDlg::on_browseContentBtn_clicked()
     const qint64 file_size = QFile(m_contentPath).size();
     if (t->file_at(0).size == file_size) {
       qDebug("The file size matches, allowing fast seeding...");
-      ui->checkSkipCheck->setEnabled(true);
+      setFastSeedingAllowed(true);
     } else {
       qDebug("The file size does not match, forbidding fast seeding...");
-      ui->checkSkipCheck->setChecked(false);
-      ui->checkSkipCheck->setEnabled(false);
+      setFastSeedingAllowed(false);
     }
     // Handle file renaming
     QStringList parts = m_contentPath.split("/");
@@ -124,7 +130,7 @@ void TorrentImportDlg::on_browseContentBtn_clicked()
     if (m_contentPath.isEmpty() || !QDir(m_contentPath).exists()) {
       m_contentPath = QString::null;
       ui->importBtn->setEnabled(false);
-      ui->checkSkipCheck->setEnabled(false);
+      setFastSeedingAllowed(false);
       return;
     }
     // Update the display
@@ -146,17 +152,40 @@ void TorrentImportDlg::on_browseContentBtn_clicked()
     }
     if (size_mismatch) {
       qDebug("The file size does not match, forbidding fast seeding...");
-      ui->checkSkipCheck->setChecked(false);
-      ui->checkSkipCheck->setEnabled(false);
+      setFastSeedingAllowed(false);
     } else {
       qDebug("The file size matches, allowing fast seeding...");
-      ui->checkSkipCheck->setEnabled(true);
+      setFastSeedingAllowed(true);
     }
   }
   // Enable the import button
   ui->importBtn->setEnabled(true);
 }
 
+void TorrentImportDlg::on_checkSkipCheck_toggled(bool checked)
+{
+  if (checked)
+    ui->checkSampledCheck->setChecked(false);
+}
+
+void TorrentImportDlg::on_checkSampledCheck_toggled(bool checked)
+{
+  if (checked)
+    ui->checkSkipCheck->setChecked(false);
+  ui->spinSamplesPerFile->setEnabled(checked && ui->checkSampledCheck->isEnabled());
+}
+
+void TorrentImportDlg::setFastSeedingAllowed(bool allowed)
+{
+  if (!allowed) {
+    ui->checkSkipCheck->setChecked(false);
+    ui->checkSampledCheck->setChecked(false);
+  }
+  ui->checkSkipCheck->setEnabled(allowed);
+  ui->checkSampledCheck->setEnabled(allowed);
+  ui->spinSamplesPerFile->setEnabled(allowed && ui->checkSampledCheck->isChecked());
+}
+
 void TorrentImportDlg::on_importBtn_clicked()
 {
   saveSettings();
@@ -193,7 +222,16 @@ void TorrentImportDlg::importTorrent()
     const QString hash = misc::toQString(t->info_hash());
     qDebug() << "Torrent hash is" << hash;
     TorrentTempData::setSavePath(hash, content_path);
-    TorrentTempData::setSeedingMode(hash, dlg.skipFileChecking());
+    bool seeding_mode = dlg.skipFileChecking();
+    if (!seeding_mode && dlg.verifyFromHashCache()) {
+      QBtSession::instance()->addConsoleMessage(tr("'%1' was verified using the hash cache, skipping the recheck.").arg(misc::toQStringU(t->name())));
+      seeding_mode = true;
+    }
+    if (!seeding_mode && dlg.sampledChecking() && dlg.runSampledVerification()) {
+      QBtSession::instance()->addConsoleMessage(tr("'%1' passed the sampled verification, skipping the recheck.").arg(misc::toQStringU(t->name())));
+      seeding_mode = true;
+    }
+    TorrentTempData::setSeedingMode(hash, seeding_mode);
     qDebug("Adding the torrent to the session...");
     QBtSession::instance()->addTorrent(torrent_path);
     // Remember the last opened folder
@@ -251,16 +289,95 @@ bool TorrentImportDlg::skipFileChecking() const
   return ui->checkSkipCheck->isChecked();
 }
 
+QString TorrentImportDlg::contentFilePath(int index) const
+{
+  if (t->num_files() == 1)
+    return m_contentPath + "/" + fsutils::fileName(m_filesPath.first());
+  QDir content_dir(m_contentPath);
+  content_dir.cdUp();
+  return fsutils::expandPath(content_dir.absoluteFilePath(m_filesPath.at(index)));
+}
+
+bool TorrentImportDlg::verifyFromHashCache() const
+{
+  HashCache *cache = HashCache::instance();
+  const int piece_length = t->piece_length();
+  QHash<int, QByteArray> file_hashes;
+  for (int piece = 0; piece < t->num_pieces(); ++piece) {
+    // Only the pieces lying within a single file are cached
+    const std::vector<file_slice> slices = t->map_block(piece, 0, t->piece_size(piece));
+    if (slices.size() != 1 || slices[0].offset % piece_length)
+      return false;
+    const int file_index = slices[0].file_index;
+    if (!file_hashes.contains(file_index))
+      file_hashes.insert(file_index, cache->blockHashes(contentFilePath(file_index), piece_length));
+    const QByteArray digests = file_hashes.value(file_index);
+    const int pos = slices[0].offset / piece_length * HashCache::DIGEST_SIZE;
+    if (pos + HashCache::DIGEST_SIZE > digests.size()
+        || memcmp(digests.constData() + pos, t->hash_for_piece_ptr(piece), HashCache::DIGEST_SIZE))
+      return false;
+  }
+  return true;
+}
+
+bool TorrentImportDlg::sampledChecking() const
+{
+  return ui->checkSampledCheck->isChecked();
+}
+
+bool TorrentImportDlg::runSampledVerification()
+{
+  QStringList file_paths;
+  for (int i = 0; i < t->num_files(); ++i)
+    file_paths << contentFilePath(i);
+  SampledVerifier verifier(t, file_paths, ui->spinSamplesPerFile->value());
+  QProgressDialog progress(tr("Verifying a sample of the pieces of '%1'...").arg(misc::toQStringU(t->name())), tr("Cancel"), 0, 0);
+  progress.setWindowTitle(tr("Sampled verification"));
+  progress.setMinimumDuration(0);
+  QEventLoop loop;
+  connect(&verifier, SIGNAL(progress(int,int)), this, SLOT(setSampledProgressMaximum(int,int)));
+  connect(&verifier, SIGNAL(progress(int,int)), &progress, SLOT(setValue(int)));
+  connect(&progress, SIGNAL(canceled()), &loop, SLOT(quit()));
+  connect(&verifier, SIGNAL(finished()), &loop, SLOT(quit()));
+  m_progress = &progress;
+  verifier.start();
+  loop.exec();
+  m_progress = 0;
+  if (progress.wasCanceled()) {
+    // Cancelled, the regular check will take place
+    verifier.abort();
+    verifier.wait();
+    return false;
+  }
+  progress.close();
+  if (verifier.passed())
+    return true;
+  const QStringList failures = verifier.failures();
+  QMessageBox::warning(0, tr("Sampled verification failed"),
+                       tr("Some files do not match the torrent, a full check will be performed.") + "\n\n"
+                       + QStringList(failures.mid(0, 20)).join("\n")
+                       + (failures.size() > 20 ? "\n..." : ""));
+  return false;
+}
+
+void TorrentImportDlg::setSampledProgressMaximum(int, int total)
+{
+  if (m_progress && m_progress->maximum() != total)
+    m_progress->setMaximum(total);
+}
+
 void TorrentImportDlg::loadSettings()
 {
   QIniSettings settings;
   restoreGeometry(settings.value("TorrentImportDlg/dimensions").toByteArray());
+  ui->spinSamplesPerFile->setValue(settings.value("TorrentImport/SamplesPerFile", 8).toInt());
 }
 
 void TorrentImportDlg::saveSettings()
 {
   QIniSettings settings;
   settings.setValue("TorrentImportDlg/dimensions", saveGeometry());
+  settings.setValue("TorrentImport/SamplesPerFile", ui->spinSamplesPerFile->value());
 }
 
 void TorrentImportDlg::closeEvent(QCloseEvent *event)
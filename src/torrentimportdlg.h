@@ -44,6 +44,7 @@ class TorrentImportDlg;
 QT_END_NAMESPACE
 
 class QBtSession;
+class QProgressDialog;
 
 class TorrentImportDlg : public QDialog
 {
@@ -58,6 +59,13 @@ public:
   bool fileRenamed() const;
   boost::intrusive_ptr<libtorrent::torrent_info> torrent() const;
   bool skipFileChecking() const;
+  // Absolute path of a file of the torrent in the selected content
+  QString contentFilePath(int index) const;
+  // True if every piece matches the hash cache, so that no recheck is needed
+  bool verifyFromHashCache() const;
+  bool sampledChecking() const;
+  // Checks a random sample of pieces, true if the data can be seeded as is
+  bool runSampledVerification();
 
 protected slots:
   void loadTorrent(const QString &torrent_path);
@@ -70,12 +78,19 @@ private slots:
 
   void on_importBtn_clicked();
 
+  void on_checkSkipCheck_toggled(bool checked);
+
+  void on_checkSampledCheck_toggled(bool checked);
+
+  void setSampledProgressMaximum(int checked, int total);
+
 protected:
   void closeEvent(QCloseEvent *event);
 
 private:
   void loadSettings();
   void saveSettings();
+  void setFastSeedingAllowed(bool allowed);
 
 private:
   Ui::TorrentImportDlg *ui;
@@ -84,6 +99,7 @@ private:
   QString m_contentPath;
   QString m_torrentPath;
   bool m_fileRenamed;
+  QProgressDialog *m_progress;
 };
 
 #endif // TORRENTIMPORTDLG_H
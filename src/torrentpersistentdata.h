@@ -40,6 +40,7 @@
 #include "misc.h"
 #include <vector>
 #include "qinisettings.h"
+#include "tracer.h"
 #include <QHash>
 
 class TorrentTempData {
@@ -273,6 +274,7 @@ public:
   }
 
   static void saveTorrentPersistentData(const QTorrentHandle &h, const QString &save_path = QString::null, const bool is_magnet = false) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::saveTorrentPersistentData");
     Q_ASSERT(h.is_valid());
     qDebug("Saving persistent data for %s", qPrintable(h.hash()));
     // Save persistent data
@@ -307,6 +309,7 @@ public:
   // Setters
 
   static void saveSavePath(const QString &hash, const QString &save_path) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::saveSavePath");
     Q_ASSERT(!hash.isEmpty());
     qDebug("TorrentPersistentData::saveSavePath(%s)", qPrintable(save_path));
     QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
@@ -319,6 +322,7 @@ public:
   }
 
   static void saveLabel(const QString &hash, const QString &label) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::saveLabel");
     Q_ASSERT(!hash.isEmpty());
     QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
     QHash<QString, QVariant> all_data = settings.value("torrents").toHash();
@@ -328,7 +332,28 @@ public:
     settings.setValue("torrents", all_data);
   }
 
+  // Per torrent limits to restore once a label bandwidth class no longer
+  // applies, by hash. An invalid QVariant removes the entry.
+  static void saveOwnLimits(const QHash<QString, QVariant> &changes) {
+    QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
+    QHash<QString, QVariant> all_data = settings.value("torrents").toHash();
+    QHash<QString, QVariant>::const_iterator it = changes.begin();
+    QHash<QString, QVariant>::const_iterator itend = changes.end();
+    for ( ; it != itend; ++it) {
+      if (!all_data.contains(it.key()))
+        continue;
+      QHash<QString, QVariant> data = all_data.value(it.key()).toHash();
+      if (it.value().isValid())
+        data["own_limits"] = it.value();
+      else
+        data.remove("own_limits");
+      all_data[it.key()] = data;
+    }
+    settings.setValue("torrents", all_data);
+  }
+
   static void saveName(const QString &hash, const QString &name) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::saveName");
     Q_ASSERT(!hash.isEmpty());
     QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
     QHash<QString, QVariant> all_data = settings.value("torrents").toHash();
@@ -379,6 +404,7 @@ public:
 
   // Getters
   static QString getSavePath(const QString &hash) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::getSavePath");
     QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
     const QHash<QString, QVariant> all_data = settings.value("torrents").toHash();
     const QHash<QString, QVariant> data = all_data.value(hash).toHash();
@@ -386,7 +412,15 @@ public:
     return data.value("save_path").toString();
   }
 
+  // The data of every torrent, by hash, for the callers which would
+  // otherwise read it once per torrent
+  static QHash<QString, QVariant> getAllData() {
+    QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
+    return settings.value("torrents").toHash();
+  }
+
   static QString getLabel(const QString &hash) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::getLabel");
     QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
     const QHash<QString, QVariant> all_data = settings.value("torrents").toHash();
     const QHash<QString, QVariant> data = all_data.value(hash).toHash();
@@ -394,6 +428,7 @@ public:
   }
 
   static QString getName(const QString &hash) {
+    QBT_TRACE_SCOPE("TorrentPersistentData::getName");
     QIniSettings settings(QString::fromUtf8("qBittorrent"), QString::fromUtf8("qBittorrent-resume"));
     const QHash<QString, QVariant> all_data = settings.value("torrents").toHash();
     const QHash<QString, QVariant> data = all_data.value(hash).toHash();
@@ -0,0 +1,267 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "tracer.h"
+#include "fs_utils.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include "unixsignalwatcher.h"
+#endif
+
+namespace {
+  // Events kept per thread, must be a power of 2
+  const uint CAPACITY = 16384;
+  const uint MASK = CAPACITY - 1;
+
+  struct Event {
+    const char *name;
+    qint64 start;
+    qint64 duration;
+  };
+
+  // Ring buffer of one thread. Only that thread writes to it: the event
+  // is stored first, then published with a release store of the count.
+  struct ThreadBuffer {
+    ThreadBuffer(): next(0), id(0), retired(false) {}
+    Event events[CAPACITY];
+    // Number of events written (modulo 2^32), only used by the writer
+    uint next;
+    QAtomicInt published;
+    QAtomicInt full;
+    int id;
+    QString threadName;
+    bool retired;
+  };
+
+  // Gives the buffer back when its thread exits
+  struct BufferHandle {
+    explicit BufferHandle(ThreadBuffer *buffer): buffer(buffer) {}
+    ~BufferHandle();
+    ThreadBuffer *buffer;
+  };
+
+  QElapsedTimer clock;
+  volatile bool enabled = false;
+  // In microseconds, 0 when disabled
+  volatile qint64 slowThreshold = 0;
+  // Seconds (on the tracer clock) of the last slow event report
+  QAtomicInt lastSlowReport(-1);
+
+  QMutex buffersMutex;
+  QList<ThreadBuffer*> buffers;
+  QThreadStorage<BufferHandle*> localBuffer;
+
+  BufferHandle::~BufferHandle()
+  {
+    QMutexLocker locker(&buffersMutex);
+    buffer->retired = true;
+  }
+
+  ThreadBuffer* acquireBuffer()
+  {
+    QThread *thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if (thread == QCoreApplication::instance()->thread())
+      name = "main";
+    else if (name.isEmpty())
+      name = thread->metaObject()->className();
+
+    QMutexLocker locker(&buffersMutex);
+    // Reuse the buffer of a finished thread, the events are lost
+    foreach (ThreadBuffer *buffer, buffers) {
+      if (buffer->retired) {
+        buffer->next = 0;
+        buffer->published.fetchAndStoreRelease(0);
+        buffer->full.fetchAndStoreRelease(0);
+        buffer->threadName = name;
+        buffer->retired = false;
+        return buffer;
+      }
+    }
+    ThreadBuffer *buffer = new ThreadBuffer;
+    buffer->id = buffers.size() + 1;
+    buffer->threadName = name;
+    buffers << buffer;
+    return buffer;
+  }
+
+  ThreadBuffer* currentBuffer()
+  {
+    BufferHandle *handle = localBuffer.localData();
+    if (!handle) {
+      handle = new BufferHandle(acquireBuffer());
+      localBuffer.setLocalData(handle);
+    }
+    return handle->buffer;
+  }
+
+  QByteArray escaped(const QString &str)
+  {
+    QByteArray ret = str.toUtf8();
+    ret.replace('\\', "\\\\");
+    ret.replace('"', "\\\"");
+    return ret;
+  }
+}
+
+Tracer* Tracer::m_instance = 0;
+
+Tracer::Tracer()
+{
+  clock.start();
+  enabled = true;
+#ifdef Q_OS_UNIX
+  // kill -USR2 writes a trace file
+  if (UnixSignalWatcher::instance()->watch(SIGUSR2))
+    connect(UnixSignalWatcher::instance(), SIGNAL(signalReceived(int)), SLOT(handleUnixSignal(int)));
+#endif
+}
+
+Tracer::~Tracer()
+{
+  enabled = false;
+}
+
+Tracer* Tracer::instance()
+{
+  if (!m_instance)
+    m_instance = new Tracer;
+  return m_instance;
+}
+
+void Tracer::drop()
+{
+  if (m_instance) {
+    delete m_instance;
+    m_instance = 0;
+  }
+}
+
+qint64 Tracer::now()
+{
+  return enabled ? clock.nsecsElapsed() / 1000 : 0;
+}
+
+void Tracer::record(const char *name, qint64 start, qint64 duration)
+{
+  if (!enabled)
+    return;
+  ThreadBuffer *buffer = currentBuffer();
+  Event &event = buffer->events[buffer->next & MASK];
+  event.name = name;
+  event.start = start;
+  event.duration = duration;
+  if (++buffer->next == CAPACITY)
+    buffer->full.fetchAndStoreRelease(1);
+  buffer->published.fetchAndStoreRelease(static_cast<int>(buffer->next));
+
+  if (slowThreshold > 0 && duration >= slowThreshold) {
+    // At most one report per second, the trace has the others
+    const int second = (start + duration) / 1000000;
+    const int last = lastSlowReport.fetchAndAddRelaxed(0);
+    if (second > last && lastSlowReport.testAndSetRelaxed(last, second))
+      emit m_instance->slowEvent(QString::fromLatin1(name), duration);
+  }
+}
+
+QByteArray Tracer::toChromeTrace() const
+{
+  QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  QMutexLocker locker(&buffersMutex);
+  foreach (const ThreadBuffer *buffer, buffers) {
+    const QByteArray tid = QByteArray::number(buffer->id);
+    json += QByteArray(first ? "" : ",") + "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+        + ",\"args\":{\"name\":\"" + escaped(buffer->threadName) + "\"}}";
+    first = false;
+
+    // Copy the published events, then drop the ones the writer may have
+    // overwritten in the meantime
+    const uint end = static_cast<uint>(const_cast<QAtomicInt&>(buffer->published).fetchAndAddAcquire(0));
+    const uint count = const_cast<QAtomicInt&>(buffer->full).fetchAndAddAcquire(0) ? CAPACITY : end;
+    QVector<Event> events(count);
+    for (uint i = 0; i < count; ++i)
+      events[i] = buffer->events[(end - count + i) & MASK];
+    const uint after = static_cast<uint>(const_cast<QAtomicInt&>(buffer->published).fetchAndAddAcquire(0));
+    const qint64 overwritten = (qint64) (after - end) + 1 + count - CAPACITY;
+    for (uint i = qBound<qint64>(0, overwritten, count); i < count; ++i) {
+      const Event &event = events[i];
+      json += ",{\"name\":\"" + escaped(QString::fromLatin1(event.name)) + "\",\"cat\":\"qbittorrent\",\"ph\":\"X\",\"ts\":"
+          + QByteArray::number(event.start) + ",\"dur\":" + QByteArray::number(event.duration)
+          + ",\"pid\":1,\"tid\":" + tid + "}";
+    }
+  }
+  json += "]}";
+  return json;
+}
+
+QString Tracer::dumpToFile()
+{
+  QDir traceDir(fsutils::cacheLocation() + "/traces");
+  if (!traceDir.exists() && !traceDir.mkpath(traceDir.absolutePath()))
+    return QString();
+  const QString path = traceDir.absoluteFilePath("trace-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json");
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return QString();
+  file.write(toChromeTrace());
+  file.close();
+  emit traceDumped(path);
+  return path;
+}
+
+void Tracer::setSlowThreshold(int msecs)
+{
+  slowThreshold = (qint64) qMax(0, msecs) * 1000;
+}
+
+void Tracer::handleUnixSignal(int signum)
+{
+#ifdef Q_OS_UNIX
+  if (signum == SIGUSR2)
+    dumpToFile();
+#else
+  Q_UNUSED(signum);
+#endif
+}
@@ -0,0 +1,104 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+// Hot path tracing, compiled in with "qmake CONFIG+=tracing".
+//
+//   QBT_TRACE_SCOPE("QBtSession::readAlerts");
+//
+// records the time spent in the enclosing scope into a ring buffer of
+// the calling thread. Without tracing the macro expands to nothing.
+
+#ifdef QBT_TRACING
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+class Tracer : public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(Tracer)
+
+public:
+  class Scope {
+  public:
+    // 'name' must outlive the tracer, i.e. be a string literal
+    explicit Scope(const char *name): m_name(name), m_start(Tracer::now()) {}
+    ~Scope() { Tracer::record(m_name, m_start, Tracer::now() - m_start); }
+
+  private:
+    const char *m_name;
+    qint64 m_start;
+  };
+
+private:
+  explicit Tracer();
+  static Tracer* m_instance;
+
+public:
+  // Must be created from the main thread before anything gets traced
+  static Tracer* instance();
+  static void drop();
+  ~Tracer();
+
+  // Microseconds since the tracer was created
+  static qint64 now();
+  static void record(const char *name, qint64 start, qint64 duration);
+
+  // Events still in the ring buffers, in the Chrome trace event format
+  // (chrome://tracing, Perfetto)
+  QByteArray toChromeTrace() const;
+  // Writes toChromeTrace() to the cache folder, returns the file path
+  QString dumpToFile();
+  // Events longer than 'msecs' are reported by slowEvent(), 0 disables it
+  void setSlowThreshold(int msecs);
+
+signals:
+  void slowEvent(const QString &name, qint64 usecs);
+  void traceDumped(const QString &path);
+
+private slots:
+  void handleUnixSignal(int signum);
+};
+
+#define QBT_TRACE_CONCAT_(a, b) a ## b
+#define QBT_TRACE_CONCAT(a, b) QBT_TRACE_CONCAT_(a, b)
+#define QBT_TRACE_SCOPE(name) Tracer::Scope QBT_TRACE_CONCAT(qbtTraceScope, __LINE__)(name)
+
+#else
+
+#define QBT_TRACE_SCOPE(name)
+
+#endif // QBT_TRACING
+
+#endif // TRACER_H
@@ -51,6 +51,9 @@
 #include "iconprovider.h"
 #include "fs_utils.h"
 #include "autoexpandabledialog.h"
+#include "labelbandwidth.h"
+#include "labelbandwidthdlg.h"
+#include "qbtsession.h"
 
 class LabelFiltersList: public QListWidget {
   Q_OBJECT
@@ -336,8 +339,11 @@ protected slots:
   void showLabelMenu(QPoint) {
     QMenu labelMenu(labelFilters);
     QAction *removeAct = 0;
-    if (!labelFilters->selectedItems().empty() && labelFilters->row(labelFilters->selectedItems().first()) > 1)
+    QAction *bandwidthAct = 0;
+    if (!labelFilters->selectedItems().empty() && labelFilters->row(labelFilters->selectedItems().first()) > 1) {
       removeAct = labelMenu.addAction(IconProvider::instance()->getIcon("list-remove"), tr("Remove label"));
+      bandwidthAct = labelMenu.addAction(IconProvider::instance()->getIcon("view-statistics"), tr("Bandwidth limits..."));
+    }
     QAction *addAct = labelMenu.addAction(IconProvider::instance()->getIcon("list-add"), tr("Add label..."));
     labelMenu.addSeparator();
     QAction *startAct = labelMenu.addAction(IconProvider::instance()->getIcon("media-playback-start"), tr("Resume torrents"));
@@ -350,6 +356,14 @@ protected slots:
         removeSelectedLabel();
         return;
       }
+      if (act == bandwidthAct) {
+        const QString label = labelFilters->labelFromRow(labelFilters->row(labelFilters->selectedItems().first()));
+        LabelBandwidth *labelBandwidth = QBtSession::instance()->getLabelBandwidth();
+        LabelLimits limits = labelBandwidth->labelClass(label);
+        if (LabelBandwidthDlg::askLabelLimits(this, label, limits))
+          labelBandwidth->setLabelClass(label, limits);
+        return;
+      }
       if (act == deleteTorrentsAct) {
         transferList->deleteVisibleTorrents();
         return;
@@ -398,6 +412,7 @@ protected slots:
     delete labelFilters->takeItem(row);
     // Save custom labels to remember it was deleted
     Preferences().removeTorrentLabel(label);
+    QBtSession::instance()->getLabelBandwidth()->setLabelClass(label, LabelLimits());
   }
 
   void applyLabelFilter(int row) {
@@ -0,0 +1,119 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "unixsignalwatcher.h"
+
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+UnixSignalWatcher* UnixSignalWatcher::m_instance = 0;
+int UnixSignalWatcher::m_sockets[2] = { -1, -1 };
+
+UnixSignalWatcher::UnixSignalWatcher()
+  : m_notifier(0)
+{
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, m_sockets) != 0) {
+    qWarning("Couldn't create the signal socket pair: %s", strerror(errno));
+    m_sockets[0] = m_sockets[1] = -1;
+    return;
+  }
+  // A full socket must never block the signal handler
+  ::fcntl(m_sockets[0], F_SETFL, ::fcntl(m_sockets[0], F_GETFL) | O_NONBLOCK);
+  ::fcntl(m_sockets[0], F_SETFD, FD_CLOEXEC);
+  ::fcntl(m_sockets[1], F_SETFD, FD_CLOEXEC);
+  m_notifier = new QSocketNotifier(m_sockets[1], QSocketNotifier::Read, this);
+  connect(m_notifier, SIGNAL(activated(int)), SLOT(readSignals()));
+}
+
+UnixSignalWatcher::~UnixSignalWatcher()
+{
+  // The handlers stay installed, they just have nowhere to write anymore
+  const int writer = m_sockets[0];
+  m_sockets[0] = -1;
+  if (writer >= 0)
+    ::close(writer);
+  if (m_sockets[1] >= 0)
+    ::close(m_sockets[1]);
+  m_sockets[1] = -1;
+}
+
+UnixSignalWatcher* UnixSignalWatcher::instance()
+{
+  if (!m_instance)
+    m_instance = new UnixSignalWatcher;
+  return m_instance;
+}
+
+void UnixSignalWatcher::drop()
+{
+  if (m_instance) {
+    delete m_instance;
+    m_instance = 0;
+  }
+}
+
+bool UnixSignalWatcher::watch(int signum)
+{
+  if (m_sockets[0] < 0)
+    return false;
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = &UnixSignalWatcher::handleSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  return ::sigaction(signum, &action, 0) == 0;
+}
+
+void UnixSignalWatcher::handleSignal(int signum)
+{
+  // Async-signal-safe calls only
+  const int savedErrno = errno;
+  const int writer = m_sockets[0];
+  if (writer >= 0) {
+    const char c = static_cast<char>(signum);
+    ssize_t ret = ::write(writer, &c, 1);
+    Q_UNUSED(ret);
+  }
+  errno = savedErrno;
+}
+
+void UnixSignalWatcher::readSignals()
+{
+  char signums[16];
+  const ssize_t count = ::read(m_sockets[1], signums, sizeof(signums));
+  for (ssize_t i = 0; i < count; ++i)
+    emit signalReceived(static_cast<unsigned char>(signums[i]));
+}
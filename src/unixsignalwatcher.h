@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt4 and libtorrent.
- * Copyright (C) 2006-2012  Christophe Dumez
+ * Copyright (C) 2014  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -28,39 +28,47 @@
  * Contact : chris@qbittorrent.org
  */
 
-#ifndef TORRENTCONTENTMODELFOLDER_H
-#define TORRENTCONTENTMODELFOLDER_H
+#ifndef UNIXSIGNALWATCHER_H
+#define UNIXSIGNALWATCHER_H
 
-#include "torrentcontentmodelitem.h"
+#include <QObject>
 
-class TorrentContentModelFolder : public TorrentContentModelItem
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+// Delivers Unix signals through the event loop.
+// The handler only writes the signal number to a socket pair, which
+// is read by the main thread, where signalReceived() is emitted.
+class UnixSignalWatcher : public QObject
 {
-public:
-  // Folder constructor
-  TorrentContentModelFolder(const QString& name, TorrentContentModelFolder* parent);
+  Q_OBJECT
+  Q_DISABLE_COPY(UnixSignalWatcher)
 
-  // Invisible root item constructor
-  TorrentContentModelFolder(const QList<QVariant>& data);
+private:
+  explicit UnixSignalWatcher();
+  static UnixSignalWatcher* m_instance;
 
-  ~TorrentContentModelFolder();
+public:
+  static UnixSignalWatcher* instance();
+  static void drop();
+  ~UnixSignalWatcher();
 
-  ItemType itemType() const { return FolderType; }
+  // Starts catching 'signum'
+  bool watch(int signum);
 
-  void increaseSize(qulonglong delta);
-  void recalculateProgress();
-  void updatePriority();
+signals:
+  void signalReceived(int signum);
 
-  void setPriority(int new_prio, bool update_parent = true);
+private slots:
+  void readSignals();
 
-  void deleteAllChildren();
-  const QList<TorrentContentModelItem*>& children() const;
-  void appendChild(TorrentContentModelItem* item);
-  TorrentContentModelItem* child(int row) const;
-  TorrentContentModelFolder* childFolderWithName(const QString& name) const;
-  int childCount() const;
+private:
+  static void handleSignal(int signum);
 
 private:
-  QList<TorrentContentModelItem*> m_childItems;
+  static int m_sockets[2];
+  QSocketNotifier *m_notifier;
 };
 
-#endif // TORRENTCONTENTMODELFOLDER_H
+#endif // UNIXSIGNALWATCHER_H
@@ -32,8 +32,11 @@
 #include "misc.h"
 #include "fs_utils.h"
 #include "qbtsession.h"
+#include "sessionsnapshot.h"
+#include "labelbandwidth.h"
 #include "torrentpersistentdata.h"
 #include "jsonutils.h"
+#include "tracer.h"
 
 #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
 #include <QElapsedTimer>
@@ -146,38 +149,10 @@ static QVariantMap toMap(const QTorrentHandle& h)
   ret[KEY_TORRENT_LEECHS] =  leechs;
   const qreal ratio = QBtSession::instance()->getRealRatio(status);
   ret[KEY_TORRENT_RATIO] = (ratio > 100.) ? QString::fromUtf8("∞") : misc::accurateDoubleToString(ratio, 1);
+  const QString state = SessionSnapshotService::torrentState(status);
   QString eta;
-  QString state;
-  if (h.is_paused(status)) {
-    if (h.has_error(status))
-      state = "error";
-    else
-      state = h.is_seed(status) ? "pausedUP" : "pausedDL";
-  } else {
-    if (QBtSession::instance()->isQueueingEnabled() && h.is_queued(status))
-      state = h.is_seed(status) ? "queuedUP" : "queuedDL";
-    else {
-      switch (status.state) {
-      case torrent_status::finished:
-      case torrent_status::seeding:
-        state = status.upload_payload_rate > 0 ? "uploading" : "stalledUP";
-        break;
-      case torrent_status::allocating:
-      case torrent_status::checking_files:
-      case torrent_status::queued_for_checking:
-      case torrent_status::checking_resume_data:
-        state = h.is_seed(status) ? "checkingUP" : "checkingDL";
-        break;
-      case torrent_status::downloading:
-      case torrent_status::downloading_metadata:
-        state = status.download_payload_rate > 0 ? "downloading" : "stalledDL";
-        eta = misc::userFriendlyDuration(QBtSession::instance()->getETA(h.hash(), status));
-        break;
-      default:
-        qWarning("Unrecognized torrent status, should not happen!!! status was %d", h.state());
-      }
-    }
-  }
+  if (state == "downloading" || state == "stalledDL")
+    eta = misc::userFriendlyDuration(QBtSession::instance()->getETA(h.hash(), status));
   ret[KEY_TORRENT_ETA] =  eta.isEmpty() ? QString::fromUtf8("∞") : eta;
   ret[KEY_TORRENT_STATE] =  state;
 
@@ -204,6 +179,7 @@ static QVariantMap toMap(const QTorrentHandle& h)
  */
 QByteArray btjson::getTorrents()
 {
+  QBT_TRACE_SCOPE("btjson::getTorrents");
   CACHED_VARIABLE(QVariantList, torrent_list, CACHE_DURATION_MS);
   std::vector<torrent_handle> torrents = QBtSession::instance()->getTorrents();
   std::vector<torrent_handle>::const_iterator it = torrents.begin();
@@ -373,8 +349,42 @@ QByteArray btjson::getFilesForTorrent(const QString& hash)
 QByteArray btjson::getTransferInfo()
 {
   CACHED_VARIABLE(QVariantMap, info, CACHE_DURATION_MS);
-  session_status sessionStatus = QBtSession::instance()->getSessionStatus();
+  const SessionSnapshotPtr snapshot = QBtSession::instance()->sessionSnapshot();
+  const session_status &sessionStatus = snapshot->status;
   info[KEY_TRANSFER_DLSPEED] = tr("D: %1/s - T: %2", "Download speed: x KiB/s - Transferred: x MiB").arg(misc::friendlyUnit(sessionStatus.payload_download_rate)).arg(misc::friendlyUnit(sessionStatus.total_payload_download));
   info[KEY_TRANSFER_UPSPEED] = tr("U: %1/s - T: %2", "Upload speed: x KiB/s - Transferred: x MiB").arg(misc::friendlyUnit(sessionStatus.payload_upload_rate)).arg(misc::friendlyUnit(sessionStatus.total_payload_upload));
   return json::toJson(info);
 }
+
+/**
+ * Returns the session settings covered by the performance
+ * profiles, as currently applied by libtorrent.
+ *
+ * The return value is a JSON-formatted dictionary, keyed by
+ * the libtorrent setting names, plus "performance_profile".
+ */
+QByteArray btjson::getSessionSettings()
+{
+  return json::toJson(QBtSession::instance()->getEffectiveSettings());
+}
+
+/**
+ * Returns the label bandwidth classes in JSON format.
+ *
+ * The return value is a JSON-formatted list of dictionaries.
+ * The dictionary keys are:
+ *   - "label": Label name
+ *   - "dl_limit", "up_limit": Configured rate limits, in KiB/s (0 is unlimited)
+ *   - "max_connec": Connections shared by the label's torrents (-1 is unlimited),
+ *     approximate since each torrent keeps at least 2 connections
+ *   - "weight": Bandwidth priority of the label's torrents
+ *   - "effective_dl_limit", "effective_up_limit": Rate limits in effect,
+ *     including the bandwidth schedule, in KiB/s
+ *   - "torrents": Number of torrents limited by the class
+ *   - "effective_max_connec": Connection cap in effect, at least 2 per torrent
+ *   - "dl_rate", "up_rate": Payload rates of these torrents, in bytes/s
+ */
+QByteArray btjson::getLabelBandwidth()
+{
+  return json::toJson(QBtSession::instance()->getLabelBandwidth()->status());
+}
@@ -46,6 +46,8 @@ public:
   static QByteArray getPropertiesForTorrent(const QString& hash);
   static QByteArray getFilesForTorrent(const QString& hash);
   static QByteArray getTransferInfo();
+  static QByteArray getSessionSettings();
+  static QByteArray getLabelBandwidth();
 }; // class btjson
 
 #endif // BTJSON_H
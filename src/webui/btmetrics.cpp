@@ -0,0 +1,245 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "btmetrics.h"
+#include "btjson.h"
+#include "qbtsession.h"
+#include "alertlatencystats.h"
+#include "requestlatencystats.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QStringList>
+
+#include <libtorrent/session.hpp>
+#include <libtorrent/disk_io_thread.hpp>
+
+using namespace libtorrent;
+
+// Scrapers may poll as often as they like, the metrics are gathered
+// at most once per CACHE_DURATION_MS
+static const int CACHE_DURATION_MS = 1000;
+
+namespace {
+
+  // Writes the samples, one family (HELP, TYPE and samples) at a time
+  class MetricsWriter {
+  public:
+    void family(const char *name, const char *type, const char *help) {
+      m_data += QByteArray("# HELP qbittorrent_") + name + ' ' + help + '\n';
+      m_data += QByteArray("# TYPE qbittorrent_") + name + ' ' + type + '\n';
+    }
+
+    void sample(const QByteArray &name, const QByteArray &labels, qint64 value) {
+      writeName(name, labels);
+      m_data += QByteArray::number(value) + '\n';
+    }
+
+    void sample(const QByteArray &name, const QByteArray &labels, double value) {
+      writeName(name, labels);
+      m_data += QByteArray::number(value, 'g', 12) + '\n';
+    }
+
+    void gauge(const char *name, const char *help, qint64 value) {
+      family(name, "gauge", help);
+      sample(name, QByteArray(), value);
+    }
+
+    void gauge(const char *name, const char *help, double value) {
+      family(name, "gauge", help);
+      sample(name, QByteArray(), value);
+    }
+
+    void counter(const char *name, const char *help, qint64 value) {
+      family(name, "counter", help);
+      sample(name, QByteArray(), value);
+    }
+
+    // 'bounds' are in microseconds, the buckets are not cumulative
+    void histogram(const QByteArray &name, const QByteArray &labels, const QVector<qint64> &bounds,
+                   const QVector<quint64> &buckets, quint64 count, quint64 sumUsecs) {
+      const QByteArray bucketName = name + "_bucket";
+      QByteArray prefix = labels;
+      if (!prefix.isEmpty())
+        prefix += ',';
+      quint64 cumulative = 0;
+      for (int i = 0; i < bounds.size(); ++i) {
+        cumulative += buckets.value(i);
+        const QByteArray le = "le=\"" + QByteArray::number(bounds[i] / 1e6, 'g', 12) + '"';
+        sample(bucketName, prefix + le, (qint64) cumulative);
+      }
+      sample(bucketName, prefix + "le=\"+Inf\"", (qint64) count);
+      sample(name + "_sum", labels, sumUsecs / 1e6);
+      sample(name + "_count", labels, (qint64) count);
+    }
+
+    const QByteArray& data() const { return m_data; }
+
+  private:
+    void writeName(const QByteArray &name, const QByteArray &labels) {
+      m_data += "qbittorrent_" + name;
+      if (!labels.isEmpty())
+        m_data += '{' + labels + '}';
+      m_data += ' ';
+    }
+
+    QByteArray m_data;
+  };
+
+  QByteArray label(const char *name, const QString &value) {
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return QByteArray(name) + "=\"" + escaped + '"';
+  }
+
+  void writeSessionStatus(MetricsWriter &w, const session_status &ss) {
+    w.gauge("download_rate_bytes", "Total download rate, in bytes per second.", (qint64) ss.download_rate);
+    w.gauge("upload_rate_bytes", "Total upload rate, in bytes per second.", (qint64) ss.upload_rate);
+    w.gauge("payload_download_rate_bytes", "Payload download rate, in bytes per second.", (qint64) ss.payload_download_rate);
+    w.gauge("payload_upload_rate_bytes", "Payload upload rate, in bytes per second.", (qint64) ss.payload_upload_rate);
+    w.gauge("ip_overhead_download_rate_bytes", "IP overhead download rate, in bytes per second.", (qint64) ss.ip_overhead_download_rate);
+    w.gauge("ip_overhead_upload_rate_bytes", "IP overhead upload rate, in bytes per second.", (qint64) ss.ip_overhead_upload_rate);
+    w.gauge("dht_download_rate_bytes", "DHT download rate, in bytes per second.", (qint64) ss.dht_download_rate);
+    w.gauge("dht_upload_rate_bytes", "DHT upload rate, in bytes per second.", (qint64) ss.dht_upload_rate);
+    w.gauge("tracker_download_rate_bytes", "Tracker download rate, in bytes per second.", (qint64) ss.tracker_download_rate);
+    w.gauge("tracker_upload_rate_bytes", "Tracker upload rate, in bytes per second.", (qint64) ss.tracker_upload_rate);
+
+    w.counter("downloaded_bytes_total", "Bytes downloaded in this session.", ss.total_download);
+    w.counter("uploaded_bytes_total", "Bytes uploaded in this session.", ss.total_upload);
+    w.counter("payload_downloaded_bytes_total", "Payload bytes downloaded in this session.", ss.total_payload_download);
+    w.counter("payload_uploaded_bytes_total", "Payload bytes uploaded in this session.", ss.total_payload_upload);
+    w.counter("ip_overhead_downloaded_bytes_total", "IP overhead bytes downloaded in this session.", ss.total_ip_overhead_download);
+    w.counter("ip_overhead_uploaded_bytes_total", "IP overhead bytes uploaded in this session.", ss.total_ip_overhead_upload);
+    w.counter("redundant_bytes_total", "Bytes downloaded more than once in this session.", ss.total_redundant_bytes);
+    w.counter("failed_bytes_total", "Bytes that failed the hash check in this session.", ss.total_failed_bytes);
+    w.counter("alltime_downloaded_bytes_total", "Bytes downloaded over all the sessions.", (qint64) QBtSession::instance()->getAlltimeDL());
+    w.counter("alltime_uploaded_bytes_total", "Bytes uploaded over all the sessions.", (qint64) QBtSession::instance()->getAlltimeUL());
+
+    w.gauge("peers", "Connected peers.", (qint64) ss.num_peers);
+    w.gauge("unchoked_peers", "Unchoked peers.", (qint64) ss.num_unchoked);
+    w.gauge("dht_nodes", "Nodes in the DHT routing table.", (qint64) ss.dht_nodes);
+    w.gauge("incoming_connections", "1 if incoming connections were received.", (qint64) ss.has_incoming_connections);
+    w.gauge("disk_read_queue_peers", "Peers waiting for a disk read.", (qint64) ss.disk_read_queue);
+    w.gauge("disk_write_queue_peers", "Peers waiting for a disk write.", (qint64) ss.disk_write_queue);
+  }
+
+  void writeCacheStatus(MetricsWriter &w, const cache_status &cs) {
+    w.counter("cache_blocks_read_total", "Blocks read from the disk cache or the disk.", cs.blocks_read);
+    w.counter("cache_blocks_read_hit_total", "Blocks read from the disk cache.", cs.blocks_read_hit);
+    w.counter("cache_blocks_written_total", "Blocks written to the disk.", cs.blocks_written);
+    w.counter("cache_reads_total", "Read operations on the disk.", cs.reads);
+    w.counter("cache_writes_total", "Write operations on the disk.", cs.writes);
+    w.gauge("cache_read_hit_ratio", "Ratio of the blocks read from the disk cache.",
+            cs.blocks_read > 0 ? (double) cs.blocks_read_hit / cs.blocks_read : 0.);
+    w.gauge("cache_queued_bytes", "Bytes waiting to be written to the disk.", (qint64) cs.queued_bytes);
+    w.gauge("cache_buffers_bytes", "Bytes of disk buffers in use.", (qint64) cs.total_used_buffers * 16 * 1024);
+    w.gauge("cache_blocks", "Blocks in the disk cache.", (qint64) cs.cache_size);
+    w.gauge("cache_read_blocks", "Blocks in the read cache.", (qint64) cs.read_cache_size);
+    w.gauge("disk_job_queue_length", "Jobs queued for the disk thread.", (qint64) cs.job_queue_length);
+    w.gauge("disk_job_average_seconds", "Average time spent on a disk job.", cs.average_job_time / 1000.);
+  }
+
+  // From the state updates, no torrent is queried on a scrape
+  void writeTorrentStates(MetricsWriter &w, const QHash<QString, int> &counts) {
+    static const char *const states[] = {
+      "downloading", "stalledDL", "uploading", "stalledUP", "pausedDL", "pausedUP",
+      "queuedDL", "queuedUP", "checkingDL", "checkingUP", "error"
+    };
+    qint64 total = 0;
+    foreach (int count, counts)
+      total += count;
+
+    w.gauge("torrents", "Torrents in the session.", total);
+    w.family("torrents_by_state", "gauge", "Torrents per state, as shown by the Web UI.");
+    for (uint i = 0; i < sizeof(states) / sizeof(states[0]); ++i)
+      w.sample("torrents_by_state", label("state", states[i]), (qint64) counts.value(states[i]));
+  }
+
+  void writeAlertStats(MetricsWriter &w, const AlertLatencyStats &stats) {
+    w.gauge("alerts_pending", "Alerts waiting to be handled by the main thread.", (qint64) QBtSession::instance()->pendingAlerts());
+    w.gauge("alert_jobs_pending", "Alert jobs waiting for a worker (resume data writes, ...).", (qint64) QBtSession::instance()->pendingAlertJobs());
+
+    const QList<AlertLatencyStats::Histogram> histograms = stats.histograms();
+    w.family("alert_handling_seconds", "histogram", "Time spent handling the alerts, per alert and stage.");
+    foreach (const AlertLatencyStats::Histogram &h, histograms) {
+      w.histogram("alert_handling_seconds",
+                  label("alert", h.alert) + ',' + label("stage", AlertLatencyStats::stageName(h.stage)),
+                  AlertLatencyStats::bucketBounds(), h.buckets, h.count, h.sumUsecs);
+    }
+    // The fast resume files are bencoded and written by the workers
+    w.family("resume_data_save_seconds", "histogram", "Time spent writing a fast resume file.");
+    foreach (const AlertLatencyStats::Histogram &h, histograms) {
+      if (h.stage == AlertLatencyStats::WorkerStage && h.alert == "save_resume_data_alert") {
+        w.histogram("resume_data_save_seconds", QByteArray(),
+                    AlertLatencyStats::bucketBounds(), h.buckets, h.count, h.sumUsecs);
+      }
+    }
+  }
+
+  void writeRequestStats(MetricsWriter &w, const RequestLatencyStats &stats) {
+    w.family("webui_request_seconds", "histogram", "Time spent handling the Web UI requests, per route.");
+    foreach (const RequestLatencyStats::Histogram &h, stats.histograms()) {
+      w.histogram("webui_request_seconds", label("route", h.route),
+                  RequestLatencyStats::bucketBounds(), h.buckets, h.count, h.sumUsecs);
+    }
+  }
+}
+
+/**
+ * Returns the metrics in the Prometheus text format.
+ *
+ * All the names start with "qbittorrent_". They cover the session
+ * status (rates and totals), the disk cache, the torrent count per
+ * state, the alert queues and handling times, the fast resume writes,
+ * the Web UI request handling times and the IP filter.
+ */
+QByteArray btmetrics::getMetrics(const RequestLatencyStats &requestStats)
+{
+  static QByteArray cached;
+  static QElapsedTimer cacheTimer;
+  if (cacheTimer.isValid() && !cacheTimer.hasExpired(CACHE_DURATION_MS))
+    return cached;
+  cacheTimer.start();
+
+  QBtSession *btSession = QBtSession::instance();
+  const SessionSnapshotPtr snapshot = btSession->sessionSnapshot();
+  MetricsWriter w;
+  writeSessionStatus(w, snapshot->status);
+  writeCacheStatus(w, snapshot->cache);
+  writeTorrentStates(w, snapshot->torrentStates);
+  writeAlertStats(w, *btSession->alertLatencyStats());
+  writeRequestStats(w, requestStats);
+  w.gauge("ip_filter_rules", "Rules of the IP filter in use.", (qint64) btSession->ipFilterRuleCount());
+
+  cached = w.data();
+  return cached;
+}
@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt4 and libtorrent.
- * Copyright (C) 2006-2012  Christophe Dumez
+ * Copyright (C) 2014  qBittorrent project
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -28,25 +28,22 @@
  * Contact : chris@qbittorrent.org
  */
 
-#ifndef TORRENTCONTENTMODELFILE_H
-#define TORRENTCONTENTMODELFILE_H
+#ifndef BTMETRICS_H
+#define BTMETRICS_H
 
-#include "torrentcontentmodelitem.h"
+#include <QByteArray>
 
-class TorrentContentModelFile : public TorrentContentModelItem
-{
-public:
-  TorrentContentModelFile(const libtorrent::file_entry& f,
-                          TorrentContentModelFolder* parent,
-                          int file_index);
+class RequestLatencyStats;
 
-  int fileIndex() const;
-  void setPriority(int new_prio, bool update_parent = true);
-  void setProgress(qulonglong done);
-  ItemType itemType() const { return FileType; }
+// Operational counters and gauges in the Prometheus text exposition
+// format (version 0.0.4), served on /metrics.
+class btmetrics {
 
 private:
-  int m_fileIndex;
-};
+  btmetrics() {}
+
+public:
+  static QByteArray getMetrics(const RequestLatencyStats &requestStats);
+}; // class btmetrics
 
-#endif // TORRENTCONTENTMODELFILE_H
+#endif // BTMETRICS_H
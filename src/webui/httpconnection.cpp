@@ -36,8 +36,11 @@
 #include "preferences.h"
 #include "btjson.h"
 #include "prefjson.h"
+#include "btmetrics.h"
 #include "qbtsession.h"
+#include "labelbandwidth.h"
 #include "misc.h"
+#include "tracer.h"
 #ifndef DISABLE_GUI
 #include "iconprovider.h"
 #endif
@@ -53,6 +56,31 @@
 
 using namespace libtorrent;
 
+namespace {
+  // The routes recorded in the request latency stats. The others are
+  // grouped, or any URL would add a histogram and a metrics series.
+  QString knownRoute(const QString &route) {
+    static QStringList routes;
+    if (routes.isEmpty()) {
+      routes << "json/torrents" << "json/propertiesGeneral" << "json/propertiesTrackers"
+             << "json/propertiesFiles" << "json/preferences" << "json/transferInfo"
+             << "json/sessionSettings" << "json/labelBandwidth"
+             << "command/download" << "command/addTrackers" << "command/upload"
+             << "command/resumeall" << "command/pauseall" << "command/resume"
+             << "command/pause" << "command/delete" << "command/deletePerm"
+             << "command/setPreferences" << "command/setFilePrio"
+             << "command/getGlobalUpLimit" << "command/getGlobalDlLimit"
+             << "command/getTorrentUpLimit" << "command/getTorrentDlLimit"
+             << "command/setTorrentUpLimit" << "command/setTorrentDlLimit"
+             << "command/setGlobalUpLimit" << "command/setGlobalDlLimit"
+             << "command/setLabelBandwidth" << "command/increasePrio"
+             << "command/decreasePrio" << "command/topPrio" << "command/bottomPrio"
+             << "command/recheck" << "command/shutdown" << "command/dumpTrace";
+    }
+    return routes.contains(route) ? route : QString::fromUtf8("other");
+  }
+}
+
 HttpConnection::HttpConnection(QTcpSocket *socket, HttpServer *parent)
   : QObject(parent), m_socket(socket), m_httpserver(parent)
 {
@@ -89,6 +117,8 @@ void HttpConnection::read()
     return;
   }
 
+  m_requestTimer.start();
+  m_route = "invalid";
   const QByteArray header = m_receivedData.left(header_end);
   m_parser.writeHeader(header);
   if (m_parser.isError()) {
@@ -139,6 +169,8 @@ void HttpConnection::read()
 void HttpConnection::write()
 {
   m_socket->write(m_generator.toByteArray());
+  if (m_requestTimer.isValid())
+    m_httpserver->requestStats().record(m_route, m_requestTimer.nsecsElapsed() / 1000);
   m_socket->disconnectFromHost();
 }
 
@@ -188,12 +220,14 @@ void HttpConnection::translateDocument(QString& data) {
 }
 
 void HttpConnection::respond() {
+  QBT_TRACE_SCOPE("HttpConnection::respond");
   if ((m_socket->peerAddress() != QHostAddress::LocalHost
       && m_socket->peerAddress() != QHostAddress::LocalHostIPv6)
      || m_httpserver->isLocalAuthEnabled()) {
     // Authentication
     const QString peer_ip = m_socket->peerAddress().toString();
     const int nb_fail = m_httpserver->NbFailedAttemptsForIp(peer_ip);
+    m_route = "unauthorized";
     if (nb_fail >= MAX_AUTH_FAILED_ATTEMPTS) {
       m_generator.setStatusLine(403, "Forbidden");
       m_generator.setMessage(tr("Your IP address has been banned after too many failed authentication attempts."));
@@ -227,6 +261,7 @@ void HttpConnection::respond() {
     // Client successfully authenticated, reset number of failed attempts
     m_httpserver->resetNbFailedAttemptsForIp(peer_ip);
   }
+  m_route = "static";
   QString url  = m_parser.url();
   // Favicon
   if (url.endsWith("favicon.ico")) {
@@ -255,8 +290,15 @@ void HttpConnection::respond() {
   if (list.isEmpty())
     list.append("index.html");
 
+  if (list.size() == 1 && list[0] == "metrics") {
+    m_route = "metrics";
+    respondMetrics();
+    return;
+  }
+
   if (list.size() >= 2) {
     if (list[0] == "json") {
+      m_route = knownRoute("json/" + list[1]);
       if (list[1] == "torrents") {
         respondTorrentsJson();
         return;
@@ -286,11 +328,31 @@ void HttpConnection::respond() {
             respondGlobalTransferInfoJson();
             return;
           }
+          if (list[1] == "sessionSettings") {
+            respondSessionSettingsJson();
+            return;
+          }
+          if (list[1] == "labelBandwidth") {
+            respondLabelBandwidthJson();
+            return;
+          }
         }
       }
     }
     if (list[0] == "command") {
       const QString& command = list[1];
+      m_route = knownRoute("command/" + command);
+#ifdef QBT_TRACING
+      if (command == "dumpTrace") {
+        // Trace of the recent hot path events, for chrome://tracing
+        m_generator.setStatusLine(200, "OK");
+        m_generator.setContentType("application/json");
+        m_generator.setMessage(Tracer::instance()->toChromeTrace());
+        m_generator.setContentEncoding(m_parser.acceptsEncoding());
+        write();
+        return;
+      }
+#endif
       if (command == "shutdown") {
         qDebug() << "Shutdown request from Web UI";
         // Special case handling for shutdown, we
@@ -314,6 +376,7 @@ void HttpConnection::respond() {
 
   // Icons from theme
   //qDebug() << "list[0]" << list[0];
+  m_route = "static";
   if (list[0] == "theme" && list.size() == 2) {
 #ifdef DISABLE_GUI
     url = ":/Icons/oxygen/"+list[1]+".png";
@@ -363,6 +426,7 @@ void HttpConnection::respond() {
 }
 
 void HttpConnection::respondNotFound() {
+  m_route = "not_found";
   m_generator.setStatusLine(404, "File not found");
   m_generator.setContentEncoding(m_parser.acceptsEncoding());
   write();
@@ -416,6 +480,30 @@ void HttpConnection::respondGlobalTransferInfoJson() {
   write();
 }
 
+void HttpConnection::respondSessionSettingsJson() {
+  m_generator.setStatusLine(200, "OK");
+  m_generator.setContentTypeByExt("js");
+  m_generator.setMessage(btjson::getSessionSettings());
+  m_generator.setContentEncoding(m_parser.acceptsEncoding());
+  write();
+}
+
+void HttpConnection::respondLabelBandwidthJson() {
+  m_generator.setStatusLine(200, "OK");
+  m_generator.setContentTypeByExt("js");
+  m_generator.setMessage(btjson::getLabelBandwidth());
+  m_generator.setContentEncoding(m_parser.acceptsEncoding());
+  write();
+}
+
+void HttpConnection::respondMetrics() {
+  m_generator.setStatusLine(200, "OK");
+  m_generator.setContentType("text/plain; version=0.0.4");
+  m_generator.setMessage(btmetrics::getMetrics(m_httpserver->requestStats()));
+  m_generator.setContentEncoding(m_parser.acceptsEncoding());
+  write();
+}
+
 void HttpConnection::respondCommand(const QString& command) {
   qDebug() << Q_FUNC_INFO << command;
   if (command == "download") {
@@ -578,6 +666,17 @@ void HttpConnection::respondCommand(const QString& command) {
     Preferences().setGlobalUploadLimit(limit/1024.);
     return;
   }
+  if (command == "setLabelBandwidth") {
+    // Rates in KiB/s, 0 is unlimited. Unlimited everything removes the class.
+    LabelLimits limits;
+    limits.downloadLimit = LabelLimits::boundRate(m_parser.post("dl_limit").toInt());
+    limits.uploadLimit = LabelLimits::boundRate(m_parser.post("up_limit").toInt());
+    if (!m_parser.post("max_connec").isEmpty())
+      limits.maxConnections = qMax(-1, m_parser.post("max_connec").toInt());
+    limits.weight = qBound(0, m_parser.post("weight").toInt(), 255);
+    QBtSession::instance()->getLabelBandwidth()->setLabelClass(m_parser.post("label"), limits);
+    return;
+  }
   if (command == "setGlobalDlLimit") {
     qlonglong limit = m_parser.post("limit").toLongLong();
     if (limit == 0) limit = -1;
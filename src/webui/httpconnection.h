@@ -34,6 +34,7 @@
 
 #include "httprequestparser.h"
 #include "httpresponsegenerator.h"
+#include <QElapsedTimer>
 #include <QObject>
 
 class HttpServer;
@@ -61,6 +62,9 @@ protected slots:
   void respondFilesPropertiesJson(const QString& hash);
   void respondPreferencesJson();
   void respondGlobalTransferInfoJson();
+  void respondSessionSettingsJson();
+  void respondLabelBandwidthJson();
+  void respondMetrics();
   void respondCommand(const QString& command);
   void respondNotFound();
   void processDownloadedFile(const QString& url, const QString& file_path);
@@ -89,6 +93,9 @@ private:
   HttpRequestParser m_parser;
   HttpResponseGenerator m_generator;
   QByteArray m_receivedData;
+  // Handling time of the current request, per route
+  QElapsedTimer m_requestTimer;
+  QString m_route;
 };
 
 #endif
@@ -44,6 +44,7 @@
 #endif
 
 #include "preferences.h"
+#include "requestlatencystats.h"
 
 class EventManager;
 
@@ -68,6 +69,7 @@ public:
   int NbFailedAttemptsForIp(const QString& ip) const;
   void increaseNbFailedAttemptsForIp(const QString& ip);
   void resetNbFailedAttemptsForIp(const QString& ip);
+  inline RequestLatencyStats& requestStats() { return m_requestStats; }
 
 #ifndef QT_NO_OPENSSL
   void enableHttps(const QSslCertificate &certificate, const QSslKey &key);
@@ -92,6 +94,7 @@ private:
   QByteArray m_passwordSha1;
   QHash<QString, int> m_clientFailedAttempts;
   bool m_localAuthEnabled;
+  RequestLatencyStats m_requestStats;
 #ifndef QT_NO_OPENSSL
   bool m_https;
   QSslCertificate m_certificate;
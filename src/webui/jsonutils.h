@@ -52,6 +52,18 @@ inline QByteArray toJson(const QVariant& var)
 #endif
 }
 
+// Without any line break, for line delimited messages
+inline QByteArray toCompactJson(const QVariant& var)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+  return QJsonDocument::fromVariant(var).toJson(QJsonDocument::Compact);
+#else
+  QJson::Serializer serializer;
+  serializer.setIndentMode(QJson::IndentCompact);
+  return serializer.serialize(var);
+#endif
+}
+
 inline QVariant fromJson(const QString& json)
 {
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
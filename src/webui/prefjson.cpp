@@ -104,6 +104,7 @@ QByteArray prefjson::getPreferences()
   data["schedule_to_hour"] = end_time.hour();
   data["schedule_to_min"] = end_time.minute();
   data["scheduler_days"] = pref.getSchedulerDays();
+  data["scheduler_rules"] = pref.getSchedulerRules();
   // Bittorrent
   data["dht"] = pref.isDHTEnabled();
   data["dhtSameAsBT"] = pref.isDHTPortSameAsBT();
@@ -112,6 +113,7 @@ QByteArray prefjson::getPreferences()
   data["lsd"] = pref.isLSDEnabled();
   data["encryption"] = pref.getEncryptionSetting();
   data["anonymous_mode"] = pref.isAnonymousModeEnabled();
+  data["performance_profile"] = pref.getPerformanceProfile();
   // Proxy
   data["proxy_type"] = pref.getProxyType();
   data["proxy_ip"] = pref.getProxyIp();
@@ -267,6 +269,8 @@ void prefjson::setPreferences(const QString& json)
   }
   if (m.contains("scheduler_days"))
     pref.setSchedulerDays(scheduler_days(m["scheduler_days"].toInt()));
+  if (m.contains("scheduler_rules"))
+    pref.setSchedulerRules(m["scheduler_rules"].toList());
   // Bittorrent
   if (m.contains("dht"))
     pref.setDHTEnabled(m["dht"].toBool());
@@ -283,6 +287,8 @@ void prefjson::setPreferences(const QString& json)
     pref.setEncryptionSetting(m["encryption"].toInt());
   if (m.contains("anonymous_mode"))
     pref.enableAnonymousMode(m["anonymous_mode"].toBool());
+  if (m.contains("performance_profile"))
+    pref.setPerformanceProfile(m["performance_profile"].toInt());
   // Proxy
   if (m.contains("proxy_type"))
     pref.setProxyType(m["proxy_type"].toInt());
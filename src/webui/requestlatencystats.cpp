@@ -0,0 +1,71 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#include "requestlatencystats.h"
+
+RequestLatencyStats::RequestLatencyStats()
+{
+}
+
+const QVector<qint64>& RequestLatencyStats::bucketBounds()
+{
+  static QVector<qint64> bounds;
+  if (bounds.isEmpty()) {
+    bounds << 100 << 250 << 500 << 1000
+           << 2500 << 5000 << 10000 << 25000
+           << 50000 << 100000 << 250000 << 500000
+           << 1000000 << 2500000;
+  }
+  return bounds;
+}
+
+void RequestLatencyStats::record(const QString &route, qint64 usecs)
+{
+  if (usecs < 0)
+    usecs = 0;
+  const QVector<qint64>& bounds = bucketBounds();
+  int bucket = 0;
+  while (bucket < bounds.size() && usecs > bounds[bucket])
+    ++bucket;
+
+  Histogram &h = m_histograms[route];
+  if (h.buckets.isEmpty()) {
+    h.route = route;
+    h.buckets.fill(0, bounds.size() + 1);
+  }
+  ++h.count;
+  h.sumUsecs += usecs;
+  ++h.buckets[bucket];
+}
+
+QList<RequestLatencyStats::Histogram> RequestLatencyStats::histograms() const
+{
+  return m_histograms.values();
+}
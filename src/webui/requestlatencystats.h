@@ -0,0 +1,67 @@
+/*
+ * Bittorrent Client using Qt4 and libtorrent.
+ * Copyright (C) 2014  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ *
+ * Contact : chris@qbittorrent.org
+ */
+
+#ifndef REQUESTLATENCYSTATS_H
+#define REQUESTLATENCYSTATS_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// Handling time histograms of the Web UI requests, per route
+// (e.g. "json/torrents", "command/pause", "static").
+// Only used from the thread of the HTTP server.
+class RequestLatencyStats {
+  Q_DISABLE_COPY(RequestLatencyStats)
+
+public:
+  struct Histogram {
+    Histogram(): count(0), sumUsecs(0) {}
+    QString route;
+    quint64 count;
+    quint64 sumUsecs;
+    // One counter per bucketBounds() entry, plus the overflow bucket
+    QVector<quint64> buckets;
+  };
+
+  RequestLatencyStats();
+
+  void record(const QString &route, qint64 usecs);
+  QList<Histogram> histograms() const;
+
+  // Upper bounds (inclusive, in microseconds) of the histogram buckets
+  static const QVector<qint64>& bucketBounds();
+
+private:
+  QHash<QString, Histogram> m_histograms;
+};
+
+#endif // REQUESTLATENCYSTATS_H
@@ -5,6 +5,8 @@ HEADERS += $$PWD/httpserver.h \
            $$PWD/httprequestparser.h \
            $$PWD/httpresponsegenerator.h \
            $$PWD/btjson.h \
+           $$PWD/btmetrics.h \
+           $$PWD/requestlatencystats.h \
            $$PWD/prefjson.h \
            $$PWD/httpheader.h \
            $$PWD/httprequestheader.h \
@@ -16,6 +18,8 @@ SOURCES += $$PWD/httpserver.cpp \
            $$PWD/httprequestparser.cpp \
            $$PWD/httpresponsegenerator.cpp \
            $$PWD/btjson.cpp \
+           $$PWD/btmetrics.cpp \
+           $$PWD/requestlatencystats.cpp \
            $$PWD/prefjson.cpp \
            $$PWD/httpheader.cpp \
            $$PWD/httprequestheader.cpp \